@@ -112,6 +112,7 @@ typedef struct _AnchorCoord             AnchorCoord;
 typedef struct _SizeRequest             SizeRequest;
 
 typedef struct _ClutterLayoutInfo       ClutterLayoutInfo;
+typedef struct _ClutterLayoutStats      ClutterLayoutStats;
 typedef struct _ClutterTransformInfo    ClutterTransformInfo;
 typedef struct _ClutterAnimationInfo    ClutterAnimationInfo;
 
@@ -175,6 +176,23 @@ struct _ClutterLayoutInfo
   ClutterSize natural;
 };
 
+/*< private >
+ * ClutterLayoutStats:
+ * @n_allocations: the number of calls to #ClutterActorClass.allocate()
+ * @n_size_requests: the number of preferred sizes that were not cached
+ * @n_kept_size_requests: the number of actors that kept their cached
+ *   preferred sizes after one of their children queued a relayout
+ *
+ * Counters for the work done by a relayout of the stage, reported by
+ * the "layout" debug note.
+ */
+struct _ClutterLayoutStats
+{
+  guint n_allocations;
+  guint n_size_requests;
+  guint n_kept_size_requests;
+};
+
 const ClutterLayoutInfo *       _clutter_actor_get_layout_info_or_defaults      (ClutterActor *self);
 ClutterLayoutInfo *             _clutter_actor_get_layout_info                  (ClutterActor *self);
 ClutterLayoutInfo *             _clutter_actor_peek_layout_info                 (ClutterActor *self);
@@ -317,6 +335,8 @@ void                            _clutter_actor_queue_redraw_on_clones
 void                            _clutter_actor_queue_relayout_on_clones                 (ClutterActor *actor);
 void                            _clutter_actor_queue_only_relayout                      (ClutterActor *actor);
 
+ClutterLayoutStats *            _clutter_actor_get_layout_stats                         (void);
+
 CoglFramebuffer *               _clutter_actor_get_active_framebuffer                   (ClutterActor *actor);
 
 ClutterPaintNode *              clutter_actor_create_texture_paint_node                 (ClutterActor *self,
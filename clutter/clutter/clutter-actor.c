@@ -668,9 +668,36 @@ typedef enum {
                               */
 } MapStateChange;
 
-/* 3 entries should be a good compromise, few layout managers
- * will ask for 3 different preferred size in each allocation cycle */
-#define N_CACHED_SIZE_REQUESTS 3
+/* layout managers like the grid and flow layouts ask for a few
+ * different preferred sizes in each allocation cycle, and the cache
+ * is also used to check whether the preferred size of an actor has
+ * changed, so keep more than those */
+#define N_CACHED_SIZE_REQUESTS 6
+
+/* The state of an actor, besides its preferred size, that is used by
+ * layout managers to compute the preferred size of its parent
+ */
+typedef struct _LayoutSnapshot
+{
+  ClutterPoint fixed_pos;
+  ClutterRequestMode request_mode;
+
+  guint is_visible   : 1;
+  guint position_set : 1;
+} LayoutSnapshot;
+
+/* The size requests from before the preferred size of an actor was
+ * invalidated, kept until its parent checks whether they changed. They
+ * only exist between a relayout and the next size request of the parent,
+ * so they are allocated separately instead of growing every actor.
+ */
+typedef struct _StaleSizeRequests
+{
+  SizeRequest width_requests[N_CACHED_SIZE_REQUESTS];
+  SizeRequest height_requests[N_CACHED_SIZE_REQUESTS];
+
+  guint evicted : 1;
+} StaleSizeRequests;
 
 struct _ClutterActorPrivate
 {
@@ -685,6 +712,14 @@ struct _ClutterActorPrivate
   guint cached_height_age;
   guint cached_width_age;
 
+  /* the size requests from before the preferred size was last
+   * invalidated, until the parent checks whether they changed
+   */
+  StaleSizeRequests *stale_size_requests;
+
+  /* the layout state when the parent last computed its preferred size */
+  LayoutSnapshot parent_snapshot;
+
   /* the bounding box of the actor, relative to the parent's
    * allocation
    */
@@ -803,6 +838,12 @@ struct _ClutterActorPrivate
   gpointer create_child_data;
   GDestroyNotify create_child_notify;
 
+  /* the paint nodes built by the last paint, if they are retained, and
+   * the paint opacity they were built with
+   */
+  ClutterPaintNode *retained_paint_node;
+  guint8 retained_paint_opacity;
+
   /* bitfields: KEEP AT THE END */
 
   /* fixed position and sizes */
@@ -840,6 +881,12 @@ struct _ClutterActorPrivate
   guint needs_compute_expand        : 1;
   guint needs_x_expand              : 1;
   guint needs_y_expand              : 1;
+  guint retain_paint_nodes          : 1;
+  /* the cached size requests are kept while a relayout queued by a
+   * child is pending, until we know whether our preferred size changed */
+  guint needs_size_validation       : 1;
+  guint relayout_from_child         : 1;
+  guint size_requests_evicted       : 1;
 };
 
 enum
@@ -1106,6 +1153,9 @@ static GQuark quark_actor_layout_info = 0;
 static GQuark quark_actor_transform_info = 0;
 static GQuark quark_actor_animation_info = 0;
 
+/* reset by the stage before each relayout */
+static ClutterLayoutStats layout_stats = { 0, };
+
 G_DEFINE_TYPE_WITH_CODE (ClutterActor,
                          clutter_actor,
                          G_TYPE_INITIALLY_UNOWNED,
@@ -2029,6 +2079,8 @@ clutter_actor_real_unrealize (ClutterActor *self)
 {
   /* we must be unmapped (implying our children are also unmapped) */
   g_assert (!CLUTTER_ACTOR_IS_MAPPED (self));
+
+  g_clear_pointer (&self->priv->retained_paint_node, clutter_paint_node_unref);
 }
 
 /**
@@ -2231,12 +2283,13 @@ clutter_actor_real_pick (ClutterActor       *self,
       width = box.x2 - box.x1;
       height = box.y2 - box.y1;
 
-      cogl_set_source_color4ub (color->red,
-                                color->green,
-                                color->blue,
-                                color->alpha);
-
-      cogl_rectangle (0, 0, width, height);
+      clutter_actor_pick_box (self,
+                              &(ClutterActorBox) {
+                                .x1 = 0,
+                                .y1 = 0,
+                                .x2 = width,
+                                .y2 = height,
+                              });
     }
 
   /* XXX - this thoroughly sucks, but we need to maintain compatibility
@@ -2257,6 +2310,97 @@ clutter_actor_real_pick (ClutterActor       *self,
     }
 }
 
+/**
+ * clutter_actor_pick_box:
+ * @self: A #ClutterActor
+ * @box: (transfer none): a rectangle in the actor's coordinate space
+ *
+ * Describes @box as a pickable area of @self. This should be called
+ * inside the implementation of the #ClutterActor::pick virtual function,
+ * instead of painting the silhouette of the actor in the pick color.
+ *
+ * When the stage is picked geometrically, @box is recorded without
+ * drawing anything; otherwise it is painted using the pick color of
+ * @self.
+ */
+void
+clutter_actor_pick_box (ClutterActor          *self,
+                        const ClutterActorBox *box)
+{
+  ClutterStage *stage;
+
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (box != NULL);
+
+  if (box->x1 >= box->x2 || box->y1 >= box->y2)
+    return;
+
+  stage = (ClutterStage *) _clutter_actor_get_stage_internal (self);
+
+  if (stage != NULL && _clutter_stage_is_geometric_picking (stage))
+    {
+      _clutter_stage_log_pick (stage, box, self);
+    }
+  else
+    {
+      ClutterColor color = { 0, };
+
+      _clutter_id_to_color (_clutter_actor_get_pick_id (self), &color);
+
+      cogl_set_source_color4ub (color.red,
+                                color.green,
+                                color.blue,
+                                color.alpha);
+
+      cogl_rectangle (box->x1, box->y1, box->x2, box->y2);
+    }
+}
+
+/* The ClutterActorClass.pick implementations which only emit geometry
+ * through clutter_actor_pick_box() and painting their children. */
+static GHashTable *geometric_pick_funcs = NULL;
+
+/**
+ * clutter_actor_class_set_geometric_pick:
+ * @klass: A #ClutterActorClass
+ *
+ * Declares that the #ClutterActorClass.pick implementation of @klass
+ * only describes the actor through clutter_actor_pick_box(), by chaining
+ * up and by painting children, so that actors of this class can be
+ * picked without rendering the stage.
+ *
+ * Actors with any other pick implementation, or with handlers connected
+ * to #ClutterActor::pick, make the stage fall back to rendering a pick
+ * buffer. This should be called from the class_init function, after
+ * setting the pick virtual function.
+ */
+void
+clutter_actor_class_set_geometric_pick (ClutterActorClass *klass)
+{
+  g_return_if_fail (CLUTTER_IS_ACTOR_CLASS (klass));
+  g_return_if_fail (klass->pick != NULL);
+
+  if (geometric_pick_funcs == NULL)
+    geometric_pick_funcs = g_hash_table_new (NULL, NULL);
+
+  g_hash_table_add (geometric_pick_funcs, (gpointer) klass->pick);
+}
+
+static gboolean
+clutter_actor_has_geometric_pick (ClutterActor *self)
+{
+  ClutterActorClass *klass = CLUTTER_ACTOR_GET_CLASS (self);
+
+  if (g_signal_has_handler_pending (self, actor_signals[PICK], 0, TRUE))
+    return FALSE;
+
+  if (klass->pick == clutter_actor_real_pick)
+    return TRUE;
+
+  return geometric_pick_funcs != NULL &&
+         g_hash_table_contains (geometric_pick_funcs, (gpointer) klass->pick);
+}
+
 /**
  * clutter_actor_should_pick_paint:
  * @self: A #ClutterActor
@@ -2507,6 +2651,12 @@ clutter_actor_set_allocation_internal (ClutterActor           *self,
           g_object_notify_by_pspec (obj, obj_props[PROP_CONTENT_BOX]);
         }
 
+      /* the paint nodes are in actor coordinates, so they only
+       * depend on the size of the allocation */
+      if (box->x2 - box->x1 != old_alloc.x2 - old_alloc.x1 ||
+          box->y2 - box->y1 != old_alloc.y2 - old_alloc.y1)
+        g_clear_pointer (&priv->retained_paint_node, clutter_paint_node_unref);
+
       retval = TRUE;
     }
   else
@@ -2726,27 +2876,91 @@ clutter_actor_real_queue_redraw (ClutterActor *self,
 }
 
 static void
-clutter_actor_real_queue_relayout (ClutterActor *self)
+clutter_actor_clear_stale_size_requests (ClutterActor *self)
 {
   ClutterActorPrivate *priv = self->priv;
 
-  /* no point in queueing a redraw on a destroyed actor */
-  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
-    return;
+  if (priv->stale_size_requests != NULL)
+    {
+      g_slice_free (StaleSizeRequests, priv->stale_size_requests);
+      priv->stale_size_requests = NULL;
+    }
+}
+
+static void
+clutter_actor_invalidate_size_requests (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  /* keep the requests the parent computed its own preferred size
+   * from, so that it can check whether they changed
+   */
+  if (priv->stale_size_requests == NULL)
+    {
+      StaleSizeRequests *stale = g_slice_new (StaleSizeRequests);
+
+      memcpy (stale->width_requests, priv->width_requests,
+              N_CACHED_SIZE_REQUESTS * sizeof (SizeRequest));
+      memcpy (stale->height_requests, priv->height_requests,
+              N_CACHED_SIZE_REQUESTS * sizeof (SizeRequest));
+
+      stale->evicted = priv->size_requests_evicted;
+      priv->stale_size_requests = stale;
+    }
 
   priv->needs_width_request  = TRUE;
   priv->needs_height_request = TRUE;
-  priv->needs_allocation     = TRUE;
+  priv->needs_size_validation = FALSE;
+  priv->size_requests_evicted = FALSE;
 
   /* reset the cached size requests */
   memset (priv->width_requests, 0,
           N_CACHED_SIZE_REQUESTS * sizeof (SizeRequest));
   memset (priv->height_requests, 0,
           N_CACHED_SIZE_REQUESTS * sizeof (SizeRequest));
+}
+
+static void
+clutter_actor_queue_relayout_from_child (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  /* the ancestors have already been told about another child */
+  if (priv->needs_size_validation && priv->needs_allocation)
+    return;
+
+  priv->relayout_from_child = TRUE;
+  _clutter_actor_queue_only_relayout (self);
+  priv->relayout_from_child = FALSE;
+}
+
+static void
+clutter_actor_real_queue_relayout (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  gboolean from_child = priv->relayout_from_child;
+
+  /* no point in queueing a redraw on a destroyed actor */
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return;
+
+  /* if only a descendant changed, our preferred size only changes if
+   * the preferred size of one of our children does; we check for that
+   * lazily, instead of throwing away the cached size requests of every
+   * ancestor of the descendant
+   */
+  if (from_child &&
+      !priv->needs_width_request &&
+      !priv->needs_height_request)
+    priv->needs_size_validation = TRUE;
+  else
+    clutter_actor_invalidate_size_requests (self);
+
+  priv->needs_allocation = TRUE;
 
   /* We need to go all the way up the hierarchy */
   if (priv->parent != NULL)
-    _clutter_actor_queue_only_relayout (priv->parent);
+    clutter_actor_queue_relayout_from_child (priv->parent);
 }
 
 /**
@@ -3735,6 +3949,42 @@ clutter_actor_paint_node (ClutterActor     *actor,
   return TRUE;
 }
 
+/* Paints the actor through the paint nodes retained from a previous
+ * paint, building them first if they have been invalidated.
+ */
+static void
+clutter_actor_paint_retained_node (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  guint8 paint_opacity;
+
+  /* the nodes bake the paint opacity into their pipelines, and it
+   * changes without a redraw being queued on the actor when one of
+   * its parents changes its opacity
+   */
+  paint_opacity = clutter_actor_get_paint_opacity_internal (self);
+  if (priv->retained_paint_node != NULL &&
+      priv->retained_paint_opacity != paint_opacity)
+    g_clear_pointer (&priv->retained_paint_node, clutter_paint_node_unref);
+
+  if (priv->retained_paint_node == NULL)
+    {
+      priv->retained_paint_node = _clutter_dummy_node_new (self);
+      priv->retained_paint_opacity = paint_opacity;
+      clutter_paint_node_set_name (priv->retained_paint_node, "Root");
+
+      clutter_actor_paint_node (self, priv->retained_paint_node);
+      return;
+    }
+
+  /* the active framebuffer differs for each stage view */
+  _clutter_dummy_node_set_framebuffer (priv->retained_paint_node,
+                                       _clutter_actor_get_active_framebuffer (self));
+
+  if (clutter_paint_node_get_n_children (priv->retained_paint_node) > 0)
+    _clutter_paint_node_paint (priv->retained_paint_node);
+}
+
 /**
  * clutter_actor_paint:
  * @self: A #ClutterActor
@@ -3760,6 +4010,7 @@ clutter_actor_paint (ClutterActor *self)
   ClutterPickMode pick_mode;
   gboolean clip_set = FALSE;
   gboolean shader_applied = FALSE;
+  gboolean geometric_pick;
   ClutterStage *stage;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
@@ -3792,6 +4043,14 @@ clutter_actor_paint (ClutterActor *self)
 
   stage = (ClutterStage *) _clutter_actor_get_stage_internal (self);
 
+  geometric_pick = (pick_mode != CLUTTER_PICK_NONE &&
+                    _clutter_stage_is_geometric_picking (stage));
+
+  /* there's no point in walking the rest of the scene graph once the
+   * geometric pick fell back to rendering */
+  if (geometric_pick && _clutter_stage_has_failed_geometric_pick (stage))
+    return;
+
   /* mark that we are in the paint process */
   CLUTTER_SET_PRIVATE_FLAGS (self, CLUTTER_IN_PAINT);
 
@@ -3850,23 +4109,50 @@ clutter_actor_paint (ClutterActor *self)
 
   if (priv->has_clip)
     {
-      CoglFramebuffer *fb = _clutter_stage_get_active_framebuffer (stage);
-      cogl_framebuffer_push_rectangle_clip (fb,
-                                            priv->clip.origin.x,
-                                            priv->clip.origin.y,
-                                            priv->clip.origin.x + priv->clip.size.width,
-                                            priv->clip.origin.y + priv->clip.size.height);
+      ClutterActorBox clip_box = {
+        .x1 = priv->clip.origin.x,
+        .y1 = priv->clip.origin.y,
+        .x2 = priv->clip.origin.x + priv->clip.size.width,
+        .y2 = priv->clip.origin.y + priv->clip.size.height,
+      };
+
+      if (geometric_pick)
+        {
+          _clutter_stage_push_pick_clip (stage, &clip_box);
+        }
+      else
+        {
+          CoglFramebuffer *fb = _clutter_stage_get_active_framebuffer (stage);
+
+          cogl_framebuffer_push_rectangle_clip (fb,
+                                                clip_box.x1,
+                                                clip_box.y1,
+                                                clip_box.x2,
+                                                clip_box.y2);
+        }
       clip_set = TRUE;
     }
   else if (priv->clip_to_allocation)
     {
-      CoglFramebuffer *fb = _clutter_stage_get_active_framebuffer (stage);
-      gfloat width, height;
+      ClutterActorBox clip_box = { 0, };
 
-      width  = priv->allocation.x2 - priv->allocation.x1;
-      height = priv->allocation.y2 - priv->allocation.y1;
+      clip_box.x2 = priv->allocation.x2 - priv->allocation.x1;
+      clip_box.y2 = priv->allocation.y2 - priv->allocation.y1;
+
+      if (geometric_pick)
+        {
+          _clutter_stage_push_pick_clip (stage, &clip_box);
+        }
+      else
+        {
+          CoglFramebuffer *fb = _clutter_stage_get_active_framebuffer (stage);
 
-      cogl_framebuffer_push_rectangle_clip (fb, 0, 0, width, height);
+          cogl_framebuffer_push_rectangle_clip (fb,
+                                                clip_box.x1,
+                                                clip_box.y1,
+                                                clip_box.x2,
+                                                clip_box.y2);
+        }
       clip_set = TRUE;
     }
 
@@ -3960,9 +4246,16 @@ done:
 
   if (clip_set)
     {
-      CoglFramebuffer *fb = _clutter_stage_get_active_framebuffer (stage);
+      if (geometric_pick)
+        {
+          _clutter_stage_pop_pick_clip (stage);
+        }
+      else
+        {
+          CoglFramebuffer *fb = _clutter_stage_get_active_framebuffer (stage);
 
-      cogl_framebuffer_pop_clip (fb);
+          cogl_framebuffer_pop_clip (fb);
+        }
     }
 
   cogl_pop_matrix ();
@@ -4006,21 +4299,33 @@ clutter_actor_continue_paint (ClutterActor *self)
     {
       if (_clutter_context_get_pick_mode () == CLUTTER_PICK_NONE)
         {
-          ClutterPaintNode *dummy;
-
-          /* XXX - this will go away in 2.0, when we can get rid of this
-           * stuff and switch to a pure retained render tree of PaintNodes
-           * for the entire frame, starting from the Stage; the paint()
-           * virtual function can then be called directly.
+          /* clones paint the actor with their own opacity, so they
+           * would throw away the retained nodes on every paint
            */
-          dummy = _clutter_dummy_node_new (self);
-          clutter_paint_node_set_name (dummy, "Root");
+          if (priv->retain_paint_nodes &&
+              !priv->in_clone_paint &&
+              !CLUTTER_ACTOR_IS_TOPLEVEL (self))
+            {
+              clutter_actor_paint_retained_node (self);
+            }
+          else
+            {
+              ClutterPaintNode *dummy;
 
-          /* XXX - for 1.12, we use the return value of paint_node() to
-           * decide whether we should emit the ::paint signal.
-           */
-          clutter_actor_paint_node (self, dummy);
-          clutter_paint_node_unref (dummy);
+              /* XXX - this will go away in 2.0, when we can get rid of this
+               * stuff and switch to a pure retained render tree of PaintNodes
+               * for the entire frame, starting from the Stage; the paint()
+               * virtual function can then be called directly.
+               */
+              dummy = _clutter_dummy_node_new (self);
+              clutter_paint_node_set_name (dummy, "Root");
+
+              /* XXX - for 1.12, we use the return value of paint_node() to
+               * decide whether we should emit the ::paint signal.
+               */
+              clutter_actor_paint_node (self, dummy);
+              clutter_paint_node_unref (dummy);
+            }
 
           /* XXX:2.0 - Call the paint() virtual directly */
           if (g_signal_has_handler_pending (self, actor_signals[PAINT],
@@ -4032,6 +4337,15 @@ clutter_actor_continue_paint (ClutterActor *self)
       else
         {
           ClutterColor col = { 0, };
+          ClutterStage *stage;
+
+          stage = (ClutterStage *) _clutter_actor_get_stage_internal (self);
+          if (_clutter_stage_is_geometric_picking (stage) &&
+              !clutter_actor_has_geometric_pick (self))
+            {
+              _clutter_stage_fail_geometric_pick (stage, self);
+              return;
+            }
 
           _clutter_id_to_color (_clutter_actor_get_pick_id (self), &col);
 
@@ -4078,6 +4392,17 @@ clutter_actor_continue_paint (ClutterActor *self)
         }
       else
         {
+          ClutterStage *stage;
+
+          stage = (ClutterStage *) _clutter_actor_get_stage_internal (self);
+          if (_clutter_stage_is_geometric_picking (stage) &&
+              _clutter_effect_has_custom_pick (priv->current_effect))
+            {
+              _clutter_stage_fail_geometric_pick (stage, self);
+              priv->current_effect = old_current_effect;
+              return;
+            }
+
           /* We can't determine when an actor has been modified since
              its last pick so lets just assume it has always been
              modified */
@@ -5946,6 +6271,8 @@ clutter_actor_dispose (GObject *object)
       g_assert (!CLUTTER_ACTOR_IS_REALIZED (self));
     }
 
+  g_clear_pointer (&priv->retained_paint_node, clutter_paint_node_unref);
+
   g_clear_object (&priv->pango_context);
   g_clear_object (&priv->actions);
   g_clear_object (&priv->constraints);
@@ -5996,6 +6323,8 @@ clutter_actor_finalize (GObject *object)
 
   g_free (priv->name);
 
+  clutter_actor_clear_stale_size_requests (CLUTTER_ACTOR (object));
+
 #ifdef CLUTTER_ENABLE_DEBUG
   g_free (priv->debug_name);
 #endif
@@ -9419,6 +9748,176 @@ _clutter_actor_get_cached_size_request (gfloat         for_size,
   return FALSE;
 }
 
+static void
+clutter_actor_store_layout_snapshot (ClutterActor   *self,
+                                     LayoutSnapshot *snapshot)
+{
+  const ClutterLayoutInfo *info;
+
+  info = _clutter_actor_get_layout_info_or_defaults (self);
+
+  snapshot->fixed_pos = info->fixed_pos;
+  snapshot->request_mode = self->priv->request_mode;
+  snapshot->is_visible = CLUTTER_ACTOR_IS_VISIBLE (self) != FALSE;
+  snapshot->position_set = self->priv->position_set;
+}
+
+/* Called before computing the preferred size of @self, which will use
+ * the current state of its children */
+static void
+clutter_actor_store_children_layout_snapshots (ClutterActor *self)
+{
+  ClutterActor *child;
+
+  for (child = self->priv->first_child;
+       child != NULL;
+       child = child->priv->next_sibling)
+    {
+      clutter_actor_clear_stale_size_requests (child);
+      clutter_actor_store_layout_snapshot (child,
+                                           &child->priv->parent_snapshot);
+    }
+}
+
+/* Checks that the stale size requests of @self are still the same,
+ * computing them again if needed */
+static gboolean
+clutter_actor_check_stale_size_requests (ClutterActor       *self,
+                                         ClutterOrientation  orientation,
+                                         guint              *n_checked)
+{
+  ClutterActorPrivate *priv = self->priv;
+  SizeRequest *stale_requests, *requests;
+  guint i;
+
+  if (orientation == CLUTTER_ORIENTATION_HORIZONTAL)
+    {
+      stale_requests = priv->stale_size_requests->width_requests;
+      requests = priv->width_requests;
+    }
+  else
+    {
+      stale_requests = priv->stale_size_requests->height_requests;
+      requests = priv->height_requests;
+    }
+
+  for (i = 0; i < N_CACHED_SIZE_REQUESTS; i++)
+    {
+      const SizeRequest *stale = &stale_requests[i];
+      SizeRequest *current;
+
+      if (stale->age == 0)
+        continue;
+
+      if (orientation == CLUTTER_ORIENTATION_HORIZONTAL)
+        clutter_actor_get_preferred_width (self, stale->for_size, NULL, NULL);
+      else
+        clutter_actor_get_preferred_height (self, stale->for_size, NULL, NULL);
+
+      if (!_clutter_actor_get_cached_size_request (stale->for_size,
+                                                   requests,
+                                                   &current))
+        return FALSE;
+
+      if (current->min_size != stale->min_size ||
+          current->natural_size != stale->natural_size)
+        return FALSE;
+
+      *n_checked += 1;
+    }
+
+  return TRUE;
+}
+
+static void clutter_actor_validate_size_requests (ClutterActor *self);
+
+/* Returns whether the preferred size of @self, or any other state the
+ * layout of its parent depends on, changed since the parent last
+ * computed its own preferred size
+ */
+static gboolean
+clutter_actor_size_requests_changed (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  LayoutSnapshot snapshot;
+  guint n_checked = 0;
+
+  clutter_actor_store_layout_snapshot (self, &snapshot);
+  if (snapshot.is_visible != priv->parent_snapshot.is_visible ||
+      snapshot.position_set != priv->parent_snapshot.position_set ||
+      snapshot.request_mode != priv->parent_snapshot.request_mode ||
+      !clutter_point_equals (&snapshot.fixed_pos,
+                             &priv->parent_snapshot.fixed_pos))
+    return TRUE;
+
+  /* the expand flags are only known after computing them again */
+  if (priv->needs_compute_expand)
+    return TRUE;
+
+  if (priv->needs_size_validation)
+    clutter_actor_validate_size_requests (self);
+
+  if (priv->stale_size_requests == NULL)
+    return FALSE;
+
+  /* the parent might have used a request that is not cached anymore */
+  if (priv->stale_size_requests->evicted)
+    return TRUE;
+
+  if (!clutter_actor_check_stale_size_requests (self,
+                                                CLUTTER_ORIENTATION_HORIZONTAL,
+                                                &n_checked) ||
+      !clutter_actor_check_stale_size_requests (self,
+                                                CLUTTER_ORIENTATION_VERTICAL,
+                                                &n_checked))
+    return TRUE;
+
+  /* without any cached request we can't tell what the parent used;
+   * this is always the case for actors with a fixed size, which return
+   * it without going through the cache, so a relayout queued by a fixed
+   * size leaf always invalidates the preferred size of its parent
+   */
+  if (n_checked == 0)
+    return TRUE;
+
+  clutter_actor_clear_stale_size_requests (self);
+
+  return FALSE;
+}
+
+/* Checks whether the cached size requests of @self are still valid
+ * after one of its descendants queued a relayout
+ */
+static void
+clutter_actor_validate_size_requests (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActor *child;
+
+  priv->needs_size_validation = FALSE;
+
+  /* a fixed size doesn't depend on the children */
+  if (priv->min_width_set && priv->natural_width_set &&
+      priv->min_height_set && priv->natural_height_set)
+    return;
+
+  for (child = priv->first_child;
+       child != NULL;
+       child = child->priv->next_sibling)
+    {
+      if (clutter_actor_size_requests_changed (child))
+        {
+          clutter_actor_invalidate_size_requests (self);
+          return;
+        }
+    }
+
+  CLUTTER_NOTE (LAYOUT, "Keeping the size requests of '%s'",
+                _clutter_actor_get_debug_name (self));
+
+  layout_stats.n_kept_size_requests += 1;
+}
+
 static void
 clutter_actor_update_preferred_size_for_constraints (ClutterActor *self,
                                                      ClutterOrientation direction,
@@ -9492,6 +9991,7 @@ clutter_actor_get_preferred_width (ClutterActor *self,
   const ClutterLayoutInfo *info;
   ClutterActorPrivate *priv;
   gboolean found_in_cache;
+  gfloat request_for_height = for_height;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
@@ -9521,12 +10021,18 @@ clutter_actor_get_preferred_width (ClutterActor *self,
    * the *_set flags.
    */
 
+  if (priv->needs_size_validation)
+    clutter_actor_validate_size_requests (self);
+
   if (!priv->needs_width_request)
     {
       found_in_cache =
         _clutter_actor_get_cached_size_request (for_height,
                                                 priv->width_requests,
                                                 &cached_size_request);
+
+      if (!found_in_cache && cached_size_request->age > 0)
+        priv->size_requests_evicted = TRUE;
     }
   else
     {
@@ -9552,6 +10058,9 @@ clutter_actor_get_preferred_width (ClutterActor *self,
 
       CLUTTER_NOTE (LAYOUT, "Width request for %.2f px", for_height);
 
+      clutter_actor_store_children_layout_snapshots (self);
+      layout_stats.n_size_requests += 1;
+
       klass = CLUTTER_ACTOR_GET_CLASS (self);
       klass->get_preferred_width (self, for_height,
                                   &minimum_width,
@@ -9576,7 +10085,7 @@ clutter_actor_get_preferred_width (ClutterActor *self,
 
       cached_size_request->min_size = minimum_width;
       cached_size_request->natural_size = natural_width;
-      cached_size_request->for_size = for_height;
+      cached_size_request->for_size = request_for_height;
       cached_size_request->age = priv->cached_width_age;
 
       priv->cached_width_age += 1;
@@ -9636,6 +10145,7 @@ clutter_actor_get_preferred_height (ClutterActor *self,
   const ClutterLayoutInfo *info;
   ClutterActorPrivate *priv;
   gboolean found_in_cache;
+  gfloat request_for_width = for_width;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
@@ -9665,12 +10175,18 @@ clutter_actor_get_preferred_height (ClutterActor *self,
    * the *_set flags.
    */
 
+  if (priv->needs_size_validation)
+    clutter_actor_validate_size_requests (self);
+
   if (!priv->needs_height_request)
     {
       found_in_cache =
         _clutter_actor_get_cached_size_request (for_width,
                                                 priv->height_requests,
                                                 &cached_size_request);
+
+      if (!found_in_cache && cached_size_request->age > 0)
+        priv->size_requests_evicted = TRUE;
     }
   else
     {
@@ -9695,6 +10211,9 @@ clutter_actor_get_preferred_height (ClutterActor *self,
             for_width = 0;
         }
 
+      clutter_actor_store_children_layout_snapshots (self);
+      layout_stats.n_size_requests += 1;
+
       klass = CLUTTER_ACTOR_GET_CLASS (self);
       klass->get_preferred_height (self, for_width,
                                    &minimum_height,
@@ -9719,7 +10238,7 @@ clutter_actor_get_preferred_height (ClutterActor *self,
 
       cached_size_request->min_size = minimum_height;
       cached_size_request->natural_size = natural_height;
-      cached_size_request->for_size = for_width;
+      cached_size_request->for_size = request_for_width;
       cached_size_request->age = priv->cached_height_age;
 
       priv->cached_height_age += 1;
@@ -9968,6 +10487,8 @@ clutter_actor_allocate_internal (ClutterActor           *self,
   CLUTTER_NOTE (LAYOUT, "Calling %s::allocate()",
                 _clutter_actor_get_debug_name (self));
 
+  layout_stats.n_allocations += 1;
+
   klass = CLUTTER_ACTOR_GET_CLASS (self);
   klass->allocate (self, allocation, flags);
 
@@ -13956,6 +14477,14 @@ clutter_actor_set_reactive (ClutterActor *actor,
   else
     CLUTTER_ACTOR_UNSET_FLAGS (actor, CLUTTER_ACTOR_REACTIVE);
 
+  if (CLUTTER_ACTOR_IS_MAPPED (actor))
+    {
+      ClutterActor *stage = _clutter_actor_get_stage_internal (actor);
+
+      if (stage != NULL)
+        _clutter_stage_clear_pick_stack (CLUTTER_STAGE (stage));
+    }
+
   g_object_notify_by_pspec (G_OBJECT (actor), obj_props[PROP_REACTIVE]);
 }
 
@@ -14253,6 +14782,7 @@ clutter_actor_store_content_box (ClutterActor *self,
   else
     self->priv->content_box_valid = FALSE;
 
+  clutter_actor_invalidate_paint_nodes (self);
   clutter_actor_queue_redraw (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_CONTENT_BOX]);
@@ -18534,6 +19064,7 @@ clutter_actor_set_background_color_internal (ClutterActor *self,
   priv->bg_color = *color;
   priv->bg_color_set = TRUE;
 
+  clutter_actor_invalidate_paint_nodes (self);
   clutter_actor_queue_redraw (self);
 
   g_object_notify_by_pspec (obj, obj_props[PROP_BACKGROUND_COLOR_SET]);
@@ -18574,6 +19105,7 @@ clutter_actor_set_background_color (ClutterActor       *self,
 
       priv->bg_color_set = FALSE;
 
+      clutter_actor_invalidate_paint_nodes (self);
       clutter_actor_queue_redraw (self);
 
       g_object_notify_by_pspec (obj, obj_props[PROP_BACKGROUND_COLOR_SET]);
@@ -19835,6 +20367,7 @@ clutter_actor_set_content (ClutterActor   *self,
   if (priv->request_mode == CLUTTER_REQUEST_CONTENT_SIZE)
     _clutter_actor_queue_only_relayout (self);
 
+  clutter_actor_invalidate_paint_nodes (self);
   clutter_actor_queue_redraw (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_CONTENT]);
@@ -20196,7 +20729,10 @@ clutter_actor_set_content_scaling_filters (ClutterActor         *self,
     }
 
   if (changed)
-    clutter_actor_queue_redraw (self);
+    {
+      clutter_actor_invalidate_paint_nodes (self);
+      clutter_actor_queue_redraw (self);
+    }
 
   g_object_thaw_notify (obj);
 }
@@ -20520,6 +21056,7 @@ clutter_actor_set_content_repeat (ClutterActor         *self,
 
   self->priv->content_repeat = repeat;
 
+  clutter_actor_invalidate_paint_nodes (self);
   clutter_actor_queue_redraw (self);
 }
 
@@ -20816,6 +21353,83 @@ clutter_actor_has_mapped_clones (ClutterActor *self)
   return FALSE;
 }
 
+/**
+ * clutter_actor_set_retain_paint_nodes:
+ * @self: a #ClutterActor
+ * @retain: whether the paint nodes of @self should be retained
+ *
+ * Sets whether the #ClutterPaintNode tree built for @self by its
+ * background color, its #ClutterContent and the
+ * #ClutterActorClass.paint_node virtual function should be kept
+ * between frames and painted again, instead of being built on
+ * every paint.
+ *
+ * The retained nodes are built again when the size of the allocation,
+ * the paint opacity, the background color or the content of @self
+ * change. Implementations of #ClutterActorClass.paint_node that depend
+ * on any other state must call clutter_actor_invalidate_paint_nodes()
+ * when that state changes.
+ */
+void
+clutter_actor_set_retain_paint_nodes (ClutterActor *self,
+                                      gboolean      retain)
+{
+  ClutterActorPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+
+  priv = self->priv;
+
+  retain = !!retain;
+  if (priv->retain_paint_nodes == retain)
+    return;
+
+  priv->retain_paint_nodes = retain;
+
+  if (!retain)
+    g_clear_pointer (&priv->retained_paint_node, clutter_paint_node_unref);
+}
+
+/**
+ * clutter_actor_get_retain_paint_nodes:
+ * @self: a #ClutterActor
+ *
+ * Retrieves whether the paint nodes of @self are retained between
+ * frames, as set by clutter_actor_set_retain_paint_nodes().
+ *
+ * Return value: %TRUE if the paint nodes are retained
+ */
+gboolean
+clutter_actor_get_retain_paint_nodes (ClutterActor *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
+
+  return self->priv->retain_paint_nodes;
+}
+
+/**
+ * clutter_actor_invalidate_paint_nodes:
+ * @self: a #ClutterActor
+ *
+ * Discards the paint nodes retained for @self, so that they are built
+ * again the next time @self is painted. This does not queue a redraw.
+ *
+ * See clutter_actor_set_retain_paint_nodes().
+ */
+void
+clutter_actor_invalidate_paint_nodes (ClutterActor *self)
+{
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+
+  g_clear_pointer (&self->priv->retained_paint_node, clutter_paint_node_unref);
+}
+
+ClutterLayoutStats *
+_clutter_actor_get_layout_stats (void)
+{
+  return &layout_stats;
+}
+
 CoglFramebuffer *
 _clutter_actor_get_active_framebuffer (ClutterActor *self)
 {
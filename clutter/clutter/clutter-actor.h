@@ -578,6 +578,11 @@ CLUTTER_AVAILABLE_IN_1_8
 ClutterOffscreenRedirect        clutter_actor_get_offscreen_redirect            (ClutterActor               *self);
 CLUTTER_AVAILABLE_IN_ALL
 gboolean                        clutter_actor_should_pick_paint                 (ClutterActor               *self);
+CLUTTER_AVAILABLE_IN_MUTTER
+void                            clutter_actor_pick_box                          (ClutterActor               *self,
+                                                                                 const ClutterActorBox      *box);
+CLUTTER_AVAILABLE_IN_MUTTER
+void                            clutter_actor_class_set_geometric_pick          (ClutterActorClass          *klass);
 CLUTTER_AVAILABLE_IN_ALL
 gboolean                        clutter_actor_is_in_clone_paint                 (ClutterActor               *self);
 CLUTTER_AVAILABLE_IN_ALL
@@ -863,6 +868,13 @@ void                            clutter_actor_set_opacity_override
                                                                                  gint                        opacity);
 CLUTTER_AVAILABLE_IN_1_22
 gint                            clutter_actor_get_opacity_override              (ClutterActor               *self);
+CLUTTER_AVAILABLE_IN_MUTTER
+void                            clutter_actor_set_retain_paint_nodes            (ClutterActor               *self,
+                                                                                 gboolean                    retain);
+CLUTTER_AVAILABLE_IN_MUTTER
+gboolean                        clutter_actor_get_retain_paint_nodes            (ClutterActor               *self);
+CLUTTER_AVAILABLE_IN_MUTTER
+void                            clutter_actor_invalidate_paint_nodes            (ClutterActor               *self);
 
 /**
  * ClutterActorCreateChildFunc:
@@ -30,6 +30,13 @@
  * #ClutterBlurEffect is a sub-class of #ClutterEffect that allows blurring a
  * actor and its contents.
  *
+ * Small radii are applied with a single 3x3 box blur. Larger radii use
+ * the "dual filter" blur: the image is repeatedly downsampled to half
+ * its size and then upsampled again, sampling a few texels around
+ * every pixel in each pass. This keeps the number of samples per pixel
+ * constant regardless of the radius, while the intermediate buffers are
+ * kept around between frames.
+ *
  * #ClutterBlurEffect is available since Clutter 1.4
  */
 
@@ -43,6 +50,8 @@
 
 #define CLUTTER_ENABLE_EXPERIMENTAL_API
 
+#include <math.h>
+
 #include "clutter-blur-effect.h"
 
 #include "cogl/cogl.h"
@@ -53,9 +62,12 @@
 
 #define BLUR_PADDING    2
 
-/* FIXME - lame shader; we should really have a decoupled
- * horizontal/vertical two pass shader for the gaussian blur
- */
+/* Radii up to this are handled by the box blur */
+#define BOX_BLUR_MAX_RADIUS     2.0
+
+/* Each level halves the size of the previous one */
+#define DUAL_BLUR_MAX_LEVELS    6
+
 static const gchar *box_blur_glsl_declarations =
 "uniform vec2 pixel_step;\n";
 #define SAMPLE(offx, offy) \
@@ -74,6 +86,50 @@ static const gchar *box_blur_glsl_shader =
 "  cogl_texel /= 9.0;\n";
 #undef SAMPLE
 
+/* The dual filter blur samples around each pixel with bilinear
+ * filtering, so that every tap averages four texels. The offsets
+ * are in units of half a texel of the source level.
+ */
+static const gchar *dual_blur_glsl_declarations =
+"uniform vec2 half_pixel;\n"
+"uniform float offset;\n";
+#define SAMPLE(offx, offy) \
+  "texture2D (cogl_sampler, cogl_tex_coord.st + half_pixel * offset * " \
+  "vec2 (" G_STRINGIFY (offx) ", " G_STRINGIFY (offy) "))"
+static const gchar *dual_blur_down_glsl_shader =
+"  cogl_texel = texture2D (cogl_sampler, cogl_tex_coord.st) * 4.0;\n"
+"  cogl_texel += " SAMPLE (-1.0, -1.0) ";\n"
+"  cogl_texel += " SAMPLE (+1.0, -1.0) ";\n"
+"  cogl_texel += " SAMPLE (-1.0, +1.0) ";\n"
+"  cogl_texel += " SAMPLE (+1.0, +1.0) ";\n"
+"  cogl_texel /= 8.0;\n";
+static const gchar *dual_blur_up_glsl_shader =
+"  cogl_texel = " SAMPLE (-2.0,  0.0) ";\n"
+"  cogl_texel += " SAMPLE (-1.0, +1.0) " * 2.0;\n"
+"  cogl_texel += " SAMPLE ( 0.0, +2.0) ";\n"
+"  cogl_texel += " SAMPLE (+1.0, +1.0) " * 2.0;\n"
+"  cogl_texel += " SAMPLE (+2.0,  0.0) ";\n"
+"  cogl_texel += " SAMPLE (+1.0, -1.0) " * 2.0;\n"
+"  cogl_texel += " SAMPLE ( 0.0, -2.0) ";\n"
+"  cogl_texel += " SAMPLE (-1.0, -1.0) " * 2.0;\n"
+"  cogl_texel /= 12.0;\n";
+#undef SAMPLE
+
+typedef struct _BlurLevel
+{
+  CoglTexture *texture;
+  CoglFramebuffer *framebuffer;
+
+  int width;
+  int height;
+
+  /* draws the next smaller level into this one */
+  CoglPipeline *up_pipeline;
+
+  /* draws the next larger level into this one */
+  CoglPipeline *down_pipeline;
+} BlurLevel;
+
 struct _ClutterBlurEffect
 {
   ClutterOffscreenEffect parent_instance;
@@ -86,7 +142,22 @@ struct _ClutterBlurEffect
   gint tex_width;
   gint tex_height;
 
+  gdouble radius;
+
   CoglPipeline *pipeline;
+
+  /* The levels of the dual filter blur; the first one is the
+   * offscreen texture of the actor and is only used to paint the
+   * blurred result on the stage. The levels are reused between
+   * frames as long as the texture and the radius don't change.
+   */
+  BlurLevel levels[DUAL_BLUR_MAX_LEVELS + 1];
+  gint n_levels;
+  CoglTexture *levels_source;
+  gdouble levels_radius;
+
+  /* whether the actor was redrawn since the levels were last filled */
+  guint levels_dirty : 1;
 };
 
 struct _ClutterBlurEffectClass
@@ -94,12 +165,222 @@ struct _ClutterBlurEffectClass
   ClutterOffscreenEffectClass parent_class;
 
   CoglPipeline *base_pipeline;
+  CoglPipeline *base_down_pipeline;
+  CoglPipeline *base_up_pipeline;
 };
 
+enum
+{
+  PROP_0,
+
+  PROP_RADIUS,
+
+  PROP_LAST
+};
+
+static GParamSpec *obj_props[PROP_LAST];
+
 G_DEFINE_TYPE (ClutterBlurEffect,
                clutter_blur_effect,
                CLUTTER_TYPE_OFFSCREEN_EFFECT);
 
+static gboolean
+use_dual_blur (ClutterBlurEffect *self)
+{
+  return self->radius > BOX_BLUR_MAX_RADIUS;
+}
+
+/* The blur spreads by roughly offset * 2^(n_passes + 1) pixels, with the
+ * offset kept between 0.5 and 1 so that the taps of neighbouring
+ * pixels keep overlapping.
+ */
+static void
+get_dual_blur_parameters (gdouble  radius,
+                          gint    *n_passes,
+                          gfloat  *offset)
+{
+  gint passes;
+
+  passes = CLAMP ((gint) ceil (log2 (radius)) - 1, 1, DUAL_BLUR_MAX_LEVELS);
+
+  *n_passes = passes;
+  *offset = radius / (1 << (passes + 1));
+}
+
+static void
+clear_blur_levels (ClutterBlurEffect *self)
+{
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (self->levels); i++)
+    {
+      BlurLevel *level = &self->levels[i];
+
+      /* The first level only borrows the offscreen texture */
+      if (i > 0)
+        {
+          g_clear_pointer (&level->framebuffer, cogl_object_unref);
+          g_clear_pointer (&level->texture, cogl_object_unref);
+        }
+      else
+        {
+          level->framebuffer = NULL;
+          level->texture = NULL;
+        }
+
+      g_clear_pointer (&level->up_pipeline, cogl_object_unref);
+      g_clear_pointer (&level->down_pipeline, cogl_object_unref);
+    }
+
+  g_clear_pointer (&self->levels_source, cogl_object_unref);
+  self->n_levels = 0;
+}
+
+static void
+setup_pass_pipeline (CoglPipeline *pipeline,
+                     CoglTexture  *source,
+                     gfloat        offset)
+{
+  gfloat half_pixel[2];
+  int location;
+
+  cogl_pipeline_set_layer_texture (pipeline, 0, source);
+
+  half_pixel[0] = 0.5f / cogl_texture_get_width (source);
+  half_pixel[1] = 0.5f / cogl_texture_get_height (source);
+
+  location = cogl_pipeline_get_uniform_location (pipeline, "half_pixel");
+  if (location > -1)
+    cogl_pipeline_set_uniform_float (pipeline, location,
+                                     2, /* n_components */
+                                     1, /* count */
+                                     half_pixel);
+
+  location = cogl_pipeline_get_uniform_location (pipeline, "offset");
+  if (location > -1)
+    cogl_pipeline_set_uniform_1f (pipeline, location, offset);
+}
+
+static gboolean
+update_blur_levels (ClutterBlurEffect *self,
+                    CoglTexture       *source)
+{
+  ClutterBlurEffectClass *klass = CLUTTER_BLUR_EFFECT_GET_CLASS (self);
+  CoglContext *ctx =
+    clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  gint n_passes, i;
+  gfloat offset;
+
+  if (self->levels_source == source &&
+      self->levels_radius == self->radius &&
+      self->n_levels > 0)
+    return TRUE;
+
+  clear_blur_levels (self);
+
+  get_dual_blur_parameters (self->radius, &n_passes, &offset);
+
+  self->levels[0].texture = source;
+  self->levels[0].width = cogl_texture_get_width (source);
+  self->levels[0].height = cogl_texture_get_height (source);
+
+  for (i = 1; i <= n_passes; i++)
+    {
+      BlurLevel *level = &self->levels[i];
+      CoglOffscreen *offscreen;
+      CoglError *error = NULL;
+
+      level->width = MAX (self->levels[0].width >> i, 1);
+      level->height = MAX (self->levels[0].height >> i, 1);
+
+      level->texture = COGL_TEXTURE (cogl_texture_2d_new_with_size (ctx,
+                                                                   level->width,
+                                                                   level->height));
+      offscreen = cogl_offscreen_new_with_texture (level->texture);
+      level->framebuffer = COGL_FRAMEBUFFER (offscreen);
+
+      if (!cogl_framebuffer_allocate (level->framebuffer, &error))
+        {
+          g_warning ("%s: Unable to create an Offscreen buffer: %s",
+                     G_STRLOC, error->message);
+          cogl_error_free (error);
+          clear_blur_levels (self);
+          return FALSE;
+        }
+
+      cogl_framebuffer_orthographic (level->framebuffer,
+                                     0, 0,
+                                     level->width, level->height,
+                                     -1, 100);
+    }
+
+  for (i = 0; i <= n_passes; i++)
+    {
+      BlurLevel *level = &self->levels[i];
+
+      if (i > 0)
+        {
+          level->down_pipeline = cogl_pipeline_copy (klass->base_down_pipeline);
+          setup_pass_pipeline (level->down_pipeline,
+                               self->levels[i - 1].texture,
+                               offset);
+        }
+
+      if (i < n_passes)
+        {
+          level->up_pipeline = cogl_pipeline_copy (klass->base_up_pipeline);
+          setup_pass_pipeline (level->up_pipeline,
+                               self->levels[i + 1].texture,
+                               offset);
+        }
+    }
+
+  /* The final pass is painted on the stage, so it has to blend */
+  cogl_pipeline_set_blend (self->levels[0].up_pipeline,
+                           "RGBA = ADD (SRC_COLOR, DST_COLOR*(1-SRC_COLOR[A]))",
+                           NULL);
+
+  self->levels_source = cogl_object_ref (source);
+  self->levels_radius = self->radius;
+  self->n_levels = n_passes + 1;
+  self->levels_dirty = TRUE;
+
+  return TRUE;
+}
+
+static void
+run_dual_blur_passes (ClutterBlurEffect *self)
+{
+  gint i;
+
+  for (i = 1; i < self->n_levels; i++)
+    {
+      BlurLevel *level = &self->levels[i];
+
+      cogl_framebuffer_draw_rectangle (level->framebuffer,
+                                       level->down_pipeline,
+                                       0, 0, level->width, level->height);
+
+      /* The up passes draw into the levels the down passes read from,
+       * so the down pass has to run before them; this also drops the
+       * dependency on the larger level, which would otherwise make
+       * each level depend on the other once the up pass is logged
+       */
+      cogl_framebuffer_flush (level->framebuffer);
+    }
+
+  for (i = self->n_levels - 2; i > 0; i--)
+    {
+      BlurLevel *level = &self->levels[i];
+
+      cogl_framebuffer_draw_rectangle (level->framebuffer,
+                                       level->up_pipeline,
+                                       0, 0, level->width, level->height);
+    }
+
+  self->levels_dirty = FALSE;
+}
+
 static gboolean
 clutter_blur_effect_pre_paint (ClutterEffect *effect)
 {
@@ -136,12 +417,15 @@ clutter_blur_effect_pre_paint (ClutterEffect *effect)
       self->tex_width = cogl_texture_get_width (texture);
       self->tex_height = cogl_texture_get_height (texture);
 
+      /* The actor is about to be redrawn into the texture */
+      self->levels_dirty = TRUE;
+
       if (self->pixel_step_uniform > -1)
         {
           gfloat pixel_step[2];
 
-          pixel_step[0] = 1.0f / self->tex_width;
-          pixel_step[1] = 1.0f / self->tex_height;
+          pixel_step[0] = MAX (self->radius, 1.0) / self->tex_width;
+          pixel_step[1] = MAX (self->radius, 1.0) / self->tex_height;
 
           cogl_pipeline_set_uniform_float (self->pipeline,
                                            self->pixel_step_uniform,
@@ -162,16 +446,31 @@ static void
 clutter_blur_effect_paint_target (ClutterOffscreenEffect *effect)
 {
   ClutterBlurEffect *self = CLUTTER_BLUR_EFFECT (effect);
+  CoglPipeline *pipeline = self->pipeline;
   guint8 paint_opacity;
 
+  if (use_dual_blur (self))
+    {
+      CoglTexture *texture = clutter_offscreen_effect_get_texture (effect);
+
+      /* If the levels can't be allocated we fall back to the box blur */
+      if (update_blur_levels (self, texture))
+        {
+          if (self->levels_dirty)
+            run_dual_blur_passes (self);
+
+          pipeline = self->levels[0].up_pipeline;
+        }
+    }
+
   paint_opacity = clutter_actor_get_paint_opacity (self->actor);
 
-  cogl_pipeline_set_color4ub (self->pipeline,
+  cogl_pipeline_set_color4ub (pipeline,
                               paint_opacity,
                               paint_opacity,
                               paint_opacity,
                               paint_opacity);
-  cogl_push_source (self->pipeline);
+  cogl_push_source (pipeline);
 
   cogl_rectangle (0, 0, self->tex_width, self->tex_height);
 
@@ -182,17 +481,22 @@ static gboolean
 clutter_blur_effect_get_paint_volume (ClutterEffect      *effect,
                                       ClutterPaintVolume *volume)
 {
+  ClutterBlurEffect *self = CLUTTER_BLUR_EFFECT (effect);
   gfloat cur_width, cur_height;
+  gfloat padding;
   ClutterVertex origin;
 
+  /* Both blurs spread up to twice the radius */
+  padding = MAX (BLUR_PADDING, ceil (self->radius * 2.0));
+
   clutter_paint_volume_get_origin (volume, &origin);
   cur_width = clutter_paint_volume_get_width (volume);
   cur_height = clutter_paint_volume_get_height (volume);
 
-  origin.x -= BLUR_PADDING;
-  origin.y -= BLUR_PADDING;
-  cur_width += 2 * BLUR_PADDING;
-  cur_height += 2 * BLUR_PADDING;
+  origin.x -= padding;
+  origin.y -= padding;
+  cur_width += 2 * padding;
+  cur_height += 2 * padding;
   clutter_paint_volume_set_origin (volume, &origin);
   clutter_paint_volume_set_width (volume, cur_width);
   clutter_paint_volume_set_height (volume, cur_height);
@@ -211,9 +515,86 @@ clutter_blur_effect_dispose (GObject *gobject)
       self->pipeline = NULL;
     }
 
+  clear_blur_levels (self);
+
   G_OBJECT_CLASS (clutter_blur_effect_parent_class)->dispose (gobject);
 }
 
+static void
+clutter_blur_effect_set_property (GObject      *gobject,
+                                  guint         prop_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+  ClutterBlurEffect *effect = CLUTTER_BLUR_EFFECT (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_RADIUS:
+      clutter_blur_effect_set_radius (effect, g_value_get_double (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_blur_effect_get_property (GObject    *gobject,
+                                  guint       prop_id,
+                                  GValue     *value,
+                                  GParamSpec *pspec)
+{
+  ClutterBlurEffect *effect = CLUTTER_BLUR_EFFECT (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_RADIUS:
+      g_value_set_double (value, effect->radius);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static CoglPipeline *
+create_dual_blur_pipeline (CoglContext *ctx,
+                           const gchar *shader)
+{
+  CoglPipeline *pipeline;
+  CoglSnippet *snippet;
+
+  pipeline = cogl_pipeline_new (ctx);
+
+  snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_TEXTURE_LOOKUP,
+                              dual_blur_glsl_declarations,
+                              NULL);
+  cogl_snippet_set_replace (snippet, shader);
+  cogl_pipeline_add_layer_snippet (pipeline, 0, snippet);
+  cogl_object_unref (snippet);
+
+  cogl_pipeline_set_layer_null_texture (pipeline,
+                                        0, /* layer number */
+                                        COGL_TEXTURE_TYPE_2D);
+
+  /* The taps rely on bilinear filtering to average four texels each */
+  cogl_pipeline_set_layer_filters (pipeline,
+                                   0, /* layer_index */
+                                   COGL_PIPELINE_FILTER_LINEAR,
+                                   COGL_PIPELINE_FILTER_LINEAR);
+  cogl_pipeline_set_layer_wrap_mode (pipeline,
+                                     0, /* layer_index */
+                                     COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+
+  /* The intermediate passes overwrite the whole level */
+  cogl_pipeline_set_blend (pipeline, "RGBA = ADD (SRC_COLOR, 0)", NULL);
+
+  return pipeline;
+}
+
 static void
 clutter_blur_effect_class_init (ClutterBlurEffectClass *klass)
 {
@@ -222,12 +603,31 @@ clutter_blur_effect_class_init (ClutterBlurEffectClass *klass)
   ClutterOffscreenEffectClass *offscreen_class;
 
   gobject_class->dispose = clutter_blur_effect_dispose;
+  gobject_class->set_property = clutter_blur_effect_set_property;
+  gobject_class->get_property = clutter_blur_effect_get_property;
 
   effect_class->pre_paint = clutter_blur_effect_pre_paint;
   effect_class->get_paint_volume = clutter_blur_effect_get_paint_volume;
 
   offscreen_class = CLUTTER_OFFSCREEN_EFFECT_CLASS (klass);
   offscreen_class->paint_target = clutter_blur_effect_paint_target;
+
+  /**
+   * ClutterBlurEffect:radius:
+   *
+   * The radius of the blur, in pixels. Radii larger than 2.0 are
+   * applied by repeatedly downsampling and upsampling the actor,
+   * which costs about the same for every radius.
+   */
+  obj_props[PROP_RADIUS] =
+    g_param_spec_double ("radius",
+                         P_("Radius"),
+                         P_("The radius of the blur"),
+                         1.0, 128.0,
+                         1.0,
+                         CLUTTER_PARAM_READWRITE);
+
+  g_object_class_install_properties (gobject_class, PROP_LAST, obj_props);
 }
 
 static void
@@ -253,8 +653,15 @@ clutter_blur_effect_init (ClutterBlurEffect *self)
       cogl_pipeline_set_layer_null_texture (klass->base_pipeline,
                                             0, /* layer number */
                                             COGL_TEXTURE_TYPE_2D);
+
+      klass->base_down_pipeline =
+        create_dual_blur_pipeline (ctx, dual_blur_down_glsl_shader);
+      klass->base_up_pipeline =
+        create_dual_blur_pipeline (ctx, dual_blur_up_glsl_shader);
     }
 
+  self->radius = 1.0;
+
   self->pipeline = cogl_pipeline_copy (klass->base_pipeline);
 
   self->pixel_step_uniform =
@@ -276,3 +683,45 @@ clutter_blur_effect_new (void)
 {
   return g_object_new (CLUTTER_TYPE_BLUR_EFFECT, NULL);
 }
+
+/**
+ * clutter_blur_effect_set_radius:
+ * @effect: a #ClutterBlurEffect
+ * @radius: the radius of the blur, in pixels
+ *
+ * Sets the radius of the blur applied by @effect
+ */
+void
+clutter_blur_effect_set_radius (ClutterBlurEffect *effect,
+                                gdouble            radius)
+{
+  g_return_if_fail (CLUTTER_IS_BLUR_EFFECT (effect));
+  g_return_if_fail (radius >= 1.0 && radius <= 128.0);
+
+  if (fabs (effect->radius - radius) >= 0.00001)
+    {
+      effect->radius = radius;
+
+      /* The paint volume, and so the size of the offscreen texture,
+       * depends on the radius, so the actor has to be redrawn */
+      clutter_offscreen_effect_invalidate (CLUTTER_OFFSCREEN_EFFECT (effect));
+
+      g_object_notify_by_pspec (G_OBJECT (effect), obj_props[PROP_RADIUS]);
+    }
+}
+
+/**
+ * clutter_blur_effect_get_radius:
+ * @effect: a #ClutterBlurEffect
+ *
+ * Retrieves the radius of the blur applied by @effect
+ *
+ * Return value: the radius of the blur, in pixels
+ */
+gdouble
+clutter_blur_effect_get_radius (ClutterBlurEffect *effect)
+{
+  g_return_val_if_fail (CLUTTER_IS_BLUR_EFFECT (effect), 1.0);
+
+  return effect->radius;
+}
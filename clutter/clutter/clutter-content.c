@@ -186,6 +186,7 @@ clutter_content_invalidate (ClutterContent *content)
 
       g_assert (actor != NULL);
 
+      clutter_actor_invalidate_paint_nodes (actor);
       clutter_actor_queue_redraw (actor);
     }
 }
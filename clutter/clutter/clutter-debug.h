@@ -28,7 +28,8 @@ typedef enum {
 
 typedef enum {
   CLUTTER_DEBUG_NOP_PICKING         = 1 << 0,
-  CLUTTER_DEBUG_DUMP_PICK_BUFFERS   = 1 << 1
+  CLUTTER_DEBUG_DUMP_PICK_BUFFERS   = 1 << 1,
+  CLUTTER_DEBUG_GPU_PICKING         = 1 << 2
 } ClutterPickDebugFlag;
 
 typedef enum {
@@ -13,6 +13,7 @@ void            _clutter_effect_paint                   (ClutterEffect
                                                          ClutterEffectPaintFlags  flags);
 void            _clutter_effect_pick                    (ClutterEffect           *effect,
                                                          ClutterEffectPaintFlags  flags);
+gboolean        _clutter_effect_has_custom_pick         (ClutterEffect           *effect);
 
 G_END_DECLS
 
@@ -289,6 +289,14 @@ _clutter_effect_paint (ClutterEffect           *effect,
   CLUTTER_EFFECT_GET_CLASS (effect)->paint (effect, flags);
 }
 
+gboolean
+_clutter_effect_has_custom_pick (ClutterEffect *effect)
+{
+  g_return_val_if_fail (CLUTTER_IS_EFFECT (effect), FALSE);
+
+  return CLUTTER_EFFECT_GET_CLASS (effect)->pick != clutter_effect_real_pick;
+}
+
 void
 _clutter_effect_pick (ClutterEffect           *effect,
                       ClutterEffectPaintFlags  flags)
@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2018 Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CLUTTER_FRAME_TIMINGS_PRIVATE_H__
+#define __CLUTTER_FRAME_TIMINGS_PRIVATE_H__
+
+#include "clutter-frame-timings.h"
+
+G_BEGIN_DECLS
+
+void _clutter_frame_timings_begin_frame       (int64_t  start_time);
+void _clutter_frame_timings_set_frame_counter (int64_t  frame_counter);
+void _clutter_frame_timings_end_frame         (gboolean stages_updated);
+void _clutter_frame_timings_presented         (int64_t  frame_counter,
+                                               int64_t  presentation_time);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_FRAME_TIMINGS_PRIVATE_H__ */
@@ -0,0 +1,254 @@
+/*
+ * Copyright (C) 2018 Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * SECTION:clutter-frame-timings
+ * @short_description: Where the time of each frame went
+ *
+ * The master clock and the stage account the time spent in each phase of
+ * a frame to a #ClutterFrameRecord. Every frame that updated a stage is
+ * published into a fixed size ring, and the presentation time is added
+ * once the backend reports it.
+ *
+ * Frames are only ever recorded from the thread running the master clock.
+ * Each slot of the ring is guarded by a sequence count that is odd while
+ * the slot is being written, so clutter_frame_timings_get_records() never
+ * blocks the frame and can be called from any thread; a reader racing the
+ * writer simply retries that slot.
+ */
+
+#include "clutter-build-config.h"
+
+#include "clutter-frame-timings-private.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAME_RECORD_RING_SIZE 1024
+
+/* How many of the last frames a presentation event is matched against */
+#define MAX_PENDING_PRESENTATIONS 16
+
+typedef struct _FrameRecordSlot
+{
+  volatile int seq;
+  ClutterFrameRecord record;
+} FrameRecordSlot;
+
+static FrameRecordSlot frame_records[FRAME_RECORD_RING_SIZE];
+static uint64_t last_sequence;
+
+static ClutterFrameRecord current_frame;
+static gboolean in_frame;
+static int64_t phase_start[CLUTTER_N_FRAME_PHASES];
+static int phase_depth[CLUTTER_N_FRAME_PHASES];
+
+static FrameRecordSlot *
+get_slot (uint64_t sequence)
+{
+  return &frame_records[sequence % FRAME_RECORD_RING_SIZE];
+}
+
+static void
+begin_write_slot (FrameRecordSlot *slot)
+{
+  g_atomic_int_inc (&slot->seq);
+}
+
+static void
+end_write_slot (FrameRecordSlot *slot)
+{
+  g_atomic_int_inc (&slot->seq);
+}
+
+static gboolean
+read_slot (FrameRecordSlot    *slot,
+           ClutterFrameRecord *record)
+{
+  int tries;
+
+  for (tries = 0; tries < 3; tries++)
+    {
+      int seq = g_atomic_int_get (&slot->seq);
+
+      if (seq & 1)
+        continue;
+
+      *record = slot->record;
+
+      if (g_atomic_int_get (&slot->seq) == seq)
+        return record->sequence != 0;
+    }
+
+  return FALSE;
+}
+
+void
+_clutter_frame_timings_begin_frame (int64_t start_time)
+{
+  memset (&current_frame, 0, sizeof (current_frame));
+  memset (phase_depth, 0, sizeof (phase_depth));
+
+  current_frame.frame_counter = -1;
+  current_frame.start_time = start_time;
+  in_frame = TRUE;
+}
+
+void
+_clutter_frame_timings_set_frame_counter (int64_t frame_counter)
+{
+  if (in_frame)
+    current_frame.frame_counter = frame_counter;
+}
+
+void
+_clutter_frame_timings_end_frame (gboolean stages_updated)
+{
+  FrameRecordSlot *slot;
+
+  if (!in_frame)
+    return;
+
+  in_frame = FALSE;
+
+  /* Idle ticks of the master clock would only push real frames out */
+  if (!stages_updated)
+    return;
+
+  current_frame.sequence = ++last_sequence;
+
+  slot = get_slot (current_frame.sequence);
+  begin_write_slot (slot);
+  slot->record = current_frame;
+  end_write_slot (slot);
+}
+
+void
+_clutter_frame_timings_presented (int64_t frame_counter,
+                                  int64_t presentation_time)
+{
+  uint64_t sequence;
+
+  for (sequence = last_sequence;
+       sequence > 0 && sequence + MAX_PENDING_PRESENTATIONS > last_sequence;
+       sequence--)
+    {
+      FrameRecordSlot *slot = get_slot (sequence);
+
+      if (slot->record.frame_counter != frame_counter)
+        continue;
+
+      begin_write_slot (slot);
+      slot->record.presentation_time = presentation_time;
+      end_write_slot (slot);
+      break;
+    }
+}
+
+/**
+ * clutter_frame_timings_begin_phase: (skip)
+ * @phase: a #ClutterFramePhase
+ *
+ * Starts accounting time to @phase of the frame currently being
+ * processed by the master clock. Nested calls for the same phase are
+ * only accounted once. Outside of a frame this does nothing.
+ */
+void
+clutter_frame_timings_begin_phase (ClutterFramePhase phase)
+{
+  g_return_if_fail (phase < CLUTTER_N_FRAME_PHASES);
+
+  if (!in_frame)
+    return;
+
+  if (phase_depth[phase]++ == 0)
+    phase_start[phase] = g_get_monotonic_time ();
+}
+
+/**
+ * clutter_frame_timings_end_phase: (skip)
+ * @phase: a #ClutterFramePhase
+ *
+ * Stops accounting time to @phase, see
+ * clutter_frame_timings_begin_phase().
+ */
+void
+clutter_frame_timings_end_phase (ClutterFramePhase phase)
+{
+  g_return_if_fail (phase < CLUTTER_N_FRAME_PHASES);
+
+  if (!in_frame || phase_depth[phase] == 0)
+    return;
+
+  if (--phase_depth[phase] == 0)
+    current_frame.phase_time[phase] += g_get_monotonic_time () - phase_start[phase];
+}
+
+static int
+compare_records (const void *a,
+                 const void *b)
+{
+  const ClutterFrameRecord *record_a = a;
+  const ClutterFrameRecord *record_b = b;
+
+  if (record_a->sequence < record_b->sequence)
+    return -1;
+  else if (record_a->sequence > record_b->sequence)
+    return 1;
+  else
+    return 0;
+}
+
+/**
+ * clutter_frame_timings_get_records: (skip)
+ * @since_sequence: only return records newer than this
+ * @records: array to return the records in
+ * @max_records: the size of @records
+ *
+ * Retrieves the oldest records still kept that are newer than
+ * @since_sequence, in order. Passing the sequence of the last record
+ * returned retrieves the next ones.
+ *
+ * Return value: the number of records stored in @records
+ */
+unsigned int
+clutter_frame_timings_get_records (uint64_t            since_sequence,
+                                   ClutterFrameRecord *records,
+                                   unsigned int        max_records)
+{
+  ClutterFrameRecord *found;
+  unsigned int n_found = 0;
+  int i;
+
+  found = g_new (ClutterFrameRecord, FRAME_RECORD_RING_SIZE);
+
+  for (i = 0; i < FRAME_RECORD_RING_SIZE; i++)
+    {
+      if (read_slot (&frame_records[i], &found[n_found]) &&
+          found[n_found].sequence > since_sequence)
+        n_found++;
+    }
+
+  qsort (found, n_found, sizeof (ClutterFrameRecord), compare_records);
+
+  n_found = MIN (n_found, max_records);
+  memcpy (records, found, n_found * sizeof (ClutterFrameRecord));
+
+  g_free (found);
+
+  return n_found;
+}
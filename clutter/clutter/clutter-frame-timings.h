@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2018 Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CLUTTER_FRAME_TIMINGS_H__
+#define __CLUTTER_FRAME_TIMINGS_H__
+
+#include <glib.h>
+#include <stdint.h>
+
+#include "clutter-macros.h"
+
+G_BEGIN_DECLS
+
+/**
+ * ClutterFramePhase: (skip)
+ * @CLUTTER_FRAME_PHASE_EVENTS: processing queued input events
+ * @CLUTTER_FRAME_PHASE_TIMELINES: advancing timelines
+ * @CLUTTER_FRAME_PHASE_RELAYOUT: allocating the stage
+ * @CLUTTER_FRAME_PHASE_CULL: culling occluded actors; part of the paint
+ * @CLUTTER_FRAME_PHASE_PAINT: painting the stage views
+ * @CLUTTER_FRAME_PHASE_SWAP: submitting the painted views
+ *
+ * The phases of a frame that #ClutterFrameRecord accounts time to.
+ */
+typedef enum
+{
+  CLUTTER_FRAME_PHASE_EVENTS,
+  CLUTTER_FRAME_PHASE_TIMELINES,
+  CLUTTER_FRAME_PHASE_RELAYOUT,
+  CLUTTER_FRAME_PHASE_CULL,
+  CLUTTER_FRAME_PHASE_PAINT,
+  CLUTTER_FRAME_PHASE_SWAP,
+
+  CLUTTER_N_FRAME_PHASES
+} ClutterFramePhase;
+
+/**
+ * ClutterFrameRecord: (skip)
+ * @sequence: increasing number of the record, starting at 1
+ * @frame_counter: the stage frame counter the frame was drawn with
+ * @start_time: monotonic time the frame started, in microseconds
+ * @phase_time: microseconds spent in each #ClutterFramePhase
+ * @presentation_time: monotonic time the frame was presented, in
+ *   microseconds, or 0 if that is not known (yet)
+ */
+typedef struct _ClutterFrameRecord
+{
+  uint64_t sequence;
+  int64_t frame_counter;
+  int64_t start_time;
+  int64_t phase_time[CLUTTER_N_FRAME_PHASES];
+  int64_t presentation_time;
+} ClutterFrameRecord;
+
+CLUTTER_AVAILABLE_IN_MUTTER
+void clutter_frame_timings_begin_phase (ClutterFramePhase phase);
+
+CLUTTER_AVAILABLE_IN_MUTTER
+void clutter_frame_timings_end_phase (ClutterFramePhase phase);
+
+CLUTTER_AVAILABLE_IN_MUTTER
+unsigned int clutter_frame_timings_get_records (uint64_t            since_sequence,
+                                                ClutterFrameRecord *records,
+                                                unsigned int        max_records);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_FRAME_TIMINGS_H__ */
@@ -138,6 +138,7 @@ static const GDebugKey clutter_debug_keys[] = {
 static const GDebugKey clutter_pick_debug_keys[] = {
   { "nop-picking", CLUTTER_DEBUG_NOP_PICKING },
   { "dump-pick-buffers", CLUTTER_DEBUG_DUMP_PICK_BUFFERS },
+  { "gpu-picking", CLUTTER_DEBUG_GPU_PICKING },
 };
 
 static const GDebugKey clutter_paint_debug_keys[] = {
@@ -36,6 +36,7 @@
 #include "clutter-master-clock.h"
 #include "clutter-master-clock-default.h"
 #include "clutter-debug.h"
+#include "clutter-frame-timings-private.h"
 #include "clutter-private.h"
 #include "clutter-stage-manager-private.h"
 #include "clutter-stage-private.h"
@@ -162,6 +163,19 @@ master_clock_is_running (ClutterMasterClockDefault *master_clock)
   return FALSE;
 }
 
+/*
+ * master_clock_get_swap_wait_time:
+ * @master_clock: a #ClutterMasterClock
+ *
+ * Computes how long to wait until the first stage is ready to be
+ * updated. A stage whose views are scheduled separately reports the
+ * update time of its earliest view, so the clock ticks at the refresh
+ * rate of the fastest output and each tick only paints the views that
+ * are due.
+ *
+ * Return value: -1 if no stage is ready, otherwise the number of
+ *   milliseconds to wait
+ */
 static gint
 master_clock_get_swap_wait_time (ClutterMasterClockDefault *master_clock)
 {
@@ -359,10 +373,14 @@ master_clock_process_events (ClutterMasterClockDefault *master_clock,
   gint64 start = g_get_monotonic_time ();
 #endif
 
+  clutter_frame_timings_begin_phase (CLUTTER_FRAME_PHASE_EVENTS);
+
   /* Process queued events */
   for (l = stages; l != NULL; l = l->next)
     _clutter_stage_process_queued_events (l->data);
 
+  clutter_frame_timings_end_phase (CLUTTER_FRAME_PHASE_EVENTS);
+
 #ifdef CLUTTER_ENABLE_DEBUG
   if (_clutter_diagnostic_enabled ())
     clutter_warn_if_over_budget (master_clock, start, "Event processing");
@@ -407,6 +425,8 @@ master_clock_advance_timelines (ClutterMasterClockDefault *master_clock)
    * and remove_timeline() would not find the timeline, failing
    * and leaving a dangling pointer behind.
    */
+  clutter_frame_timings_begin_phase (CLUTTER_FRAME_PHASE_TIMELINES);
+
   timelines = g_slist_copy (master_clock->timelines);
   g_slist_foreach (timelines, (GFunc) g_object_ref, NULL);
 
@@ -416,6 +436,8 @@ master_clock_advance_timelines (ClutterMasterClockDefault *master_clock)
   g_slist_foreach (timelines, (GFunc) g_object_unref, NULL);
   g_slist_free (timelines);
 
+  clutter_frame_timings_end_phase (CLUTTER_FRAME_PHASE_TIMELINES);
+
 #ifdef CLUTTER_ENABLE_DEBUG
   if (_clutter_diagnostic_enabled ())
     clutter_warn_if_over_budget (master_clock, start, "Animations");
@@ -540,6 +562,8 @@ clutter_clock_dispatch (GSource     *source,
   /* Get the time to use for this frame */
   master_clock->cur_tick = g_source_get_time (source);
 
+  _clutter_frame_timings_begin_frame (master_clock->cur_tick);
+
 #ifdef CLUTTER_ENABLE_DEBUG
   master_clock->remaining_budget = master_clock->frame_budget;
 #endif
@@ -571,6 +595,8 @@ clutter_clock_dispatch (GSource     *source,
   if (!stages_updated)
     master_clock->idle = TRUE;
 
+  _clutter_frame_timings_end_frame (stages_updated);
+
   master_clock_reschedule_stage_updates (master_clock, stages);
 
   g_slist_foreach (stages, (GFunc) g_object_unref, NULL);
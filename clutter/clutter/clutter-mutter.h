@@ -26,6 +26,7 @@
 #define __CLUTTER_H_INSIDE__
 
 #include "clutter-backend.h"
+#include "clutter-frame-timings.h"
 #include "clutter-macros.h"
 #include "clutter-stage-view.h"
 #include "cogl/clutter-stage-cogl.h"
@@ -53,6 +53,13 @@
  * function, which encapsulates the effective painting of the texture that
  * contains the result of the offscreen redirection.
  *
+ * The contents of the offscreen buffer are reused, without painting the
+ * actor again, as long as no redraw has been queued on the actor or its
+ * children and the actor has at most been moved around on the stage.
+ * Sub-classes whose parameters change how the actor is rendered into the
+ * offscreen buffer should call clutter_offscreen_effect_invalidate() when
+ * those parameters change.
+ *
  * The size of the target material is defined to be as big as the
  * transformed size of the #ClutterActor using the offscreen effect.
  * Sub-classes of #ClutterOffscreenEffect can change the texture creation
@@ -66,15 +73,22 @@
 #include "clutter-build-config.h"
 #endif
 
+#include <math.h>
+
 #include "clutter-offscreen-effect.h"
 
 #include "cogl/cogl.h"
 
 #include "clutter-actor-private.h"
 #include "clutter-debug.h"
+#include "clutter-paint-volume-private.h"
 #include "clutter-private.h"
 #include "clutter-stage-private.h"
 
+/* Tolerance when comparing the actor transformations of two paints to
+   decide whether the cached image can be moved instead of redrawn */
+#define MATRIX_EPSILON 1e-4f
+
 struct _ClutterOffscreenEffectPrivate
 {
   CoglHandle offscreen;
@@ -105,6 +119,19 @@ struct _ClutterOffscreenEffectPrivate
      and it won't cause a redraw to be queued on the parent's
      children. */
   CoglMatrix last_matrix_drawn;
+
+  /* The transformation from the actor to stage coordinates when the fbo
+     was last updated. If only the translation changes and the actor is
+     flat then the contents can be painted at the new position instead
+     of redrawing the actor. */
+  CoglMatrix last_actor_to_stage;
+
+  /* Whether the fbo holds the whole paint box of the actor, which is
+     not the case if it had to be clamped to the size of the stage */
+  guint fbo_has_whole_actor : 1;
+
+  /* Set by clutter_offscreen_effect_invalidate() */
+  guint invalidated : 1;
 };
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (ClutterOffscreenEffect,
@@ -216,6 +243,89 @@ update_fbo (ClutterEffect *effect, int fbo_width, int fbo_height)
   return TRUE;
 }
 
+/* Computes the transformation from the actor to stage coordinates by
+ * removing the stage's own transformation from @modelview */
+static void
+get_actor_to_stage (ClutterOffscreenEffect *self,
+                    const CoglMatrix       *modelview,
+                    CoglMatrix             *actor_to_stage)
+{
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+  CoglMatrix stage_modelview;
+  CoglMatrix stage_inverse;
+
+  cogl_matrix_init_identity (&stage_modelview);
+  _clutter_actor_apply_modelview_transform (priv->stage, &stage_modelview);
+
+  if (!cogl_matrix_get_inverse (&stage_modelview, &stage_inverse))
+    {
+      /* This makes every comparison fail so the actor gets redrawn */
+      cogl_matrix_init_identity (actor_to_stage);
+      actor_to_stage->ww = 0.0f;
+      return;
+    }
+
+  cogl_matrix_multiply (actor_to_stage, &stage_inverse, modelview);
+}
+
+/* Checks whether the cached image can be reused for painting the
+ * actor with @modelview by moving it, and if so returns the distance
+ * to move it in stage coordinates.
+ *
+ * That is the case if the actor is flat and its transformation only
+ * differs from the one it was drawn with by a translation on the
+ * plane of the stage. Any other change, like a scale or a rotation
+ * around the x or y axis, changes how the actor looks and requires
+ * redrawing it.
+ */
+static gboolean
+get_cached_image_offset (ClutterOffscreenEffect *self,
+                         const CoglMatrix       *modelview,
+                         gfloat                 *dx,
+                         gfloat                 *dy)
+{
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+  const ClutterPaintVolume *volume;
+  const CoglMatrix *last = &priv->last_actor_to_stage;
+  CoglMatrix current;
+
+  if (!priv->fbo_has_whole_actor)
+    return FALSE;
+
+  volume = clutter_actor_get_paint_volume (priv->actor);
+  if (volume == NULL || !volume->is_2d)
+    return FALSE;
+
+  get_actor_to_stage (self, modelview, &current);
+
+  /* The actor has to stay on the plane of the stage... */
+  if (fabsf (current.zx) > MATRIX_EPSILON ||
+      fabsf (current.zy) > MATRIX_EPSILON ||
+      fabsf (current.zw) > MATRIX_EPSILON ||
+      fabsf (current.wx) > MATRIX_EPSILON ||
+      fabsf (current.wy) > MATRIX_EPSILON ||
+      fabsf (current.ww - 1.0f) > MATRIX_EPSILON)
+    return FALSE;
+
+  /* ...and keep the same size, shape and orientation */
+  if (fabsf (current.xx - last->xx) > MATRIX_EPSILON ||
+      fabsf (current.xy - last->xy) > MATRIX_EPSILON ||
+      fabsf (current.yx - last->yx) > MATRIX_EPSILON ||
+      fabsf (current.yy - last->yy) > MATRIX_EPSILON ||
+      fabsf (current.zx - last->zx) > MATRIX_EPSILON ||
+      fabsf (current.zy - last->zy) > MATRIX_EPSILON ||
+      fabsf (current.zw - last->zw) > MATRIX_EPSILON ||
+      fabsf (current.wx - last->wx) > MATRIX_EPSILON ||
+      fabsf (current.wy - last->wy) > MATRIX_EPSILON ||
+      fabsf (current.ww - last->ww) > MATRIX_EPSILON)
+    return FALSE;
+
+  *dx = current.xw - last->xw;
+  *dy = current.yw - last->yw;
+
+  return TRUE;
+}
+
 static gboolean
 clutter_offscreen_effect_pre_paint (ClutterEffect *effect)
 {
@@ -230,6 +340,7 @@ clutter_offscreen_effect_pre_paint (ClutterEffect *effect)
   gfloat width, height;
   gfloat xexpand, yexpand;
   int texture_width, texture_height;
+  gboolean has_whole_actor = FALSE;
 
   if (!clutter_actor_meta_get_enabled (CLUTTER_ACTOR_META (effect)))
     return FALSE;
@@ -249,6 +360,9 @@ clutter_offscreen_effect_pre_paint (ClutterEffect *effect)
       clutter_actor_box_get_size (&box, &fbo_width, &fbo_height);
       clutter_actor_box_get_origin (&box, &priv->x_offset, &priv->y_offset);
 
+      has_whole_actor = (fbo_width < stage_width &&
+                         fbo_height < stage_height);
+
       fbo_width = MIN (fbo_width, stage_width);
       fbo_height = MIN (fbo_height, stage_height);
     }
@@ -267,6 +381,9 @@ clutter_offscreen_effect_pre_paint (ClutterEffect *effect)
   if (!update_fbo (effect, fbo_width, fbo_height))
     return FALSE;
 
+  priv->fbo_has_whole_actor = has_whole_actor;
+  priv->invalidated = FALSE;
+
   texture_width = cogl_texture_get_width (priv->texture);
   texture_height = cogl_texture_get_height (priv->texture);
 
@@ -275,6 +392,8 @@ clutter_offscreen_effect_pre_paint (ClutterEffect *effect)
    * updated the FBO so that we can detect when we don't need to
    * update the FBO to paint a second time */
   cogl_get_modelview_matrix (&priv->last_matrix_drawn);
+  get_actor_to_stage (self, &priv->last_matrix_drawn,
+                      &priv->last_actor_to_stage);
 
   /* let's draw offscreen */
   cogl_push_framebuffer (priv->offscreen);
@@ -426,6 +545,7 @@ clutter_offscreen_effect_paint (ClutterEffect           *effect,
   ClutterOffscreenEffect *self = CLUTTER_OFFSCREEN_EFFECT (effect);
   ClutterOffscreenEffectPrivate *priv = self->priv;
   CoglMatrix matrix;
+  gfloat dx, dy;
 
   cogl_get_modelview_matrix (&matrix);
 
@@ -433,16 +553,32 @@ clutter_offscreen_effect_paint (ClutterEffect           *effect,
      actor hasn't been redrawn then we can just use the cached image
      in the fbo */
   if (priv->offscreen == NULL ||
-      (flags & CLUTTER_EFFECT_PAINT_ACTOR_DIRTY) ||
-      !cogl_matrix_equal (&matrix, &priv->last_matrix_drawn))
+      priv->invalidated ||
+      (flags & CLUTTER_EFFECT_PAINT_ACTOR_DIRTY))
     {
       /* Chain up to the parent paint method which will call the pre and
          post paint functions to update the image */
       CLUTTER_EFFECT_CLASS (clutter_offscreen_effect_parent_class)->
         paint (effect, flags);
     }
-  else
+  else if (cogl_matrix_equal (&matrix, &priv->last_matrix_drawn))
     clutter_offscreen_effect_paint_texture (self);
+  else if (get_cached_image_offset (self, &matrix, &dx, &dy))
+    {
+      /* The actor has only been moved, for example because one of its
+         parents is being animated, so the cached image can be painted
+         at the new position */
+      priv->x_offset += dx;
+      priv->y_offset += dy;
+      priv->last_matrix_drawn = matrix;
+      priv->last_actor_to_stage.xw += dx;
+      priv->last_actor_to_stage.yw += dy;
+
+      clutter_offscreen_effect_paint_texture (self);
+    }
+  else
+    CLUTTER_EFFECT_CLASS (clutter_offscreen_effect_parent_class)->
+      paint (effect, flags);
 }
 
 static void
@@ -667,3 +803,28 @@ clutter_offscreen_effect_get_target_rect (ClutterOffscreenEffect *effect,
 
   return TRUE;
 }
+
+/**
+ * clutter_offscreen_effect_invalidate:
+ * @effect: a #ClutterOffscreenEffect
+ *
+ * Discards the image of the actor cached in the offscreen buffer of
+ * @effect and queues a repaint, so that the actor is painted into the
+ * offscreen buffer again.
+ *
+ * This should be used by sub-classes when a parameter that changes how
+ * the actor is rendered into the offscreen buffer is modified. When a
+ * parameter only changes how the offscreen buffer is painted, as in
+ * #ClutterOffscreenEffectClass.paint_target(), then
+ * clutter_effect_queue_repaint() is enough and the cached image will
+ * be reused.
+ */
+void
+clutter_offscreen_effect_invalidate (ClutterOffscreenEffect *effect)
+{
+  g_return_if_fail (CLUTTER_IS_OFFSCREEN_EFFECT (effect));
+
+  effect->priv->invalidated = TRUE;
+
+  clutter_effect_queue_repaint (CLUTTER_EFFECT (effect));
+}
@@ -116,6 +116,9 @@ CLUTTER_AVAILABLE_IN_1_14
 gboolean        clutter_offscreen_effect_get_target_rect        (ClutterOffscreenEffect *effect,
                                                                  ClutterRect            *rect);
 
+CLUTTER_AVAILABLE_IN_MUTTER
+void            clutter_offscreen_effect_invalidate             (ClutterOffscreenEffect *effect);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_OFFSCREEN_EFFECT_H__ */
@@ -39,6 +39,9 @@ ClutterStageWindow *_clutter_stage_get_default_window    (void);
 void                _clutter_stage_paint_view            (ClutterStage                *stage,
                                                           ClutterStageView            *view,
                                                           const cairo_rectangle_int_t *clip);
+void                _clutter_stage_emit_after_paint_view (ClutterStage                *stage,
+                                                          ClutterStageView            *view,
+                                                          const cairo_region_t        *damage);
 
 void                _clutter_stage_set_window            (ClutterStage          *stage,
                                                           ClutterStageWindow    *stage_window);
@@ -79,6 +82,18 @@ ClutterActor *_clutter_stage_do_pick (ClutterStage    *stage,
                                       gint             y,
                                       ClutterPickMode  mode);
 
+gboolean      _clutter_stage_is_geometric_picking     (ClutterStage          *stage);
+void          _clutter_stage_log_pick                 (ClutterStage          *stage,
+                                                       const ClutterActorBox *box,
+                                                       ClutterActor          *actor);
+void          _clutter_stage_push_pick_clip           (ClutterStage          *stage,
+                                                       const ClutterActorBox *box);
+void          _clutter_stage_pop_pick_clip            (ClutterStage          *stage);
+void          _clutter_stage_fail_geometric_pick      (ClutterStage          *stage,
+                                                       ClutterActor          *actor);
+gboolean      _clutter_stage_has_failed_geometric_pick (ClutterStage         *stage);
+void          _clutter_stage_clear_pick_stack         (ClutterStage          *stage);
+
 ClutterPaintVolume *_clutter_stage_paint_volume_stack_allocate (ClutterStage *stage);
 void                _clutter_stage_paint_volume_stack_free_all (ClutterStage *stage);
 
@@ -330,3 +330,14 @@ _clutter_stage_window_get_frame_counter (ClutterStageWindow *window)
   else
     return 0;
 }
+
+gboolean
+_clutter_stage_window_has_deferred_redraws (ClutterStageWindow *window)
+{
+  ClutterStageWindowIface *iface = CLUTTER_STAGE_WINDOW_GET_IFACE (window);
+
+  if (iface->has_deferred_redraws)
+    return iface->has_deferred_redraws (window);
+  else
+    return FALSE;
+}
@@ -48,6 +48,7 @@
 
 #include <math.h>
 #include <cairo.h>
+#include <cairo-gobject.h>
 
 #define CLUTTER_DISABLE_DEPRECATION_WARNINGS
 #define CLUTTER_ENABLE_EXPERIMENTAL_API
@@ -65,6 +66,7 @@
 #include "clutter-device-manager-private.h"
 #include "clutter-enum-types.h"
 #include "clutter-event-private.h"
+#include "clutter-frame-timings-private.h"
 #include "clutter-id-pool.h"
 #include "clutter-main.h"
 #include "clutter-marshal.h"
@@ -140,6 +142,12 @@ struct _ClutterStagePrivate
 
   ClutterIDPool *pick_id_pool;
 
+  GArray *pick_stack;
+  GArray *pick_clip_stack;
+  int pick_clip_stack_top;
+  GArray **pick_grid;
+  ClutterPickMode cached_pick_mode;
+
 #ifdef CLUTTER_ENABLE_DEBUG
   gulong redraw_count;
 #endif /* CLUTTER_ENABLE_DEBUG */
@@ -162,6 +170,10 @@ struct _ClutterStagePrivate
   guint motion_events_enabled  : 1;
   guint has_custom_perspective : 1;
   guint stage_was_relayout     : 1;
+  guint geometric_pick_in_progress : 1;
+  guint geometric_pick_failed  : 1;
+  guint pick_stack_valid       : 1;
+  guint pick_stack_reused      : 1;
 };
 
 enum
@@ -191,6 +203,7 @@ enum
   DEACTIVATE,
   DELETE_EVENT,
   AFTER_PAINT,
+  AFTER_PAINT_VIEW,
   PRESENTED,
 
   LAST_SIGNAL
@@ -686,6 +699,14 @@ _clutter_stage_paint_view (ClutterStage                *stage,
   g_signal_emit (stage, stage_signals[AFTER_PAINT], 0);
 }
 
+void
+_clutter_stage_emit_after_paint_view (ClutterStage         *stage,
+                                      ClutterStageView     *view,
+                                      const cairo_region_t *damage)
+{
+  g_signal_emit (stage, stage_signals[AFTER_PAINT_VIEW], 0, view, damage);
+}
+
 /* If we don't implement this here, we get the paint function
  * from the deprecated clutter-group class, which doesn't
  * respect the Z order as it uses our empty sort_depth_order.
@@ -1061,6 +1082,7 @@ _clutter_stage_maybe_relayout (ClutterActor *actor)
   ClutterStagePrivate *priv = stage->priv;
   gfloat natural_width, natural_height;
   ClutterActorBox box = { 0, };
+  ClutterLayoutStats *stats;
 
   if (!priv->relayout_pending)
     return;
@@ -1073,6 +1095,9 @@ _clutter_stage_maybe_relayout (ClutterActor *actor)
 
       CLUTTER_NOTE (ACTOR, "Recomputing layout");
 
+      stats = _clutter_actor_get_layout_stats ();
+      memset (stats, 0, sizeof (ClutterLayoutStats));
+
       CLUTTER_SET_PRIVATE_FLAGS (stage, CLUTTER_IN_RELAYOUT);
 
       natural_width = natural_height = 0;
@@ -1093,6 +1118,13 @@ _clutter_stage_maybe_relayout (ClutterActor *actor)
                               &box, CLUTTER_ALLOCATION_NONE);
 
       CLUTTER_UNSET_PRIVATE_FLAGS (stage, CLUTTER_IN_RELAYOUT);
+
+      CLUTTER_NOTE (LAYOUT,
+                    "Relayout: %u actors allocated, %u size requests "
+                    "computed, %u actors kept their size requests",
+                    stats->n_allocations,
+                    stats->n_size_requests,
+                    stats->n_kept_size_requests);
     }
 }
 
@@ -1223,7 +1255,9 @@ _clutter_stage_do_update (ClutterStage *stage)
    * check or clear the pending redraws flag since a relayout may
    * queue a redraw.
    */
+  clutter_frame_timings_begin_phase (CLUTTER_FRAME_PHASE_RELAYOUT);
   _clutter_stage_maybe_relayout (CLUTTER_ACTOR (stage));
+  clutter_frame_timings_end_phase (CLUTTER_FRAME_PHASE_RELAYOUT);
 
   if (!priv->redraw_pending)
     return FALSE;
@@ -1235,8 +1269,10 @@ _clutter_stage_do_update (ClutterStage *stage)
 
   clutter_stage_do_redraw (stage);
 
-  /* reset the guard, so that new redraws are possible */
-  priv->redraw_pending = FALSE;
+  /* reset the guard, so that new redraws are possible, unless the
+   * stage window kept damage for views that weren't due to be
+   * presented yet and needs another update to paint them */
+  priv->redraw_pending = _clutter_stage_window_has_deferred_redraws (priv->impl);
 
 #ifdef CLUTTER_ENABLE_DEBUG
   if (priv->redraw_count > 0)
@@ -1289,6 +1325,8 @@ clutter_stage_real_queue_redraw (ClutterActor *actor,
   if (CLUTTER_ACTOR_IN_DESTRUCTION (actor))
     return;
 
+  _clutter_stage_clear_pick_stack (stage);
+
   /* If the backend can't do anything with redraw clips (e.g. it already knows
    * it needs to redraw everything anyway) then don't spend time transforming
    * any clip volume into stage coordinates... */
@@ -1424,12 +1462,429 @@ read_pixels_to_file (char *filename_stem,
   read_count++;
 }
 
+/* Geometric picking
+ *
+ * Instead of rendering the scene in pick mode and reading back a pixel,
+ * the scene graph is traversed in pick mode without drawing anything:
+ * actors describe their pickable area with clutter_actor_pick_box(),
+ * which is transformed into stage coordinates and logged, together with
+ * the clip rectangles of their ancestors. Picking then amounts to
+ * finding the top-most logged quad containing the point.
+ *
+ * The log stays valid until something queues a redraw, so repeated
+ * picks of an unchanged scene (e.g. the pointer moving over a static
+ * desktop) don't need another traversal. Once a log is reused, it is
+ * bucketed into a coarse grid so lookups only test the quads that can
+ * contain the point.
+ *
+ * Actors whose pick implementation can't be modelled this way make the
+ * traversal fail, in which case the stage falls back to rendering a pick
+ * buffer; see clutter_actor_class_set_geometric_pick(). A failure is
+ * remembered just like a log, so the picks that follow it don't repeat
+ * the traversal until the next redraw is queued.
+ */
+
+#define PICK_GRID_SIZE 16
+#define PICK_GRID_MIN_RECORDS 64
+
+typedef struct _PickRecord
+{
+  ClutterPoint vertex[4];
+  ClutterActor *actor;
+  int clip_stack_top;
+} PickRecord;
+
+typedef struct _PickClipRecord
+{
+  int prev;
+  ClutterPoint vertex[4];
+} PickClipRecord;
+
+static void
+clutter_stage_clear_pick_grid (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  int i;
+
+  if (priv->pick_grid == NULL)
+    return;
+
+  for (i = 0; i < PICK_GRID_SIZE * PICK_GRID_SIZE; i++)
+    g_array_free (priv->pick_grid[i], TRUE);
+
+  g_clear_pointer (&priv->pick_grid, g_free);
+}
+
+void
+_clutter_stage_clear_pick_stack (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  /* Never drop the log while it's being filled */
+  if (priv->geometric_pick_in_progress)
+    return;
+
+  if (!priv->pick_stack_valid && priv->pick_stack->len == 0)
+    return;
+
+  g_array_set_size (priv->pick_stack, 0);
+  g_array_set_size (priv->pick_clip_stack, 0);
+  priv->pick_clip_stack_top = -1;
+  priv->pick_stack_valid = FALSE;
+  priv->pick_stack_reused = FALSE;
+  priv->geometric_pick_failed = FALSE;
+
+  clutter_stage_clear_pick_grid (stage);
+}
+
+gboolean
+_clutter_stage_is_geometric_picking (ClutterStage *stage)
+{
+  return stage->priv->geometric_pick_in_progress;
+}
+
+void
+_clutter_stage_fail_geometric_pick (ClutterStage *stage,
+                                    ClutterActor *actor)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  if (!priv->geometric_pick_failed)
+    CLUTTER_NOTE (PICK, "Actor %s can't be picked geometrically, "
+                  "falling back to rendering a pick buffer",
+                  _clutter_actor_get_debug_name (actor));
+
+  priv->geometric_pick_failed = TRUE;
+}
+
+gboolean
+_clutter_stage_has_failed_geometric_pick (ClutterStage *stage)
+{
+  return stage->priv->geometric_pick_failed;
+}
+
+static void
+transform_pick_box (ClutterStage          *stage,
+                    const ClutterActorBox *box,
+                    ClutterPoint           vertex[4])
+{
+  ClutterStagePrivate *priv = stage->priv;
+  ClutterVertex vertices[4];
+  CoglMatrix modelview;
+  int i;
+
+  vertices[0] = (ClutterVertex) { box->x1, box->y1, 0.f };
+  vertices[1] = (ClutterVertex) { box->x2, box->y1, 0.f };
+  vertices[2] = (ClutterVertex) { box->x2, box->y2, 0.f };
+  vertices[3] = (ClutterVertex) { box->x1, box->y2, 0.f };
+
+  cogl_get_modelview_matrix (&modelview);
+
+  _clutter_util_fully_transform_vertices (&modelview,
+                                          &priv->projection,
+                                          priv->viewport,
+                                          vertices,
+                                          vertices,
+                                          4);
+
+  for (i = 0; i < 4; i++)
+    {
+      vertex[i].x = vertices[i].x;
+      vertex[i].y = vertices[i].y;
+    }
+}
+
+void
+_clutter_stage_log_pick (ClutterStage          *stage,
+                         const ClutterActorBox *box,
+                         ClutterActor          *actor)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  PickRecord rec;
+
+  g_assert (priv->geometric_pick_in_progress);
+
+  transform_pick_box (stage, box, rec.vertex);
+  rec.actor = actor;
+  rec.clip_stack_top = priv->pick_clip_stack_top;
+
+  g_array_append_val (priv->pick_stack, rec);
+}
+
+void
+_clutter_stage_push_pick_clip (ClutterStage          *stage,
+                               const ClutterActorBox *box)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  PickClipRecord clip;
+
+  g_assert (priv->geometric_pick_in_progress);
+
+  transform_pick_box (stage, box, clip.vertex);
+  clip.prev = priv->pick_clip_stack_top;
+
+  g_array_append_val (priv->pick_clip_stack, clip);
+  priv->pick_clip_stack_top = priv->pick_clip_stack->len - 1;
+}
+
+void
+_clutter_stage_pop_pick_clip (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  const PickClipRecord *top;
+
+  g_assert (priv->pick_clip_stack_top >= 0);
+
+  /* Individual clip records are never freed until the next traversal,
+   * since pick records keep referring to them by index. */
+  top = &g_array_index (priv->pick_clip_stack,
+                        PickClipRecord,
+                        priv->pick_clip_stack_top);
+  priv->pick_clip_stack_top = top->prev;
+}
+
+static gboolean
+is_inside_quad (const ClutterPoint  vertex[4],
+                float               x,
+                float               y)
+{
+  gboolean has_positive = FALSE;
+  gboolean has_negative = FALSE;
+  int i;
+
+  /* The point is inside a convex quad if it lies on the same side of
+   * every edge, whatever the winding the transformation left us with. */
+  for (i = 0; i < 4; i++)
+    {
+      const ClutterPoint *a = &vertex[i];
+      const ClutterPoint *b = &vertex[(i + 1) % 4];
+      float cross;
+
+      cross = (b->x - a->x) * (y - a->y) - (b->y - a->y) * (x - a->x);
+
+      if (cross > 0.f)
+        has_positive = TRUE;
+      else if (cross < 0.f)
+        has_negative = TRUE;
+
+      if (has_positive && has_negative)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+pick_record_contains_point (ClutterStage     *stage,
+                            const PickRecord *rec,
+                            float             x,
+                            float             y)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  int clip_index;
+
+  if (!is_inside_quad (rec->vertex, x, y))
+    return FALSE;
+
+  clip_index = rec->clip_stack_top;
+  while (clip_index >= 0)
+    {
+      const PickClipRecord *clip =
+        &g_array_index (priv->pick_clip_stack, PickClipRecord, clip_index);
+
+      if (!is_inside_quad (clip->vertex, x, y))
+        return FALSE;
+
+      clip_index = clip->prev;
+    }
+
+  return TRUE;
+}
+
+static int
+pick_grid_cell (float coord,
+                float stage_size)
+{
+  int cell;
+
+  if (stage_size <= 0.f)
+    return 0;
+
+  cell = floorf (coord * PICK_GRID_SIZE / stage_size);
+
+  return CLAMP (cell, 0, PICK_GRID_SIZE - 1);
+}
+
+static void
+clutter_stage_build_pick_grid (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  float stage_width, stage_height;
+  int i;
+
+  clutter_actor_get_size (CLUTTER_ACTOR (stage), &stage_width, &stage_height);
+
+  priv->pick_grid = g_new0 (GArray *, PICK_GRID_SIZE * PICK_GRID_SIZE);
+  for (i = 0; i < PICK_GRID_SIZE * PICK_GRID_SIZE; i++)
+    priv->pick_grid[i] = g_array_new (FALSE, FALSE, sizeof (int));
+
+  for (i = 0; i < (int) priv->pick_stack->len; i++)
+    {
+      const PickRecord *rec = &g_array_index (priv->pick_stack, PickRecord, i);
+      float x_1, y_1, x_2, y_2;
+      int cell_x1, cell_y1, cell_x2, cell_y2;
+      int cell_x, cell_y;
+      int j;
+
+      x_1 = x_2 = rec->vertex[0].x;
+      y_1 = y_2 = rec->vertex[0].y;
+      for (j = 1; j < 4; j++)
+        {
+          x_1 = MIN (x_1, rec->vertex[j].x);
+          y_1 = MIN (y_1, rec->vertex[j].y);
+          x_2 = MAX (x_2, rec->vertex[j].x);
+          y_2 = MAX (y_2, rec->vertex[j].y);
+        }
+
+      if (x_2 < 0.f || y_2 < 0.f || x_1 >= stage_width || y_1 >= stage_height)
+        continue;
+
+      cell_x1 = pick_grid_cell (x_1, stage_width);
+      cell_y1 = pick_grid_cell (y_1, stage_height);
+      cell_x2 = pick_grid_cell (x_2, stage_width);
+      cell_y2 = pick_grid_cell (y_2, stage_height);
+
+      for (cell_y = cell_y1; cell_y <= cell_y2; cell_y++)
+        for (cell_x = cell_x1; cell_x <= cell_x2; cell_x++)
+          g_array_append_val (priv->pick_grid[cell_y * PICK_GRID_SIZE + cell_x], i);
+    }
+}
+
 static ClutterActor *
-_clutter_stage_do_pick_on_view (ClutterStage     *stage,
-                                gint              x,
-                                gint              y,
-                                ClutterPickMode   mode,
-                                ClutterStageView *view)
+clutter_stage_find_picked_actor (ClutterStage *stage,
+                                 float         x,
+                                 float         y)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  int i;
+
+  if (priv->pick_stack_reused &&
+      priv->pick_grid == NULL &&
+      priv->pick_stack->len >= PICK_GRID_MIN_RECORDS)
+    clutter_stage_build_pick_grid (stage);
+
+  /* Records are logged in paint order, so the last match is on top */
+  if (priv->pick_grid != NULL)
+    {
+      float stage_width, stage_height;
+      GArray *cell;
+
+      clutter_actor_get_size (CLUTTER_ACTOR (stage),
+                              &stage_width, &stage_height);
+      cell = priv->pick_grid[pick_grid_cell (y, stage_height) * PICK_GRID_SIZE +
+                             pick_grid_cell (x, stage_width)];
+
+      for (i = cell->len - 1; i >= 0; i--)
+        {
+          int index = g_array_index (cell, int, i);
+          const PickRecord *rec =
+            &g_array_index (priv->pick_stack, PickRecord, index);
+
+          if (pick_record_contains_point (stage, rec, x, y))
+            return rec->actor;
+        }
+    }
+  else
+    {
+      for (i = priv->pick_stack->len - 1; i >= 0; i--)
+        {
+          const PickRecord *rec =
+            &g_array_index (priv->pick_stack, PickRecord, i);
+
+          if (pick_record_contains_point (stage, rec, x, y))
+            return rec->actor;
+        }
+    }
+
+  return CLUTTER_ACTOR (stage);
+}
+
+static gboolean
+clutter_stage_do_geometric_pick_on_view (ClutterStage      *stage,
+                                         gint               x,
+                                         gint               y,
+                                         ClutterPickMode    mode,
+                                         ClutterStageView  *view,
+                                         ClutterActor     **picked_actor)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  if (priv->pick_stack_valid && priv->cached_pick_mode == mode)
+    {
+      /* The scene hasn't changed since it last failed to be picked
+       * geometrically, so it would fail again */
+      if (priv->geometric_pick_failed)
+        return FALSE;
+
+      priv->pick_stack_reused = TRUE;
+    }
+  else
+    {
+      CoglFramebuffer *fb = clutter_stage_view_get_framebuffer (view);
+      ClutterMainContext *context = _clutter_context_get_default ();
+
+      _clutter_stage_clear_pick_stack (stage);
+
+      cogl_push_framebuffer (fb);
+
+      priv->geometric_pick_in_progress = TRUE;
+      priv->geometric_pick_failed = FALSE;
+
+      /* Nothing is drawn, the paint only walks the actors to log their
+       * geometry. */
+      context->pick_mode = mode;
+      clutter_stage_do_paint_view (stage, view, NULL);
+      context->pick_mode = CLUTTER_PICK_NONE;
+
+      priv->geometric_pick_in_progress = FALSE;
+
+      cogl_pop_framebuffer ();
+
+      if (priv->geometric_pick_failed)
+        {
+          /* Remember the failure until the log would have been
+           * invalidated, so that the picks in between go straight to
+           * the pick buffer */
+          _clutter_stage_clear_pick_stack (stage);
+          priv->pick_stack_valid = TRUE;
+          priv->geometric_pick_failed = TRUE;
+          priv->cached_pick_mode = mode;
+          return FALSE;
+        }
+
+      priv->pick_stack_valid = TRUE;
+      priv->cached_pick_mode = mode;
+
+      CLUTTER_NOTE (PICK, "Logged %u pick records and %u pick clips",
+                    priv->pick_stack->len,
+                    priv->pick_clip_stack->len);
+    }
+
+  *picked_actor = clutter_stage_find_picked_actor (stage, x, y);
+
+  CLUTTER_NOTE (PICK, "Geometric pick at %i,%i found actor %s",
+                x, y,
+                _clutter_actor_get_debug_name (*picked_actor));
+
+  return TRUE;
+}
+
+static ClutterActor *
+clutter_stage_do_gpu_pick_on_view (ClutterStage     *stage,
+                                   gint              x,
+                                   gint              y,
+                                   ClutterPickMode   mode,
+                                   ClutterStageView *view)
 {
   ClutterActor *actor = CLUTTER_ACTOR (stage);
   ClutterStagePrivate *priv = stage->priv;
@@ -1566,6 +2021,24 @@ _clutter_stage_do_pick_on_view (ClutterStage     *stage,
   return retval;
 }
 
+static ClutterActor *
+_clutter_stage_do_pick_on_view (ClutterStage     *stage,
+                                gint              x,
+                                gint              y,
+                                ClutterPickMode   mode,
+                                ClutterStageView *view)
+{
+  ClutterActor *retval;
+
+  if (G_LIKELY (!(clutter_pick_debug_flags & (CLUTTER_DEBUG_GPU_PICKING |
+                                              CLUTTER_DEBUG_DUMP_PICK_BUFFERS))) &&
+      clutter_stage_do_geometric_pick_on_view (stage, x, y, mode, view,
+                                               &retval))
+    return retval;
+
+  return clutter_stage_do_gpu_pick_on_view (stage, x, y, mode, view);
+}
+
 static ClutterStageView *
 get_view_at (ClutterStage *stage,
              int           x,
@@ -1878,6 +2351,10 @@ clutter_stage_finalize (GObject *object)
 
   _clutter_id_pool_free (priv->pick_id_pool);
 
+  clutter_stage_clear_pick_grid (stage);
+  g_array_free (priv->pick_stack, TRUE);
+  g_array_free (priv->pick_clip_stack, TRUE);
+
   if (priv->fps_timer != NULL)
     g_timer_destroy (priv->fps_timer);
 
@@ -1905,6 +2382,7 @@ clutter_stage_class_init (ClutterStageClass *klass)
   actor_class->get_preferred_height = clutter_stage_get_preferred_height;
   actor_class->paint = clutter_stage_paint;
   actor_class->pick = clutter_stage_pick;
+  clutter_actor_class_set_geometric_pick (actor_class);
   actor_class->get_paint_volume = clutter_stage_get_paint_volume;
   actor_class->realize = clutter_stage_realize;
   actor_class->unrealize = clutter_stage_unrealize;
@@ -2243,6 +2721,28 @@ clutter_stage_class_init (ClutterStageClass *klass)
                   NULL, NULL, NULL,
                   G_TYPE_NONE, 0);
 
+  /**
+   * ClutterStage::after-paint-view: (skip)
+   * @stage: the stage that received the event
+   * @view: the #ClutterStageView that was painted
+   * @damage: the area of @view that changed, in stage coordinates
+   *
+   * The ::after-paint-view signal is emitted once a view has been
+   * completely painted, but before the results are displayed on the
+   * screen. Unlike #ClutterStage::after-paint, it is emitted only once
+   * per view and frame, even when the view is painted in multiple
+   * clipped passes.
+   */
+  stage_signals[AFTER_PAINT_VIEW] =
+    g_signal_new (I_("after-paint-view"),
+                  G_TYPE_FROM_CLASS (gobject_class),
+                  G_SIGNAL_RUN_LAST,
+                  0, /* no corresponding vfunc */
+                  NULL, NULL, NULL,
+                  G_TYPE_NONE, 2,
+                  CLUTTER_TYPE_STAGE_VIEW,
+                  CAIRO_GOBJECT_TYPE_REGION | G_SIGNAL_TYPE_STATIC_SCOPE);
+
   /**
    * ClutterStage::presented: (skip)
    * @stage: the stage that received the event
@@ -2375,6 +2875,10 @@ clutter_stage_init (ClutterStage *self)
     g_array_new (FALSE, FALSE, sizeof (ClutterPaintVolume));
 
   priv->pick_id_pool = _clutter_id_pool_new (256);
+
+  priv->pick_stack = g_array_new (FALSE, FALSE, sizeof (PickRecord));
+  priv->pick_clip_stack = g_array_new (FALSE, FALSE, sizeof (PickClipRecord));
+  priv->pick_clip_stack_top = -1;
 }
 
 /**
@@ -4149,6 +4653,8 @@ _clutter_stage_queue_actor_redraw (ClutterStage *stage,
   CLUTTER_NOTE (CLIPPING, "stage_queue_actor_redraw (actor=%s, clip=%p): ",
                 _clutter_actor_get_debug_name (actor), clip);
 
+  _clutter_stage_clear_pick_stack (stage);
+
   if (!priv->redraw_pending)
     {
       ClutterMasterClock *master_clock;
@@ -4429,6 +4935,8 @@ _clutter_stage_release_pick_id (ClutterStage *stage,
   g_assert (priv->pick_id_pool != NULL);
 
   _clutter_id_pool_remove (priv->pick_id_pool, pick_id);
+
+  _clutter_stage_clear_pick_stack (stage);
 }
 
 ClutterActor *
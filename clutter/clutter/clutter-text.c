@@ -83,7 +83,13 @@
  */
 #define N_CACHED_LAYOUTS        6
 
+/* Maximum number of layouts kept in the cache shared between all the
+ * non-editable #ClutterText actors
+ */
+#define N_SHARED_LAYOUTS        256
+
 typedef struct _LayoutCache     LayoutCache;
+typedef struct _SharedLayout    SharedLayout;
 
 struct _LayoutCache
 {
@@ -99,6 +105,34 @@ struct _LayoutCache
   guint age;
 };
 
+/* An entry in the shared layout cache. The fields are everything
+ * that clutter_text_create_layout_no_cache() sets on a layout, so two
+ * actors asking for a layout with the same values can use the same
+ * PangoLayout and with it the same glyph display list
+ */
+struct _SharedLayout
+{
+  gchar *text;
+  gsize text_len;
+  PangoFontDescription *font_desc;
+  PangoAttrList *attrs;
+  PangoDirection direction;
+  PangoAlignment alignment;
+  PangoWrapMode wrap_mode;
+  PangoEllipsizeMode ellipsize;
+  gint width;
+  gint height;
+  guint single_line_mode : 1;
+  guint justify          : 1;
+
+  guint hash;
+
+  PangoLayout *layout;
+
+  /* Link in the list of shared layouts, most recently used first */
+  GList link;
+};
+
 struct _ClutterTextInputFocus
 {
   ClutterInputFocus parent_instance;
@@ -121,6 +155,12 @@ struct _ClutterTextPrivate
   LayoutCache cached_layouts[N_CACHED_LAYOUTS];
   guint cache_age;
 
+  /* The copy of a shared layout returned by clutter_text_get_layout(),
+   * and the layout it was copied from
+   */
+  PangoLayout *public_layout;
+  PangoLayout *public_layout_source;
+
   /* These are the attributes set by the attributes property */
   PangoAttrList *attrs;
   /* These are the attributes derived from the text when the
@@ -211,6 +251,7 @@ struct _ClutterTextPrivate
   guint paint_volume_valid      : 1;
   guint show_password_hint      : 1;
   guint password_hint_visible   : 1;
+  guint uses_shared_layouts     : 1;
   guint resolved_direction      : 4;
 };
 
@@ -605,6 +646,63 @@ clutter_text_ensure_effective_attributes (ClutterText *self)
     }
 }
 
+static PangoDirection
+clutter_text_resolve_direction (ClutterText *text,
+                                const gchar *contents,
+                                gsize        contents_len)
+{
+  ClutterTextPrivate *priv = text->priv;
+  PangoDirection pango_dir;
+
+  if (priv->password_char != 0)
+    pango_dir = PANGO_DIRECTION_NEUTRAL;
+  else
+    pango_dir = pango_find_base_dir (contents, contents_len);
+
+  if (pango_dir == PANGO_DIRECTION_NEUTRAL)
+    {
+      ClutterBackend *backend = clutter_get_default_backend ();
+      ClutterTextDirection text_dir;
+
+      if (clutter_actor_has_key_focus (CLUTTER_ACTOR (text)))
+        pango_dir = _clutter_backend_get_keymap_direction (backend);
+      else
+        {
+          text_dir = clutter_actor_get_text_direction (CLUTTER_ACTOR (text));
+
+          if (text_dir == CLUTTER_TEXT_DIRECTION_RTL)
+            pango_dir = PANGO_DIRECTION_RTL;
+          else
+            pango_dir = PANGO_DIRECTION_LTR;
+       }
+    }
+
+  pango_context_set_base_dir (clutter_actor_get_pango_context (CLUTTER_ACTOR (text)), pango_dir);
+
+  priv->resolved_direction = pango_dir;
+
+  return pango_dir;
+}
+
+static void
+clutter_text_set_layout_properties (ClutterText       *text,
+                                    PangoLayout       *layout,
+                                    gint               width,
+                                    gint               height,
+                                    PangoEllipsizeMode ellipsize)
+{
+  ClutterTextPrivate *priv = text->priv;
+
+  pango_layout_set_alignment (layout, priv->alignment);
+  pango_layout_set_single_paragraph_mode (layout, priv->single_line_mode);
+  pango_layout_set_justify (layout, priv->justify);
+  pango_layout_set_wrap (layout, priv->wrap_mode);
+
+  pango_layout_set_ellipsize (layout, ellipsize);
+  pango_layout_set_width (layout, width);
+  pango_layout_set_height (layout, height);
+}
+
 static PangoLayout *
 clutter_text_create_layout_no_cache (ClutterText       *text,
 				     gint               width,
@@ -651,55 +749,348 @@ clutter_text_create_layout_no_cache (ClutterText       *text,
     }
   else
     {
-      PangoDirection pango_dir;
+      clutter_text_resolve_direction (text, contents, contents_len);
 
-      if (priv->password_char != 0)
-        pango_dir = PANGO_DIRECTION_NEUTRAL;
-      else
-        pango_dir = pango_find_base_dir (contents, contents_len);
+      pango_layout_set_text (layout, contents, contents_len);
+    }
+
+  /* This will merge the markup attributes and the attributes
+   * property if needed */
+  clutter_text_ensure_effective_attributes (text);
+
+  if (priv->effective_attrs != NULL)
+    pango_layout_set_attributes (layout, priv->effective_attrs);
+
+  clutter_text_set_layout_properties (text, layout, width, height, ellipsize);
+
+  g_free (contents);
+
+  return layout;
+}
+
+/* The shared layout cache. Labels, clocks and panels lay out the same
+ * strings over and over again while their size is negotiated and
+ * when they are recreated, so the layouts of non-editable actors are
+ * looked up by their contents in a cache shared by all of them. The
+ * layouts in it are created from a PangoContext owned by the cache,
+ * one for each base direction, so that they don't depend on the actor
+ * that created them
+ */
+static GHashTable *shared_layouts = NULL;
+static GQueue shared_layouts_lru = G_QUEUE_INIT;
+static PangoContext *shared_layout_contexts[2] = { NULL, NULL };
+static guint shared_layouts_users = 0;
+static gulong shared_layouts_resolution_changed_id = 0;
+static gulong shared_layouts_font_changed_id = 0;
+static guint shared_layout_hits = 0;
+static guint shared_layout_misses = 0;
 
-      if (pango_dir == PANGO_DIRECTION_NEUTRAL)
+static gboolean
+attr_lists_equal (PangoAttrList *a,
+                  PangoAttrList *b)
+{
+  PangoAttrIterator *iter_a, *iter_b;
+  gboolean equal = TRUE;
+
+  if (a == b)
+    return TRUE;
+
+  if (a == NULL || b == NULL)
+    return FALSE;
+
+  iter_a = pango_attr_list_get_iterator (a);
+  iter_b = pango_attr_list_get_iterator (b);
+
+  while (equal)
+    {
+      GSList *attrs_a, *attrs_b, *l_a, *l_b;
+      gint start_a, end_a, start_b, end_b;
+      gboolean more_a, more_b;
+
+      pango_attr_iterator_range (iter_a, &start_a, &end_a);
+      pango_attr_iterator_range (iter_b, &start_b, &end_b);
+
+      if (start_a != start_b || end_a != end_b)
         {
-          ClutterBackend *backend = clutter_get_default_backend ();
-          ClutterTextDirection text_dir;
+          equal = FALSE;
+          break;
+        }
 
-          if (clutter_actor_has_key_focus (CLUTTER_ACTOR (text)))
-            pango_dir = _clutter_backend_get_keymap_direction (backend);
-          else
-            {
-              text_dir = clutter_actor_get_text_direction (CLUTTER_ACTOR (text));
+      attrs_a = pango_attr_iterator_get_attrs (iter_a);
+      attrs_b = pango_attr_iterator_get_attrs (iter_b);
 
-              if (text_dir == CLUTTER_TEXT_DIRECTION_RTL)
-                pango_dir = PANGO_DIRECTION_RTL;
-              else
-                pango_dir = PANGO_DIRECTION_LTR;
-           }
+      for (l_a = attrs_a, l_b = attrs_b;
+           l_a != NULL && l_b != NULL;
+           l_a = l_a->next, l_b = l_b->next)
+        {
+          if (!pango_attribute_equal (l_a->data, l_b->data))
+            break;
         }
 
-      pango_context_set_base_dir (clutter_actor_get_pango_context (CLUTTER_ACTOR (text)), pango_dir);
+      if (l_a != NULL || l_b != NULL)
+        equal = FALSE;
 
-      priv->resolved_direction = pango_dir;
+      g_slist_free_full (attrs_a, (GDestroyNotify) pango_attribute_destroy);
+      g_slist_free_full (attrs_b, (GDestroyNotify) pango_attribute_destroy);
 
-      pango_layout_set_text (layout, contents, contents_len);
+      more_a = pango_attr_iterator_next (iter_a);
+      more_b = pango_attr_iterator_next (iter_b);
+
+      if (more_a != more_b)
+        equal = FALSE;
+      else if (!more_a)
+        break;
+    }
+
+  pango_attr_iterator_destroy (iter_a);
+  pango_attr_iterator_destroy (iter_b);
+
+  return equal;
+}
+
+static guint
+shared_layout_hash (gconstpointer key)
+{
+  const SharedLayout *entry = key;
+
+  return entry->hash;
+}
+
+static gboolean
+shared_layout_equal (gconstpointer a,
+                     gconstpointer b)
+{
+  const SharedLayout *entry_a = a;
+  const SharedLayout *entry_b = b;
+
+  return entry_a->hash == entry_b->hash &&
+         entry_a->text_len == entry_b->text_len &&
+         entry_a->direction == entry_b->direction &&
+         entry_a->alignment == entry_b->alignment &&
+         entry_a->wrap_mode == entry_b->wrap_mode &&
+         entry_a->ellipsize == entry_b->ellipsize &&
+         entry_a->width == entry_b->width &&
+         entry_a->height == entry_b->height &&
+         entry_a->single_line_mode == entry_b->single_line_mode &&
+         entry_a->justify == entry_b->justify &&
+         memcmp (entry_a->text, entry_b->text, entry_a->text_len) == 0 &&
+         pango_font_description_equal (entry_a->font_desc,
+                                       entry_b->font_desc) &&
+         attr_lists_equal (entry_a->attrs, entry_b->attrs);
+}
+
+static void
+shared_layout_free (SharedLayout *entry)
+{
+  g_queue_unlink (&shared_layouts_lru, &entry->link);
+
+  g_object_unref (entry->layout);
+  if (entry->attrs != NULL)
+    pango_attr_list_unref (entry->attrs);
+  pango_font_description_free (entry->font_desc);
+  g_free (entry->text);
+
+  g_slice_free (SharedLayout, entry);
+}
+
+static void
+clutter_text_flush_shared_layouts (ClutterBackend *backend)
+{
+  guint i;
+
+  CLUTTER_NOTE (ACTOR, "ClutterText: flushing %u shared layouts",
+                g_hash_table_size (shared_layouts));
+
+  /* Removing the entries also unlinks them from the list */
+  g_hash_table_remove_all (shared_layouts);
+
+  /* The contexts are recreated with the new font options and
+   * resolution the next time they are needed
+   */
+  for (i = 0; i < G_N_ELEMENTS (shared_layout_contexts); i++)
+    g_clear_object (&shared_layout_contexts[i]);
+}
+
+static PangoContext *
+clutter_text_get_shared_layout_context (ClutterText    *text,
+                                        PangoDirection  direction)
+{
+  int index = direction == PANGO_DIRECTION_RTL ? 1 : 0;
+
+  if (G_UNLIKELY (shared_layout_contexts[index] == NULL))
+    {
+      PangoContext *context;
+
+      context = clutter_actor_create_pango_context (CLUTTER_ACTOR (text));
+      pango_context_set_base_dir (context, direction);
+
+      shared_layout_contexts[index] = context;
+    }
+
+  return shared_layout_contexts[index];
+}
+
+/* Every #ClutterText that created a shared layout holds a reference
+ * on the cache, so that it is destroyed along with the last of them
+ */
+static void
+clutter_text_ref_shared_layouts (void)
+{
+  ClutterBackend *backend;
+
+  if (shared_layouts_users++ > 0)
+    return;
+
+  shared_layouts = g_hash_table_new_full (shared_layout_hash,
+                                          shared_layout_equal,
+                                          (GDestroyNotify) shared_layout_free,
+                                          NULL);
+
+  /* The shared contexts are not owned by an actor, so nothing else
+   * will update them when the font options change
+   */
+  backend = clutter_get_default_backend ();
+  shared_layouts_resolution_changed_id =
+    g_signal_connect (backend, "resolution-changed",
+                      G_CALLBACK (clutter_text_flush_shared_layouts), NULL);
+  shared_layouts_font_changed_id =
+    g_signal_connect (backend, "font-changed",
+                      G_CALLBACK (clutter_text_flush_shared_layouts), NULL);
+}
+
+static void
+clutter_text_unref_shared_layouts (void)
+{
+  ClutterBackend *backend;
+  guint i;
+
+  g_assert (shared_layouts_users > 0);
+
+  if (--shared_layouts_users > 0)
+    return;
+
+  backend = clutter_get_default_backend ();
+  g_signal_handler_disconnect (backend, shared_layouts_resolution_changed_id);
+  g_signal_handler_disconnect (backend, shared_layouts_font_changed_id);
+  shared_layouts_resolution_changed_id = 0;
+  shared_layouts_font_changed_id = 0;
+
+  g_clear_pointer (&shared_layouts, g_hash_table_destroy);
+
+  for (i = 0; i < G_N_ELEMENTS (shared_layout_contexts); i++)
+    g_clear_object (&shared_layout_contexts[i]);
+}
+
+/*
+ * clutter_text_create_shared_layout:
+ * @text: a non-editable #ClutterText
+ * @width: the width of the layout, in Pango units
+ * @height: the height of the layout, in Pango units
+ * @ellipsize: the ellipsization mode of the layout
+ *
+ * Like clutter_text_create_layout_no_cache(), but returns a layout
+ * from the shared layout cache if another #ClutterText already
+ * created one with the same contents and properties.
+ *
+ * Return value: (transfer full): a #PangoLayout that must not be
+ *   modified
+ */
+static PangoLayout *
+clutter_text_create_shared_layout (ClutterText       *text,
+                                   gint               width,
+                                   gint               height,
+                                   PangoEllipsizeMode ellipsize)
+{
+  ClutterTextPrivate *priv = text->priv;
+  SharedLayout key, *entry;
+  PangoLayout *layout;
+
+  if (!priv->uses_shared_layouts)
+    {
+      clutter_text_ref_shared_layouts ();
+      priv->uses_shared_layouts = TRUE;
     }
 
   /* This will merge the markup attributes and the attributes
    * property if needed */
   clutter_text_ensure_effective_attributes (text);
 
+  key.text = clutter_text_get_display_text (text);
+  key.text_len = strlen (key.text);
+  key.font_desc = priv->font_desc;
+  key.attrs = priv->effective_attrs;
+  key.direction = clutter_text_resolve_direction (text,
+                                                  key.text,
+                                                  key.text_len);
+  key.alignment = priv->alignment;
+  key.wrap_mode = priv->wrap_mode;
+  key.ellipsize = ellipsize;
+  key.width = width;
+  key.height = height;
+  key.single_line_mode = priv->single_line_mode;
+  key.justify = priv->justify;
+
+  key.hash = g_str_hash (key.text);
+  key.hash = key.hash * 31 + pango_font_description_hash (priv->font_desc);
+  key.hash = key.hash * 31 + width;
+  key.hash = key.hash * 31 + height;
+  key.hash = key.hash * 31 + ((ellipsize << 8) | (key.direction << 4) |
+                              (key.single_line_mode << 1) | key.justify);
+
+  entry = g_hash_table_lookup (shared_layouts, &key);
+  if (entry != NULL)
+    {
+      shared_layout_hits += 1;
+
+      CLUTTER_NOTE (ACTOR,
+                    "ClutterText: %p: shared layout hit (%u hits, %u misses)",
+                    text,
+                    shared_layout_hits,
+                    shared_layout_misses);
+
+      g_queue_unlink (&shared_layouts_lru, &entry->link);
+      g_queue_push_head_link (&shared_layouts_lru, &entry->link);
+
+      g_free (key.text);
+
+      return g_object_ref (entry->layout);
+    }
+
+  shared_layout_misses += 1;
+
+  CLUTTER_NOTE (ACTOR,
+                "ClutterText: %p: shared layout miss (%u hits, %u misses)",
+                text,
+                shared_layout_hits,
+                shared_layout_misses);
+
+  layout =
+    pango_layout_new (clutter_text_get_shared_layout_context (text,
+                                                              key.direction));
+  pango_layout_set_font_description (layout, priv->font_desc);
+  pango_layout_set_text (layout, key.text, key.text_len);
+
   if (priv->effective_attrs != NULL)
     pango_layout_set_attributes (layout, priv->effective_attrs);
 
-  pango_layout_set_alignment (layout, priv->alignment);
-  pango_layout_set_single_paragraph_mode (layout, priv->single_line_mode);
-  pango_layout_set_justify (layout, priv->justify);
-  pango_layout_set_wrap (layout, priv->wrap_mode);
+  clutter_text_set_layout_properties (text, layout, width, height, ellipsize);
 
-  pango_layout_set_ellipsize (layout, ellipsize);
-  pango_layout_set_width (layout, width);
-  pango_layout_set_height (layout, height);
+  entry = g_slice_dup (SharedLayout, &key);
+  entry->font_desc = pango_font_description_copy (priv->font_desc);
+  if (entry->attrs != NULL)
+    entry->attrs = pango_attr_list_copy (entry->attrs);
+  entry->layout = g_object_ref (layout);
+  entry->link.data = entry;
+  entry->link.prev = entry->link.next = NULL;
 
-  g_free (contents);
+  g_queue_push_head_link (&shared_layouts_lru, &entry->link);
+  g_hash_table_add (shared_layouts, entry);
+
+  /* Drop the least recently used layout; any actor still using it
+   * keeps its own reference
+   */
+  if (g_hash_table_size (shared_layouts) > N_SHARED_LAYOUTS)
+    g_hash_table_remove (shared_layouts, shared_layouts_lru.tail->data);
 
   return layout;
 }
@@ -719,6 +1110,9 @@ clutter_text_dirty_cache (ClutterText *text)
 	priv->cached_layouts[i].layout = NULL;
       }
 
+  g_clear_object (&priv->public_layout);
+  g_clear_object (&priv->public_layout_source);
+
   clutter_text_dirty_paint_volume (text);
 }
 
@@ -981,8 +1375,15 @@ clutter_text_create_layout (ClutterText *text,
   if (oldest_cache->layout)
     g_object_unref (oldest_cache->layout);
 
-  oldest_cache->layout =
-    clutter_text_create_layout_no_cache (text, width, height, ellipsize);
+  /* Editable actors change their contents and preedit string too
+   * often for it to be worth sharing their layouts
+   */
+  if (priv->editable)
+    oldest_cache->layout =
+      clutter_text_create_layout_no_cache (text, width, height, ellipsize);
+  else
+    oldest_cache->layout =
+      clutter_text_create_shared_layout (text, width, height, ellipsize);
 
   cogl_pango_ensure_glyph_cache_for_layout (oldest_cache->layout);
 
@@ -991,6 +1392,22 @@ clutter_text_create_layout (ClutterText *text,
   return oldest_cache->layout;
 }
 
+/* Like clutter_text_get_layout(), but returns the layout used to
+ * paint the actor, which may be shared with other actors
+ */
+static PangoLayout *
+clutter_text_get_current_layout (ClutterText *self)
+{
+  gfloat width, height;
+
+  if (self->priv->editable && self->priv->single_line_mode)
+    return clutter_text_create_layout (self, -1, -1);
+
+  clutter_actor_get_size (CLUTTER_ACTOR (self), &width, &height);
+
+  return clutter_text_create_layout (self, width, height);
+}
+
 /**
  * clutter_text_coords_to_position:
  * @self: a #ClutterText
@@ -1020,7 +1437,7 @@ clutter_text_coords_to_position (ClutterText *self,
   px = (x - self->priv->text_x) * PANGO_SCALE;
   py = (y - self->priv->text_y) * PANGO_SCALE;
 
-  pango_layout_xy_to_index (clutter_text_get_layout (self),
+  pango_layout_xy_to_index (clutter_text_get_current_layout (self),
                             px, py,
                             &index_, &trailing);
 
@@ -1106,7 +1523,7 @@ clutter_text_position_to_coords (ClutterText *self,
       g_string_free (tmp, TRUE);
     }
 
-  pango_layout_get_cursor_pos (clutter_text_get_layout (self),
+  pango_layout_get_cursor_pos (clutter_text_get_current_layout (self),
                                index_,
                                &rect, NULL);
 
@@ -1593,6 +2010,12 @@ clutter_text_dispose (GObject *gobject)
   /* get rid of the entire cache */
   clutter_text_dirty_cache (self);
 
+  if (priv->uses_shared_layouts)
+    {
+      clutter_text_unref_shared_layouts ();
+      priv->uses_shared_layouts = FALSE;
+    }
+
   if (priv->direction_changed_id)
     {
       g_signal_handler_disconnect (self, priv->direction_changed_id);
@@ -1655,7 +2078,7 @@ clutter_text_foreach_selection_rectangle (ClutterText              *self,
                                           gpointer                  user_data)
 {
   ClutterTextPrivate *priv = self->priv;
-  PangoLayout *layout = clutter_text_get_layout (self);
+  PangoLayout *layout = clutter_text_get_current_layout (self);
   gchar *utf8 = clutter_text_get_display_text (self);
   gint lines;
   gint start_index;
@@ -1777,7 +2200,7 @@ selection_paint (ClutterText *self)
   else
     {
       /* Paint selection background first */
-      PangoLayout *layout = clutter_text_get_layout (self);
+      PangoLayout *layout = clutter_text_get_current_layout (self);
       CoglPath *selection_path = cogl_path_new ();
       CoglColor cogl_color = { 0, };
       CoglFramebuffer *fb;
@@ -1834,7 +2257,7 @@ clutter_text_move_word_backward (ClutterText *self,
 
   if (clutter_text_buffer_get_length (get_buffer (self)) > 0 && start > 0)
     {
-      PangoLayout *layout = clutter_text_get_layout (self);
+      PangoLayout *layout = clutter_text_get_current_layout (self);
       PangoLogAttr *log_attrs = NULL;
       gint n_attrs = 0;
 
@@ -1860,7 +2283,7 @@ clutter_text_move_word_forward (ClutterText *self,
   n_chars = clutter_text_buffer_get_length (get_buffer (self));
   if (n_chars > 0 && start < n_chars)
     {
-      PangoLayout *layout = clutter_text_get_layout (self);
+      PangoLayout *layout = clutter_text_get_current_layout (self);
       PangoLogAttr *log_attrs = NULL;
       gint n_attrs = 0;
 
@@ -1887,7 +2310,7 @@ clutter_text_move_line_start (ClutterText *self,
   gint position;
   const gchar *text;
 
-  layout = clutter_text_get_layout (self);
+  layout = clutter_text_get_current_layout (self);
   text = clutter_text_buffer_get_text (get_buffer (self));
 
   if (start == 0)
@@ -1923,7 +2346,7 @@ clutter_text_move_line_end (ClutterText *self,
   gint position;
   const gchar *text;
 
-  layout = clutter_text_get_layout (self);
+  layout = clutter_text_get_current_layout (self);
   text = clutter_text_buffer_get_text (get_buffer (self));
 
   if (start == 0)
@@ -2643,7 +3066,7 @@ clutter_text_get_paint_volume (ClutterActor       *self,
 
       _clutter_paint_volume_init_static (&priv->paint_volume, self);
 
-      layout = clutter_text_get_layout (text);
+      layout = clutter_text_get_current_layout (text);
       pango_layout_get_extents (layout, &ink_rect, NULL);
 
       origin.x = ink_rect.x / (float) PANGO_SCALE;
@@ -2955,7 +3378,7 @@ clutter_text_real_move_up (ClutterText         *self,
   gint x;
   const gchar *text;
 
-  layout = clutter_text_get_layout (self);
+  layout = clutter_text_get_current_layout (self);
   text = clutter_text_buffer_get_text (get_buffer (self));
 
   if (priv->position == 0)
@@ -3012,7 +3435,7 @@ clutter_text_real_move_down (ClutterText         *self,
   gint pos;
   const gchar *text;
 
-  layout = clutter_text_get_layout (self);
+  layout = clutter_text_get_current_layout (self);
   text = clutter_text_buffer_get_text (get_buffer (self));
 
   if (priv->position == 0)
@@ -4690,6 +5113,15 @@ clutter_text_set_editable (ClutterText *self,
     {
       priv->editable = editable;
 
+      /* Editable actors don't use the shared layouts and ignore the
+       * markup attributes and the ellipsization mode */
+      if (priv->effective_attrs)
+        {
+          pango_attr_list_unref (priv->effective_attrs);
+          priv->effective_attrs = NULL;
+        }
+      clutter_text_dirty_cache (self);
+
       if (method)
         {
           if (!priv->editable && clutter_input_focus_is_focused (priv->input_focus))
@@ -5471,6 +5903,11 @@ clutter_text_set_markup (ClutterText *self,
  *
  * Retrieves the current #PangoLayout used by a #ClutterText actor.
  *
+ * Non-editable actors showing the same text share their layouts, so
+ * for those this returns a copy of the layout that is private to
+ * @self. Changes to it are not painted, and it is replaced whenever
+ * the contents or the size of the actor change.
+ *
  * Return value: (transfer none): a #PangoLayout. The returned object is owned by
  *   the #ClutterText actor and should not be modified or freed
  *
@@ -5479,16 +5916,25 @@ clutter_text_set_markup (ClutterText *self,
 PangoLayout *
 clutter_text_get_layout (ClutterText *self)
 {
-  gfloat width, height;
+  ClutterTextPrivate *priv;
+  PangoLayout *layout;
 
   g_return_val_if_fail (CLUTTER_IS_TEXT (self), NULL);
 
-  if (self->priv->editable && self->priv->single_line_mode)
-    return clutter_text_create_layout (self, -1, -1);
+  priv = self->priv;
 
-  clutter_actor_get_size (CLUTTER_ACTOR (self), &width, &height);
+  layout = clutter_text_get_current_layout (self);
+  if (priv->editable)
+    return layout;
 
-  return clutter_text_create_layout (self, width, height);
+  if (priv->public_layout_source != layout)
+    {
+      g_clear_object (&priv->public_layout);
+      g_set_object (&priv->public_layout_source, layout);
+      priv->public_layout = pango_layout_copy (layout);
+    }
+
+  return priv->public_layout;
 }
 
 /**
@@ -45,6 +45,7 @@
 #include "clutter-event.h"
 #include "clutter-enum-types.h"
 #include "clutter-feature.h"
+#include "clutter-frame-timings-private.h"
 #include "clutter-main.h"
 #include "clutter-private.h"
 #include "clutter-stage-private.h"
@@ -56,10 +57,25 @@ typedef struct _ClutterStageViewCoglPrivate
    */
 #define DAMAGE_HISTORY_MAX 16
 #define DAMAGE_HISTORY(x) ((x) & (DAMAGE_HISTORY_MAX - 1))
-  cairo_rectangle_int_t damage_history[DAMAGE_HISTORY_MAX];
+  cairo_region_t *damage_history[DAMAGE_HISTORY_MAX];
   unsigned int damage_index;
+
+  /*
+   * Frame scheduling state of the view, used instead of the one of the
+   * stage when the backend reports presentation per view.
+   */
+  float refresh_rate;
+  int pending_swaps;
+  gint64 last_swap_time;
+  gint64 last_presentation_time;
+  gint64 update_time;
 } ClutterStageViewCoglPrivate;
 
+/* A swap that hasn't completed after this long is assumed to be lost,
+ * for example because the output was turned off while it was pending,
+ * so that it doesn't keep the view from being painted forever. */
+#define PENDING_SWAP_TIMEOUT_US (G_USEC_PER_SEC / 2)
+
 G_DEFINE_TYPE_WITH_PRIVATE (ClutterStageViewCogl, clutter_stage_view_cogl,
                             CLUTTER_TYPE_STAGE_VIEW)
 
@@ -78,6 +94,14 @@ enum {
   PROP_LAST
 };
 
+/* Every damage rectangle is painted in a separate pass over the scene
+ * graph, so once a region gets too fragmented, or its rectangles cover
+ * most of their bounding box anyway, a single pass over the extents is
+ * cheaper.
+ */
+#define MAX_CLIPPED_PAINT_RECTS 8
+#define MIN_CLIPPED_PAINT_COVERAGE 0.75
+
 static void
 clutter_stage_cogl_unrealize (ClutterStageWindow *stage_window)
 {
@@ -117,6 +141,9 @@ _clutter_stage_cogl_presented (ClutterStageCogl *stage_cogl,
 
           stage_cogl->last_presentation_time =
             now + (presentation_time_cogl - current_time_cogl) / 1000;
+
+          _clutter_frame_timings_presented (frame_info->frame_counter,
+                                            stage_cogl->last_presentation_time);
         }
 
       stage_cogl->refresh_rate = frame_info->refresh_rate;
@@ -125,6 +152,49 @@ _clutter_stage_cogl_presented (ClutterStageCogl *stage_cogl,
   _clutter_stage_presented (stage_cogl->wrapper, frame_event, frame_info);
 }
 
+/*
+ * Called by backends that receive frame events for each view separately,
+ * which lets every view be scheduled at the refresh rate of the output it
+ * is presented on. The stage wide _clutter_stage_cogl_presented() still
+ * has to be called once per frame for the frame timings and the
+ * ClutterStage::presented signal.
+ */
+void
+_clutter_stage_cogl_view_presented (ClutterStageCogl *stage_cogl,
+                                    ClutterStageView *view,
+                                    CoglFrameEvent    frame_event,
+                                    ClutterFrameInfo *frame_info)
+{
+  ClutterStageViewCogl *view_cogl = CLUTTER_STAGE_VIEW_COGL (view);
+  ClutterStageViewCoglPrivate *view_priv =
+    clutter_stage_view_cogl_get_instance_private (view_cogl);
+
+  stage_cogl->uses_view_frame_clocks = TRUE;
+
+  if (frame_event == COGL_FRAME_EVENT_SYNC)
+    {
+      if (view_priv->pending_swaps > 0)
+        view_priv->pending_swaps--;
+    }
+  else if (frame_event == COGL_FRAME_EVENT_COMPLETE)
+    {
+      gint64 presentation_time_cogl = frame_info->presentation_time;
+
+      if (presentation_time_cogl != 0)
+        {
+          ClutterBackend *backend = stage_cogl->backend;
+          CoglContext *context = clutter_backend_get_cogl_context (backend);
+          gint64 current_time_cogl = cogl_get_clock_time (context);
+          gint64 now = g_get_monotonic_time ();
+
+          view_priv->last_presentation_time =
+            now + (presentation_time_cogl - current_time_cogl) / 1000;
+        }
+
+      view_priv->refresh_rate = frame_info->refresh_rate;
+    }
+}
+
 static gboolean
 clutter_stage_cogl_realize (ClutterStageWindow *stage_window)
 {
@@ -145,39 +215,27 @@ clutter_stage_cogl_realize (ClutterStageWindow *stage_window)
   return TRUE;
 }
 
-static void
-clutter_stage_cogl_schedule_update (ClutterStageWindow *stage_window,
-                                    gint                sync_delay)
+static gint64
+compute_update_time (gint64 last_presentation_time,
+                     float  refresh_rate,
+                     gint   sync_delay,
+                     gint64 now)
 {
-  ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
-  gint64 now;
-  float refresh_rate;
   gint64 refresh_interval;
-
-  if (stage_cogl->update_time != -1)
-    return;
-
-  now = g_get_monotonic_time ();
+  gint64 update_time;
 
   if (sync_delay < 0)
-    {
-      stage_cogl->update_time = now;
-      return;
-    }
+    return now;
 
   /* We only extrapolate presentation times for 150ms  - this is somewhat
    * arbitrary. The reasons it might not be accurate for larger times are
    * that the refresh interval might be wrong or the vertical refresh
    * might be downclocked if nothing is going on onscreen.
    */
-  if (stage_cogl->last_presentation_time == 0||
-      stage_cogl->last_presentation_time < now - 150000)
-    {
-      stage_cogl->update_time = now;
-      return;
-    }
+  if (last_presentation_time == 0||
+      last_presentation_time < now - 150000)
+    return now;
 
-  refresh_rate = stage_cogl->refresh_rate;
   if (refresh_rate == 0.0)
     refresh_rate = 60.0;
 
@@ -185,10 +243,159 @@ clutter_stage_cogl_schedule_update (ClutterStageWindow *stage_window,
   if (refresh_interval == 0)
     refresh_interval = 16667; /* 1/60th second */
 
-  stage_cogl->update_time = stage_cogl->last_presentation_time + 1000 * sync_delay;
+  update_time = last_presentation_time + 1000 * sync_delay;
 
-  while (stage_cogl->update_time < now)
-    stage_cogl->update_time += refresh_interval;
+  while (update_time < now)
+    update_time += refresh_interval;
+
+  return update_time;
+}
+
+/* Whether @view is still waiting for a swap to complete. Swaps that
+ * timed out are forgotten. */
+static gboolean
+view_has_pending_swaps (ClutterStageView *view,
+                        gint64            now)
+{
+  ClutterStageViewCogl *view_cogl = CLUTTER_STAGE_VIEW_COGL (view);
+  ClutterStageViewCoglPrivate *view_priv =
+    clutter_stage_view_cogl_get_instance_private (view_cogl);
+
+  if (view_priv->pending_swaps == 0)
+    return FALSE;
+
+  if (now - view_priv->last_swap_time < PENDING_SWAP_TIMEOUT_US)
+    return TRUE;
+
+  CLUTTER_NOTE (BACKEND,
+                "View %p: %d swaps didn't complete within %d ms, "
+                "ignoring them",
+                view, view_priv->pending_swaps,
+                (int) (PENDING_SWAP_TIMEOUT_US / 1000));
+
+  view_priv->pending_swaps = 0;
+  return FALSE;
+}
+
+/* Whether the redraw clip of the stage covers part of @view */
+static gboolean
+view_has_damage (ClutterStageCogl *stage_cogl,
+                 ClutterStageView *view)
+{
+  cairo_rectangle_int_t view_rect;
+
+  /* NB: a NULL redraw clip == full stage redraw */
+  if (stage_cogl->redraw_clip == NULL)
+    return TRUE;
+
+  clutter_stage_view_get_layout (view, &view_rect);
+
+  return (cairo_region_contains_rectangle (stage_cogl->redraw_clip,
+                                           &view_rect) !=
+          CAIRO_REGION_OVERLAP_OUT);
+}
+
+/* Returns the earliest update time of the views that aren't waiting for
+ * a swap to complete and have something to paint, or -1 if there is
+ * none.
+ *
+ * A view that has been idle for a while is always due right away, so
+ * idle views without damage are only considered when no other view is
+ * throttled by a pending swap; otherwise they would keep the master
+ * clock ticking without ever painting anything until the swap completes.
+ * If nothing else is due, the stage is updated again when the oldest
+ * pending swap times out.
+ */
+static gint64
+get_next_view_update_time (ClutterStageWindow *stage_window)
+{
+  ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
+  gint64 min_update_time = -1;
+  gint64 min_idle_update_time = -1;
+  gint64 min_swap_timeout = -1;
+  gboolean has_pending_swaps = FALSE;
+  gint64 now;
+  GList *l;
+
+  now = g_get_monotonic_time ();
+
+  for (l = _clutter_stage_window_get_views (stage_window); l; l = l->next)
+    {
+      ClutterStageView *view = l->data;
+      ClutterStageViewCogl *view_cogl = CLUTTER_STAGE_VIEW_COGL (view);
+      ClutterStageViewCoglPrivate *view_priv =
+        clutter_stage_view_cogl_get_instance_private (view_cogl);
+
+      if (view_has_pending_swaps (view, now))
+        {
+          gint64 swap_timeout =
+            view_priv->last_swap_time + PENDING_SWAP_TIMEOUT_US;
+
+          if (min_swap_timeout == -1 || swap_timeout < min_swap_timeout)
+            min_swap_timeout = swap_timeout;
+
+          has_pending_swaps = TRUE;
+          continue;
+        }
+
+      if (view_priv->update_time == -1)
+        continue;
+
+      if (!view_has_damage (stage_cogl, view))
+        {
+          if (min_idle_update_time == -1 ||
+              view_priv->update_time < min_idle_update_time)
+            min_idle_update_time = view_priv->update_time;
+          continue;
+        }
+
+      if (min_update_time == -1 || view_priv->update_time < min_update_time)
+        min_update_time = view_priv->update_time;
+    }
+
+  if (min_update_time == -1 && !has_pending_swaps)
+    return min_idle_update_time;
+
+  if (min_update_time == -1)
+    return min_swap_timeout;
+
+  return min_update_time;
+}
+
+static void
+clutter_stage_cogl_schedule_update (ClutterStageWindow *stage_window,
+                                    gint                sync_delay)
+{
+  ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
+  gint64 now;
+  GList *l;
+
+  if (stage_cogl->update_time != -1)
+    return;
+
+  now = g_get_monotonic_time ();
+
+  stage_cogl->update_time =
+    compute_update_time (stage_cogl->last_presentation_time,
+                         stage_cogl->refresh_rate,
+                         sync_delay,
+                         now);
+
+  if (!stage_cogl->uses_view_frame_clocks)
+    return;
+
+  for (l = _clutter_stage_window_get_views (stage_window); l; l = l->next)
+    {
+      ClutterStageViewCogl *view_cogl = l->data;
+      ClutterStageViewCoglPrivate *view_priv =
+        clutter_stage_view_cogl_get_instance_private (view_cogl);
+
+      view_priv->update_time =
+        compute_update_time (view_priv->last_presentation_time,
+                             view_priv->refresh_rate,
+                             sync_delay,
+                             now);
+    }
 }
 
 static gint64
@@ -196,6 +403,12 @@ clutter_stage_cogl_get_update_time (ClutterStageWindow *stage_window)
 {
   ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
 
+  /* With a clock per view the stage is ready as soon as any of its views
+   * is, and only the views that are due get painted */
+  if (stage_cogl->uses_view_frame_clocks &&
+      stage_cogl->update_time != -1)
+    return get_next_view_update_time (stage_window);
+
   if (stage_cogl->pending_swaps)
     return -1; /* in the future, indefinite */
 
@@ -206,8 +419,29 @@ static void
 clutter_stage_cogl_clear_update_time (ClutterStageWindow *stage_window)
 {
   ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
+  GList *l;
 
   stage_cogl->update_time = -1;
+
+  if (!stage_cogl->uses_view_frame_clocks)
+    return;
+
+  for (l = _clutter_stage_window_get_views (stage_window); l; l = l->next)
+    {
+      ClutterStageViewCogl *view_cogl = l->data;
+      ClutterStageViewCoglPrivate *view_priv =
+        clutter_stage_view_cogl_get_instance_private (view_cogl);
+
+      view_priv->update_time = -1;
+    }
+}
+
+static gboolean
+clutter_stage_cogl_has_deferred_redraws (ClutterStageWindow *stage_window)
+{
+  ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
+
+  return stage_cogl->has_deferred_redraws;
 }
 
 static ClutterActor *
@@ -249,12 +483,12 @@ clutter_stage_cogl_has_redraw_clips (ClutterStageWindow *stage_window)
    * clips everything (i.e. nothing would be drawn) so we need to make
    * sure we return True in the un-initialized case here.
    *
-   * NB: a clip width of 0 means a full stage redraw has been queued
+   * NB: a NULL redraw clip means a full stage redraw has been queued
    * so we effectively don't have any redraw clips in that case.
    */
   if (!stage_cogl->initialized_redraw_clip ||
       (stage_cogl->initialized_redraw_clip &&
-       stage_cogl->bounding_redraw_clip.width != 0))
+       stage_cogl->redraw_clip != NULL))
     return TRUE;
   else
     return FALSE;
@@ -265,9 +499,9 @@ clutter_stage_cogl_ignoring_redraw_clips (ClutterStageWindow *stage_window)
 {
   ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
 
-  /* NB: a clip width of 0 means a full stage redraw is required */
+  /* NB: a NULL redraw clip means a full stage redraw is required */
   if (stage_cogl->initialized_redraw_clip &&
-      stage_cogl->bounding_redraw_clip.width == 0)
+      stage_cogl->redraw_clip == NULL)
     return TRUE;
   else
     return FALSE;
@@ -282,10 +516,10 @@ clutter_stage_cogl_ignoring_redraw_clips (ClutterStageWindow *stage_window)
  * A NULL stage_clip means the whole stage needs to be redrawn.
  *
  * What we do with this information:
- * - we keep track of the bounding box for all redraw clips
- * - when we come to redraw; we scissor the redraw to that box and use
- *   glBlitFramebuffer to present the redraw to the front
- *   buffer.
+ * - we keep track of the union of all redraw clips as a region
+ * - when we come to redraw; we scissor the redraw to the rectangles
+ *   of that region and use glBlitFramebuffer or the swap damage to
+ *   present the redraw to the front buffer.
  */
 static void
 clutter_stage_cogl_add_redraw_clip (ClutterStageWindow    *stage_window,
@@ -298,11 +532,10 @@ clutter_stage_cogl_add_redraw_clip (ClutterStageWindow    *stage_window,
     return;
 
   /* A NULL stage clip means a full stage redraw has been queued and
-   * we keep track of this by setting a zero width
-   * stage_cogl->bounding_redraw_clip */
+   * we keep track of this by dropping the redraw clip region */
   if (stage_clip == NULL)
     {
-      stage_cogl->bounding_redraw_clip.width = 0;
+      g_clear_pointer (&stage_cogl->redraw_clip, cairo_region_destroy);
       stage_cogl->initialized_redraw_clip = TRUE;
       return;
     }
@@ -313,13 +546,12 @@ clutter_stage_cogl_add_redraw_clip (ClutterStageWindow    *stage_window,
 
   if (!stage_cogl->initialized_redraw_clip)
     {
-      stage_cogl->bounding_redraw_clip = *stage_clip;
+      g_clear_pointer (&stage_cogl->redraw_clip, cairo_region_destroy);
+      stage_cogl->redraw_clip = cairo_region_create_rectangle (stage_clip);
     }
-  else if (stage_cogl->bounding_redraw_clip.width > 0)
+  else
     {
-      _clutter_util_rectangle_union (&stage_cogl->bounding_redraw_clip,
-                                     stage_clip,
-                                     &stage_cogl->bounding_redraw_clip);
+      cairo_region_union_rectangle (stage_cogl->redraw_clip, stage_clip);
     }
 
   stage_cogl->initialized_redraw_clip = TRUE;
@@ -355,52 +587,55 @@ valid_buffer_age (ClutterStageViewCogl *view_cogl,
 }
 
 static gboolean
-swap_framebuffer (ClutterStageWindow    *stage_window,
-                  ClutterStageView      *view,
-                  cairo_rectangle_int_t *swap_region,
-                  gboolean               swap_with_damage)
+swap_framebuffer (ClutterStageWindow *stage_window,
+                  ClutterStageView   *view,
+                  cairo_region_t     *swap_region,
+                  gboolean            swap_with_damage)
 {
   CoglFramebuffer *framebuffer = clutter_stage_view_get_onscreen (view);
-  int damage[4], ndamage;
+  int *damage, n_rects, i;
+  gboolean swap_event;
 
-  damage[0] = swap_region->x;
-  damage[1] = swap_region->y;
-  damage[2] = swap_region->width;
-  damage[3] = swap_region->height;
+  n_rects = cairo_region_num_rectangles (swap_region);
+  damage = g_newa (int, n_rects * 4);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
 
-  if (swap_region->width != 0)
-    ndamage = 1;
-  else
-    ndamage = 0;
+      cairo_region_get_rectangle (swap_region, i, &rect);
+      damage[i * 4] = rect.x;
+      damage[i * 4 + 1] = rect.y;
+      damage[i * 4 + 2] = rect.width;
+      damage[i * 4 + 3] = rect.height;
+    }
 
   if (cogl_is_onscreen (framebuffer))
     {
       CoglOnscreen *onscreen = COGL_ONSCREEN (framebuffer);
 
       /* push on the screen */
-      if (ndamage == 1 && !swap_with_damage)
+      if (n_rects > 0 && !swap_with_damage)
         {
           CLUTTER_NOTE (BACKEND,
                         "cogl_onscreen_swap_region (onscreen: %p, "
-                        "x: %d, y: %d, "
-                        "width: %d, height: %d)",
-                        onscreen,
-                        damage[0], damage[1], damage[2], damage[3]);
+                        "n_rects: %d)",
+                        onscreen, n_rects);
 
           cogl_onscreen_swap_region (onscreen,
-                                     damage, ndamage);
+                                     damage, n_rects);
 
-          return FALSE;
+          swap_event = FALSE;
         }
       else
         {
-          CLUTTER_NOTE (BACKEND, "cogl_onscreen_swap_buffers (onscreen: %p)",
-                        onscreen);
+          CLUTTER_NOTE (BACKEND, "cogl_onscreen_swap_buffers (onscreen: %p, "
+                        "n_rects: %d)",
+                        onscreen, n_rects);
 
           cogl_onscreen_swap_buffers_with_damage (onscreen,
-                                                  damage, ndamage);
+                                                  damage, n_rects);
 
-          return TRUE;
+          swap_event = TRUE;
         }
     }
   else
@@ -409,8 +644,10 @@ swap_framebuffer (ClutterStageWindow    *stage_window,
                     framebuffer);
       cogl_framebuffer_finish (framebuffer);
 
-      return FALSE;
+      swap_event = FALSE;
     }
+
+  return swap_event;
 }
 
 static void
@@ -420,6 +657,8 @@ paint_stage (ClutterStageCogl            *stage_cogl,
 {
   ClutterStage *stage = stage_cogl->wrapper;
 
+  clutter_frame_timings_begin_phase (CLUTTER_FRAME_PHASE_PAINT);
+
   _clutter_stage_maybe_setup_viewport (stage, view);
   _clutter_stage_paint_view (stage, view, clip);
 
@@ -428,66 +667,92 @@ paint_stage (ClutterStageCogl            *stage_cogl,
     {
       clutter_stage_view_blit_offscreen (view, clip);
     }
+
+  clutter_frame_timings_end_phase (CLUTTER_FRAME_PHASE_PAINT);
 }
 
 static void
-fill_current_damage_history_and_step (ClutterStageView *view)
+record_damage_history (ClutterStageView *view,
+                       cairo_region_t   *fb_damage)
 {
   ClutterStageViewCogl *view_cogl = CLUTTER_STAGE_VIEW_COGL (view);
   ClutterStageViewCoglPrivate *view_priv =
     clutter_stage_view_cogl_get_instance_private (view_cogl);
-  cairo_rectangle_int_t view_rect;
-  float fb_scale;
-  cairo_rectangle_int_t *current_fb_damage;
+  cairo_region_t **current_fb_damage;
 
   current_fb_damage =
     &view_priv->damage_history[DAMAGE_HISTORY (view_priv->damage_index)];
+  g_clear_pointer (current_fb_damage, cairo_region_destroy);
+  *current_fb_damage = fb_damage;
+  view_priv->damage_index++;
+}
+
+static void
+fill_current_damage_history_and_step (ClutterStageView *view)
+{
+  cairo_rectangle_int_t view_rect;
+  float fb_scale;
+
   clutter_stage_view_get_layout (view, &view_rect);
   fb_scale = clutter_stage_view_get_scale (view);
 
-  *current_fb_damage = (cairo_rectangle_int_t) {
-    .x = 0,
-    .y = 0,
-    .width = view_rect.width * fb_scale,
-    .height = view_rect.height * fb_scale
-  };
-  view_priv->damage_index++;
+  record_damage_history (view,
+                         cairo_region_create_rectangle (&(cairo_rectangle_int_t) {
+                           .x = 0,
+                           .y = 0,
+                           .width = view_rect.width * fb_scale,
+                           .height = view_rect.height * fb_scale
+                         }));
 }
 
-static void
-transform_swap_region_to_onscreen (ClutterStageView      *view,
-                                   cairo_rectangle_int_t *swap_region)
+static cairo_region_t *
+transform_swap_region_to_onscreen (ClutterStageView *view,
+                                   cairo_region_t   *swap_region)
 {
   CoglFramebuffer *framebuffer;
   cairo_rectangle_int_t layout;
-  gfloat x1, y1, x2, y2;
+  cairo_region_t *transformed_region;
   gint width, height;
+  int n_rects, i;
 
   framebuffer = clutter_stage_view_get_onscreen (view);
   clutter_stage_view_get_layout (view, &layout);
 
-  x1 = (float) swap_region->x / layout.width;
-  y1 = (float) swap_region->y / layout.height;
-  x2 = (float) (swap_region->x + swap_region->width) / layout.width;
-  y2 = (float) (swap_region->y + swap_region->height) / layout.height;
-
-  clutter_stage_view_transform_to_onscreen (view, &x1, &y1);
-  clutter_stage_view_transform_to_onscreen (view, &x2, &y2);
-
   width = cogl_framebuffer_get_width (framebuffer);
   height = cogl_framebuffer_get_height (framebuffer);
 
-  x1 = floor (x1 * width);
-  y1 = floor (height - (y1 * height));
-  x2 = ceil (x2 * width);
-  y2 = ceil (height - (y2 * height));
+  transformed_region = cairo_region_create ();
+  n_rects = cairo_region_num_rectangles (swap_region);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+      gfloat x1, y1, x2, y2;
+
+      cairo_region_get_rectangle (swap_region, i, &rect);
+
+      x1 = (float) rect.x / layout.width;
+      y1 = (float) rect.y / layout.height;
+      x2 = (float) (rect.x + rect.width) / layout.width;
+      y2 = (float) (rect.y + rect.height) / layout.height;
+
+      clutter_stage_view_transform_to_onscreen (view, &x1, &y1);
+      clutter_stage_view_transform_to_onscreen (view, &x2, &y2);
+
+      x1 = floor (x1 * width);
+      y1 = floor (height - (y1 * height));
+      x2 = ceil (x2 * width);
+      y2 = ceil (height - (y2 * height));
+
+      cairo_region_union_rectangle (transformed_region,
+                                    &(cairo_rectangle_int_t) {
+                                      .x = MIN (x1, x2),
+                                      .y = MIN (y1, y2),
+                                      .width = ABS (x2 - x1),
+                                      .height = ABS (y2 - y1)
+                                    });
+    }
 
-  *swap_region = (cairo_rectangle_int_t) {
-    .x = x1,
-    .y = y1,
-    .width = x2 - x1,
-    .height = y2 - y1
-  };
+  return transformed_region;
 }
 
 static void
@@ -524,6 +789,140 @@ calculate_scissor_region (cairo_rectangle_int_t *fb_clip_region,
   };
 }
 
+static cairo_region_t *
+stage_region_to_fb_region (const cairo_region_t        *stage_region,
+                           const cairo_rectangle_int_t *view_rect,
+                           float                        fb_scale,
+                           int                          subpixel_compensation)
+{
+  cairo_region_t *fb_region;
+  int n_rects, i;
+
+  fb_region = cairo_region_create ();
+  n_rects = cairo_region_num_rectangles (stage_region);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (stage_region, i, &rect);
+      cairo_region_union_rectangle (fb_region,
+                                    &(cairo_rectangle_int_t) {
+                                      .x = (floorf ((rect.x - view_rect->x) * fb_scale) -
+                                            subpixel_compensation),
+                                      .y = (floorf ((rect.y - view_rect->y) * fb_scale) -
+                                            subpixel_compensation),
+                                      .width = (ceilf (rect.width * fb_scale) +
+                                                (2 * subpixel_compensation)),
+                                      .height = (ceilf (rect.height * fb_scale) +
+                                                 (2 * subpixel_compensation))
+                                    });
+    }
+
+  return fb_region;
+}
+
+static void
+fb_rect_to_stage_rect (const cairo_rectangle_int_t *fb_rect,
+                       const cairo_rectangle_int_t *view_rect,
+                       float                        fb_scale,
+                       cairo_rectangle_int_t       *stage_rect)
+{
+  *stage_rect = (cairo_rectangle_int_t) {
+    .x = view_rect->x + floorf (fb_rect->x / fb_scale),
+    .y = view_rect->y + floorf (fb_rect->y / fb_scale),
+    .width = ceilf (fb_rect->width / fb_scale),
+    .height = ceilf (fb_rect->height / fb_scale)
+  };
+}
+
+/* Decides which framebuffer rectangles to paint the stage through when
+ * repairing @fb_clip_region; see MAX_CLIPPED_PAINT_RECTS.
+ */
+static cairo_region_t *
+get_fb_paint_region (cairo_region_t *fb_clip_region)
+{
+  cairo_rectangle_int_t extents;
+  int n_rects, i;
+  double extents_area, region_area;
+
+  n_rects = cairo_region_num_rectangles (fb_clip_region);
+  if (n_rects <= 1)
+    return cairo_region_copy (fb_clip_region);
+
+  cairo_region_get_extents (fb_clip_region, &extents);
+
+  if (n_rects > MAX_CLIPPED_PAINT_RECTS)
+    return cairo_region_create_rectangle (&extents);
+
+  region_area = 0.0;
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (fb_clip_region, i, &rect);
+      region_area += (double) rect.width * rect.height;
+    }
+
+  extents_area = (double) extents.width * extents.height;
+  if (region_area >= extents_area * MIN_CLIPPED_PAINT_COVERAGE)
+    return cairo_region_create_rectangle (&extents);
+
+  return cairo_region_copy (fb_clip_region);
+}
+
+static void
+paint_stage_clipped (ClutterStageCogl            *stage_cogl,
+                     ClutterStageView            *view,
+                     cairo_region_t              *fb_clip_region,
+                     const cairo_rectangle_int_t *view_rect,
+                     float                        fb_scale,
+                     int                          subpixel_compensation)
+{
+  CoglFramebuffer *fb = clutter_stage_view_get_framebuffer (view);
+  cairo_region_t *fb_paint_region;
+  int fb_width, fb_height;
+  int n_rects, i;
+
+  fb_width = cogl_framebuffer_get_width (fb);
+  fb_height = cogl_framebuffer_get_height (fb);
+
+  fb_paint_region = get_fb_paint_region (fb_clip_region);
+  n_rects = cairo_region_num_rectangles (fb_paint_region);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t fb_rect;
+      cairo_rectangle_int_t scissor_rect;
+      cairo_rectangle_int_t stage_rect;
+
+      cairo_region_get_rectangle (fb_paint_region, i, &fb_rect);
+
+      calculate_scissor_region (&fb_rect,
+                                subpixel_compensation,
+                                fb_width, fb_height,
+                                &scissor_rect);
+
+      CLUTTER_NOTE (CLIPPING,
+                    "Stage clip pushed: x=%d, y=%d, width=%d, height=%d\n",
+                    scissor_rect.x,
+                    scissor_rect.y,
+                    scissor_rect.width,
+                    scissor_rect.height);
+
+      fb_rect_to_stage_rect (&fb_rect, view_rect, fb_scale, &stage_rect);
+      stage_cogl->bounding_redraw_clip = stage_rect;
+
+      cogl_framebuffer_push_scissor_clip (fb,
+                                          scissor_rect.x,
+                                          scissor_rect.y,
+                                          scissor_rect.width,
+                                          scissor_rect.height);
+      paint_stage (stage_cogl, view, &stage_rect);
+      cogl_framebuffer_pop_clip (fb);
+    }
+
+  cairo_region_destroy (fb_paint_region);
+}
+
 static gboolean
 clutter_stage_cogl_redraw_view (ClutterStageWindow *stage_window,
                                 ClutterStageView   *view)
@@ -541,21 +940,19 @@ clutter_stage_cogl_redraw_view (ClutterStageWindow *stage_window,
   gboolean has_buffer_age;
   gboolean do_swap_buffer;
   gboolean swap_with_damage;
+  gboolean swap_event;
   ClutterActor *wrapper;
-  cairo_rectangle_int_t redraw_clip;
-  cairo_rectangle_int_t swap_region;
-  cairo_rectangle_int_t fb_clip_region;
+  cairo_region_t *redraw_clip = NULL;
+  cairo_region_t *swap_region = NULL;
+  cairo_region_t *fb_clip_region = NULL;
   gboolean clip_region_empty;
   float fb_scale;
   int subpixel_compensation = 0;
-  int fb_width, fb_height;
 
   wrapper = CLUTTER_ACTOR (stage_cogl->wrapper);
 
   clutter_stage_view_get_layout (view, &view_rect);
   fb_scale = clutter_stage_view_get_scale (view);
-  fb_width = cogl_framebuffer_get_width (fb);
-  fb_height = cogl_framebuffer_get_height (fb);
 
   can_blit_sub_buffer =
     cogl_is_onscreen (fb) &&
@@ -565,20 +962,17 @@ clutter_stage_cogl_redraw_view (ClutterStageWindow *stage_window,
     cogl_is_onscreen (fb) &&
     cogl_clutter_winsys_has_feature (COGL_WINSYS_FEATURE_BUFFER_AGE);
 
-  /* NB: a zero width redraw clip == full stage redraw */
-  if (stage_cogl->bounding_redraw_clip.width == 0)
+  /* NB: a NULL redraw clip == full stage redraw */
+  if (stage_cogl->redraw_clip == NULL)
     have_clip = FALSE;
   else
     {
-      redraw_clip = stage_cogl->bounding_redraw_clip;
-      _clutter_util_rectangle_intersection (&redraw_clip,
-                                            &view_rect,
-                                            &redraw_clip);
+      redraw_clip = cairo_region_copy (stage_cogl->redraw_clip);
+      cairo_region_intersect_rectangle (redraw_clip, &view_rect);
 
-      have_clip = !(redraw_clip.x == view_rect.x &&
-                    redraw_clip.y == view_rect.y &&
-                    redraw_clip.width == view_rect.width &&
-                    redraw_clip.height == view_rect.height);
+      have_clip = !(cairo_region_num_rectangles (redraw_clip) == 1 &&
+                    cairo_region_contains_rectangle (redraw_clip, &view_rect) ==
+                    CAIRO_REGION_OVERLAP_IN);
     }
 
   may_use_clipped_redraw = FALSE;
@@ -594,20 +988,14 @@ clutter_stage_cogl_redraw_view (ClutterStageWindow *stage_window,
       if (fb_scale != floorf (fb_scale))
         subpixel_compensation = ceilf (fb_scale);
 
-      fb_clip_region = (cairo_rectangle_int_t) {
-        .x = (floorf ((redraw_clip.x - view_rect.x) * fb_scale) -
-              subpixel_compensation),
-        .y = (floorf ((redraw_clip.y - view_rect.y) * fb_scale) -
-              subpixel_compensation),
-        .width = (ceilf (redraw_clip.width * fb_scale) +
-                  (2 * subpixel_compensation)),
-        .height = (ceilf (redraw_clip.height * fb_scale) +
-                   (2 * subpixel_compensation))
-      };
+      fb_clip_region = stage_region_to_fb_region (redraw_clip,
+                                                  &view_rect,
+                                                  fb_scale,
+                                                  subpixel_compensation);
     }
   else
     {
-      fb_clip_region = (cairo_rectangle_int_t) { 0 };
+      fb_clip_region = cairo_region_create ();
     }
 
   if (may_use_clipped_redraw &&
@@ -616,7 +1004,8 @@ clutter_stage_cogl_redraw_view (ClutterStageWindow *stage_window,
   else
     use_clipped_redraw = FALSE;
 
-  clip_region_empty = may_use_clipped_redraw && fb_clip_region.width == 0;
+  clip_region_empty = may_use_clipped_redraw &&
+                      cairo_region_is_empty (fb_clip_region);
 
   swap_with_damage = FALSE;
   if (has_buffer_age)
@@ -624,44 +1013,50 @@ clutter_stage_cogl_redraw_view (ClutterStageWindow *stage_window,
       if (use_clipped_redraw && !clip_region_empty)
         {
           int age, i;
-          cairo_rectangle_int_t *current_fb_damage =
+          cairo_region_t **current_fb_damage =
             &view_priv->damage_history[DAMAGE_HISTORY (view_priv->damage_index++)];
 
+          g_clear_pointer (current_fb_damage, cairo_region_destroy);
+
           age = cogl_onscreen_get_buffer_age (COGL_ONSCREEN (fb));
 
           if (valid_buffer_age (view_cogl, age))
             {
-              cairo_rectangle_int_t damage_region;
+              cairo_rectangle_int_t fb_clip_extents;
+              int n_rects;
 
-              *current_fb_damage = fb_clip_region;
+              *current_fb_damage = cairo_region_copy (fb_clip_region);
 
               for (i = 1; i <= age; i++)
                 {
-                  cairo_rectangle_int_t *fb_damage =
-                    &view_priv->damage_history[DAMAGE_HISTORY (view_priv->damage_index - i - 1)];
+                  cairo_region_t *fb_damage =
+                    view_priv->damage_history[DAMAGE_HISTORY (view_priv->damage_index - i - 1)];
 
-                  _clutter_util_rectangle_union (&fb_clip_region,
-                                                 fb_damage,
-                                                 &fb_clip_region);
+                  cairo_region_union (fb_clip_region, fb_damage);
                 }
 
-              /* Update the bounding redraw clip state with the extra damage. */
-              damage_region = (cairo_rectangle_int_t) {
-                .x = view_rect.x + floorf (fb_clip_region.x / fb_scale),
-                .y = view_rect.y + floorf (fb_clip_region.y / fb_scale),
-                .width = ceilf (fb_clip_region.width / fb_scale),
-                .height = ceilf (fb_clip_region.height / fb_scale)
-              };
-              _clutter_util_rectangle_union (&stage_cogl->bounding_redraw_clip,
-                                             &damage_region,
-                                             &stage_cogl->bounding_redraw_clip);
-
-              CLUTTER_NOTE (CLIPPING, "Reusing back buffer(age=%d) - repairing region: x=%d, y=%d, width=%d, height=%d\n",
+              /* Update the redraw clip state with the extra damage. */
+              n_rects = cairo_region_num_rectangles (fb_clip_region);
+              for (i = 0; i < n_rects; i++)
+                {
+                  cairo_rectangle_int_t fb_rect;
+                  cairo_rectangle_int_t damage_rect;
+
+                  cairo_region_get_rectangle (fb_clip_region, i, &fb_rect);
+                  fb_rect_to_stage_rect (&fb_rect, &view_rect, fb_scale,
+                                         &damage_rect);
+                  cairo_region_union_rectangle (stage_cogl->redraw_clip,
+                                                &damage_rect);
+                }
+
+              cairo_region_get_extents (fb_clip_region, &fb_clip_extents);
+              CLUTTER_NOTE (CLIPPING, "Reusing back buffer(age=%d) - repairing region: x=%d, y=%d, width=%d, height=%d, n_rects=%d\n",
                             age,
-                            fb_clip_region.x,
-                            fb_clip_region.y,
-                            fb_clip_region.width,
-                            fb_clip_region.height);
+                            fb_clip_extents.x,
+                            fb_clip_extents.y,
+                            fb_clip_extents.width,
+                            fb_clip_extents.height,
+                            n_rects);
 
               swap_with_damage = TRUE;
             }
@@ -669,12 +1064,13 @@ clutter_stage_cogl_redraw_view (ClutterStageWindow *stage_window,
             {
               CLUTTER_NOTE (CLIPPING, "Invalid back buffer(age=%d): forcing full redraw\n", age);
               use_clipped_redraw = FALSE;
-              *current_fb_damage = (cairo_rectangle_int_t) {
-                .x = 0,
-                .y = 0,
-                .width = view_rect.width * fb_scale,
-                .height = view_rect.height * fb_scale
-              };
+              *current_fb_damage =
+                cairo_region_create_rectangle (&(cairo_rectangle_int_t) {
+                  .x = 0,
+                  .y = 0,
+                  .width = view_rect.width * fb_scale,
+                  .height = view_rect.height * fb_scale
+                });
             }
         }
       else if (!use_clipped_redraw)
@@ -690,35 +1086,10 @@ clutter_stage_cogl_redraw_view (ClutterStageWindow *stage_window,
     }
   else if (use_clipped_redraw)
     {
-      cairo_rectangle_int_t scissor_rect;
-
-      calculate_scissor_region (&fb_clip_region,
-                                subpixel_compensation,
-                                fb_width, fb_height,
-                                &scissor_rect);
-
-      CLUTTER_NOTE (CLIPPING,
-                    "Stage clip pushed: x=%d, y=%d, width=%d, height=%d\n",
-                    scissor_rect.x,
-                    scissor_rect.y,
-                    scissor_rect.width,
-                    scissor_rect.height);
-
       stage_cogl->using_clipped_redraw = TRUE;
 
-      cogl_framebuffer_push_scissor_clip (fb,
-                                          scissor_rect.x,
-                                          scissor_rect.y,
-                                          scissor_rect.width,
-                                          scissor_rect.height);
-      paint_stage (stage_cogl, view,
-                   &(cairo_rectangle_int_t) {
-                     .x = view_rect.x + floorf ((fb_clip_region.x - 0) / fb_scale),
-                     .y = view_rect.y + floorf ((fb_clip_region.y - 0) / fb_scale),
-                     .width = ceilf ((fb_clip_region.width + 0) / fb_scale),
-                     .height = ceilf ((fb_clip_region.height + 0) / fb_scale)
-                   });
-      cogl_framebuffer_pop_clip (fb);
+      paint_stage_clipped (stage_cogl, view, fb_clip_region,
+                           &view_rect, fb_scale, subpixel_compensation);
 
       stage_cogl->using_clipped_redraw = FALSE;
     }
@@ -727,31 +1098,13 @@ clutter_stage_cogl_redraw_view (ClutterStageWindow *stage_window,
       CLUTTER_NOTE (CLIPPING, "Unclipped stage paint\n");
 
       /* If we are trying to debug redraw issues then we want to pass
-       * the bounding_redraw_clip so it can be visualized */
+       * the redraw clip so it can be visualized */
       if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_DISABLE_CLIPPED_REDRAWS) &&
           may_use_clipped_redraw &&
           !clip_region_empty)
         {
-          cairo_rectangle_int_t scissor_rect;
-
-          calculate_scissor_region (&fb_clip_region,
-                                    subpixel_compensation,
-                                    fb_width, fb_height,
-                                    &scissor_rect);
-
-          cogl_framebuffer_push_scissor_clip (fb,
-                                              scissor_rect.x,
-                                              scissor_rect.y,
-                                              scissor_rect.width,
-                                              scissor_rect.height);
-          paint_stage (stage_cogl, view,
-                       &(cairo_rectangle_int_t) {
-                         .x = view_rect.x + floorf (fb_clip_region.x / fb_scale),
-                         .y = view_rect.y + floorf (fb_clip_region.y / fb_scale),
-                         .width = ceilf (fb_clip_region.width / fb_scale),
-                         .height = ceilf (fb_clip_region.height / fb_scale)
-                       });
-          cogl_framebuffer_pop_clip (fb);
+          paint_stage_clipped (stage_cogl, view, fb_clip_region,
+                               &view_rect, fb_scale, subpixel_compensation);
         }
       else
         paint_stage (stage_cogl, view, &view_rect);
@@ -764,18 +1117,8 @@ clutter_stage_cogl_redraw_view (ClutterStageWindow *stage_window,
       CoglContext *ctx = cogl_framebuffer_get_context (fb);
       static CoglPipeline *outline = NULL;
       ClutterActor *actor = CLUTTER_ACTOR (wrapper);
-      float x_1 = redraw_clip.x;
-      float x_2 = redraw_clip.x + redraw_clip.width;
-      float y_1 = redraw_clip.y;
-      float y_2 = redraw_clip.y + redraw_clip.height;
-      CoglVertexP2 quad[4] = {
-        { x_1, y_1 },
-        { x_2, y_1 },
-        { x_2, y_2 },
-        { x_1, y_2 }
-      };
-      CoglPrimitive *prim;
       CoglMatrix modelview;
+      int n_rects, i;
 
       if (outline == NULL)
         {
@@ -783,18 +1126,56 @@ clutter_stage_cogl_redraw_view (ClutterStageWindow *stage_window,
           cogl_pipeline_set_color4ub (outline, 0xff, 0x00, 0x00, 0xff);
         }
 
-      prim = cogl_primitive_new_p2 (ctx,
-                                    COGL_VERTICES_MODE_LINE_LOOP,
-                                    4, /* n_vertices */
-                                    quad);
-
       cogl_framebuffer_push_matrix (fb);
       cogl_matrix_init_identity (&modelview);
       _clutter_actor_apply_modelview_transform (actor, &modelview);
       cogl_framebuffer_set_modelview_matrix (fb, &modelview);
-      cogl_framebuffer_draw_primitive (fb, outline, prim);
+
+      n_rects = cairo_region_num_rectangles (redraw_clip);
+      for (i = 0; i < n_rects; i++)
+        {
+          cairo_rectangle_int_t rect;
+          float x_1, x_2, y_1, y_2;
+          CoglVertexP2 quad[4];
+          CoglPrimitive *prim;
+
+          cairo_region_get_rectangle (redraw_clip, i, &rect);
+          x_1 = rect.x;
+          x_2 = rect.x + rect.width;
+          y_1 = rect.y;
+          y_2 = rect.y + rect.height;
+
+          quad[0] = (CoglVertexP2) { x_1, y_1 };
+          quad[1] = (CoglVertexP2) { x_2, y_1 };
+          quad[2] = (CoglVertexP2) { x_2, y_2 };
+          quad[3] = (CoglVertexP2) { x_1, y_2 };
+
+          prim = cogl_primitive_new_p2 (ctx,
+                                        COGL_VERTICES_MODE_LINE_LOOP,
+                                        4, /* n_vertices */
+                                        quad);
+          cogl_framebuffer_draw_primitive (fb, outline, prim);
+          cogl_object_unref (prim);
+        }
+
       cogl_framebuffer_pop_matrix (fb);
-      cogl_object_unref (prim);
+    }
+
+  /* Report what changed in the view, regardless of how much of it had to
+   * be repainted to repair the back buffer. */
+  if (redraw_clip)
+    {
+      _clutter_stage_emit_after_paint_view (stage_cogl->wrapper, view,
+                                            redraw_clip);
+    }
+  else
+    {
+      cairo_region_t *view_region;
+
+      view_region = cairo_region_create_rectangle (&view_rect);
+      _clutter_stage_emit_after_paint_view (stage_cogl->wrapper, view,
+                                            view_region);
+      cairo_region_destroy (view_region);
     }
 
   /* XXX: It seems there will be a race here in that the stage
@@ -807,45 +1188,47 @@ clutter_stage_cogl_redraw_view (ClutterStageWindow *stage_window,
    */
   if (use_clipped_redraw)
     {
-      if (use_clipped_redraw && clip_region_empty)
+      if (clip_region_empty)
         {
           do_swap_buffer = FALSE;
         }
-      else if (use_clipped_redraw)
-        {
-          swap_region = fb_clip_region;
-          g_assert (swap_region.width > 0);
-          do_swap_buffer = TRUE;
-        }
       else
         {
-          swap_region = (cairo_rectangle_int_t) {
-            .x = 0,
-            .y = 0,
-            .width = view_rect.width * fb_scale,
-            .height = view_rect.height * fb_scale,
-          };
+          swap_region = cairo_region_copy (fb_clip_region);
           do_swap_buffer = TRUE;
         }
     }
   else
     {
-      swap_region = (cairo_rectangle_int_t) { 0 };
+      swap_region = cairo_region_create ();
       do_swap_buffer = TRUE;
     }
 
+  g_clear_pointer (&redraw_clip, cairo_region_destroy);
+  g_clear_pointer (&fb_clip_region, cairo_region_destroy);
+
   if (do_swap_buffer)
     {
       if (clutter_stage_view_get_onscreen (view) !=
           clutter_stage_view_get_framebuffer (view))
         {
-          transform_swap_region_to_onscreen (view, &swap_region);
+          cairo_region_t *transformed_swap_region;
+
+          transformed_swap_region =
+            transform_swap_region_to_onscreen (view, swap_region);
+          cairo_region_destroy (swap_region);
+          swap_region = transformed_swap_region;
         }
 
-      return swap_framebuffer (stage_window,
-                               view,
-                               &swap_region,
-                               swap_with_damage);
+      clutter_frame_timings_begin_phase (CLUTTER_FRAME_PHASE_SWAP);
+      swap_event = swap_framebuffer (stage_window,
+                                     view,
+                                     swap_region,
+                                     swap_with_damage);
+      clutter_frame_timings_end_phase (CLUTTER_FRAME_PHASE_SWAP);
+      cairo_region_destroy (swap_region);
+
+      return swap_event;
     }
   else
     {
@@ -853,34 +1236,145 @@ clutter_stage_cogl_redraw_view (ClutterStageWindow *stage_window,
     }
 }
 
+/* Whether a view should be painted in the current frame. Views that are
+ * still waiting for a swap to complete or whose next update is later
+ * than @now are left for a later frame. */
+static gboolean
+view_is_due (ClutterStageCogl *stage_cogl,
+             ClutterStageView *view,
+             gint64            now)
+{
+  ClutterStageViewCogl *view_cogl = CLUTTER_STAGE_VIEW_COGL (view);
+  ClutterStageViewCoglPrivate *view_priv =
+    clutter_stage_view_cogl_get_instance_private (view_cogl);
+
+  if (!stage_cogl->uses_view_frame_clocks)
+    return TRUE;
+
+  if (view_has_pending_swaps (view, now))
+    return FALSE;
+
+  return view_priv->update_time == -1 || view_priv->update_time <= now;
+}
+
+/* Replaces the redraw clip with the part of it covering @deferred_views
+ * so that it is painted when those views are due. Returns FALSE if none
+ * of the deferred views had any damage. */
+static gboolean
+keep_deferred_redraw_clip (ClutterStageCogl *stage_cogl,
+                           GList            *deferred_views)
+{
+  cairo_region_t *deferred_clip;
+  GList *l;
+
+  deferred_clip = cairo_region_create ();
+
+  for (l = deferred_views; l; l = l->next)
+    {
+      ClutterStageView *view = l->data;
+      cairo_rectangle_int_t view_rect;
+
+      clutter_stage_view_get_layout (view, &view_rect);
+
+      /* NB: a NULL redraw clip == full stage redraw */
+      if (stage_cogl->redraw_clip)
+        {
+          cairo_region_t *view_clip;
+
+          view_clip = cairo_region_copy (stage_cogl->redraw_clip);
+          cairo_region_intersect_rectangle (view_clip, &view_rect);
+          cairo_region_union (deferred_clip, view_clip);
+          cairo_region_destroy (view_clip);
+        }
+      else
+        {
+          cairo_region_union_rectangle (deferred_clip, &view_rect);
+        }
+    }
+
+  g_clear_pointer (&stage_cogl->redraw_clip, cairo_region_destroy);
+
+  if (cairo_region_is_empty (deferred_clip))
+    {
+      cairo_region_destroy (deferred_clip);
+      stage_cogl->initialized_redraw_clip = FALSE;
+      return FALSE;
+    }
+
+  stage_cogl->redraw_clip = deferred_clip;
+  stage_cogl->initialized_redraw_clip = TRUE;
+  return TRUE;
+}
+
 static void
 clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
 {
   ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
+  gboolean has_swap_events;
   gboolean swap_event = FALSE;
+  GList *deferred_views = NULL;
+  gint64 now;
   GList *l;
 
+  /* Presentation events report the frame counter the frame was drawn
+   * with, which is the one before any view is swapped */
+  _clutter_frame_timings_set_frame_counter (
+    _clutter_stage_window_get_frame_counter (stage_window));
+
+  has_swap_events = clutter_feature_available (CLUTTER_FEATURE_SWAP_EVENTS);
+  now = g_get_monotonic_time ();
+
   for (l = _clutter_stage_window_get_views (stage_window); l; l = l->next)
     {
       ClutterStageView *view = l->data;
+      ClutterStageViewCogl *view_cogl = CLUTTER_STAGE_VIEW_COGL (view);
+      ClutterStageViewCoglPrivate *view_priv =
+        clutter_stage_view_cogl_get_instance_private (view_cogl);
+      gboolean view_swap_event;
+
+      if (!view_is_due (stage_cogl, view, now))
+        {
+          deferred_views = g_list_prepend (deferred_views, view);
+          continue;
+        }
+
+      view_swap_event = clutter_stage_cogl_redraw_view (stage_window, view);
 
-      swap_event =
-        clutter_stage_cogl_redraw_view (stage_window, view) || swap_event;
+      if (view_swap_event && has_swap_events &&
+          stage_cogl->uses_view_frame_clocks)
+        {
+          view_priv->pending_swaps++;
+          view_priv->last_swap_time = now;
+        }
+
+      swap_event = view_swap_event || swap_event;
     }
 
   _clutter_stage_window_finish_frame (stage_window);
 
-  if (swap_event)
+  if (swap_event && !stage_cogl->uses_view_frame_clocks)
     {
       /* If we have swap buffer events then cogl_onscreen_swap_buffers
        * will return immediately and we need to track that there is a
        * swap in progress... */
-      if (clutter_feature_available (CLUTTER_FEATURE_SWAP_EVENTS))
+      if (has_swap_events)
         stage_cogl->pending_swaps++;
     }
 
-  /* reset the redraw clipping for the next paint... */
-  stage_cogl->initialized_redraw_clip = FALSE;
+  /* reset the redraw clipping for the next paint, keeping the damage of
+   * the views that weren't painted... */
+  if (deferred_views)
+    {
+      stage_cogl->has_deferred_redraws =
+        keep_deferred_redraw_clip (stage_cogl, deferred_views);
+      g_list_free (deferred_views);
+    }
+  else
+    {
+      g_clear_pointer (&stage_cogl->redraw_clip, cairo_region_destroy);
+      stage_cogl->initialized_redraw_clip = FALSE;
+      stage_cogl->has_deferred_redraws = FALSE;
+    }
 
   stage_cogl->frame_count++;
 }
@@ -923,14 +1417,20 @@ clutter_stage_cogl_get_dirty_pixel (ClutterStageWindow *stage_window,
       ClutterStageViewCogl *view_cogl = CLUTTER_STAGE_VIEW_COGL (view);
       ClutterStageViewCoglPrivate *view_priv =
         clutter_stage_view_cogl_get_instance_private (view_cogl);
-      cairo_rectangle_int_t view_layout;
-      cairo_rectangle_int_t *fb_damage;
+      cairo_region_t *fb_damage;
+      cairo_rectangle_int_t fb_damage_rect;
 
-      clutter_stage_view_get_layout (view, &view_layout);
+      fb_damage = view_priv->damage_history[DAMAGE_HISTORY (view_priv->damage_index - 1)];
+      if (fb_damage == NULL || cairo_region_is_empty (fb_damage))
+        {
+          *x = 0;
+          *y = 0;
+          return;
+        }
 
-      fb_damage = &view_priv->damage_history[DAMAGE_HISTORY (view_priv->damage_index - 1)];
-      *x = fb_damage->x / fb_scale;
-      *y = fb_damage->y / fb_scale;
+      cairo_region_get_rectangle (fb_damage, 0, &fb_damage_rect);
+      *x = fb_damage_rect.x / fb_scale;
+      *y = fb_damage_rect.y / fb_scale;
     }
 }
 
@@ -946,6 +1446,7 @@ clutter_stage_window_iface_init (ClutterStageWindowIface *iface)
   iface->schedule_update = clutter_stage_cogl_schedule_update;
   iface->get_update_time = clutter_stage_cogl_get_update_time;
   iface->clear_update_time = clutter_stage_cogl_clear_update_time;
+  iface->has_deferred_redraws = clutter_stage_cogl_has_deferred_redraws;
   iface->add_redraw_clip = clutter_stage_cogl_add_redraw_clip;
   iface->has_redraw_clips = clutter_stage_cogl_has_redraw_clips;
   iface->ignoring_redraw_clips = clutter_stage_cogl_ignoring_redraw_clips;
@@ -978,12 +1479,23 @@ clutter_stage_cogl_set_property (GObject      *gobject,
     }
 }
 
+static void
+clutter_stage_cogl_finalize (GObject *gobject)
+{
+  ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (gobject);
+
+  g_clear_pointer (&stage_cogl->redraw_clip, cairo_region_destroy);
+
+  G_OBJECT_CLASS (_clutter_stage_cogl_parent_class)->finalize (gobject);
+}
+
 static void
 _clutter_stage_cogl_class_init (ClutterStageCoglClass *klass)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
 
   gobject_class->set_property = clutter_stage_cogl_set_property;
+  gobject_class->finalize = clutter_stage_cogl_finalize;
 
   g_object_class_override_property (gobject_class, PROP_WRAPPER, "wrapper");
   g_object_class_override_property (gobject_class, PROP_BACKEND, "backend");
@@ -998,12 +1510,33 @@ _clutter_stage_cogl_init (ClutterStageCogl *stage)
   stage->update_time = -1;
 }
 
+static void
+clutter_stage_view_cogl_finalize (GObject *object)
+{
+  ClutterStageViewCogl *view_cogl = CLUTTER_STAGE_VIEW_COGL (object);
+  ClutterStageViewCoglPrivate *view_priv =
+    clutter_stage_view_cogl_get_instance_private (view_cogl);
+  int i;
+
+  for (i = 0; i < DAMAGE_HISTORY_MAX; i++)
+    g_clear_pointer (&view_priv->damage_history[i], cairo_region_destroy);
+
+  G_OBJECT_CLASS (clutter_stage_view_cogl_parent_class)->finalize (object);
+}
+
 static void
 clutter_stage_view_cogl_init (ClutterStageViewCogl *view_cogl)
 {
+  ClutterStageViewCoglPrivate *view_priv =
+    clutter_stage_view_cogl_get_instance_private (view_cogl);
+
+  view_priv->update_time = -1;
 }
 
 static void
 clutter_stage_view_cogl_class_init (ClutterStageViewCoglClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = clutter_stage_view_cogl_finalize;
 }
@@ -59,6 +59,11 @@ struct _ClutterStageCogl
    * junk frames to start with. */
   unsigned int frame_count;
 
+  /* The accumulated damage for the next paint in stage coordinates.
+   * NULL after initialization means a full stage redraw was queued. */
+  cairo_region_t *redraw_clip;
+
+  /* The bounds of the damage rectangle currently being painted. */
   cairo_rectangle_int_t bounding_redraw_clip;
 
   guint initialized_redraw_clip : 1;
@@ -66,6 +71,15 @@ struct _ClutterStageCogl
   /* TRUE if the current paint cycle has a clipped redraw. In that
      case bounding_redraw_clip specifies the the bounds. */
   guint using_clipped_redraw : 1;
+
+  /* TRUE once the backend reports presentation per view. Each view is
+     then scheduled at the refresh rate of its own output instead of
+     the stage being scheduled as a whole. */
+  guint uses_view_frame_clocks : 1;
+
+  /* TRUE if the last paint skipped views that weren't due yet and kept
+     their damage in redraw_clip. */
+  guint has_deferred_redraws : 1;
 };
 
 struct _ClutterStageCoglClass
@@ -81,6 +95,12 @@ void _clutter_stage_cogl_presented (ClutterStageCogl *stage_cogl,
                                     CoglFrameEvent    frame_event,
                                     ClutterFrameInfo *frame_info);
 
+CLUTTER_AVAILABLE_IN_MUTTER
+void _clutter_stage_cogl_view_presented (ClutterStageCogl *stage_cogl,
+                                         ClutterStageView *view,
+                                         CoglFrameEvent    frame_event,
+                                         ClutterFrameInfo *frame_info);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_STAGE_COGL_H__ */
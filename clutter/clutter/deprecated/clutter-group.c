@@ -448,6 +448,7 @@ clutter_group_class_init (ClutterGroupClass *klass)
   actor_class->allocate = clutter_group_real_allocate;
   actor_class->paint = clutter_group_real_paint;
   actor_class->pick = clutter_group_real_pick;
+  clutter_actor_class_set_geometric_pick (actor_class);
   actor_class->show_all = clutter_group_real_show_all;
   actor_class->hide_all = clutter_group_real_hide_all;
   actor_class->get_paint_volume = clutter_group_real_get_paint_volume;
@@ -0,0 +1,87 @@
+#include <clutter/clutter.h>
+
+static guint8
+get_red (int x, int y)
+{
+  guint8 data[4];
+
+  cogl_read_pixels (x, y, 1, 1,
+                    COGL_READ_PIXELS_COLOR_BUFFER,
+                    COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                    data);
+
+  return data[0];
+}
+
+static void
+paint_cb (ClutterStage *stage,
+          gpointer      data)
+{
+  gboolean *was_painted = data;
+
+  /* the inside of the rectangle is still white */
+  g_assert_cmpint (get_red (100, 100), >, 0xe0);
+
+  /* the blur spreads outside of the rectangle */
+  g_assert_cmpint (get_red (45, 100), >, 0);
+  g_assert_cmpint (get_red (45, 100), <, 0xff);
+
+  /* but not further than the radius */
+  g_assert_cmpint (get_red (5, 5), ==, 0);
+
+  *was_painted = TRUE;
+}
+
+static void
+wait_for_paint (ClutterActor *stage)
+{
+  gboolean was_painted = FALSE;
+  guint paint_handler;
+
+  paint_handler = g_signal_connect (stage, "after-paint",
+                                    G_CALLBACK (paint_cb),
+                                    &was_painted);
+
+  clutter_actor_queue_redraw (stage);
+
+  while (!was_painted)
+    g_main_context_iteration (NULL, FALSE);
+
+  g_signal_handler_disconnect (stage, paint_handler);
+}
+
+static void
+actor_blur_effect (void)
+{
+  const ClutterColor white = { 0xff, 0xff, 0xff, 0xff };
+  ClutterActor *stage, *rect;
+  ClutterEffect *effect;
+
+  if (!clutter_feature_available (CLUTTER_FEATURE_SHADERS_GLSL))
+    return;
+
+  stage = clutter_test_get_stage ();
+  clutter_actor_set_background_color (stage, CLUTTER_COLOR_Black);
+
+  rect = clutter_actor_new ();
+  clutter_actor_set_background_color (rect, &white);
+  clutter_actor_set_position (rect, 50, 50);
+  clutter_actor_set_size (rect, 100, 100);
+  clutter_actor_add_child (stage, rect);
+
+  /* a radius above 4 takes more than one pass of the dual filter blur */
+  effect = clutter_blur_effect_new ();
+  clutter_blur_effect_set_radius (CLUTTER_BLUR_EFFECT (effect), 16.0);
+  clutter_actor_add_effect (rect, effect);
+
+  clutter_actor_show (stage);
+
+  wait_for_paint (stage);
+
+  /* the second paint reuses the levels of the blur */
+  wait_for_paint (stage);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/actor/blur-effect", actor_blur_effect)
+)
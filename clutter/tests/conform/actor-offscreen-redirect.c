@@ -189,9 +189,13 @@ verify_redraws (gpointer user_data)
   clutter_actor_queue_redraw (data->child);
   verify_redraw (data, 1);
 
-  /* Modifying the transformation on the parent should cause a
-     redraw */
+  /* Only moving the parent should reuse the cached image */
   clutter_actor_set_anchor_point (data->parent_container, 0, 1);
+  verify_redraw (data, 0);
+
+  /* Any other change to the transformation on the parent should
+     cause a redraw */
+  clutter_actor_set_scale (data->parent_container, 2.0, 2.0);
   verify_redraw (data, 1);
 
   /* Redrawing an unrelated actor shouldn't cause a redraw */
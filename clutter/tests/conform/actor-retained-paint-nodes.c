@@ -0,0 +1,141 @@
+#include <clutter/clutter.h>
+
+typedef struct _FooActor      FooActor;
+typedef struct _FooActorClass FooActorClass;
+
+struct _FooActorClass
+{
+  ClutterActorClass parent_class;
+};
+
+struct _FooActor
+{
+  ClutterActor parent;
+
+  int paint_node_count;
+};
+
+GType foo_actor_get_type (void) G_GNUC_CONST;
+
+G_DEFINE_TYPE (FooActor, foo_actor, CLUTTER_TYPE_ACTOR);
+
+static void
+foo_actor_paint_node (ClutterActor     *actor,
+                      ClutterPaintNode *root)
+{
+  FooActor *foo_actor = (FooActor *) actor;
+  ClutterColor color = { 255, 0, 0, 255 };
+  ClutterActorBox box;
+  ClutterPaintNode *node;
+
+  foo_actor->paint_node_count++;
+
+  clutter_actor_get_allocation_box (actor, &box);
+  clutter_actor_box_set_origin (&box, 0, 0);
+
+  node = clutter_color_node_new (&color);
+  clutter_paint_node_add_rectangle (node, &box);
+  clutter_paint_node_add_child (root, node);
+  clutter_paint_node_unref (node);
+}
+
+static void
+foo_actor_class_init (FooActorClass *klass)
+{
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+
+  actor_class->paint_node = foo_actor_paint_node;
+}
+
+static void
+foo_actor_init (FooActor *self)
+{
+}
+
+static void
+verify_redraw (ClutterActor *stage,
+               FooActor     *foo_actor,
+               int           expected_paint_node_count)
+{
+  GMainLoop *main_loop = g_main_loop_new (NULL, TRUE);
+  guint paint_handler;
+
+  paint_handler = g_signal_connect_data (stage,
+                                         "paint",
+                                         G_CALLBACK (g_main_loop_quit),
+                                         main_loop,
+                                         NULL,
+                                         G_CONNECT_SWAPPED | G_CONNECT_AFTER);
+
+  /* Queue a redraw on the stage */
+  clutter_actor_queue_redraw (stage);
+
+  foo_actor->paint_node_count = 0;
+
+  /* Wait for it to paint */
+  g_main_loop_run (main_loop);
+
+  g_signal_handler_disconnect (stage, paint_handler);
+  g_main_loop_unref (main_loop);
+
+  g_assert_cmpint (foo_actor->paint_node_count, ==, expected_paint_node_count);
+}
+
+static void
+actor_retained_paint_nodes (void)
+{
+  ClutterColor bg_color = { 0, 0, 255, 255 };
+  ClutterActor *stage, *parent;
+  FooActor *foo_actor;
+
+  stage = clutter_test_get_stage ();
+
+  parent = clutter_actor_new ();
+  clutter_actor_add_child (stage, parent);
+
+  foo_actor = g_object_new (foo_actor_get_type (), NULL);
+  clutter_actor_set_size (CLUTTER_ACTOR (foo_actor), 100, 100);
+  clutter_actor_add_child (parent, CLUTTER_ACTOR (foo_actor));
+
+  clutter_actor_show (stage);
+
+  /* Without retained nodes they are built on every paint */
+  verify_redraw (stage, foo_actor, 1);
+  verify_redraw (stage, foo_actor, 1);
+
+  clutter_actor_set_retain_paint_nodes (CLUTTER_ACTOR (foo_actor), TRUE);
+  g_assert (clutter_actor_get_retain_paint_nodes (CLUTTER_ACTOR (foo_actor)));
+
+  /* The nodes are built once and then reused */
+  verify_redraw (stage, foo_actor, 1);
+  verify_redraw (stage, foo_actor, 0);
+
+  /* Moving or transforming the actor doesn't change its nodes */
+  clutter_actor_set_position (CLUTTER_ACTOR (foo_actor), 10, 10);
+  verify_redraw (stage, foo_actor, 0);
+  clutter_actor_set_scale (CLUTTER_ACTOR (foo_actor), 2.0, 2.0);
+  verify_redraw (stage, foo_actor, 0);
+
+  /* Resizing the actor does */
+  clutter_actor_set_size (CLUTTER_ACTOR (foo_actor), 50, 50);
+  verify_redraw (stage, foo_actor, 1);
+
+  /* So does changing the opacity of a parent */
+  clutter_actor_set_opacity (parent, 128);
+  verify_redraw (stage, foo_actor, 1);
+
+  /* And changing the background color */
+  clutter_actor_set_background_color (CLUTTER_ACTOR (foo_actor), &bg_color);
+  verify_redraw (stage, foo_actor, 1);
+
+  clutter_actor_invalidate_paint_nodes (CLUTTER_ACTOR (foo_actor));
+  verify_redraw (stage, foo_actor, 1);
+
+  clutter_actor_set_retain_paint_nodes (CLUTTER_ACTOR (foo_actor), FALSE);
+  verify_redraw (stage, foo_actor, 1);
+  verify_redraw (stage, foo_actor, 1);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/actor/retained-paint-nodes", actor_retained_paint_nodes)
+)
@@ -78,6 +78,92 @@ test_actor_init (TestActor *self)
 {
 }
 
+#define TEST_TYPE_SIZE_ACTOR    (test_size_actor_get_type ())
+
+typedef struct _TestSizeActor           TestSizeActor;
+typedef struct _ClutterActorClass       TestSizeActorClass;
+
+/* An actor whose preferred size is not fixed, counting how often it is
+ * computed; without children it has the size set with
+ * test_size_actor_set_size(), otherwise the one of its layout manager */
+struct _TestSizeActor
+{
+  ClutterActor parent_instance;
+
+  gfloat width;
+  gfloat height;
+
+  guint n_width_requests;
+  guint n_height_requests;
+};
+
+GType test_size_actor_get_type (void);
+
+G_DEFINE_TYPE (TestSizeActor, test_size_actor, CLUTTER_TYPE_ACTOR);
+
+static void
+test_size_actor_get_preferred_width (ClutterActor *self,
+                                     gfloat        for_height,
+                                     gfloat       *min_width_p,
+                                     gfloat       *nat_width_p)
+{
+  TestSizeActor *test = (TestSizeActor *) self;
+
+  test->n_width_requests += 1;
+
+  CLUTTER_ACTOR_CLASS (test_size_actor_parent_class)->get_preferred_width (self,
+                                                                          for_height,
+                                                                          min_width_p,
+                                                                          nat_width_p);
+
+  *min_width_p = MAX (*min_width_p, test->width);
+  *nat_width_p = MAX (*nat_width_p, test->width);
+}
+
+static void
+test_size_actor_get_preferred_height (ClutterActor *self,
+                                      gfloat        for_width,
+                                      gfloat       *min_height_p,
+                                      gfloat       *nat_height_p)
+{
+  TestSizeActor *test = (TestSizeActor *) self;
+
+  test->n_height_requests += 1;
+
+  CLUTTER_ACTOR_CLASS (test_size_actor_parent_class)->get_preferred_height (self,
+                                                                           for_width,
+                                                                           min_height_p,
+                                                                           nat_height_p);
+
+  *min_height_p = MAX (*min_height_p, test->height);
+  *nat_height_p = MAX (*nat_height_p, test->height);
+}
+
+static void
+test_size_actor_class_init (TestSizeActorClass *klass)
+{
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+
+  actor_class->get_preferred_width = test_size_actor_get_preferred_width;
+  actor_class->get_preferred_height = test_size_actor_get_preferred_height;
+}
+
+static void
+test_size_actor_init (TestSizeActor *self)
+{
+}
+
+static void
+test_size_actor_set_size (TestSizeActor *self,
+                          gfloat         width,
+                          gfloat         height)
+{
+  self->width = width;
+  self->height = height;
+
+  clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
+}
+
 static void
 actor_preferred_size (void)
 {
@@ -210,7 +296,132 @@ actor_fixed_size (void)
   g_object_unref (rect);
 }
 
+static void
+actor_nested_preferred_size (void)
+{
+  ClutterActor *grandparent, *parent, *child;
+  gfloat nat_width, nat_height;
+
+  grandparent = clutter_actor_new ();
+  g_object_ref_sink (grandparent);
+
+  parent = clutter_actor_new ();
+  clutter_actor_add_child (grandparent, parent);
+
+  child = clutter_actor_new ();
+  clutter_actor_set_size (child, 50, 50);
+  clutter_actor_add_child (parent, child);
+
+  clutter_actor_get_preferred_size (grandparent,
+                                    NULL, NULL,
+                                    &nat_width, &nat_height);
+  g_assert_cmpfloat (nat_width, ==, 50);
+  g_assert_cmpfloat (nat_height, ==, 50);
+
+  if (g_test_verbose ())
+    g_print ("Moving the child\n");
+
+  clutter_actor_set_position (child, 10, 10);
+  clutter_actor_get_preferred_size (grandparent,
+                                    NULL, NULL,
+                                    &nat_width, &nat_height);
+  g_assert_cmpfloat (nat_width, ==, 60);
+  g_assert_cmpfloat (nat_height, ==, 60);
+
+  if (g_test_verbose ())
+    g_print ("Relayout without size changes\n");
+
+  clutter_actor_queue_relayout (child);
+  clutter_actor_get_preferred_size (grandparent,
+                                    NULL, NULL,
+                                    &nat_width, &nat_height);
+  g_assert_cmpfloat (nat_width, ==, 60);
+  g_assert_cmpfloat (nat_height, ==, 60);
+
+  if (g_test_verbose ())
+    g_print ("Resizing the child\n");
+
+  clutter_actor_set_size (child, 100, 20);
+  clutter_actor_get_preferred_size (grandparent,
+                                    NULL, NULL,
+                                    &nat_width, &nat_height);
+  g_assert_cmpfloat (nat_width, ==, 110);
+  g_assert_cmpfloat (nat_height, ==, 30);
+
+  if (g_test_verbose ())
+    g_print ("Adding a margin to the child\n");
+
+  clutter_actor_set_margin_right (child, 5);
+  clutter_actor_get_preferred_size (grandparent,
+                                    NULL, NULL,
+                                    &nat_width, &nat_height);
+  g_assert_cmpfloat (nat_width, ==, 115);
+  g_assert_cmpfloat (nat_height, ==, 30);
+
+  clutter_actor_destroy (grandparent);
+  g_object_unref (grandparent);
+}
+
+static void
+actor_nested_preferred_size_cache (void)
+{
+  ClutterActor *grandparent;
+  TestSizeActor *parent, *child;
+  gfloat nat_width, nat_height;
+  guint n_width_requests, n_height_requests;
+
+  grandparent = clutter_actor_new ();
+  g_object_ref_sink (grandparent);
+
+  parent = g_object_new (TEST_TYPE_SIZE_ACTOR, NULL);
+  clutter_actor_add_child (grandparent, CLUTTER_ACTOR (parent));
+
+  child = g_object_new (TEST_TYPE_SIZE_ACTOR, NULL);
+  test_size_actor_set_size (child, 50, 50);
+  clutter_actor_add_child (CLUTTER_ACTOR (parent), CLUTTER_ACTOR (child));
+
+  clutter_actor_get_preferred_size (grandparent,
+                                    NULL, NULL,
+                                    &nat_width, &nat_height);
+  g_assert_cmpfloat (nat_width, ==, 50);
+  g_assert_cmpfloat (nat_height, ==, 50);
+  g_assert_cmpuint (parent->n_width_requests, >, 0);
+  g_assert_cmpuint (parent->n_height_requests, >, 0);
+
+  if (g_test_verbose ())
+    g_print ("Relayout without size changes\n");
+
+  n_width_requests = parent->n_width_requests;
+  n_height_requests = parent->n_height_requests;
+
+  clutter_actor_queue_relayout (CLUTTER_ACTOR (child));
+  clutter_actor_get_preferred_size (grandparent,
+                                    NULL, NULL,
+                                    &nat_width, &nat_height);
+  g_assert_cmpfloat (nat_width, ==, 50);
+  g_assert_cmpfloat (nat_height, ==, 50);
+  g_assert_cmpuint (parent->n_width_requests, ==, n_width_requests);
+  g_assert_cmpuint (parent->n_height_requests, ==, n_height_requests);
+
+  if (g_test_verbose ())
+    g_print ("Relayout with size changes\n");
+
+  test_size_actor_set_size (child, 80, 40);
+  clutter_actor_get_preferred_size (grandparent,
+                                    NULL, NULL,
+                                    &nat_width, &nat_height);
+  g_assert_cmpfloat (nat_width, ==, 80);
+  g_assert_cmpfloat (nat_height, ==, 40);
+  g_assert_cmpuint (parent->n_width_requests, >, n_width_requests);
+  g_assert_cmpuint (parent->n_height_requests, >, n_height_requests);
+
+  clutter_actor_destroy (grandparent);
+  g_object_unref (grandparent);
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/actor/size/preferred", actor_preferred_size)
   CLUTTER_TEST_UNIT ("/actor/size/fixed", actor_fixed_size)
+  CLUTTER_TEST_UNIT ("/actor/size/nested", actor_nested_preferred_size)
+  CLUTTER_TEST_UNIT ("/actor/size/nested-cache", actor_nested_preferred_size_cache)
 )
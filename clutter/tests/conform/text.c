@@ -1,5 +1,6 @@
 #include <glib.h>
 #include <clutter/clutter.h>
+#include <cogl-pango/cogl-pango.h>
 #include <string.h>
 
 typedef struct {
@@ -533,6 +534,133 @@ text_idempotent_use_markup (void)
   clutter_actor_destroy (CLUTTER_ACTOR (text));
 }
 
+static void
+text_shared_layout (void)
+{
+  ClutterText *text_a = CLUTTER_TEXT (clutter_text_new_with_text ("Sans 10", "Shared"));
+  ClutterText *text_b = CLUTTER_TEXT (clutter_text_new_with_text ("Sans 10", "Shared"));
+  PangoLayout *layout_a, *layout_b;
+
+  g_object_ref_sink (text_a);
+  g_object_ref_sink (text_b);
+
+  /* Actors showing the same text share their layouts, but each of
+   * them hands out a copy of its own
+   */
+  layout_a = clutter_text_get_layout (text_a);
+  layout_b = clutter_text_get_layout (text_b);
+  g_assert (layout_a != layout_b);
+  g_assert (clutter_text_get_layout (text_a) == layout_a);
+  g_assert_cmpstr (pango_layout_get_text (layout_a), ==, "Shared");
+
+  /* Changing the copy of one actor doesn't affect the other */
+  pango_layout_set_text (layout_a, "Changed", -1);
+  g_assert_cmpstr (pango_layout_get_text (clutter_text_get_layout (text_b)),
+                   ==,
+                   "Shared");
+
+  clutter_text_set_text (text_b, "Not shared");
+  g_assert_cmpstr (pango_layout_get_text (clutter_text_get_layout (text_b)),
+                   ==,
+                   "Not shared");
+
+  clutter_text_set_text (text_b, "Shared");
+  clutter_text_set_font_name (text_b, "Sans 12");
+  layout_b = clutter_text_get_layout (text_b);
+  g_assert_cmpint (pango_font_description_get_size (pango_layout_get_font_description (layout_b)),
+                   ==,
+                   12 * PANGO_SCALE);
+
+  /* Editable actors always have a layout of their own, and return it */
+  clutter_text_set_editable (text_b, TRUE);
+  layout_b = clutter_text_get_layout (text_b);
+  g_assert_cmpstr (pango_layout_get_text (layout_b), ==, "Shared");
+
+  clutter_actor_destroy (CLUTTER_ACTOR (text_a));
+  clutter_actor_destroy (CLUTTER_ACTOR (text_b));
+
+  g_object_unref (text_a);
+  g_object_unref (text_b);
+}
+
+static void
+text_glyph_cache_max_size (void)
+{
+  CoglPangoFontMap *font_map = COGL_PANGO_FONT_MAP (clutter_get_font_map ());
+  const size_t max_size = 64 * 1024;
+  size_t old_max_size, resident_bytes;
+  unsigned int n_misses, n_evictions, old_n_evictions;
+  PangoContext *context;
+  PangoFontDescription *font_desc;
+  PangoLayout *layout, *empty_layout;
+
+  old_max_size = cogl_pango_font_map_get_glyph_cache_max_size (font_map);
+
+  cogl_pango_font_map_clear_glyph_cache (font_map);
+  cogl_pango_font_map_set_glyph_cache_max_size (font_map, max_size);
+  g_assert_cmpuint (cogl_pango_font_map_get_glyph_cache_max_size (font_map),
+                    ==,
+                    max_size);
+
+  context = cogl_pango_font_map_create_context (font_map);
+  font_desc = pango_font_description_from_string ("Sans 64");
+  pango_context_set_font_description (context, font_desc);
+  pango_font_description_free (font_desc);
+
+  layout = pango_layout_new (context);
+  pango_layout_set_text (layout,
+                         "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                         "abcdefghijklmnopqrstuvwxyz"
+                         "0123456789",
+                         -1);
+  empty_layout = pango_layout_new (context);
+
+  /* The cache is only trimmed before the glyphs of a layout are
+   * added, so a single layout can take it past the limit
+   */
+  cogl_pango_font_map_get_glyph_cache_stats (font_map,
+                                             NULL, NULL,
+                                             &old_n_evictions,
+                                             NULL);
+  cogl_pango_ensure_glyph_cache_for_layout (layout);
+  cogl_pango_font_map_get_glyph_cache_stats (font_map,
+                                             NULL, &n_misses,
+                                             &n_evictions,
+                                             &resident_bytes);
+  g_assert_cmpuint (n_misses, >, 0);
+  g_assert_cmpuint (n_evictions, ==, old_n_evictions);
+  g_assert_cmpuint (resident_bytes, >, max_size);
+
+  /* The next layout evicts the least recently used glyphs down to
+   * three quarters of the limit
+   */
+  cogl_pango_ensure_glyph_cache_for_layout (empty_layout);
+  cogl_pango_font_map_get_glyph_cache_stats (font_map,
+                                             NULL, NULL,
+                                             &n_evictions,
+                                             &resident_bytes);
+  g_assert_cmpuint (n_evictions, >, old_n_evictions);
+  g_assert_cmpuint (resident_bytes, <=, max_size / 4 * 3);
+
+  /* Without a limit nothing is evicted */
+  cogl_pango_font_map_set_glyph_cache_max_size (font_map, 0);
+  old_n_evictions = n_evictions;
+  cogl_pango_ensure_glyph_cache_for_layout (layout);
+  cogl_pango_ensure_glyph_cache_for_layout (empty_layout);
+  cogl_pango_font_map_get_glyph_cache_stats (font_map,
+                                             NULL, NULL,
+                                             &n_evictions,
+                                             &resident_bytes);
+  g_assert_cmpuint (n_evictions, ==, old_n_evictions);
+  g_assert_cmpuint (resident_bytes, >, max_size);
+
+  g_object_unref (layout);
+  g_object_unref (empty_layout);
+  g_object_unref (context);
+
+  cogl_pango_font_map_set_glyph_cache_max_size (font_map, old_max_size);
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/text/utf8-validation", text_utf8_validation)
   CLUTTER_TEST_UNIT ("/text/set-empty", text_set_empty)
@@ -547,4 +675,6 @@ CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/text/cursor", text_cursor)
   CLUTTER_TEST_UNIT ("/text/event", text_event)
   CLUTTER_TEST_UNIT ("/text/idempotent-use-markup", text_idempotent_use_markup)
+  CLUTTER_TEST_UNIT ("/text/shared-layout", text_shared_layout)
+  CLUTTER_TEST_UNIT ("/text/glyph-cache-max-size", text_glyph_cache_max_size)
 )
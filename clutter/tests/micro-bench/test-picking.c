@@ -5,9 +5,15 @@
 
 #define N_ACTORS 100
 #define N_EVENTS 5
+#define N_FRAMES_PER_REPORT 100
 
 static gint n_actors = N_ACTORS;
 static gint n_events = N_EVENTS;
+static gboolean gpu_picking = FALSE;
+
+static GTimer *pick_timer = NULL;
+static gdouble pick_time = 0.0;
+static guint n_frames = 0;
 
 static GOptionEntry entries[] = {
   {
@@ -22,6 +28,12 @@ static GOptionEntry entries[] = {
     G_OPTION_ARG_INT, &n_events,
     "Number of events", "EVENTS"
   },
+  {
+    "gpu-picking", 'g',
+    0,
+    G_OPTION_ARG_NONE, &gpu_picking,
+    "Render a pick buffer instead of picking geometrically", NULL
+  },
   { NULL }
 };
 
@@ -37,6 +49,8 @@ do_events (ClutterActor *stage)
   glong i;
   static gdouble angle = 0;
 
+  g_timer_start (pick_timer);
+
   for (i = 0; i < n_events; i++)
     {
       angle += (2.0 * G_PI) / (gdouble)n_actors;
@@ -51,12 +65,24 @@ do_events (ClutterActor *stage)
 				      256.0 + 206.0 * cos (angle),
 				      256.0 + 206.0 * sin (angle));
     }
+
+  pick_time += g_timer_elapsed (pick_timer, NULL);
 }
 
 static void
 on_paint (ClutterActor *stage, gconstpointer *data)
 {
   do_events (stage);
+
+  if (++n_frames == N_FRAMES_PER_REPORT)
+    {
+      printf ("%s picking: %.3f us per pick\n",
+              gpu_picking ? "GPU" : "Geometric",
+              pick_time * 1000000.0 / (N_FRAMES_PER_REPORT * n_events));
+
+      pick_time = 0.0;
+      n_frames = 0;
+    }
 }
 
 static gboolean
@@ -80,6 +106,15 @@ main (int argc, char **argv)
   g_setenv ("CLUTTER_DEFAULT_FPS", "1000", FALSE);
   g_setenv ("CLUTTER_SHOW_FPS", "1", FALSE);
 
+  /* The pick method is read from the environment while initializing
+   * Clutter, so it has to be set up before parsing the other options */
+  for (i = 1; i < argc; i++)
+    {
+      if (g_strcmp0 (argv[i], "--gpu-picking") == 0 ||
+          g_strcmp0 (argv[i], "-g") == 0)
+        g_setenv ("CLUTTER_PICK", "gpu-picking", TRUE);
+    }
+
   if (clutter_init_with_args (&argc, &argv,
                               NULL,
                               entries,
@@ -93,9 +128,12 @@ main (int argc, char **argv)
   clutter_stage_set_title (CLUTTER_STAGE (stage), "Picking");
 
   printf ("Picking performance test with "
-          "%d actors and %d events per frame\n",
+          "%d actors and %d events per frame (%s picking)\n",
           n_actors,
-          n_events);
+          n_events,
+          gpu_picking ? "GPU" : "geometric");
+
+  pick_timer = g_timer_new ();
 
   for (i = n_actors - 1; i >= 0; i--)
     {
@@ -134,6 +172,8 @@ main (int argc, char **argv)
 
   clutter_actor_destroy (stage);
 
+  g_timer_destroy (pick_timer);
+
   return 0;
 }
 
@@ -172,6 +172,48 @@ cogl_pango_font_map_get_use_mipmapping (CoglPangoFontMap *fm)
     _cogl_pango_renderer_get_use_mipmapping (COGL_PANGO_RENDERER (renderer));
 }
 
+void
+cogl_pango_font_map_set_glyph_cache_max_size (CoglPangoFontMap *fm,
+                                              size_t            max_size)
+{
+  PangoRenderer *renderer = _cogl_pango_font_map_get_renderer (fm);
+
+  _cogl_pango_renderer_set_glyph_cache_max_size (COGL_PANGO_RENDERER (renderer),
+                                                 max_size);
+}
+
+size_t
+cogl_pango_font_map_get_glyph_cache_max_size (CoglPangoFontMap *fm)
+{
+  PangoRenderer *renderer = _cogl_pango_font_map_get_renderer (fm);
+
+  return
+    _cogl_pango_renderer_get_glyph_cache_max_size (COGL_PANGO_RENDERER (renderer));
+}
+
+void
+cogl_pango_font_map_get_glyph_cache_stats (CoglPangoFontMap *fm,
+                                           unsigned int     *n_hits,
+                                           unsigned int     *n_misses,
+                                           unsigned int     *n_evictions,
+                                           size_t           *resident_bytes)
+{
+  PangoRenderer *renderer = _cogl_pango_font_map_get_renderer (fm);
+  CoglPangoGlyphCacheStats stats;
+
+  _cogl_pango_renderer_get_glyph_cache_stats (COGL_PANGO_RENDERER (renderer),
+                                              &stats);
+
+  if (n_hits)
+    *n_hits = stats.n_hits;
+  if (n_misses)
+    *n_misses = stats.n_misses;
+  if (n_evictions)
+    *n_evictions = stats.n_evictions;
+  if (resident_bytes)
+    *resident_bytes = stats.resident_bytes;
+}
+
 static GQuark
 cogl_pango_font_map_get_priv_key (void)
 {
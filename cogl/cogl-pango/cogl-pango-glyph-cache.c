@@ -31,12 +31,16 @@
 #endif
 
 #include <glib.h>
+#include <string.h>
 
 #include "cogl-pango-glyph-cache.h"
 #include "cogl-pango-private.h"
 #include "cogl/cogl-atlas.h"
 #include "cogl/cogl-atlas-texture-private.h"
 
+/* Default limit on the texture memory used by the glyphs of a cache */
+#define COGL_PANGO_GLYPH_CACHE_DEFAULT_MAX_SIZE (8 * 1024 * 1024)
+
 typedef struct _CoglPangoGlyphCacheKey     CoglPangoGlyphCacheKey;
 
 struct _CoglPangoGlyphCache
@@ -66,6 +70,16 @@ struct _CoglPangoGlyphCache
   /* Whether mipmapping is being used for this cache. This only
      affects whether we decide to put the glyph in the global atlas */
   CoglBool          use_mipmapping;
+
+  /* Keys of all the cached glyphs with the most recently used glyph
+     at the head */
+  GQueue            lru;
+
+  /* Once the glyphs use more texture memory than this the least
+     recently used ones get evicted. Zero means there is no limit */
+  size_t            max_size;
+
+  CoglPangoGlyphCacheStats stats;
 };
 
 struct _CoglPangoGlyphCacheKey
@@ -144,6 +158,10 @@ cogl_pango_glyph_cache_new (CoglContext *ctx,
 
   cache->use_mipmapping = use_mipmapping;
 
+  g_queue_init (&cache->lru);
+  cache->max_size = COGL_PANGO_GLYPH_CACHE_DEFAULT_MAX_SIZE;
+  memset (&cache->stats, 0, sizeof (cache->stats));
+
   return cache;
 }
 
@@ -151,6 +169,19 @@ static void
 cogl_pango_glyph_cache_reorganize_cb (void *user_data)
 {
   CoglPangoGlyphCache *cache = user_data;
+  GSList *l;
+
+  /* Glyphs that moved in one of our own atlases have been marked as
+     dirty. A defragmentation can move them outside of a lookup so we
+     can't rely on the glyphs being added to have set this */
+  cache->has_dirty_glyphs = TRUE;
+
+  /* Display lists keep a reference on the textures they use, which
+     keep the glyphs that haven't moved yet. So they only need to be
+     rebuilt once, after the last slice of a defragmentation */
+  for (l = cache->atlases; l; l = l->next)
+    if (_cogl_atlas_is_migrating (l->data))
+      return;
 
   g_hook_list_invoke (&cache->reorganize_callbacks, FALSE);
 }
@@ -163,7 +194,9 @@ cogl_pango_glyph_cache_clear (CoglPangoGlyphCache *cache)
   cache->atlases = NULL;
   cache->has_dirty_glyphs = FALSE;
 
+  g_queue_clear (&cache->lru);
   g_hash_table_remove_all (cache->hash_table);
+  cache->stats.resident_bytes = 0;
 }
 
 void
@@ -239,6 +272,7 @@ cogl_pango_glyph_cache_add_to_global_atlas (CoglPangoGlyphCache *cache,
     }
 
   value->texture = COGL_TEXTURE (texture);
+  value->n_bytes = value->draw_width * value->draw_height * 4;
   value->tx1 = 0;
   value->ty1 = 0;
   value->tx2 = 1;
@@ -306,6 +340,9 @@ cogl_pango_glyph_cache_add_to_local_atlas (CoglPangoGlyphCache *cache,
       cache->atlases = g_slist_prepend (cache->atlases, atlas);
     }
 
+  value->atlas = atlas;
+  value->n_bytes = (value->draw_width + 1) * (value->draw_height + 1);
+
   return TRUE;
 }
 
@@ -323,13 +360,29 @@ cogl_pango_glyph_cache_lookup (CoglPangoGlyphCache *cache,
 
   value = g_hash_table_lookup (cache->hash_table, &lookup_key);
 
-  if (create && value == NULL)
+  if (value)
+    {
+      if (create)
+        cache->stats.n_hits++;
+
+      /* Move the glyph to the head of the list of recently used glyphs */
+      if (value->lru_link != cache->lru.head)
+        {
+          g_queue_unlink (&cache->lru, value->lru_link);
+          g_queue_push_head_link (&cache->lru, value->lru_link);
+        }
+    }
+  else if (create)
     {
       CoglPangoGlyphCacheKey *key;
       PangoRectangle ink_rect;
 
+      cache->stats.n_misses++;
+
       value = g_slice_new (CoglPangoGlyphCacheValue);
       value->texture = NULL;
+      value->atlas = NULL;
+      value->n_bytes = 0;
 
       pango_font_get_glyph_extents (font, glyph, &ink_rect, NULL);
       pango_extents_to_pixels (&ink_rect, NULL);
@@ -368,12 +421,119 @@ cogl_pango_glyph_cache_lookup (CoglPangoGlyphCache *cache,
       key->font = g_object_ref (font);
       key->glyph = glyph;
 
+      value->lru_link = g_list_alloc ();
+      value->lru_link->data = key;
+      g_queue_push_head_link (&cache->lru, value->lru_link);
+      cache->stats.resident_bytes += value->n_bytes;
+
       g_hash_table_insert (cache->hash_table, key, value);
     }
 
   return value;
 }
 
+static void
+cogl_pango_glyph_cache_evict (CoglPangoGlyphCache *cache,
+                              GList *link)
+{
+  CoglPangoGlyphCacheKey *key = link->data;
+  CoglPangoGlyphCacheValue *value;
+
+  value = g_hash_table_lookup (cache->hash_table, key);
+
+  g_queue_unlink (&cache->lru, link);
+  g_list_free_1 (link);
+  value->lru_link = NULL;
+
+  /* Give the space back to the local atlas so another glyph can use
+     it. Glyphs in the global atlas release their space when the
+     texture is destroyed */
+  if (value->atlas)
+    {
+      CoglRectangleMapEntry rectangle;
+
+      rectangle.x = value->tx_pixel;
+      rectangle.y = value->ty_pixel;
+      rectangle.width = value->draw_width + 1;
+      rectangle.height = value->draw_height + 1;
+
+      _cogl_atlas_remove (value->atlas, &rectangle, value);
+    }
+
+  cache->stats.resident_bytes -= value->n_bytes;
+  cache->stats.n_evictions++;
+
+  g_hash_table_remove (cache->hash_table, key);
+}
+
+void
+_cogl_pango_glyph_cache_trim (CoglPangoGlyphCache *cache)
+{
+  unsigned int n_evicted = 0;
+  GSList *l, *next;
+
+  if (cache->max_size == 0 ||
+      cache->stats.resident_bytes <= cache->max_size)
+    return;
+
+  /* Evict down to a bit below the limit so that we don't end up
+     evicting a few glyphs every time a layout adds new ones */
+  while (cache->lru.tail &&
+         cache->stats.resident_bytes > cache->max_size / 4 * 3)
+    {
+      cogl_pango_glyph_cache_evict (cache, cache->lru.tail);
+      n_evicted++;
+    }
+
+  /* Drop the local atlases that no longer hold any glyphs so that
+     their textures get freed */
+  for (l = cache->atlases; l; l = next)
+    {
+      CoglAtlas *atlas = l->data;
+
+      next = l->next;
+
+      if (atlas->map == NULL ||
+          _cogl_rectangle_map_get_n_rectangles (atlas->map) == 0)
+        {
+          cogl_object_unref (atlas);
+          cache->atlases = g_slist_delete_link (cache->atlases, l);
+        }
+    }
+
+  COGL_NOTE (PANGO, "%p: Evicted %u glyphs; %u glyphs using %" G_GSIZE_FORMAT
+             " bytes remain, %u hits, %u misses, %u evictions so far",
+             cache, n_evicted,
+             g_hash_table_size (cache->hash_table),
+             cache->stats.resident_bytes,
+             cache->stats.n_hits,
+             cache->stats.n_misses,
+             cache->stats.n_evictions);
+
+  /* The space of the evicted glyphs may be reused so anything that
+     refers to their position needs to be rebuilt */
+  g_hook_list_invoke (&cache->reorganize_callbacks, FALSE);
+}
+
+void
+_cogl_pango_glyph_cache_set_max_size (CoglPangoGlyphCache *cache,
+                                      size_t max_size)
+{
+  cache->max_size = max_size;
+}
+
+size_t
+_cogl_pango_glyph_cache_get_max_size (CoglPangoGlyphCache *cache)
+{
+  return cache->max_size;
+}
+
+const CoglPangoGlyphCacheStats *
+_cogl_pango_glyph_cache_get_stats (CoglPangoGlyphCache *cache)
+{
+  return &cache->stats;
+}
+
 static void
 _cogl_pango_glyph_cache_set_dirty_glyphs_cb (void *key_ptr,
                                              void *value_ptr,
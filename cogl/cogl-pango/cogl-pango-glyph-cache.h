@@ -33,6 +33,7 @@
 #include <pango/pango-font.h>
 
 #include "cogl/cogl-texture.h"
+#include "cogl/cogl-atlas.h"
 
 COGL_BEGIN_DECLS
 
@@ -59,8 +60,31 @@ struct _CoglPangoGlyphCacheValue
   /* This will be set to TRUE when the glyph atlas is reorganized
      which means the glyph will need to be redrawn */
   CoglBool   dirty;
+
+  /* The local atlas holding the glyph or NULL if it is in the global
+     atlas. The cache owns the reference on the atlas */
+  CoglAtlas *atlas;
+
+  /* Number of bytes of texture memory used by the glyph */
+  size_t     n_bytes;
+
+  /* Link in the cache's list of glyphs ordered by last use. The data
+     of the link is the hash table key for the glyph */
+  GList     *lru_link;
 };
 
+typedef struct _CoglPangoGlyphCacheStats
+{
+  /* Lookups that found the glyph already cached and lookups that had
+     to add it */
+  unsigned int n_hits;
+  unsigned int n_misses;
+  /* Number of glyphs dropped to stay within the size limit */
+  unsigned int n_evictions;
+  /* Texture memory used by the glyphs currently in the cache */
+  size_t resident_bytes;
+} CoglPangoGlyphCacheStats;
+
 typedef void (* CoglPangoGlyphCacheDirtyFunc) (PangoFont *font,
                                                PangoGlyph glyph,
                                                CoglPangoGlyphCacheValue *value);
@@ -81,6 +105,19 @@ cogl_pango_glyph_cache_lookup (CoglPangoGlyphCache *cache,
 void
 cogl_pango_glyph_cache_clear (CoglPangoGlyphCache *cache);
 
+void
+_cogl_pango_glyph_cache_set_max_size (CoglPangoGlyphCache *cache,
+                                      size_t max_size);
+
+size_t
+_cogl_pango_glyph_cache_get_max_size (CoglPangoGlyphCache *cache);
+
+void
+_cogl_pango_glyph_cache_trim (CoglPangoGlyphCache *cache);
+
+const CoglPangoGlyphCacheStats *
+_cogl_pango_glyph_cache_get_stats (CoglPangoGlyphCache *cache);
+
 void
 _cogl_pango_glyph_cache_add_reorganize_callback (CoglPangoGlyphCache *cache,
                                                  GHookFunc func,
@@ -37,6 +37,7 @@
 #define __COGL_PANGO_PRIVATE_H__
 
 #include "cogl-pango.h"
+#include "cogl-pango-glyph-cache.h"
 
 COGL_BEGIN_DECLS
 
@@ -52,6 +53,15 @@ _cogl_pango_renderer_set_use_mipmapping (CoglPangoRenderer *renderer,
 CoglBool
 _cogl_pango_renderer_get_use_mipmapping (CoglPangoRenderer *renderer);
 
+void
+_cogl_pango_renderer_set_glyph_cache_max_size (CoglPangoRenderer *renderer,
+                                               size_t max_size);
+size_t
+_cogl_pango_renderer_get_glyph_cache_max_size (CoglPangoRenderer *renderer);
+void
+_cogl_pango_renderer_get_glyph_cache_stats (CoglPangoRenderer *renderer,
+                                            CoglPangoGlyphCacheStats *stats);
+
 
 
 CoglContext *
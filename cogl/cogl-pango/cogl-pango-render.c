@@ -534,6 +534,40 @@ _cogl_pango_renderer_clear_glyph_cache (CoglPangoRenderer *renderer)
   cogl_pango_glyph_cache_clear (renderer->no_mipmap_caches.glyph_cache);
 }
 
+void
+_cogl_pango_renderer_set_glyph_cache_max_size (CoglPangoRenderer *renderer,
+                                               size_t max_size)
+{
+  _cogl_pango_glyph_cache_set_max_size (renderer->mipmap_caches.glyph_cache,
+                                        max_size);
+  _cogl_pango_glyph_cache_set_max_size (renderer->no_mipmap_caches.glyph_cache,
+                                        max_size);
+}
+
+size_t
+_cogl_pango_renderer_get_glyph_cache_max_size (CoglPangoRenderer *renderer)
+{
+  return
+    _cogl_pango_glyph_cache_get_max_size (renderer->no_mipmap_caches.glyph_cache);
+}
+
+void
+_cogl_pango_renderer_get_glyph_cache_stats (CoglPangoRenderer *renderer,
+                                            CoglPangoGlyphCacheStats *stats)
+{
+  const CoglPangoGlyphCacheStats *mipmap_stats =
+    _cogl_pango_glyph_cache_get_stats (renderer->mipmap_caches.glyph_cache);
+  const CoglPangoGlyphCacheStats *no_mipmap_stats =
+    _cogl_pango_glyph_cache_get_stats (renderer->no_mipmap_caches.glyph_cache);
+
+  stats->n_hits = mipmap_stats->n_hits + no_mipmap_stats->n_hits;
+  stats->n_misses = mipmap_stats->n_misses + no_mipmap_stats->n_misses;
+  stats->n_evictions =
+    mipmap_stats->n_evictions + no_mipmap_stats->n_evictions;
+  stats->resident_bytes =
+    mipmap_stats->resident_bytes + no_mipmap_stats->resident_bytes;
+}
+
 void
 _cogl_pango_renderer_set_use_mipmapping (CoglPangoRenderer *renderer,
                                          CoglBool value)
@@ -672,6 +706,15 @@ _cogl_pango_ensure_glyph_cache_for_layout_line_internal (PangoLayoutLine *line)
     }
 }
 
+static void
+_cogl_pango_trim_glyph_caches (CoglPangoRenderer *priv)
+{
+  /* This has to happen before any glyphs are looked up for a layout
+     so that none of the glyphs it is about to use get evicted */
+  _cogl_pango_glyph_cache_trim (priv->mipmap_caches.glyph_cache);
+  _cogl_pango_glyph_cache_trim (priv->no_mipmap_caches.glyph_cache);
+}
+
 static void
 _cogl_pango_set_dirty_glyphs (CoglPangoRenderer *priv)
 {
@@ -690,6 +733,8 @@ _cogl_pango_ensure_glyph_cache_for_layout_line (PangoLayoutLine *line)
   context = pango_layout_get_context (line->layout);
   priv = cogl_pango_get_renderer_from_context (context);
 
+  _cogl_pango_trim_glyph_caches (priv);
+
   _cogl_pango_ensure_glyph_cache_for_layout_line_internal (line);
 
   /* Now that we know all of the positions are settled we'll fill in
@@ -712,6 +757,8 @@ cogl_pango_ensure_glyph_cache_for_layout (PangoLayout *layout)
   if ((iter = pango_layout_get_iter (layout)) == NULL)
     return;
 
+  _cogl_pango_trim_glyph_caches (priv);
+
   do
     {
       PangoLayoutLine *line;
@@ -160,6 +160,62 @@ cogl_pango_font_map_set_use_mipmapping (CoglPangoFontMap *font_map,
 CoglBool
 cogl_pango_font_map_get_use_mipmapping (CoglPangoFontMap *font_map);
 
+/**
+ * cogl_pango_font_map_set_glyph_cache_max_size:
+ * @font_map: a #CoglPangoFontMap
+ * @max_size: the limit in bytes, or 0 for no limit
+ *
+ * Limits the texture memory used to cache the glyphs rendered with
+ * @font_map. Once the cached glyphs use more than @max_size bytes the
+ * ones that were used least recently are evicted. The limit applies
+ * separately to mipmapped and non-mipmapped glyphs.
+ *
+ * Since: 1.22
+ */
+void
+cogl_pango_font_map_set_glyph_cache_max_size (CoglPangoFontMap *font_map,
+                                              size_t max_size);
+
+/**
+ * cogl_pango_font_map_get_glyph_cache_max_size:
+ * @font_map: a #CoglPangoFontMap
+ *
+ * Retrieves the limit set with
+ * cogl_pango_font_map_set_glyph_cache_max_size().
+ *
+ * Return value: the limit in bytes, or 0 if there is no limit
+ *
+ * Since: 1.22
+ */
+size_t
+cogl_pango_font_map_get_glyph_cache_max_size (CoglPangoFontMap *font_map);
+
+/**
+ * cogl_pango_font_map_get_glyph_cache_stats:
+ * @font_map: a #CoglPangoFontMap
+ * @n_hits: (out) (optional): return location for the number of glyph
+ *   lookups that found the glyph already cached
+ * @n_misses: (out) (optional): return location for the number of
+ *   glyph lookups that had to render the glyph
+ * @n_evictions: (out) (optional): return location for the number of
+ *   glyphs evicted to stay within the limit set with
+ *   cogl_pango_font_map_set_glyph_cache_max_size()
+ * @resident_bytes: (out) (optional): return location for the texture
+ *   memory used by the glyphs that are currently cached, in bytes
+ *
+ * Retrieves statistics about the glyph cache of @font_map, summed
+ * over the mipmapped and non-mipmapped glyphs. The counters are not
+ * reset by cogl_pango_font_map_clear_glyph_cache().
+ *
+ * Since: 1.22
+ */
+void
+cogl_pango_font_map_get_glyph_cache_stats (CoglPangoFontMap *font_map,
+                                           unsigned int *n_hits,
+                                           unsigned int *n_misses,
+                                           unsigned int *n_evictions,
+                                           size_t *resident_bytes);
+
 /**
  * cogl_pango_font_map_get_renderer:
  * @font_map: a #CoglPangoFontMap
@@ -187,8 +187,11 @@ _cogl_atlas_texture_post_reorganize_cb (void *user_data)
       g_free (data.textures);
     }
 
-  /* Notify any listeners that an atlas has changed */
-  g_hook_list_invoke (&ctx->atlas_reorganize_callbacks, FALSE);
+  /* Notify any listeners that an atlas has changed. While it is being
+     defragmented, this is only done once the last slice has been
+     migrated, so that they don't rebuild their caches every frame */
+  if (!_cogl_atlas_is_migrating (atlas))
+    g_hook_list_invoke (&ctx->atlas_reorganize_callbacks, FALSE);
 }
 
 static void
@@ -273,7 +276,8 @@ _cogl_atlas_texture_remove_from_atlas (CoglAtlasTexture *atlas_tex)
   if (atlas_tex->atlas)
     {
       _cogl_atlas_remove (atlas_tex->atlas,
-                          &atlas_tex->rectangle);
+                          &atlas_tex->rectangle,
+                          atlas_tex);
 
       cogl_object_unref (atlas_tex->atlas);
       atlas_tex->atlas = NULL;
@@ -389,6 +393,7 @@ _cogl_atlas_texture_migrate_out_of_atlas (CoglAtlasTexture *atlas_tex)
 
   standalone_tex =
     _cogl_atlas_copy_rectangle (atlas_tex->atlas,
+                                atlas_tex,
                                 atlas_tex->rectangle.x + 1,
                                 atlas_tex->rectangle.y + 1,
                                 atlas_tex->rectangle.width - 2,
@@ -457,10 +462,11 @@ _cogl_atlas_texture_set_region_with_border (CoglAtlasTexture *atlas_tex,
                                             CoglBitmap *bmp,
                                             CoglError **error)
 {
-  CoglAtlas *atlas = atlas_tex->atlas;
+  CoglTexture *texture =
+    _cogl_atlas_get_rectangle_texture (atlas_tex->atlas, atlas_tex);
 
   /* Copy the central data */
-  if (!_cogl_texture_set_region_from_bitmap (atlas->texture,
+  if (!_cogl_texture_set_region_from_bitmap (texture,
                                              src_x, src_y,
                                              dst_width,
                                              dst_height,
@@ -473,7 +479,7 @@ _cogl_atlas_texture_set_region_with_border (CoglAtlasTexture *atlas_tex,
 
   /* Update the left edge pixels */
   if (dst_x == 0 &&
-      !_cogl_texture_set_region_from_bitmap (atlas->texture,
+      !_cogl_texture_set_region_from_bitmap (texture,
                                              src_x, src_y,
                                              1, dst_height,
                                              bmp,
@@ -484,7 +490,7 @@ _cogl_atlas_texture_set_region_with_border (CoglAtlasTexture *atlas_tex,
     return FALSE;
   /* Update the right edge pixels */
   if (dst_x + dst_width == atlas_tex->rectangle.width - 2 &&
-      !_cogl_texture_set_region_from_bitmap (atlas->texture,
+      !_cogl_texture_set_region_from_bitmap (texture,
                                              src_x + dst_width - 1, src_y,
                                              1, dst_height,
                                              bmp,
@@ -496,7 +502,7 @@ _cogl_atlas_texture_set_region_with_border (CoglAtlasTexture *atlas_tex,
     return FALSE;
   /* Update the top edge pixels */
   if (dst_y == 0 &&
-      !_cogl_texture_set_region_from_bitmap (atlas->texture,
+      !_cogl_texture_set_region_from_bitmap (texture,
                                              src_x, src_y,
                                              dst_width, 1,
                                              bmp,
@@ -507,7 +513,7 @@ _cogl_atlas_texture_set_region_with_border (CoglAtlasTexture *atlas_tex,
     return FALSE;
   /* Update the bottom edge pixels */
   if (dst_y + dst_height == atlas_tex->rectangle.height - 2 &&
-      !_cogl_texture_set_region_from_bitmap (atlas->texture,
+      !_cogl_texture_set_region_from_bitmap (texture,
                                              src_x, src_y + dst_height - 1,
                                              dst_width, 1,
                                              bmp,
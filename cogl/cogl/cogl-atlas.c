@@ -33,6 +33,8 @@
 #include "cogl-config.h"
 #endif
 
+#include <test-fixtures/test-unit.h>
+
 #include "cogl-atlas.h"
 #include "cogl-rectangle-map.h"
 #include "cogl-context-private.h"
@@ -45,11 +47,26 @@
 #include "cogl-framebuffer-private.h"
 #include "cogl-blit.h"
 #include "cogl-private.h"
+#include "cogl-poll-private.h"
 
 #include <stdlib.h>
+#include <string.h>
+
+/* Repacking a fragmented atlas that would mean migrating more pixels
+ * than this in one go is not done while reserving space. Instead the
+ * reservation fails so that the caller uses another atlas, and the
+ * atlas gets defragmented a slice of about this many pixels per frame,
+ * from an idle handler added after each frame is swapped. */
+#define COGL_ATLAS_MIGRATION_SLICE_SIZE (256 * 256)
+
+/* If no frame is swapped for this long, for example because nothing on
+ * screen changes, the next slice is migrated anyway */
+#define COGL_ATLAS_IDLE_SLICE_INTERVAL_US (G_USEC_PER_SEC / 60)
 
 static void _cogl_atlas_free (CoglAtlas *atlas);
 
+static void _cogl_atlas_end_defragment (CoglAtlas *atlas);
+
 COGL_OBJECT_INTERNAL_DEFINE (Atlas, atlas);
 
 CoglAtlas *
@@ -67,6 +84,16 @@ _cogl_atlas_new (CoglPixelFormat texture_format,
   g_hook_list_init (&atlas->pre_reorganize_callbacks, sizeof (GHook));
   g_hook_list_init (&atlas->post_reorganize_callbacks, sizeof (GHook));
 
+  atlas->defragmenting = FALSE;
+  atlas->defragment_idle = NULL;
+  atlas->old_texture = NULL;
+  atlas->moves = NULL;
+  atlas->n_moves = 0;
+  atlas->next_move = 0;
+  atlas->pending_moves = NULL;
+
+  memset (&atlas->stats, 0, sizeof (atlas->stats));
+
   return _cogl_atlas_object_new (atlas);
 }
 
@@ -75,6 +102,19 @@ _cogl_atlas_free (CoglAtlas *atlas)
 {
   COGL_NOTE (ATLAS, "%p: Atlas destroyed", atlas);
 
+  if (atlas->old_texture)
+    _cogl_atlas_end_defragment (atlas);
+  if (atlas->defragment_idle)
+    _cogl_closure_disconnect (atlas->defragment_idle);
+  if (atlas->defragmenting)
+    {
+      CoglContext *ctx = _cogl_context_get_default ();
+
+      if (ctx)
+        ctx->defragmenting_atlases =
+          g_list_remove (ctx->defragmenting_atlases, atlas);
+    }
+
   if (atlas->texture)
     cogl_object_unref (atlas->texture);
   if (atlas->map)
@@ -86,14 +126,14 @@ _cogl_atlas_free (CoglAtlas *atlas)
   g_free (atlas);
 }
 
-typedef struct _CoglAtlasRepositionData
+struct _CoglAtlasRepositionData
 {
   /* The current user data for this texture */
   void *user_data;
   /* The old and new positions of the texture */
   CoglRectangleMapEntry old_position;
   CoglRectangleMapEntry new_position;
-} CoglAtlasRepositionData;
+};
 
 static void
 _cogl_atlas_migrate (CoglAtlas               *atlas,
@@ -124,13 +164,20 @@ _cogl_atlas_migrate (CoglAtlas               *atlas,
           /* Skip the texture that is being added because it doesn't contain
              any data yet */
           if (textures[i].user_data != skip_user_data)
-            _cogl_blit (&blit_data,
-                        textures[i].old_position.x,
-                        textures[i].old_position.y,
-                        textures[i].new_position.x,
-                        textures[i].new_position.y,
-                        textures[i].new_position.width,
-                        textures[i].new_position.height);
+            {
+              _cogl_blit (&blit_data,
+                          textures[i].old_position.x,
+                          textures[i].old_position.y,
+                          textures[i].new_position.x,
+                          textures[i].new_position.y,
+                          textures[i].new_position.width,
+                          textures[i].new_position.height);
+
+              atlas->stats.n_migrated_rectangles++;
+              atlas->stats.n_migrated_pixels +=
+                textures[i].new_position.width *
+                textures[i].new_position.height;
+            }
 
           /* Update the texture position */
           atlas->update_position_cb (textures[i].user_data,
@@ -364,6 +411,307 @@ _cogl_atlas_notify_post_reorganize (CoglAtlas *atlas)
   g_hook_list_invoke (&atlas->post_reorganize_callbacks, FALSE);
 }
 
+static CoglBool
+_cogl_atlas_begin_defragment (CoglAtlas *atlas)
+{
+  CoglAtlasGetRectanglesData data;
+  CoglRectangleMap *new_map;
+  CoglTexture2D *new_tex;
+  unsigned int i;
+
+  if (atlas->map == NULL ||
+      _cogl_rectangle_map_get_n_rectangles (atlas->map) == 0)
+    return FALSE;
+
+  data.textures = g_new (CoglAtlasRepositionData,
+                         _cogl_rectangle_map_get_n_rectangles (atlas->map));
+  data.n_textures = 0;
+  _cogl_rectangle_map_foreach (atlas->map,
+                               _cogl_atlas_get_rectangles_cb,
+                               &data);
+
+  qsort (data.textures, data.n_textures,
+         sizeof (CoglAtlasRepositionData),
+         _cogl_atlas_compare_size_cb);
+
+  /* Repacking the rectangles from scratch into an atlas of the same
+     size gets rid of the holes left by removed rectangles */
+  new_map = _cogl_atlas_create_map (atlas->texture_format,
+                                    _cogl_rectangle_map_get_width (atlas->map),
+                                    _cogl_rectangle_map_get_height (atlas->map),
+                                    data.n_textures, data.textures);
+  if (new_map == NULL)
+    {
+      g_free (data.textures);
+      return FALSE;
+    }
+
+  new_tex = _cogl_atlas_create_texture (atlas,
+                                        _cogl_rectangle_map_get_width (new_map),
+                                        _cogl_rectangle_map_get_height (new_map));
+  if (new_tex == NULL)
+    {
+      COGL_NOTE (ATLAS, "%p: Could not create a CoglTexture2D", atlas);
+      _cogl_rectangle_map_free (new_map);
+      g_free (data.textures);
+      return FALSE;
+    }
+
+  COGL_NOTE (ATLAS, "%p: Defragmenting atlas with %u textures into %ix%i",
+             atlas, data.n_textures,
+             _cogl_rectangle_map_get_width (new_map),
+             _cogl_rectangle_map_get_height (new_map));
+
+  /* From now on new rectangles are placed in the new map and texture
+     while the existing ones are moved over slice by slice */
+  _cogl_rectangle_map_free (atlas->map);
+  atlas->map = new_map;
+  atlas->old_texture = atlas->texture;
+  atlas->texture = COGL_TEXTURE (new_tex);
+
+  atlas->moves = data.textures;
+  atlas->n_moves = data.n_textures;
+  atlas->next_move = 0;
+  atlas->pending_moves = g_hash_table_new (NULL, NULL);
+  for (i = 0; i < data.n_textures; i++)
+    g_hash_table_insert (atlas->pending_moves,
+                         data.textures[i].user_data,
+                         &data.textures[i]);
+
+  return TRUE;
+}
+
+static void
+_cogl_atlas_end_defragment (CoglAtlas *atlas)
+{
+  cogl_object_unref (atlas->old_texture);
+  atlas->old_texture = NULL;
+
+  g_free (atlas->moves);
+  atlas->moves = NULL;
+  atlas->n_moves = 0;
+  atlas->next_move = 0;
+
+  g_hash_table_destroy (atlas->pending_moves);
+  atlas->pending_moves = NULL;
+}
+
+/* Slices are migrated one frame apart, and the reorganize callbacks
+   are invoked around each of them. Until the last slice has been
+   migrated, the rectangles that haven't moved yet are still valid in
+   their old texture, so callbacks that only need to know about the
+   final layout can wait for this to return FALSE */
+CoglBool
+_cogl_atlas_is_migrating (CoglAtlas *atlas)
+{
+  return atlas->old_texture != NULL;
+}
+
+static void
+_cogl_atlas_defragment_slice (CoglAtlas *atlas)
+{
+  CoglBlitData blit_data;
+  unsigned int n_pixels = 0;
+  int64_t start_time;
+
+  start_time = g_get_monotonic_time ();
+
+  _cogl_atlas_notify_pre_reorganize (atlas);
+
+  if (!(atlas->flags & COGL_ATLAS_DISABLE_MIGRATION))
+    _cogl_blit_begin (&blit_data, atlas->texture, atlas->old_texture);
+
+  while (atlas->next_move < atlas->n_moves &&
+         n_pixels < COGL_ATLAS_MIGRATION_SLICE_SIZE)
+    {
+      CoglAtlasRepositionData *move = &atlas->moves[atlas->next_move++];
+
+      /* The rectangle was removed since the defragmentation started */
+      if (move->user_data == NULL)
+        continue;
+
+      if (!(atlas->flags & COGL_ATLAS_DISABLE_MIGRATION))
+        _cogl_blit (&blit_data,
+                    move->old_position.x,
+                    move->old_position.y,
+                    move->new_position.x,
+                    move->new_position.y,
+                    move->new_position.width,
+                    move->new_position.height);
+
+      atlas->update_position_cb (move->user_data,
+                                 atlas->texture,
+                                 &move->new_position);
+
+      g_hash_table_remove (atlas->pending_moves, move->user_data);
+
+      n_pixels += move->new_position.width * move->new_position.height;
+      atlas->stats.n_migrated_rectangles++;
+    }
+
+  if (!(atlas->flags & COGL_ATLAS_DISABLE_MIGRATION))
+    _cogl_blit_end (&blit_data);
+
+  atlas->stats.n_migrated_pixels += n_pixels;
+  atlas->stats.n_defragment_slices++;
+  atlas->stats.max_migration_time =
+    MAX (atlas->stats.max_migration_time,
+         g_get_monotonic_time () - start_time);
+
+  /* Release the old texture before the last notification, so that
+     listeners can tell that the defragmentation is complete */
+  if (atlas->next_move >= atlas->n_moves)
+    _cogl_atlas_end_defragment (atlas);
+
+  _cogl_atlas_notify_post_reorganize (atlas);
+}
+
+static int64_t
+_cogl_atlas_defragment_poll_prepare (void *user_data)
+{
+  CoglContext *ctx = user_data;
+  int64_t now;
+
+  if (ctx->defragmenting_atlases == NULL)
+    return -1;
+
+  now = g_get_monotonic_time ();
+
+  return MAX (ctx->defragment_deadline - now, 0);
+}
+
+static void
+_cogl_atlas_defragment_poll_dispatch (void *user_data,
+                                      int revents)
+{
+  CoglContext *ctx = user_data;
+
+  if (ctx->defragmenting_atlases != NULL &&
+      g_get_monotonic_time () >= ctx->defragment_deadline)
+    _cogl_atlas_continue_defragmentations ();
+}
+
+static void
+_cogl_atlas_wait_for_next_frame (CoglAtlas *atlas)
+{
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  if (ctx->defragmenting_atlases == NULL)
+    ctx->defragment_deadline =
+      g_get_monotonic_time () + COGL_ATLAS_IDLE_SLICE_INTERVAL_US;
+
+  ctx->defragmenting_atlases =
+    g_list_prepend (ctx->defragmenting_atlases, atlas);
+
+  if (!ctx->defragment_poll_source)
+    {
+      ctx->defragment_poll_source =
+        _cogl_poll_renderer_add_source (ctx->display->renderer,
+                                        _cogl_atlas_defragment_poll_prepare,
+                                        _cogl_atlas_defragment_poll_dispatch,
+                                        ctx);
+    }
+}
+
+static void
+_cogl_atlas_defragment_idle_cb (void *user_data)
+{
+  CoglAtlas *atlas = user_data;
+
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  /* Migrating can drop the last references on the rectangles and
+     with them the last reference on the atlas */
+  cogl_object_ref (atlas);
+
+  if (atlas->defragment_idle)
+    {
+      _cogl_closure_disconnect (atlas->defragment_idle);
+      atlas->defragment_idle = NULL;
+    }
+  ctx->defragmenting_atlases =
+    g_list_remove (ctx->defragmenting_atlases, atlas);
+
+  if (atlas->old_texture == NULL &&
+      !_cogl_atlas_begin_defragment (atlas))
+    {
+      atlas->defragmenting = FALSE;
+    }
+  else
+    {
+      _cogl_atlas_defragment_slice (atlas);
+
+      if (!_cogl_atlas_is_migrating (atlas))
+        {
+          atlas->defragmenting = FALSE;
+
+          atlas->stats.n_defragmentations++;
+
+          COGL_NOTE (ATLAS, "%p: Atlas defragmented; %u defragmentations in "
+                     "%u slices, %u reorganizations, %u refused reservations, "
+                     "%u rectangles and %" G_GUINT64_FORMAT " pixels "
+                     "migrated, longest migration took %" G_GINT64_FORMAT
+                     "us",
+                     atlas,
+                     atlas->stats.n_defragmentations,
+                     atlas->stats.n_defragment_slices,
+                     atlas->stats.n_reorganizations,
+                     atlas->stats.n_refused,
+                     atlas->stats.n_migrated_rectangles,
+                     atlas->stats.n_migrated_pixels,
+                     atlas->stats.max_migration_time);
+        }
+      else
+        {
+          /* Running the next slice straight away would keep the
+             main loop busy until the whole atlas is migrated, so
+             wait for the next frame */
+          _cogl_atlas_wait_for_next_frame (atlas);
+        }
+    }
+
+  cogl_object_unref (atlas);
+}
+
+static void
+_cogl_atlas_add_defragment_idle (CoglAtlas *atlas)
+{
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  atlas->defragment_idle =
+    _cogl_poll_renderer_add_idle (ctx->display->renderer,
+                                  _cogl_atlas_defragment_idle_cb,
+                                  atlas,
+                                  NULL);
+}
+
+static void
+_cogl_atlas_schedule_defragment (CoglAtlas *atlas)
+{
+  if (atlas->defragmenting)
+    return;
+
+  atlas->defragmenting = TRUE;
+  _cogl_atlas_add_defragment_idle (atlas);
+}
+
+/* Called after a frame is swapped, or when none was swapped for a
+   while, to let every atlas that is being defragmented migrate its
+   next slice */
+void
+_cogl_atlas_continue_defragmentations (void)
+{
+  GList *l;
+
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  for (l = ctx->defragmenting_atlases; l; l = l->next)
+    _cogl_atlas_add_defragment_idle (l->data);
+
+  g_list_free (ctx->defragmenting_atlases);
+  ctx->defragmenting_atlases = NULL;
+}
+
 CoglBool
 _cogl_atlas_reserve_space (CoglAtlas             *atlas,
                            unsigned int           width,
@@ -400,6 +748,40 @@ _cogl_atlas_reserve_space (CoglAtlas             *atlas,
       return TRUE;
     }
 
+  /* Wait for a pending defragmentation rather than reorganizing the
+     atlas twice; the caller can use another atlas in the meantime */
+  if (atlas->defragmenting)
+    {
+      atlas->stats.n_refused++;
+      return FALSE;
+    }
+
+  if (atlas->map)
+    {
+      unsigned int map_size = (_cogl_rectangle_map_get_width (atlas->map) *
+                               _cogl_rectangle_map_get_height (atlas->map));
+      unsigned int used_size =
+        map_size - _cogl_rectangle_map_get_remaining_space (atlas->map);
+
+      /* Migrating everything at once would stall the caller for too
+         long, so if the atlas has room for the rectangle but is too
+         fragmented to fit it, it'll get repacked a slice at a time
+         while the caller uses another atlas. A full atlas is still
+         grown straight away, since starting new atlases instead would
+         break up batching */
+      if (used_size > COGL_ATLAS_MIGRATION_SLICE_SIZE &&
+          (used_size + width * height) * 53 / 50 <= map_size)
+        {
+          COGL_NOTE (ATLAS, "%p: Atlas is fragmented, scheduling a "
+                     "defragmentation", atlas);
+
+          atlas->stats.n_refused++;
+          _cogl_atlas_schedule_defragment (atlas);
+
+          return FALSE;
+        }
+    }
+
   /* If we make it here then we need to reorganize the atlas. First
      we'll notify any users of the atlas that this is going to happen
      so that for example in CoglAtlasTexture it can notify that the
@@ -493,6 +875,8 @@ _cogl_atlas_reserve_space (CoglAtlas             *atlas,
 
       if (atlas->map)
         {
+          int64_t start_time = g_get_monotonic_time ();
+
           /* Move all the textures to the right position in the new
              texture. This will also update the texture's rectangle */
           _cogl_atlas_migrate (atlas,
@@ -503,6 +887,11 @@ _cogl_atlas_reserve_space (CoglAtlas             *atlas,
                                user_data);
           _cogl_rectangle_map_free (atlas->map);
           cogl_object_unref (atlas->texture);
+
+          atlas->stats.n_reorganizations++;
+          atlas->stats.max_migration_time =
+            MAX (atlas->stats.max_migration_time,
+                 g_get_monotonic_time () - start_time);
         }
       else
         /* We know there's only one texture so we can just directly
@@ -537,9 +926,24 @@ _cogl_atlas_reserve_space (CoglAtlas             *atlas,
 
 void
 _cogl_atlas_remove (CoglAtlas *atlas,
-                    const CoglRectangleMapEntry *rectangle)
+                    const CoglRectangleMapEntry *rectangle,
+                    void *user_data)
 {
-  _cogl_rectangle_map_remove (atlas->map, rectangle);
+  CoglAtlasRepositionData *move = NULL;
+
+  if (atlas->pending_moves)
+    move = g_hash_table_lookup (atlas->pending_moves, user_data);
+
+  /* If the rectangle hasn't been migrated yet then the map only knows
+     about its new position */
+  if (move)
+    {
+      _cogl_rectangle_map_remove (atlas->map, &move->new_position);
+      g_hash_table_remove (atlas->pending_moves, user_data);
+      move->user_data = NULL;
+    }
+  else
+    _cogl_rectangle_map_remove (atlas->map, rectangle);
 
   COGL_NOTE (ATLAS, "%p: Removed rectangle sized %ix%i",
              atlas,
@@ -605,8 +1009,22 @@ create_migration_texture (CoglContext *ctx,
   return tex;
 }
 
+CoglTexture *
+_cogl_atlas_get_rectangle_texture (CoglAtlas *atlas,
+                                   void *user_data)
+{
+  /* Rectangles waiting to be migrated by a defragmentation still have
+     their contents in the old texture */
+  if (atlas->pending_moves &&
+      g_hash_table_contains (atlas->pending_moves, user_data))
+    return atlas->old_texture;
+  else
+    return atlas->texture;
+}
+
 CoglTexture *
 _cogl_atlas_copy_rectangle (CoglAtlas *atlas,
+                            void *user_data,
                             int x,
                             int y,
                             int width,
@@ -631,7 +1049,8 @@ _cogl_atlas_copy_rectangle (CoglAtlas *atlas,
   /* Blit the data out of the atlas to the new texture. If FBOs
      aren't available this will end up having to copy the entire
      atlas texture */
-  _cogl_blit_begin (&blit_data, tex, atlas->texture);
+  _cogl_blit_begin (&blit_data, tex,
+                    _cogl_atlas_get_rectangle_texture (atlas, user_data));
   _cogl_blit (&blit_data,
                     x, y,
                     0, 0,
@@ -688,3 +1107,196 @@ _cogl_atlas_remove_reorganize_callback (CoglAtlas            *atlas,
         g_hook_destroy_link (&atlas->post_reorganize_callbacks, hook);
     }
 }
+
+#ifdef ENABLE_UNIT_TESTS
+
+#define TEST_RECTANGLE_SIZE 64
+
+typedef struct
+{
+  CoglTexture *texture;
+  CoglRectangleMapEntry rectangle;
+  uint8_t value;
+} TestRectangle;
+
+static void
+test_update_position_cb (void *user_data,
+                         CoglTexture *new_texture,
+                         const CoglRectangleMapEntry *rectangle)
+{
+  TestRectangle *test_rect = user_data;
+
+  test_rect->texture = new_texture;
+  test_rect->rectangle = *rectangle;
+}
+
+static void
+fill_test_rectangle (TestRectangle *test_rect)
+{
+  uint8_t *data;
+
+  data = g_malloc (TEST_RECTANGLE_SIZE * TEST_RECTANGLE_SIZE * 4);
+  memset (data, test_rect->value, TEST_RECTANGLE_SIZE * TEST_RECTANGLE_SIZE * 4);
+
+  cogl_texture_set_region (test_rect->texture,
+                           0, 0,
+                           test_rect->rectangle.x,
+                           test_rect->rectangle.y,
+                           TEST_RECTANGLE_SIZE, TEST_RECTANGLE_SIZE,
+                           TEST_RECTANGLE_SIZE, TEST_RECTANGLE_SIZE,
+                           COGL_PIXEL_FORMAT_RGBA_8888,
+                           TEST_RECTANGLE_SIZE * 4,
+                           data);
+
+  g_free (data);
+}
+
+typedef struct
+{
+  CoglAtlas *atlas;
+  unsigned int n_completed;
+} TestReorganizeData;
+
+static void
+test_post_reorganize_cb (void *user_data)
+{
+  TestReorganizeData *data = user_data;
+
+  if (!_cogl_atlas_is_migrating (data->atlas))
+    data->n_completed++;
+}
+
+UNIT_TEST (check_atlas_defragment,
+           0, /* requirements */
+           0 /* no failure cases */)
+{
+  TestRectangle *test_rects;
+  TestRectangle big_rect;
+  CoglAtlas *atlas;
+  unsigned int map_width, map_height;
+  unsigned int n_rects, i;
+  TestReorganizeData reorganize_data;
+  uint8_t *data;
+
+  atlas = _cogl_atlas_new (COGL_PIXEL_FORMAT_RGBA_8888,
+                           0,
+                           test_update_position_cb);
+
+  /* The first rectangle creates the atlas at its initial size.
+     Filling all of it with equally sized squares doesn't need any
+     reorganization */
+  test_rects = g_new0 (TestRectangle, 1);
+  g_assert (_cogl_atlas_reserve_space (atlas,
+                                       TEST_RECTANGLE_SIZE,
+                                       TEST_RECTANGLE_SIZE,
+                                       &test_rects[0]));
+
+  map_width = _cogl_rectangle_map_get_width (atlas->map);
+  map_height = _cogl_rectangle_map_get_height (atlas->map);
+  n_rects = ((map_width / TEST_RECTANGLE_SIZE) *
+             (map_height / TEST_RECTANGLE_SIZE));
+
+  /* Half of the atlas has to be more than can be migrated at once */
+  if (n_rects * TEST_RECTANGLE_SIZE * TEST_RECTANGLE_SIZE / 2 <=
+      COGL_ATLAS_MIGRATION_SLICE_SIZE)
+    {
+      g_free (test_rects);
+      cogl_object_unref (atlas);
+      return;
+    }
+
+  test_rects = g_renew (TestRectangle, test_rects, n_rects);
+  memset (test_rects + 1, 0, sizeof (TestRectangle) * (n_rects - 1));
+
+  for (i = 1; i < n_rects; i++)
+    g_assert (_cogl_atlas_reserve_space (atlas,
+                                         TEST_RECTANGLE_SIZE,
+                                         TEST_RECTANGLE_SIZE,
+                                         &test_rects[i]));
+
+  for (i = 0; i < n_rects; i++)
+    {
+      test_rects[i].value = i + 1;
+      fill_test_rectangle (&test_rects[i]);
+    }
+
+  /* Punch holes into the atlas that are too small for a bigger
+     rectangle even though there is plenty of space left overall */
+  for (i = 1; i < n_rects; i += 2)
+    _cogl_atlas_remove (atlas, &test_rects[i].rectangle, &test_rects[i]);
+
+  g_assert (!_cogl_atlas_reserve_space (atlas,
+                                        TEST_RECTANGLE_SIZE * 2,
+                                        TEST_RECTANGLE_SIZE * 2,
+                                        &big_rect));
+  g_assert_cmpint (atlas->stats.n_refused, ==, 1);
+  g_assert_cmpint (atlas->stats.n_reorganizations, ==, 0);
+  g_assert (atlas->defragmenting);
+
+  /* Listeners only need to see the end of the defragmentation */
+  reorganize_data.atlas = atlas;
+  reorganize_data.n_completed = 0;
+  _cogl_atlas_add_reorganize_callback (atlas,
+                                       NULL,
+                                       test_post_reorganize_cb,
+                                       &reorganize_data);
+
+  /* Nothing has moved until the idle handler runs */
+  for (i = 0; i < n_rects; i += 2)
+    g_assert (test_rects[i].texture == atlas->texture);
+
+  /* Only one slice is migrated per frame */
+  _cogl_atlas_defragment_idle_cb (atlas);
+  g_assert (atlas->defragmenting);
+  g_assert (atlas->defragment_idle == NULL);
+  g_assert (_cogl_atlas_is_migrating (atlas));
+  g_assert_cmpint (reorganize_data.n_completed, ==, 0);
+
+  while (atlas->defragmenting)
+    {
+      _cogl_atlas_continue_defragmentations ();
+      g_assert (atlas->defragment_idle != NULL);
+      _cogl_atlas_defragment_idle_cb (atlas);
+    }
+
+  g_assert_cmpint (atlas->stats.n_defragmentations, ==, 1);
+  g_assert_cmpint (atlas->stats.n_defragment_slices, >, 1);
+  g_assert_cmpint (atlas->stats.n_migrated_rectangles, ==, n_rects / 2);
+  g_assert (atlas->old_texture == NULL);
+  g_assert_cmpint (reorganize_data.n_completed, ==, 1);
+
+  /* Check that every rectangle kept its contents */
+  data = g_malloc (map_width * map_height * 4);
+  cogl_texture_get_data (atlas->texture,
+                         COGL_PIXEL_FORMAT_RGBA_8888,
+                         map_width * 4,
+                         data);
+
+  for (i = 0; i < n_rects; i += 2)
+    {
+      int x = test_rects[i].rectangle.x + TEST_RECTANGLE_SIZE / 2;
+      int y = test_rects[i].rectangle.y + TEST_RECTANGLE_SIZE / 2;
+
+      g_assert (test_rects[i].texture == atlas->texture);
+      g_assert_cmpint (data[(y * map_width + x) * 4], ==, test_rects[i].value);
+    }
+
+  g_free (data);
+
+  /* Now the bigger rectangle fits without any further reorganization */
+  g_assert (_cogl_atlas_reserve_space (atlas,
+                                       TEST_RECTANGLE_SIZE * 2,
+                                       TEST_RECTANGLE_SIZE * 2,
+                                       &big_rect));
+  g_assert_cmpint (atlas->stats.n_refused, ==, 1);
+  g_assert_cmpint (atlas->stats.n_reorganizations, ==, 0);
+
+  _cogl_atlas_remove_reorganize_callback (atlas,
+                                          NULL,
+                                          test_post_reorganize_cb,
+                                          &reorganize_data);
+  cogl_object_unref (atlas);
+  g_free (test_rects);
+}
+
+#endif /* ENABLE_UNIT_TESTS */
@@ -31,6 +31,7 @@
 
 #include "cogl-rectangle-map.h"
 #include "cogl-object-private.h"
+#include "cogl-closure-list-private.h"
 #include "cogl-texture.h"
 
 typedef void
@@ -48,6 +49,28 @@ typedef struct _CoglAtlas CoglAtlas;
 
 #define COGL_ATLAS(object) ((CoglAtlas *) object)
 
+typedef struct _CoglAtlasRepositionData CoglAtlasRepositionData;
+
+typedef struct _CoglAtlasStats
+{
+  /* Number of times the atlas was resized or repacked synchronously
+     while reserving space */
+  unsigned int n_reorganizations;
+  /* Number of times reserving space failed because repacking the
+     atlas would have meant migrating too much at once */
+  unsigned int n_refused;
+  /* Number of incremental defragmentations that completed, and the
+     number of slices they were done in */
+  unsigned int n_defragmentations;
+  unsigned int n_defragment_slices;
+  /* Rectangles and pixels moved to a new texture so far */
+  unsigned int n_migrated_rectangles;
+  uint64_t n_migrated_pixels;
+  /* The longest the atlas has blocked its caller to migrate
+     rectangles, in microseconds */
+  int64_t max_migration_time;
+} CoglAtlasStats;
+
 struct _CoglAtlas
 {
   CoglObject _parent;
@@ -62,6 +85,23 @@ struct _CoglAtlas
 
   GHookList pre_reorganize_callbacks;
   GHookList post_reorganize_callbacks;
+
+  /* Set while a defragmentation is scheduled or running */
+  CoglBool defragmenting;
+  /* The idle handler migrating the next slice. Between slices it is
+     unset while the atlas waits for the next frame to be swapped */
+  CoglClosure *defragment_idle;
+
+  /* While defragmenting, the map and texture above already describe
+     the new layout but the rectangles that still have a pending move
+     keep their contents in old_texture until a slice migrates them */
+  CoglTexture *old_texture;
+  CoglAtlasRepositionData *moves;
+  unsigned int n_moves;
+  unsigned int next_move;
+  GHashTable *pending_moves;
+
+  CoglAtlasStats stats;
 };
 
 CoglAtlas *
@@ -69,6 +109,12 @@ _cogl_atlas_new (CoglPixelFormat texture_format,
                  CoglAtlasFlags flags,
                  CoglAtlasUpdatePositionCallback update_position_cb);
 
+void
+_cogl_atlas_continue_defragmentations (void);
+
+CoglBool
+_cogl_atlas_is_migrating (CoglAtlas *atlas);
+
 CoglBool
 _cogl_atlas_reserve_space (CoglAtlas             *atlas,
                            unsigned int           width,
@@ -77,10 +123,16 @@ _cogl_atlas_reserve_space (CoglAtlas             *atlas,
 
 void
 _cogl_atlas_remove (CoglAtlas *atlas,
-                    const CoglRectangleMapEntry *rectangle);
+                    const CoglRectangleMapEntry *rectangle,
+                    void *user_data);
+
+CoglTexture *
+_cogl_atlas_get_rectangle_texture (CoglAtlas *atlas,
+                                   void *user_data);
 
 CoglTexture *
 _cogl_atlas_copy_rectangle (CoglAtlas *atlas,
+                            void *user_data,
                             int x,
                             int y,
                             int width,
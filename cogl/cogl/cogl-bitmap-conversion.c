@@ -36,6 +36,9 @@
 #include "cogl-bitmap-private.h"
 #include "cogl-context-private.h"
 #include "cogl-texture-private.h"
+#include "cogl-debug.h"
+
+#include <test-fixtures/test-unit.h>
 
 #include <string.h>
 
@@ -63,35 +66,124 @@
 #undef component_type
 #undef component_size
 
-/* (Un)Premultiplication */
+/* (Un)Premultiplication and swizzling of the 8888 formats
+ *
+ * These are on the path of every upload and read back that needs a
+ * conversion, so they are done for several pixels at once when the CPU
+ * allows it. SSE2 and NEON are checked at build time; SSSE3 and AVX2 are
+ * checked at runtime so that generic x86 builds still use them. All of
+ * the kernels give exactly the same results as the generic code, which
+ * is always used for the pixels left over at the end of a span and when
+ * COGL_DEBUG=disable-simd-conversion is set.
+ */
 
-inline static void
-_cogl_unpremult_alpha_0 (uint8_t *dst)
+#if defined(__SSE2__) && defined(__GNUC__) \
+  && (defined(__x86_64) || defined(__i386))
+#define COGL_CONVERSION_USE_SSE2
+#include <emmintrin.h>
+
+#if (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)) || \
+  defined(__clang__)
+#define COGL_CONVERSION_USE_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define COGL_CONVERSION_USE_NEON
+#include <arm_neon.h>
+#endif
+
+typedef enum
+{
+  CONVERSION_KERNEL_SSSE3 = 1 << 0,
+  CONVERSION_KERNEL_AVX2 = 1 << 1,
+} ConversionKernels;
+
+/* 255 / alpha as a 16.16 fixed point number, split into 16-bit halves
+ * and repeated for each component so that the SIMD kernels can load it
+ * directly. See _cogl_unpremult_component(). */
+typedef struct
 {
-  dst[0] = 0;
-  dst[1] = 0;
-  dst[2] = 0;
-  dst[3] = 0;
+  uint16_t lo[4];
+  uint16_t hi[4];
+} UnpremultReciprocal;
+
+static UnpremultReciprocal unpremult_reciprocals[256];
+
+static ConversionKernels
+get_conversion_kernels (void)
+{
+  static ConversionKernels kernels;
+  static gsize initialized = 0;
+
+  if (g_once_init_enter (&initialized))
+    {
+      int alpha;
+
+      /* Leaving the reciprocal of 0 at 0 clears transparent pixels */
+      for (alpha = 1; alpha < 256; alpha++)
+        {
+          uint32_t reciprocal = (255 * 65536 + alpha - 1) / alpha;
+          int i;
+
+          for (i = 0; i < 4; i++)
+            {
+              unpremult_reciprocals[alpha].lo[i] = reciprocal & 0xffff;
+              unpremult_reciprocals[alpha].hi[i] = reciprocal >> 16;
+            }
+        }
+
+      kernels = 0;
+#ifdef COGL_CONVERSION_USE_AVX2
+      __builtin_cpu_init ();
+      if (__builtin_cpu_supports ("ssse3"))
+        kernels |= CONVERSION_KERNEL_SSSE3;
+      if (__builtin_cpu_supports ("avx2"))
+        kernels |= CONVERSION_KERNEL_AVX2;
+#endif
+
+      g_once_init_leave (&initialized, 1);
+    }
+
+  return kernels;
+}
+
+static inline CoglBool
+use_simd_conversion (void)
+{
+  return !COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_SIMD_CONVERSION);
+}
+
+/* Computes (c * 255) / alpha, truncated to 8 bits, without dividing.
+ * The reciprocal is rounded up, and its error stays below the distance
+ * of any inexact quotient to the next integer, so the result is exact
+ * for all 8-bit c and alpha values, including c > alpha. */
+static inline uint8_t
+_cogl_unpremult_component (uint8_t c,
+                           const UnpremultReciprocal *reciprocal)
+{
+  return c * reciprocal->hi[0] + ((c * reciprocal->lo[0]) >> 16);
 }
 
 inline static void
 _cogl_unpremult_alpha_last (uint8_t *dst)
 {
-  uint8_t alpha = dst[3];
+  const UnpremultReciprocal *reciprocal = &unpremult_reciprocals[dst[3]];
 
-  dst[0] = (dst[0] * 255) / alpha;
-  dst[1] = (dst[1] * 255) / alpha;
-  dst[2] = (dst[2] * 255) / alpha;
+  dst[0] = _cogl_unpremult_component (dst[0], reciprocal);
+  dst[1] = _cogl_unpremult_component (dst[1], reciprocal);
+  dst[2] = _cogl_unpremult_component (dst[2], reciprocal);
 }
 
 inline static void
 _cogl_unpremult_alpha_first (uint8_t *dst)
 {
-  uint8_t alpha = dst[0];
+  const UnpremultReciprocal *reciprocal = &unpremult_reciprocals[dst[0]];
 
-  dst[1] = (dst[1] * 255) / alpha;
-  dst[2] = (dst[2] * 255) / alpha;
-  dst[3] = (dst[3] * 255) / alpha;
+  dst[1] = _cogl_unpremult_component (dst[1], reciprocal);
+  dst[2] = _cogl_unpremult_component (dst[2], reciprocal);
+  dst[3] = _cogl_unpremult_component (dst[3], reciprocal);
 }
 
 /* No division form of floor((c*a + 128)/255) (I first encountered
@@ -131,133 +223,532 @@ _cogl_premult_alpha_first (uint8_t *dst)
 
 #undef MULT
 
-/* Use the SSE optimized version to premult four pixels at once when
-   it is available. The same assembler code works for x86 and x86-64
-   because it doesn't refer to any non-SSE registers directly */
-#if defined(__SSE2__) && defined(__GNUC__) \
-  && (defined(__x86_64) || defined(__i386))
-#define COGL_USE_PREMULT_SSE2
-#endif
+/* The premultiplication kernels work on 16-bit intermediate values with
+ * the same rounding as MULT(). The alpha byte of each pixel is copied to
+ * the other three bytes so that every component gets multiplied, and
+ * the original alpha byte is put back afterwards. @alpha_shift is the
+ * position of the alpha byte within a little endian 32-bit pixel. */
+
+#ifdef COGL_CONVERSION_USE_SSE2
+static int
+_cogl_premult_span_8888_sse2 (uint8_t *data,
+                              int width,
+                              int alpha_shift)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i half = _mm_set1_epi16 (128);
+  const __m128i byte_mask = _mm_set1_epi32 (0xff);
+  const __m128i shift = _mm_cvtsi32_si128 (alpha_shift);
+  const __m128i alpha_mask = _mm_sll_epi32 (byte_mask, shift);
+  int x;
 
-#ifdef COGL_USE_PREMULT_SSE2
+  for (x = 0; x + 4 <= width; x += 4)
+    {
+      __m128i pixels = _mm_loadu_si128 ((const __m128i *) (data + x * 4));
+      __m128i alpha, lo, hi;
+
+      alpha = _mm_and_si128 (_mm_srl_epi32 (pixels, shift), byte_mask);
+      alpha = _mm_or_si128 (alpha, _mm_slli_epi32 (alpha, 8));
+      alpha = _mm_or_si128 (alpha, _mm_slli_epi32 (alpha, 16));
+
+      lo = _mm_mullo_epi16 (_mm_unpacklo_epi8 (pixels, zero),
+                            _mm_unpacklo_epi8 (alpha, zero));
+      hi = _mm_mullo_epi16 (_mm_unpackhi_epi8 (pixels, zero),
+                            _mm_unpackhi_epi8 (alpha, zero));
+      lo = _mm_add_epi16 (lo, half);
+      hi = _mm_add_epi16 (hi, half);
+      lo = _mm_srli_epi16 (_mm_add_epi16 (lo, _mm_srli_epi16 (lo, 8)), 8);
+      hi = _mm_srli_epi16 (_mm_add_epi16 (hi, _mm_srli_epi16 (hi, 8)), 8);
+
+      pixels = _mm_or_si128 (_mm_and_si128 (pixels, alpha_mask),
+                             _mm_andnot_si128 (alpha_mask,
+                                               _mm_packus_epi16 (lo, hi)));
+
+      _mm_storeu_si128 ((__m128i *) (data + x * 4), pixels);
+    }
 
-inline static void
-_cogl_premult_alpha_last_four_pixels_sse2 (uint8_t *p)
-{
-  /* 8 copies of 128 used below */
-  static const int16_t eight_halves[8] __attribute__ ((aligned (16))) =
-    { 128, 128, 128, 128, 128, 128, 128, 128 };
-  /* Mask of the rgb components of the four pixels */
-  static const int8_t just_rgb[16] __attribute__ ((aligned (16))) =
-    { 0xff, 0xff, 0xff, 0x00, 0xff, 0xff, 0xff, 0x00,
-      0xff, 0xff, 0xff, 0x00, 0xff, 0xff, 0xff, 0x00 };
-  /* Each SSE register only holds two pixels because we need to work
-     with 16-bit intermediate values. We still do four pixels by
-     interleaving two registers in the hope that it will pipeline
-     better */
-  asm (/* Load eight_halves into xmm5 for later */
-       "movdqa (%1), %%xmm5\n"
-       /* Clear xmm3 */
-       "pxor %%xmm3, %%xmm3\n"
-       /* Load two pixels from p into the low half of xmm0 */
-       "movlps (%0), %%xmm0\n"
-       /* Load the next set of two pixels from p into the low half of xmm1 */
-       "movlps 8(%0), %%xmm1\n"
-       /* Unpack 8 bytes from the low quad-words in each register to 8
-          16-bit values */
-       "punpcklbw %%xmm3, %%xmm0\n"
-       "punpcklbw %%xmm3, %%xmm1\n"
-       /* Copy alpha values of the first pixel in xmm0 to all
-          components of the first pixel in xmm2 */
-       "pshuflw $255, %%xmm0, %%xmm2\n"
-       /* same for xmm1 and xmm3 */
-       "pshuflw $255, %%xmm1, %%xmm3\n"
-       /* The above also copies the second pixel directly so we now
-          want to replace the RGB components with copies of the alpha
-          components */
-       "pshufhw $255, %%xmm2, %%xmm2\n"
-       "pshufhw $255, %%xmm3, %%xmm3\n"
-       /* Multiply the rgb components by the alpha */
-       "pmullw %%xmm2, %%xmm0\n"
-       "pmullw %%xmm3, %%xmm1\n"
-       /* Add 128 to each component */
-       "paddw %%xmm5, %%xmm0\n"
-       "paddw %%xmm5, %%xmm1\n"
-       /* Copy the results to temporary registers xmm4 and xmm5 */
-       "movdqa %%xmm0, %%xmm4\n"
-       "movdqa %%xmm1, %%xmm5\n"
-       /* Divide the results by 256 */
-       "psrlw $8, %%xmm0\n"
-       "psrlw $8, %%xmm1\n"
-       /* Add the temporaries back in */
-       "paddw %%xmm4, %%xmm0\n"
-       "paddw %%xmm5, %%xmm1\n"
-       /* Divide again */
-       "psrlw $8, %%xmm0\n"
-       "psrlw $8, %%xmm1\n"
-       /* Pack the results back as bytes */
-       "packuswb %%xmm1, %%xmm0\n"
-       /* Load just_rgb into xmm3 for later */
-       "movdqa (%2), %%xmm3\n"
-       /* Reload all four pixels into xmm2 */
-       "movups (%0), %%xmm2\n"
-       /* Mask out the alpha from the results */
-       "andps %%xmm3, %%xmm0\n"
-       /* Mask out the RGB from the original four pixels */
-       "andnps %%xmm2, %%xmm3\n"
-       /* Combine the two to get the right alpha values */
-       "orps %%xmm3, %%xmm0\n"
-       /* Write to memory */
-       "movdqu %%xmm0, (%0)\n"
-       : /* no outputs */
-       : "r" (p), "r" (eight_halves), "r" (just_rgb)
-       : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5");
-}
-
-#endif /* COGL_USE_PREMULT_SSE2 */
+  return x;
+}
+#endif /* COGL_CONVERSION_USE_SSE2 */
+
+#ifdef COGL_CONVERSION_USE_AVX2
+/* The unpacking and packing both work within 128 bit lanes, so the
+ * pixels come back out in the order they were loaded. */
+__attribute__ ((target ("avx2")))
+static int
+_cogl_premult_span_8888_avx2 (uint8_t *data,
+                              int width,
+                              int alpha_shift)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+  const __m256i half = _mm256_set1_epi16 (128);
+  const __m256i byte_mask = _mm256_set1_epi32 (0xff);
+  const __m128i shift = _mm_cvtsi32_si128 (alpha_shift);
+  const __m256i alpha_mask = _mm256_sll_epi32 (byte_mask, shift);
+  int x;
+
+  for (x = 0; x + 8 <= width; x += 8)
+    {
+      __m256i pixels =
+        _mm256_loadu_si256 ((const __m256i *) (data + x * 4));
+      __m256i alpha, lo, hi;
+
+      alpha = _mm256_and_si256 (_mm256_srl_epi32 (pixels, shift), byte_mask);
+      alpha = _mm256_or_si256 (alpha, _mm256_slli_epi32 (alpha, 8));
+      alpha = _mm256_or_si256 (alpha, _mm256_slli_epi32 (alpha, 16));
+
+      lo = _mm256_mullo_epi16 (_mm256_unpacklo_epi8 (pixels, zero),
+                               _mm256_unpacklo_epi8 (alpha, zero));
+      hi = _mm256_mullo_epi16 (_mm256_unpackhi_epi8 (pixels, zero),
+                               _mm256_unpackhi_epi8 (alpha, zero));
+      lo = _mm256_add_epi16 (lo, half);
+      hi = _mm256_add_epi16 (hi, half);
+      lo = _mm256_srli_epi16 (_mm256_add_epi16 (lo, _mm256_srli_epi16 (lo, 8)),
+                              8);
+      hi = _mm256_srli_epi16 (_mm256_add_epi16 (hi, _mm256_srli_epi16 (hi, 8)),
+                              8);
+
+      pixels = _mm256_or_si256 (_mm256_and_si256 (pixels, alpha_mask),
+                                _mm256_andnot_si256 (alpha_mask,
+                                                     _mm256_packus_epi16 (lo,
+                                                                          hi)));
+
+      _mm256_storeu_si256 ((__m256i *) (data + x * 4), pixels);
+    }
+
+  return x;
+}
+#endif /* COGL_CONVERSION_USE_AVX2 */
+
+#ifdef COGL_CONVERSION_USE_NEON
+/* (t + ((t + 128) >> 8) + 128) >> 8 is the same as MULT() */
+static inline uint8x16_t
+_cogl_premult_component_neon (uint8x16_t c,
+                              uint8x16_t alpha)
+{
+  uint16x8_t lo = vmull_u8 (vget_low_u8 (c), vget_low_u8 (alpha));
+  uint16x8_t hi = vmull_u8 (vget_high_u8 (c), vget_high_u8 (alpha));
+
+  return vcombine_u8 (vraddhn_u16 (lo, vrshrq_n_u16 (lo, 8)),
+                      vraddhn_u16 (hi, vrshrq_n_u16 (hi, 8)));
+}
+
+static int
+_cogl_premult_span_8888_neon (uint8_t *data,
+                              int width,
+                              int alpha_shift)
+{
+  int alpha_index = alpha_shift / 8;
+  int x, i;
+
+  for (x = 0; x + 16 <= width; x += 16)
+    {
+      uint8x16x4_t pixels = vld4q_u8 (data + x * 4);
+
+      for (i = 0; i < 4; i++)
+        {
+          if (i != alpha_index)
+            pixels.val[i] =
+              _cogl_premult_component_neon (pixels.val[i],
+                                            pixels.val[alpha_index]);
+        }
+
+      vst4q_u8 (data + x * 4, pixels);
+    }
+
+  return x;
+}
+#endif /* COGL_CONVERSION_USE_NEON */
 
 static void
-_cogl_bitmap_premult_unpacked_span_8 (uint8_t *data,
-                                      int width)
+_cogl_premult_span_8888 (uint8_t *data,
+                         int width,
+                         CoglBool alpha_first)
 {
-#ifdef COGL_USE_PREMULT_SSE2
+  int alpha_shift = alpha_first ? 0 : 24;
+  int x = 0;
+
+  if (use_simd_conversion ())
+    {
+#ifdef COGL_CONVERSION_USE_AVX2
+      if (get_conversion_kernels () & CONVERSION_KERNEL_AVX2)
+        x = _cogl_premult_span_8888_avx2 (data, width, alpha_shift);
+#endif
+#ifdef COGL_CONVERSION_USE_SSE2
+      x += _cogl_premult_span_8888_sse2 (data + x * 4, width - x,
+                                         alpha_shift);
+#endif
+#ifdef COGL_CONVERSION_USE_NEON
+      x = _cogl_premult_span_8888_neon (data, width, alpha_shift);
+#endif
+    }
 
-  /* Process 4 pixels at a time */
-  while (width >= 4)
+  for (data += x * 4; x < width; x++, data += 4)
     {
-      _cogl_premult_alpha_last_four_pixels_sse2 (data);
-      data += 4 * 4;
-      width -= 4;
+      if (alpha_first)
+        _cogl_premult_alpha_first (data);
+      else
+        _cogl_premult_alpha_last (data);
     }
+}
 
-  /* If there are any pixels left we will fall through and
-     handle them below */
+/* Unpremultiplying multiplies each component with the reciprocal of its
+ * alpha as in _cogl_unpremult_component(). There is no cheap way to look
+ * the reciprocals up in SIMD registers, so they are loaded per pixel,
+ * which doesn't leave enough work to make wider registers worthwhile. */
 
-#endif /* COGL_USE_PREMULT_SSE2 */
+#ifdef COGL_CONVERSION_USE_SSE2
+static inline __m128i
+_cogl_unpremult_two_pixels_sse2 (__m128i pixels,
+                                 const UnpremultReciprocal *first,
+                                 const UnpremultReciprocal *second)
+{
+  __m128i lo = _mm_unpacklo_epi64 (_mm_loadl_epi64 ((const __m128i *) first->lo),
+                                   _mm_loadl_epi64 ((const __m128i *) second->lo));
+  __m128i hi = _mm_unpacklo_epi64 (_mm_loadl_epi64 ((const __m128i *) first->hi),
+                                   _mm_loadl_epi64 ((const __m128i *) second->hi));
+
+  return _mm_and_si128 (_mm_add_epi16 (_mm_mullo_epi16 (pixels, hi),
+                                       _mm_mulhi_epu16 (pixels, lo)),
+                        _mm_set1_epi16 (0xff));
+}
 
-  while (width-- > 0)
+static int
+_cogl_unpremult_span_8888_sse2 (uint8_t *data,
+                                int width,
+                                int alpha_shift)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i alpha_mask = _mm_sll_epi32 (_mm_set1_epi32 (0xff),
+                                            _mm_cvtsi32_si128 (alpha_shift));
+  int alpha_index = alpha_shift / 8;
+  int x;
+
+  for (x = 0; x + 4 <= width; x += 4)
     {
-      _cogl_premult_alpha_last (data);
-      data += 4;
+      uint8_t *p = data + x * 4;
+      __m128i pixels = _mm_loadu_si128 ((const __m128i *) p);
+      __m128i lo, hi;
+
+      lo = _cogl_unpremult_two_pixels_sse2
+        (_mm_unpacklo_epi8 (pixels, zero),
+         &unpremult_reciprocals[p[alpha_index]],
+         &unpremult_reciprocals[p[4 + alpha_index]]);
+      hi = _cogl_unpremult_two_pixels_sse2
+        (_mm_unpackhi_epi8 (pixels, zero),
+         &unpremult_reciprocals[p[8 + alpha_index]],
+         &unpremult_reciprocals[p[12 + alpha_index]]);
+
+      pixels = _mm_or_si128 (_mm_and_si128 (pixels, alpha_mask),
+                             _mm_andnot_si128 (alpha_mask,
+                                               _mm_packus_epi16 (lo, hi)));
+
+      _mm_storeu_si128 ((__m128i *) p, pixels);
+    }
+
+  return x;
+}
+#endif /* COGL_CONVERSION_USE_SSE2 */
+
+#ifdef COGL_CONVERSION_USE_NEON
+static int
+_cogl_unpremult_span_8888_neon (uint8_t *data,
+                                int width,
+                                int alpha_shift)
+{
+  int alpha_index = alpha_shift / 8;
+  int x, i;
+
+  for (x = 0; x + 8 <= width; x += 8)
+    {
+      uint8x8x4_t pixels = vld4_u8 (data + x * 4);
+      uint8_t alpha[8], hi[8];
+      uint16_t lo[8];
+      uint8x8_t hi8;
+      uint16x8_t lo16;
+
+      vst1_u8 (alpha, pixels.val[alpha_index]);
+      for (i = 0; i < 8; i++)
+        {
+          lo[i] = unpremult_reciprocals[alpha[i]].lo[0];
+          hi[i] = unpremult_reciprocals[alpha[i]].hi[0];
+        }
+      lo16 = vld1q_u16 (lo);
+      hi8 = vld1_u8 (hi);
+
+      for (i = 0; i < 4; i++)
+        {
+          uint16x8_t c = vmovl_u8 (pixels.val[i]);
+          uint16x8_t q;
+
+          if (i == alpha_index)
+            continue;
+
+          q = vcombine_u16 (vshrn_n_u32 (vmull_u16 (vget_low_u16 (c),
+                                                    vget_low_u16 (lo16)),
+                                         16),
+                            vshrn_n_u32 (vmull_u16 (vget_high_u16 (c),
+                                                    vget_high_u16 (lo16)),
+                                         16));
+          pixels.val[i] = vmovn_u16 (vaddq_u16 (vmull_u8 (pixels.val[i], hi8),
+                                                q));
+        }
+
+      vst4_u8 (data + x * 4, pixels);
     }
+
+  return x;
 }
+#endif /* COGL_CONVERSION_USE_NEON */
 
 static void
-_cogl_bitmap_unpremult_unpacked_span_8 (uint8_t *data,
-                                        int width)
+_cogl_unpremult_span_8888 (uint8_t *data,
+                           int width,
+                           CoglBool alpha_first)
 {
-  int x;
+  int alpha_shift = alpha_first ? 0 : 24;
+  int x = 0;
+
+  /* Makes sure the reciprocals are initialized */
+  get_conversion_kernels ();
+
+  if (use_simd_conversion ())
+    {
+#ifdef COGL_CONVERSION_USE_SSE2
+      x = _cogl_unpremult_span_8888_sse2 (data, width, alpha_shift);
+#endif
+#ifdef COGL_CONVERSION_USE_NEON
+      x = _cogl_unpremult_span_8888_neon (data, width, alpha_shift);
+#endif
+    }
 
-  for (x = 0; x < width; x++)
+  for (data += x * 4; x < width; x++, data += 4)
     {
-      if (data[3] == 0)
-        _cogl_unpremult_alpha_0 (data);
+      if (alpha_first)
+        _cogl_unpremult_alpha_first (data);
       else
         _cogl_unpremult_alpha_last (data);
-      data += 4;
     }
 }
 
+/* Conversions between the 8888 formats and the unpacked RGBA rows only
+ * reorder the bytes of each pixel. @order gives the source byte for each
+ * destination byte. */
+
+#ifdef COGL_CONVERSION_USE_AVX2
+__attribute__ ((target ("ssse3")))
+static int
+_cogl_swizzle_span_8888_ssse3 (const uint8_t *src,
+                               uint8_t *dst,
+                               int width,
+                               const int order[4])
+{
+  __m128i shuffle;
+  int x;
+
+  shuffle = _mm_add_epi8 (_mm_set1_epi32 (order[0] |
+                                          order[1] << 8 |
+                                          order[2] << 16 |
+                                          order[3] << 24),
+                          _mm_setr_epi8 (0, 0, 0, 0, 4, 4, 4, 4,
+                                         8, 8, 8, 8, 12, 12, 12, 12));
+
+  for (x = 0; x + 4 <= width; x += 4)
+    {
+      __m128i pixels = _mm_loadu_si128 ((const __m128i *) (src + x * 4));
+
+      _mm_storeu_si128 ((__m128i *) (dst + x * 4),
+                        _mm_shuffle_epi8 (pixels, shuffle));
+    }
+
+  return x;
+}
+
+/* The shuffle works within 128 bit lanes, so both lanes use the same
+ * indices as the SSSE3 version. */
+__attribute__ ((target ("avx2")))
+static int
+_cogl_swizzle_span_8888_avx2 (const uint8_t *src,
+                              uint8_t *dst,
+                              int width,
+                              const int order[4])
+{
+  __m256i shuffle;
+  int x;
+
+  shuffle = _mm256_add_epi8 (_mm256_set1_epi32 (order[0] |
+                                                order[1] << 8 |
+                                                order[2] << 16 |
+                                                order[3] << 24),
+                             _mm256_setr_epi8 (0, 0, 0, 0, 4, 4, 4, 4,
+                                               8, 8, 8, 8, 12, 12, 12, 12,
+                                               0, 0, 0, 0, 4, 4, 4, 4,
+                                               8, 8, 8, 8, 12, 12, 12, 12));
+
+  for (x = 0; x + 8 <= width; x += 8)
+    {
+      __m256i pixels = _mm256_loadu_si256 ((const __m256i *) (src + x * 4));
+
+      _mm256_storeu_si256 ((__m256i *) (dst + x * 4),
+                           _mm256_shuffle_epi8 (pixels, shuffle));
+    }
+
+  return x;
+}
+#endif /* COGL_CONVERSION_USE_AVX2 */
+
+#ifdef COGL_CONVERSION_USE_NEON
+static int
+_cogl_swizzle_span_8888_neon (const uint8_t *src,
+                              uint8_t *dst,
+                              int width,
+                              const int order[4])
+{
+  int x;
+
+  for (x = 0; x + 16 <= width; x += 16)
+    {
+      uint8x16x4_t pixels = vld4q_u8 (src + x * 4);
+      uint8x16x4_t swizzled;
+
+      swizzled.val[0] = pixels.val[order[0]];
+      swizzled.val[1] = pixels.val[order[1]];
+      swizzled.val[2] = pixels.val[order[2]];
+      swizzled.val[3] = pixels.val[order[3]];
+
+      vst4q_u8 (dst + x * 4, swizzled);
+    }
+
+  return x;
+}
+#endif /* COGL_CONVERSION_USE_NEON */
+
+static void
+_cogl_swizzle_span_8888 (const uint8_t *src,
+                         uint8_t *dst,
+                         int width,
+                         const int order[4])
+{
+  int x = 0;
+
+  if (use_simd_conversion ())
+    {
+#ifdef COGL_CONVERSION_USE_AVX2
+      ConversionKernels kernels = get_conversion_kernels ();
+
+      if (kernels & CONVERSION_KERNEL_AVX2)
+        x = _cogl_swizzle_span_8888_avx2 (src, dst, width, order);
+      if (kernels & CONVERSION_KERNEL_SSSE3)
+        x += _cogl_swizzle_span_8888_ssse3 (src + x * 4, dst + x * 4,
+                                            width - x, order);
+#endif
+#ifdef COGL_CONVERSION_USE_NEON
+      x = _cogl_swizzle_span_8888_neon (src, dst, width, order);
+#endif
+    }
+
+  for (src += x * 4, dst += x * 4; x < width; x++, src += 4, dst += 4)
+    {
+      uint8_t r = src[order[0]];
+      uint8_t g = src[order[1]];
+      uint8_t b = src[order[2]];
+      uint8_t a = src[order[3]];
+
+      dst[0] = r;
+      dst[1] = g;
+      dst[2] = b;
+      dst[3] = a;
+    }
+}
+
+/* Gets the byte of each component of an 8888 format, in RGBA order */
+static CoglBool
+_cogl_get_8888_component_bytes (CoglPixelFormat format,
+                                int bytes[4])
+{
+  static const int component_bytes[][4] = {
+    { 0, 1, 2, 3 }, /* RGBA */
+    { 2, 1, 0, 3 }, /* BGRA */
+    { 1, 2, 3, 0 }, /* ARGB */
+    { 3, 2, 1, 0 }, /* ABGR */
+  };
+  int i;
+
+  switch (format & ~COGL_PREMULT_BIT)
+    {
+    case COGL_PIXEL_FORMAT_RGBA_8888:
+      i = 0;
+      break;
+    case COGL_PIXEL_FORMAT_BGRA_8888:
+      i = 1;
+      break;
+    case COGL_PIXEL_FORMAT_ARGB_8888:
+      i = 2;
+      break;
+    case COGL_PIXEL_FORMAT_ABGR_8888:
+      i = 3;
+      break;
+    default:
+      return FALSE;
+    }
+
+  memcpy (bytes, component_bytes[i], sizeof (component_bytes[i]));
+
+  return TRUE;
+}
+
+/* Like _cogl_unpack_8(), but without going through a pixel at a time for
+ * the 8888 formats */
+static void
+_cogl_bitmap_unpack_span_8 (CoglPixelFormat format,
+                            const uint8_t *src,
+                            uint8_t *dst,
+                            int width)
+{
+  int bytes[4];
+
+  if (_cogl_get_8888_component_bytes (format, bytes))
+    _cogl_swizzle_span_8888 (src, dst, width, bytes);
+  else
+    _cogl_unpack_8 (format, src, dst, width);
+}
+
+/* Like _cogl_pack_8(), but without going through a pixel at a time for
+ * the 8888 formats */
+static void
+_cogl_bitmap_pack_span_8 (CoglPixelFormat format,
+                          const uint8_t *src,
+                          uint8_t *dst,
+                          int width)
+{
+  int bytes[4], order[4];
+  int i;
+
+  if (_cogl_get_8888_component_bytes (format, bytes))
+    {
+      for (i = 0; i < 4; i++)
+        order[bytes[i]] = i;
+
+      _cogl_swizzle_span_8888 (src, dst, width, order);
+    }
+  else
+    _cogl_pack_8 (format, src, dst, width);
+}
+
+static void
+_cogl_bitmap_premult_unpacked_span_8 (uint8_t *data,
+                                      int width)
+{
+  _cogl_premult_span_8888 (data, width, FALSE);
+}
+
+static void
+_cogl_bitmap_unpremult_unpacked_span_8 (uint8_t *data,
+                                        int width)
+{
+  _cogl_unpremult_span_8888 (data, width, FALSE);
+}
+
 static void
 _cogl_bitmap_unpremult_unpacked_span_16 (uint16_t *data,
                                          int width)
@@ -274,6 +765,7 @@ _cogl_bitmap_unpremult_unpacked_span_16 (uint16_t *data,
           data[1] = (data[1] * 65535) / alpha;
           data[2] = (data[2] * 65535) / alpha;
         }
+      data += 4;
     }
 }
 
@@ -288,6 +780,7 @@ _cogl_bitmap_premult_unpacked_span_16 (uint16_t *data,
       data[0] = (data[0] * alpha) / 65535;
       data[1] = (data[1] * alpha) / 65535;
       data[2] = (data[2] * alpha) / 65535;
+      data += 4;
     }
 }
 
@@ -451,7 +944,7 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
       if (use_16)
         _cogl_unpack_16 (src_format, src, tmp_row, width);
       else
-        _cogl_unpack_8 (src_format, src, tmp_row, width);
+        _cogl_bitmap_unpack_span_8 (src_format, src, tmp_row, width);
 
       /* Handle premultiplication */
       if (need_premult)
@@ -475,7 +968,7 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
       if (use_16)
         _cogl_pack_16 (dst_format, tmp_row, dst, width);
       else
-        _cogl_pack_8 (dst_format, tmp_row, dst, width);
+        _cogl_bitmap_pack_span_8 (dst_format, tmp_row, dst, width);
     }
 
   _cogl_bitmap_unmap (src_bmp);
@@ -621,7 +1114,7 @@ _cogl_bitmap_unpremult (CoglBitmap *bmp,
 {
   uint8_t *p, *data;
   uint16_t *tmp_row;
-  int x,y;
+  int y;
   CoglPixelFormat format;
   int width, height;
   int rowstride;
@@ -657,21 +1150,7 @@ _cogl_bitmap_unpremult (CoglBitmap *bmp,
           _cogl_pack_16 (format, tmp_row, p, width);
         }
       else
-        {
-          if (format & COGL_AFIRST_BIT)
-            {
-              for (x = 0; x < width; x++)
-                {
-                  if (p[0] == 0)
-                    _cogl_unpremult_alpha_0 (p);
-                  else
-                    _cogl_unpremult_alpha_first (p);
-                  p += 4;
-                }
-            }
-          else
-            _cogl_bitmap_unpremult_unpacked_span_8 (p, width);
-        }
+        _cogl_unpremult_span_8888 (p, width, format & COGL_AFIRST_BIT);
     }
 
   g_free (tmp_row);
@@ -689,7 +1168,7 @@ _cogl_bitmap_premult (CoglBitmap *bmp,
 {
   uint8_t *p, *data;
   uint16_t *tmp_row;
-  int x,y;
+  int y;
   CoglPixelFormat format;
   int width, height;
   int rowstride;
@@ -724,18 +1203,7 @@ _cogl_bitmap_premult (CoglBitmap *bmp,
           _cogl_pack_16 (format, tmp_row, p, width);
         }
       else
-        {
-          if (format & COGL_AFIRST_BIT)
-            {
-              for (x = 0; x < width; x++)
-                {
-                  _cogl_premult_alpha_first (p);
-                  p += 4;
-                }
-            }
-          else
-            _cogl_bitmap_premult_unpacked_span_8 (p, width);
-        }
+        _cogl_premult_span_8888 (p, width, format & COGL_AFIRST_BIT);
     }
 
   g_free (tmp_row);
@@ -746,3 +1214,134 @@ _cogl_bitmap_premult (CoglBitmap *bmp,
 
   return TRUE;
 }
+
+#ifdef ENABLE_UNIT_TESTS
+
+/* Every combination of a component and an alpha value, with the alpha
+ * in the first or in the last byte. One more pixel than a multiple of
+ * the widest kernel makes sure the generic code finishes the span. */
+#define TEST_CONVERSION_WIDTH (256 * 256 + 1)
+
+static uint8_t *
+create_test_span (CoglBool alpha_first)
+{
+  uint8_t *data = g_malloc (TEST_CONVERSION_WIDTH * 4);
+  int i;
+
+  for (i = 0; i < TEST_CONVERSION_WIDTH; i++)
+    {
+      uint8_t c = i & 0xff;
+      uint8_t alpha = (i >> 8) & 0xff;
+      uint8_t *pixel = data + i * 4;
+
+      pixel[0] = alpha_first ? alpha : c;
+      pixel[1] = c;
+      pixel[2] = 255 - c;
+      pixel[3] = alpha_first ? c ^ 0x5a : alpha;
+    }
+
+  return data;
+}
+
+typedef void (* TestSpanFunc) (uint8_t *data,
+                               CoglBool alpha_first);
+
+static void
+test_premult_span (uint8_t *data,
+                   CoglBool alpha_first)
+{
+  _cogl_premult_span_8888 (data, TEST_CONVERSION_WIDTH, alpha_first);
+}
+
+static void
+test_unpremult_span (uint8_t *data,
+                     CoglBool alpha_first)
+{
+  _cogl_unpremult_span_8888 (data, TEST_CONVERSION_WIDTH, alpha_first);
+}
+
+/* Runs @func with and without the SIMD kernels and checks that they
+ * give the same pixels */
+static void
+check_span_func (TestSpanFunc func,
+                 CoglBool alpha_first)
+{
+  CoglBool simd_disabled =
+    COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_SIMD_CONVERSION);
+  uint8_t *fast = create_test_span (alpha_first);
+  uint8_t *generic = create_test_span (alpha_first);
+
+  COGL_DEBUG_CLEAR_FLAG (COGL_DEBUG_DISABLE_SIMD_CONVERSION);
+  func (fast, alpha_first);
+
+  COGL_DEBUG_SET_FLAG (COGL_DEBUG_DISABLE_SIMD_CONVERSION);
+  func (generic, alpha_first);
+
+  if (!simd_disabled)
+    COGL_DEBUG_CLEAR_FLAG (COGL_DEBUG_DISABLE_SIMD_CONVERSION);
+
+  g_assert (memcmp (fast, generic, TEST_CONVERSION_WIDTH * 4) == 0);
+
+  g_free (fast);
+  g_free (generic);
+}
+
+static void
+check_swizzle (const int order[4])
+{
+  CoglBool simd_disabled =
+    COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_SIMD_CONVERSION);
+  uint8_t *src = create_test_span (FALSE);
+  uint8_t *fast = g_malloc (TEST_CONVERSION_WIDTH * 4);
+  uint8_t *generic = g_malloc (TEST_CONVERSION_WIDTH * 4);
+
+  COGL_DEBUG_CLEAR_FLAG (COGL_DEBUG_DISABLE_SIMD_CONVERSION);
+  _cogl_swizzle_span_8888 (src, fast, TEST_CONVERSION_WIDTH, order);
+
+  COGL_DEBUG_SET_FLAG (COGL_DEBUG_DISABLE_SIMD_CONVERSION);
+  _cogl_swizzle_span_8888 (src, generic, TEST_CONVERSION_WIDTH, order);
+
+  if (!simd_disabled)
+    COGL_DEBUG_CLEAR_FLAG (COGL_DEBUG_DISABLE_SIMD_CONVERSION);
+
+  g_assert (memcmp (fast, generic, TEST_CONVERSION_WIDTH * 4) == 0);
+
+  g_free (src);
+  g_free (fast);
+  g_free (generic);
+}
+
+UNIT_TEST (check_8888_conversion_kernels,
+           0 /* no requirements */,
+           0 /* no failure cases */)
+{
+  static const CoglPixelFormat formats[] = {
+    COGL_PIXEL_FORMAT_RGBA_8888,
+    COGL_PIXEL_FORMAT_BGRA_8888,
+    COGL_PIXEL_FORMAT_ARGB_8888,
+    COGL_PIXEL_FORMAT_ABGR_8888,
+  };
+  int i, j;
+
+  check_span_func (test_premult_span, FALSE);
+  check_span_func (test_premult_span, TRUE);
+  check_span_func (test_unpremult_span, FALSE);
+  check_span_func (test_unpremult_span, TRUE);
+
+  /* The swizzles used to unpack and to pack each format, as in
+   * _cogl_bitmap_unpack_span_8() and _cogl_bitmap_pack_span_8() */
+  for (i = 0; i < G_N_ELEMENTS (formats); i++)
+    {
+      int bytes[4], order[4];
+
+      g_assert (_cogl_get_8888_component_bytes (formats[i], bytes));
+
+      for (j = 0; j < 4; j++)
+        order[bytes[j]] = j;
+
+      check_swizzle (bytes);
+      check_swizzle (order);
+    }
+}
+
+#endif /* ENABLE_UNIT_TESTS */
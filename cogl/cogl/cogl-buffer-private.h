@@ -69,7 +69,11 @@ typedef enum _CoglBufferFlags
   COGL_BUFFER_FLAG_NONE            = 0,
   COGL_BUFFER_FLAG_BUFFER_OBJECT   = 1UL << 0,  /* real openGL buffer object */
   COGL_BUFFER_FLAG_MAPPED          = 1UL << 1,
-  COGL_BUFFER_FLAG_MAPPED_FALLBACK = 1UL << 2
+  COGL_BUFFER_FLAG_MAPPED_FALLBACK = 1UL << 2,
+  /* The buffer is only ever written through unsynchronized maps and
+   * the user synchronizes with fences itself. This lets the GL driver
+   * give it immutable, persistently mapped storage */
+  COGL_BUFFER_FLAG_STREAM          = 1UL << 3
 } CoglBufferFlags;
 
 typedef enum {
@@ -108,6 +112,10 @@ struct _CoglBuffer
    * ... or points to allocated memory in the fallback paths */
   uint8_t *data;
 
+  /* points to the whole buffer when the storage of a stream buffer
+   * is persistently mapped */
+  uint8_t *persistent_data;
+
   int immutable_ref;
 
   unsigned int store_created:1;
@@ -131,6 +131,7 @@ _cogl_buffer_initialize (CoglBuffer *buffer,
   buffer->usage_hint = usage_hint;
   buffer->update_hint = update_hint;
   buffer->data = NULL;
+  buffer->persistent_data = NULL;
   buffer->immutable_ref = 0;
 
   if (default_target == COGL_BUFFER_BIND_TARGET_PIXEL_PACK ||
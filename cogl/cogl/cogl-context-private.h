@@ -60,6 +60,7 @@
 #include "cogl-onscreen-private.h"
 #include "cogl-fence-private.h"
 #include "cogl-poll-private.h"
+#include "cogl-stream-buffer-private.h"
 #include "cogl-path/cogl-path-types.h"
 #include "cogl-private.h"
 
@@ -167,6 +168,15 @@ struct _CoglContext
 
   CoglPipelineCache *pipeline_cache;
 
+  /* Where linked GLSL programs are stored between runs, see
+   * driver/gl/cogl-program-binary-cache.c */
+  char             *program_binary_dir;
+  CoglBool          program_binary_dirs_pruned;
+  /* Programs linked since the last idle whose binaries are still to
+   * be stored */
+  GList            *pending_program_binaries;
+  CoglClosure      *program_binary_store_idle;
+
   /* Textures */
   CoglTexture2D *default_gl_texture_2d_tex;
   CoglTexture3D *default_gl_texture_3d_tex;
@@ -179,6 +189,9 @@ struct _CoglContext
   /* Global journal buffers */
   GArray           *journal_flush_attributes_array;
   GArray           *journal_clip_bounds;
+  /* Shared by all journals to upload their vertices. This is created
+   * the first time a journal is flushed. */
+  CoglStreamBuffer *journal_stream;
 
   GArray           *polygon_vertices;
 
@@ -248,6 +261,13 @@ struct _CoglContext
 
   GSList           *atlases;
   GHookList         atlas_reorganize_callbacks;
+  /* Atlases waiting for a frame to be swapped before migrating the
+     next slice of their defragmentation */
+  GList            *defragmenting_atlases;
+  /* Migrates the next slices anyway if no frame is swapped before
+     defragment_deadline */
+  CoglPollSource   *defragment_poll_source;
+  int64_t           defragment_deadline;
 
   /* This debugging variable is used to pick a colour for visually
      displaying the quad batches. It needs to be global so that it can
@@ -272,6 +292,29 @@ struct _CoglContext
   CoglColorMask current_gl_color_mask;
   GLenum current_gl_draw_buffer;
 
+  /* Shadow copies of the rest of the GL state that gets changed
+   * often, so that setting it to the value it already has can be
+   * skipped. A negative width in the viewport and scissor caches
+   * means their contents are unknown */
+  CoglBool gl_scissor_test_enabled_cache;
+  CoglBool gl_stencil_test_enabled_cache;
+  CoglBool gl_cull_face_enabled_cache;
+  GLenum gl_cull_face_mode_cache;
+  GLenum gl_front_face_cache;
+  GLint gl_viewport_cache[4];
+  GLint gl_scissor_cache[4];
+  /* Source RGB, destination RGB, source alpha, destination alpha */
+  GLenum gl_blend_func_cache[4];
+  /* RGB and alpha */
+  GLenum gl_blend_equation_cache[2];
+  float gl_blend_color_cache[4];
+
+  /* The number of GL state changes made and skipped because the
+   * state already had the right value since the last swap, for
+   * COGL_DEBUG=gl-state */
+  unsigned int n_gl_state_changes_issued;
+  unsigned int n_gl_state_changes_elided;
+
   /* Clipping */
   /* TRUE if we have a valid clipping stack flushed. In that case
      current_clip_stack will describe what the current state is. If
@@ -49,6 +49,7 @@
 #include "cogl-texture-rectangle-private.h"
 #include "cogl-pipeline-private.h"
 #include "cogl-pipeline-opengl-private.h"
+#include "cogl-program-binary-cache-private.h"
 #include "cogl-framebuffer-private.h"
 #include "cogl-onscreen-private.h"
 #include "cogl-attribute-private.h"
@@ -76,6 +77,10 @@
 #define GL_NUM_EXTENSIONS 0x821D
 #endif
 
+#ifndef GL_FUNC_ADD
+#define GL_FUNC_ADD 0x8006
+#endif
+
 /* This is a relatively new extension */
 #ifndef GL_PURGED_CONTEXT_RESET_NV
 #define GL_PURGED_CONTEXT_RESET_NV 0x92BB
@@ -355,6 +360,7 @@ cogl_context_new (CoglDisplay *display,
   context->journal_flush_attributes_array =
     g_array_new (TRUE, FALSE, sizeof (CoglAttribute *));
   context->journal_clip_bounds = NULL;
+  context->journal_stream = NULL;
 
   context->polygon_vertices = g_array_new (FALSE, FALSE, sizeof (float));
 
@@ -380,6 +386,27 @@ cogl_context_new (CoglDisplay *display,
   context->current_gl_dither_enabled = TRUE;
   context->current_gl_color_mask = COGL_COLOR_MASK_ALL;
 
+  context->gl_scissor_test_enabled_cache = FALSE;
+  context->gl_stencil_test_enabled_cache = FALSE;
+  context->gl_cull_face_enabled_cache = FALSE;
+  context->gl_cull_face_mode_cache = GL_BACK;
+  context->gl_front_face_cache = GL_CCW;
+  /* The initial viewport and scissor box depend on the size of the
+   * first surface the context is bound to */
+  context->gl_viewport_cache[2] = -1;
+  context->gl_scissor_cache[2] = -1;
+  context->gl_blend_func_cache[0] = GL_ONE;
+  context->gl_blend_func_cache[1] = GL_ZERO;
+  context->gl_blend_func_cache[2] = GL_ONE;
+  context->gl_blend_func_cache[3] = GL_ZERO;
+  context->gl_blend_equation_cache[0] = GL_FUNC_ADD;
+  context->gl_blend_equation_cache[1] = GL_FUNC_ADD;
+  memset (context->gl_blend_color_cache, 0,
+          sizeof (context->gl_blend_color_cache));
+
+  context->n_gl_state_changes_issued = 0;
+  context->n_gl_state_changes_elided = 0;
+
   context->gl_blend_enable_cache = FALSE;
 
   context->depth_test_enabled_cache = FALSE;
@@ -505,6 +532,9 @@ cogl_context_new (CoglDisplay *display,
   cogl_push_source (context->opaque_color_pipeline);
 
   context->atlases = NULL;
+  context->defragmenting_atlases = NULL;
+  context->defragment_poll_source = NULL;
+  context->defragment_deadline = 0;
   g_hook_list_init (&context->atlas_reorganize_callbacks, sizeof (GHook));
 
   context->buffer_map_fallback_array = g_byte_array_new ();
@@ -564,6 +594,8 @@ _cogl_context_free (CoglContext *context)
     g_array_free (context->journal_flush_attributes_array, TRUE);
   if (context->journal_clip_bounds)
     g_array_free (context->journal_clip_bounds, TRUE);
+  if (context->journal_stream)
+    _cogl_stream_buffer_free (context->journal_stream);
 
   if (context->polygon_vertices)
     g_array_free (context->polygon_vertices, TRUE);
@@ -592,6 +624,10 @@ _cogl_context_free (CoglContext *context)
     _cogl_clip_stack_unref (context->current_clip_stack);
 
   g_slist_free (context->atlases);
+  g_list_free (context->defragmenting_atlases);
+  if (context->defragment_poll_source)
+    _cogl_poll_renderer_remove_source (context->display->renderer,
+                                       context->defragment_poll_source);
   g_hook_list_clear (&context->atlas_reorganize_callbacks);
 
   _cogl_bitmask_destroy (&context->enabled_builtin_attributes);
@@ -610,6 +646,7 @@ _cogl_context_free (CoglContext *context)
   _cogl_matrix_entry_cache_destroy (&context->builtin_flushed_modelview);
 
   _cogl_pipeline_cache_free (context->pipeline_cache);
+  _cogl_program_binary_cache_free (context);
 
   _cogl_sampler_cache_free (context->sampler_cache);
 
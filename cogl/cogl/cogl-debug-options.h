@@ -171,6 +171,12 @@ OPT (OPENGL,
      "opengl",
      N_("Trace some OpenGL"),
      N_("Traces some select OpenGL calls"))
+OPT (GL_STATE,
+     N_("Cogl Tracing"),
+     "gl-state",
+     N_("Trace GL state changes"),
+     N_("Reports how many GL state changes were made and how many were "
+        "skipped as redundant in each frame"))
 OPT (OFFSCREEN,
      N_("Cogl Tracing"),
      "offscreen",
@@ -187,6 +193,18 @@ OPT (DISABLE_FAST_READ_PIXEL,
      N_("Disable read pixel optimization"),
      N_("Disable optimization for reading 1px for simple "
         "scenes of opaque rectangles"))
+OPT (DISABLE_SIMD_CONVERSION,
+     N_("Root Cause"),
+     "disable-simd-conversion",
+     N_("Disable SIMD pixel conversion"),
+     N_("Convert and premultiply pixels one at a time instead of using "
+        "SSE2, SSSE3, AVX2 or NEON"))
+OPT (DISABLE_AUTHORITIES_CACHE,
+     N_("Root Cause"),
+     "disable-authorities-cache",
+     N_("Disable pipeline authorities cache"),
+     N_("Always walk the ancestry of pipelines to look up their state "
+        "instead of caching where the state is found"))
 OPT (CLIPPING,
      N_("Cogl Tracing"),
      "clipping",
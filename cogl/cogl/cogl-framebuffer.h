@@ -1723,6 +1723,20 @@ cogl_framebuffer_discard_buffers (CoglFramebuffer *framebuffer,
 void
 cogl_framebuffer_finish (CoglFramebuffer *framebuffer);
 
+/**
+ * cogl_framebuffer_flush:
+ * @framebuffer: A #CoglFramebuffer pointer
+ *
+ * Flushes all pending rendering associated with the specified framebuffer
+ * to the GPU without waiting for it to complete. This is useful when the
+ * framebuffer is backed by a buffer shared with another process, which
+ * relies on implicit synchronization to see the finished contents.
+ *
+ * Stability: unstable
+ */
+void
+cogl_framebuffer_flush (CoglFramebuffer *framebuffer);
+
 /**
  * cogl_framebuffer_read_pixels_into_bitmap:
  * @framebuffer: A #CoglFramebuffer
@@ -38,4 +38,11 @@ _cogl_glsl_shader_set_source_with_boilerplate (CoglContext *ctx,
                                                const char **strings_in,
                                                const GLint *lengths_in);
 
+/* The GLSL backends only set the source of their shaders so that
+ * nothing is compiled for programs loaded from a binary. This compiles
+ * the shader if that hasn't happened yet. */
+void
+_cogl_glsl_shader_ensure_compiled (CoglContext *ctx,
+                                   GLuint shader_gl_handle);
+
 #endif /* _COGL_GLSL_SHADER_PRIVATE_H_ */
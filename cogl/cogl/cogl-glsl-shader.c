@@ -198,3 +198,30 @@ _cogl_glsl_shader_set_source_with_boilerplate (CoglContext *ctx,
 
   g_free (version_string);
 }
+
+void
+_cogl_glsl_shader_ensure_compiled (CoglContext *ctx,
+                                   GLuint shader_gl_handle)
+{
+  GLint compile_status;
+
+  GE( ctx, glGetShaderiv (shader_gl_handle, GL_COMPILE_STATUS,
+                          &compile_status) );
+  if (compile_status)
+    return;
+
+  GE( ctx, glCompileShader (shader_gl_handle) );
+  GE( ctx, glGetShaderiv (shader_gl_handle, GL_COMPILE_STATUS,
+                          &compile_status) );
+
+  if (!compile_status)
+    {
+      GLint len = 0;
+      char *shader_log;
+
+      GE( ctx, glGetShaderiv (shader_gl_handle, GL_INFO_LOG_LENGTH, &len) );
+      shader_log = g_alloca (len);
+      GE( ctx, glGetShaderInfoLog (shader_gl_handle, len, &len, shader_log) );
+      g_warning ("Shader compilation failed:\n%s", shader_log);
+    }
+}
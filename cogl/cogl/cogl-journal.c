@@ -93,6 +93,25 @@
   (POS_STRIDE + COLOR_STRIDE + \
    TEX_STRIDE * (N_LAYERS < MIN_LAYER_PADING ? MIN_LAYER_PADING : N_LAYERS))
 
+/* The software transform of the quad corners is done for all four
+   vertices at once when the CPU allows it. Each output vertex is
+   computed with the same sequence of multiplies and adds whichever
+   version is used so that edges shared between neighbouring quads get
+   exactly the same positions */
+#if defined(__SSE__) && defined(__GNUC__) \
+  && (defined(__x86_64) || defined(__i386))
+#define COGL_JOURNAL_USE_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define COGL_JOURNAL_USE_NEON
+#include <arm_neon.h>
+#endif
+
+/* Attribute buffers in the pool are never made smaller than this so
+   that a journal that grows slowly doesn't recreate its buffer on
+   every flush */
+#define COGL_JOURNAL_MIN_VBO_SIZE 4096
+
 /* If a batch is longer than this threshold then we'll assume it's not
    worth doing software clipping and it's cheaper to program the GPU
    to do the clip */
@@ -768,6 +787,7 @@ typedef struct
 static CoglBool
 can_software_clip_entry (CoglJournalEntry *journal_entry,
                          CoglJournalEntry *prev_journal_entry,
+                         const ClipBounds *prev_clip_bounds,
                          CoglClipStack *clip_stack,
                          ClipBounds *clip_bounds_out)
 {
@@ -798,6 +818,16 @@ can_software_clip_entry (CoglJournalEntry *journal_entry,
           return FALSE;
     }
 
+  /* Runs of entries drawn with the same modelview are common (eg, the
+     glyphs of a text layout) and they all end up with the same clip
+     bounds so there's no need to walk the clip stack again */
+  if (prev_clip_bounds &&
+      journal_entry->modelview_entry == prev_journal_entry->modelview_entry)
+    {
+      *clip_bounds_out = *prev_clip_bounds;
+      return TRUE;
+    }
+
   /* Now we need to verify that each clip entry's matrix is just a
      translation of the journal entry's modelview matrix. We can
      also work out the bounds of the clip in modelview space using
@@ -993,8 +1023,11 @@ maybe_software_clip_entries (CoglJournalEntry      *batch_start,
         entry_num ? batch_start + (entry_num - 1) : NULL;
       ClipBounds *clip_bounds = &g_array_index (ctx->journal_clip_bounds,
                                                 ClipBounds, entry_num);
+      ClipBounds *prev_clip_bounds =
+        entry_num ? clip_bounds - 1 : NULL;
 
       if (!can_software_clip_entry (journal_entry, prev_journal_entry,
+                                    prev_clip_bounds,
                                     clip_stack,
                                     clip_bounds))
         return;
@@ -1046,6 +1079,17 @@ compare_entry_clip_stacks (CoglJournalEntry *entry0, CoglJournalEntry *entry1)
   return entry0->clip_stack == entry1->clip_stack;
 }
 
+static size_t
+pool_buffer_size (size_t n_bytes)
+{
+  size_t size = COGL_JOURNAL_MIN_VBO_SIZE;
+
+  while (size < n_bytes)
+    size *= 2;
+
+  return size;
+}
+
 /* Gets a new vertex array from the pool. A reference is taken on the
    array so it can be treated as if it was just newly allocated */
 static CoglAttributeBuffer *
@@ -1065,14 +1109,20 @@ create_attribute_buffer (CoglJournal *journal,
 
   if (vbo == NULL)
     {
-      vbo = cogl_attribute_buffer_new_with_size (ctx, n_bytes);
+      vbo = cogl_attribute_buffer_new_with_size (ctx,
+                                                 pool_buffer_size (n_bytes));
       journal->vbo_pool[journal->next_vbo_in_pool] = vbo;
     }
   else if (cogl_buffer_get_size (COGL_BUFFER (vbo)) < n_bytes)
     {
-      /* If the buffer is too small then we'll just recreate it */
+      /* If the buffer is too small then we'll recreate it. The size
+         is rounded up to a power of two so that a journal that grows
+         a little every frame settles on a size instead of
+         reallocating the buffer each time it comes round in the
+         pool */
       cogl_object_unref (vbo);
-      vbo = cogl_attribute_buffer_new_with_size (ctx, n_bytes);
+      vbo = cogl_attribute_buffer_new_with_size (ctx,
+                                                 pool_buffer_size (n_bytes));
       journal->vbo_pool[journal->next_vbo_in_pool] = vbo;
     }
 
@@ -1082,31 +1132,143 @@ create_attribute_buffer (CoglJournal *journal,
   return cogl_object_ref (vbo);
 }
 
+/* Returns the context's stream buffer if the vertices can be written
+   into it or NULL if the journal should use its pool of buffers */
+static CoglStreamBuffer *
+get_journal_stream (CoglContext *ctx)
+{
+  /* Dumping the batches maps the buffer for reading which isn't
+     allowed for a stream buffer */
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_JOURNAL)))
+    return NULL;
+
+  if (ctx->journal_stream == NULL)
+    {
+      if (!_cogl_stream_buffer_is_supported (ctx))
+        return NULL;
+
+      ctx->journal_stream = _cogl_stream_buffer_new (ctx);
+    }
+
+  return ctx->journal_stream;
+}
+
+/* Transforms the corners (x1,y1) (x1,y2) (x2,y2) (x2,y1) of a
+ * rectangle by the modelview matrix into four consecutive vertices
+ * that are stride floats apart. The x, y and z products of both x
+ * values and both y values are only calculated once.
+ *
+ * The SIMD versions store four floats per vertex so the fourth one
+ * clobbers the vertex color. The caller needs to write the colors
+ * afterwards.
+ */
+static inline void
+transform_rectangle_corners (const CoglMatrix *matrix,
+                             float x1,
+                             float y1,
+                             float x2,
+                             float y2,
+                             float *vout,
+                             size_t stride)
+{
+#if defined(COGL_JOURNAL_USE_SSE)
+  __m128 col0 = _mm_loadu_ps (&matrix->xx);
+  __m128 col1 = _mm_loadu_ps (&matrix->xy);
+  __m128 col3 = _mm_loadu_ps (&matrix->xw);
+  __m128 ax1 = _mm_mul_ps (col0, _mm_set1_ps (x1));
+  __m128 ax2 = _mm_mul_ps (col0, _mm_set1_ps (x2));
+  __m128 by1 = _mm_mul_ps (col1, _mm_set1_ps (y1));
+  __m128 by2 = _mm_mul_ps (col1, _mm_set1_ps (y2));
+
+  _mm_storeu_ps (vout, _mm_add_ps (_mm_add_ps (ax1, by1), col3));
+  _mm_storeu_ps (vout + stride, _mm_add_ps (_mm_add_ps (ax1, by2), col3));
+  _mm_storeu_ps (vout + stride * 2,
+                 _mm_add_ps (_mm_add_ps (ax2, by2), col3));
+  _mm_storeu_ps (vout + stride * 3,
+                 _mm_add_ps (_mm_add_ps (ax2, by1), col3));
+#elif defined(COGL_JOURNAL_USE_NEON)
+  float32x4_t col0 = vld1q_f32 (&matrix->xx);
+  float32x4_t col1 = vld1q_f32 (&matrix->xy);
+  float32x4_t col3 = vld1q_f32 (&matrix->xw);
+  float32x4_t ax1 = vmulq_n_f32 (col0, x1);
+  float32x4_t ax2 = vmulq_n_f32 (col0, x2);
+  float32x4_t by1 = vmulq_n_f32 (col1, y1);
+  float32x4_t by2 = vmulq_n_f32 (col1, y2);
+
+  vst1q_f32 (vout, vaddq_f32 (vaddq_f32 (ax1, by1), col3));
+  vst1q_f32 (vout + stride, vaddq_f32 (vaddq_f32 (ax1, by2), col3));
+  vst1q_f32 (vout + stride * 2, vaddq_f32 (vaddq_f32 (ax2, by2), col3));
+  vst1q_f32 (vout + stride * 3, vaddq_f32 (vaddq_f32 (ax2, by1), col3));
+#else
+  const float *col0 = &matrix->xx;
+  const float *col1 = &matrix->xy;
+  const float *col3 = &matrix->xw;
+  int i;
+
+  for (i = 0; i < 3; i++)
+    {
+      float ax1 = col0[i] * x1;
+      float ax2 = col0[i] * x2;
+      float by1 = col1[i] * y1;
+      float by2 = col1[i] * y2;
+
+      vout[i] = ax1 + by1 + col3[i];
+      vout[stride + i] = ax1 + by2 + col3[i];
+      vout[stride * 2 + i] = ax2 + by2 + col3[i];
+      vout[stride * 3 + i] = ax2 + by1 + col3[i];
+    }
+#endif
+}
+
 static CoglAttributeBuffer *
 upload_vertices (CoglJournal *journal,
                  const CoglJournalEntry *entries,
                  int n_entries,
                  size_t needed_vbo_len,
-                 GArray *vertices)
+                 GArray *vertices,
+                 CoglStreamBuffer *stream,
+                 size_t *array_offset)
 {
-  CoglAttributeBuffer *attribute_buffer;
-  CoglBuffer *buffer;
+  CoglAttributeBuffer *attribute_buffer = NULL;
   const float *vin;
   float *vout;
   int entry_num;
   int i;
   CoglMatrixEntry *last_modelview_entry = NULL;
   CoglMatrix modelview;
+  CoglBool sw_transform = SW_TRANSFORM;
 
   g_assert (needed_vbo_len);
 
-  attribute_buffer = create_attribute_buffer (journal, needed_vbo_len * 4);
-  buffer = COGL_BUFFER (attribute_buffer);
-  cogl_buffer_set_update_hint (buffer, COGL_BUFFER_UPDATE_HINT_DYNAMIC);
+  /* Append the vertices to the stream if there is one so that the
+     buffer doesn't have to be orphaned or synchronised. If the range
+     can't be mapped then fall back to a buffer from the pool */
+  vout = NULL;
+  if (stream)
+    vout = _cogl_stream_buffer_map (stream,
+                                    needed_vbo_len * 4,
+                                    &attribute_buffer,
+                                    array_offset);
+
+  if (vout)
+    cogl_object_ref (attribute_buffer);
+  else
+    {
+      CoglBuffer *buffer;
+
+      stream = NULL;
+      *array_offset = 0;
+
+      attribute_buffer = create_attribute_buffer (journal,
+                                                  needed_vbo_len * 4);
+      buffer = COGL_BUFFER (attribute_buffer);
+      cogl_buffer_set_update_hint (buffer, COGL_BUFFER_UPDATE_HINT_DYNAMIC);
+
+      vout = _cogl_buffer_map_range_for_fill_or_fallback (buffer,
+                                                          0, /* offset */
+                                                          needed_vbo_len * 4);
+    }
 
-  vout = _cogl_buffer_map_range_for_fill_or_fallback (buffer,
-                                                      0, /* offset */
-                                                      needed_vbo_len * 4);
   vin = &g_array_index (vertices, float, 0);
 
   /* Expand the number of vertices from 2 to 4 while uploading */
@@ -1117,12 +1279,11 @@ upload_vertices (CoglJournal *journal,
       size_t array_stride =
         GET_JOURNAL_ARRAY_STRIDE_FOR_N_LAYERS (entry->n_layers);
 
-      /* Copy the color to all four of the vertices */
-      for (i = 0; i < 4; i++)
-        memcpy (vout + vb_stride * i + POS_STRIDE, vin, 4);
+      const float *color = vin;
+
       vin++;
 
-      if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_SOFTWARE_TRANSFORM)))
+      if (G_UNLIKELY (!sw_transform))
         {
           vout[vb_stride * 0] = vin[0];
           vout[vb_stride * 0 + 1] = vin[1];
@@ -1135,29 +1296,24 @@ upload_vertices (CoglJournal *journal,
         }
       else
         {
-          float v[8];
-
-          v[0] = vin[0];
-          v[1] = vin[1];
-          v[2] = vin[0];
-          v[3] = vin[array_stride + 1];
-          v[4] = vin[array_stride];
-          v[5] = vin[array_stride + 1];
-          v[6] = vin[array_stride];
-          v[7] = vin[1];
-
           if (entry->modelview_entry != last_modelview_entry)
-            cogl_matrix_entry_get (entry->modelview_entry, &modelview);
-          cogl_matrix_transform_points (&modelview,
-                                        2, /* n_components */
-                                        sizeof (float) * 2, /* stride_in */
-                                        v, /* points_in */
-                                        /* strideout */
-                                        vb_stride * sizeof (float),
-                                        vout, /* points_out */
-                                        4 /* n_points */);
+            {
+              cogl_matrix_entry_get (entry->modelview_entry, &modelview);
+              last_modelview_entry = entry->modelview_entry;
+            }
+
+          transform_rectangle_corners (&modelview,
+                                       vin[0], vin[1],
+                                       vin[array_stride],
+                                       vin[array_stride + 1],
+                                       vout, vb_stride);
         }
 
+      /* Copy the color to all four of the vertices. This has to come
+         after the transform because that may overwrite it */
+      for (i = 0; i < 4; i++)
+        memcpy (vout + vb_stride * i + POS_STRIDE, color, 4);
+
       for (i = 0; i < entry->n_layers; i++)
         {
           const float *tin = vin + 2;
@@ -1177,7 +1333,10 @@ upload_vertices (CoglJournal *journal,
       vout += vb_stride * 4;
     }
 
-  _cogl_buffer_unmap_for_fill_or_fallback (buffer);
+  if (stream)
+    _cogl_stream_buffer_unmap (stream);
+  else
+    _cogl_buffer_unmap_for_fill_or_fallback (COGL_BUFFER (attribute_buffer));
 
   return attribute_buffer;
 }
@@ -1299,6 +1458,7 @@ _cogl_journal_flush (CoglJournal *journal)
   CoglFramebuffer *framebuffer;
   CoglContext *ctx;
   CoglJournalFlushState state;
+  CoglStreamBuffer *stream;
   int i;
   COGL_STATIC_TIMER (flush_timer,
                      "Mainloop", /* parent */
@@ -1366,13 +1526,15 @@ _cogl_journal_flush (CoglJournal *journal)
 
   /* We upload the vertices after the clip stack pass in case it
      modifies the entries */
+  stream = get_journal_stream (ctx);
   state.attribute_buffer =
     upload_vertices (journal,
                      &g_array_index (journal->entries, CoglJournalEntry, 0),
                      journal->entries->len,
                      journal->needed_vbo_len,
-                     journal->vertices);
-  state.array_offset = 0;
+                     journal->vertices,
+                     stream,
+                     &state.array_offset);
 
   /* batch_and_call() batches a list of journal entries according to some
    * given criteria and calls a callback once for each determined batch.
@@ -1403,6 +1565,11 @@ _cogl_journal_flush (CoglJournal *journal)
                   _cogl_journal_flush_clip_stacks_and_entries, /* callback */
                   &state); /* data */
 
+  /* The vertices written to the stream can't be reused until the GPU
+     has finished drawing them */
+  if (stream)
+    _cogl_stream_buffer_fence (stream);
+
   for (i = 0; i < state.attributes->len; i++)
     cogl_object_unref (g_array_index (state.attributes, CoglAttribute *, i));
   g_array_set_size (state.attributes, 0);
@@ -1725,7 +1892,7 @@ try_checking_point_hits_entry_after_clipping (CoglFramebuffer *framebuffer,
       if (!can_software_clip)
         return FALSE;
 
-      if (!can_software_clip_entry (entry, NULL,
+      if (!can_software_clip_entry (entry, NULL, NULL,
                                     entry->clip_stack, &clip_bounds))
         return FALSE;
 
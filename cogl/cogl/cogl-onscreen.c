@@ -38,6 +38,8 @@
 #include "cogl-framebuffer-private.h"
 #include "cogl-onscreen-template-private.h"
 #include "cogl-context-private.h"
+#include "cogl-atlas.h"
+#include "cogl-util-gl-private.h"
 #include "cogl-object-private.h"
 #include "cogl1-context.h"
 #include "cogl-closure-list-private.h"
@@ -318,6 +320,7 @@ cogl_onscreen_swap_buffers_with_damage (CoglOnscreen *onscreen,
   winsys = _cogl_framebuffer_get_winsys (framebuffer);
   winsys->onscreen_swap_buffers_with_damage (onscreen,
                                              rectangles, n_rectangles);
+  _cogl_gl_util_report_state_changes (framebuffer->context);
   cogl_framebuffer_discard_buffers (framebuffer,
                                     COGL_BUFFER_BIT_COLOR |
                                     COGL_BUFFER_BIT_DEPTH |
@@ -339,6 +342,8 @@ cogl_onscreen_swap_buffers_with_damage (CoglOnscreen *onscreen,
 
   onscreen->frame_counter++;
   framebuffer->mid_scene = FALSE;
+
+  _cogl_atlas_continue_defragmentations ();
 }
 
 void
@@ -374,6 +379,7 @@ cogl_onscreen_swap_region (CoglOnscreen *onscreen,
   winsys->onscreen_swap_region (COGL_ONSCREEN (framebuffer),
                                 rectangles,
                                 n_rectangles);
+  _cogl_gl_util_report_state_changes (framebuffer->context);
 
   cogl_framebuffer_discard_buffers (framebuffer,
                                     COGL_BUFFER_BIT_COLOR |
@@ -396,6 +402,8 @@ cogl_onscreen_swap_region (CoglOnscreen *onscreen,
 
   onscreen->frame_counter++;
   framebuffer->mid_scene = FALSE;
+
+  _cogl_atlas_continue_defragmentations ();
 }
 
 int
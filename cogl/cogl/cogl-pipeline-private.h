@@ -360,6 +360,22 @@ typedef struct _CoglPipelineHashState
   unsigned int hash;
 } CoglPipelineHashState;
 
+/* Pipelines that are deep in a chain of copies keep a cache of the
+ * authority for each sparse state group so that looking up the same
+ * state again doesn't have to walk up the ancestry. The cache is
+ * only valid while ->age matches _cogl_pipeline_authorities_age and
+ * ->valid has the bit for the state group set. */
+typedef struct
+{
+  unsigned int age;
+  unsigned long valid;
+  CoglPipeline *authorities[COGL_PIPELINE_STATE_SPARSE_COUNT];
+} CoglPipelineAuthoritiesCache;
+
+/* The authorities cache is only created once looking up some state
+ * has had to walk at least this many ancestors */
+#define COGL_PIPELINE_AUTHORITIES_CACHE_MIN_DEPTH 3
+
 /*
  * CoglPipelineDestroyCallback
  * @pipeline: The #CoglPipeline that has been destroyed
@@ -455,11 +471,10 @@ struct _CoglPipeline
    * const GList of layers, which we track here... */
   GList                *deprecated_get_layers_list;
 
-  /* XXX: consider adding an authorities cache to speed up sparse
-   * property value lookups:
-   * CoglPipeline *authorities_cache[COGL_PIPELINE_N_SPARSE_PROPERTIES];
-   * and corresponding authorities_cache_dirty:1 bitfield
-   */
+  /* A cache of the authority of each sparse state group, allocated
+   * lazily for pipelines that have a deep ancestry. See
+   * _cogl_pipeline_get_authority() */
+  CoglPipelineAuthoritiesCache *authorities_cache;
 
   /* bitfields */
 
@@ -597,13 +612,50 @@ _cogl_pipeline_get_parent (CoglPipeline *pipeline)
   return COGL_PIPELINE (parent_node);
 }
 
+/* Any change that may move the authority for some state to a
+ * different pipeline, ie, a change to the differences mask or the
+ * parent of a pipeline, has to be reported with
+ * _cogl_pipeline_authorities_changed(). If the pipeline has
+ * descendants that bumps this age, which invalidates every pipeline's
+ * authorities cache at once so that no dependants have to be
+ * tracked. */
+extern unsigned int _cogl_pipeline_authorities_age;
+
+void
+_cogl_pipeline_authorities_changed (CoglPipeline *pipeline);
+
+CoglPipeline *
+_cogl_pipeline_get_cached_authority (CoglPipeline *pipeline,
+                                     unsigned long difference);
+
+void
+_cogl_pipeline_cache_authority (CoglPipeline *pipeline,
+                                unsigned long difference,
+                                CoglPipeline *authority);
+
 static inline CoglPipeline *
 _cogl_pipeline_get_authority (CoglPipeline *pipeline,
                               unsigned long difference)
 {
   CoglPipeline *authority = pipeline;
-  while (!(authority->differences & difference))
-    authority = _cogl_pipeline_get_parent (authority);
+  int depth = 0;
+
+  if (pipeline->differences & difference)
+    return pipeline;
+
+  if (pipeline->authorities_cache)
+    return _cogl_pipeline_get_cached_authority (pipeline, difference);
+
+  do
+    {
+      authority = _cogl_pipeline_get_parent (authority);
+      depth++;
+    }
+  while (!(authority->differences & difference));
+
+  if (G_UNLIKELY (depth >= COGL_PIPELINE_AUTHORITIES_CACHE_MIN_DEPTH))
+    _cogl_pipeline_cache_authority (pipeline, difference, authority);
+
   return authority;
 }
 
@@ -1019,7 +1019,10 @@ cogl_pipeline_set_blend (CoglPipeline *pipeline,
         _cogl_pipeline_get_authority (parent, state);
 
       if (_cogl_pipeline_blend_state_equal (authority, old_authority))
-        pipeline->differences &= ~state;
+        {
+          pipeline->differences &= ~state;
+          _cogl_pipeline_authorities_changed (pipeline);
+        }
     }
 
   /* If we weren't previously the authority on this state then we need
@@ -1029,6 +1032,7 @@ cogl_pipeline_set_blend (CoglPipeline *pipeline,
   if (pipeline != authority)
     {
       pipeline->differences |= state;
+      _cogl_pipeline_authorities_changed (pipeline);
       _cogl_pipeline_prune_redundant_ancestry (pipeline);
     }
 
@@ -1131,7 +1135,10 @@ cogl_pipeline_set_user_program (CoglPipeline *pipeline,
         _cogl_pipeline_get_authority (parent, state);
 
       if (old_authority->big_state->user_program == program)
-        pipeline->differences &= ~state;
+        {
+          pipeline->differences &= ~state;
+          _cogl_pipeline_authorities_changed (pipeline);
+        }
     }
   else if (pipeline != authority)
     {
@@ -1140,6 +1147,7 @@ cogl_pipeline_set_user_program (CoglPipeline *pipeline,
        * that some of our ancestry will now become redundant, so we
        * aim to reparent ourselves if that's true... */
       pipeline->differences |= state;
+      _cogl_pipeline_authorities_changed (pipeline);
       _cogl_pipeline_prune_redundant_ancestry (pipeline);
     }
 
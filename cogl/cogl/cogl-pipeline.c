@@ -61,6 +61,8 @@ static void _cogl_pipeline_free (CoglPipeline *tex);
 static void recursively_free_layer_caches (CoglPipeline *pipeline);
 static CoglBool _cogl_pipeline_is_weak (CoglPipeline *pipeline);
 
+unsigned int _cogl_pipeline_authorities_age = 1;
+
 const CoglPipelineFragend *_cogl_pipeline_fragends[COGL_PIPELINE_N_FRAGENDS];
 const CoglPipelineVertend *_cogl_pipeline_vertends[COGL_PIPELINE_N_VERTENDS];
 /* The 'MAX' here is so that we don't define an empty array when there
@@ -169,6 +171,7 @@ _cogl_pipeline_init_default_pipeline (void)
   pipeline->blend_enable = COGL_PIPELINE_BLEND_ENABLE_AUTOMATIC;
   pipeline->layer_differences = NULL;
   pipeline->n_layers = 0;
+  pipeline->authorities_cache = NULL;
 
   pipeline->big_state = big_state;
   pipeline->has_big_state = TRUE;
@@ -243,6 +246,8 @@ _cogl_pipeline_unparent (CoglNode *pipeline)
 {
   /* Chain up */
   _cogl_pipeline_node_unparent_real (pipeline);
+
+  _cogl_pipeline_authorities_changed (COGL_PIPELINE (pipeline));
 }
 
 static CoglBool
@@ -288,6 +293,8 @@ _cogl_pipeline_set_parent (CoglPipeline *pipeline,
                                        _cogl_pipeline_unparent,
                                        take_strong_reference);
 
+  _cogl_pipeline_authorities_changed (pipeline);
+
   /* Since we just changed the ancestry of the pipeline its cache of
    * layers could now be invalid so free it... */
   if (pipeline->differences & COGL_PIPELINE_STATE_LAYERS)
@@ -388,6 +395,8 @@ _cogl_pipeline_copy (CoglPipeline *src, CoglBool is_weak)
   pipeline->deprecated_get_layers_list = NULL;
   pipeline->deprecated_get_layers_list_dirty = TRUE;
 
+  pipeline->authorities_cache = NULL;
+
   pipeline->progend = src->progend;
 
   pipeline->has_static_breadcrumb = FALSE;
@@ -512,6 +521,9 @@ _cogl_pipeline_free (CoglPipeline *pipeline)
 
   recursively_free_layer_caches (pipeline);
 
+  if (pipeline->authorities_cache)
+    g_slice_free (CoglPipelineAuthoritiesCache, pipeline->authorities_cache);
+
   g_slice_free (CoglPipeline, pipeline);
 }
 
@@ -1125,6 +1137,7 @@ check_for_blending_change:
     dest->dirty_real_blend_enable = TRUE;
 
   dest->differences |= differences;
+  _cogl_pipeline_authorities_changed (dest);
 }
 
 static void
@@ -1460,6 +1473,7 @@ _cogl_pipeline_pre_change_notify (CoglPipeline     *pipeline,
     {
       _cogl_pipeline_init_multi_property_sparse_state (pipeline, change);
       pipeline->differences |= change;
+      _cogl_pipeline_authorities_changed (pipeline);
     }
 
   /* Each pipeline has a sorted cache of the layers it depends on
@@ -1504,6 +1518,7 @@ _cogl_pipeline_add_layer_difference (CoglPipeline *pipeline,
                                     !inc_n_layers);
 
   pipeline->differences |= COGL_PIPELINE_STATE_LAYERS;
+  _cogl_pipeline_authorities_changed (pipeline);
 
   pipeline->layer_differences =
     g_list_prepend (pipeline->layer_differences, layer);
@@ -1554,6 +1569,7 @@ _cogl_pipeline_remove_layer_difference (CoglPipeline *pipeline,
     }
 
   pipeline->differences |= COGL_PIPELINE_STATE_LAYERS;
+  _cogl_pipeline_authorities_changed (pipeline);
 
   if (dec_n_layers)
     pipeline->n_layers--;
@@ -1577,7 +1593,10 @@ _cogl_pipeline_try_reverting_layers_authority (CoglPipeline *authority,
         }
 
       if (old_authority->n_layers == authority->n_layers)
-        authority->differences &= ~COGL_PIPELINE_STATE_LAYERS;
+        {
+          authority->differences &= ~COGL_PIPELINE_STATE_LAYERS;
+          _cogl_pipeline_authorities_changed (authority);
+        }
     }
 }
 
@@ -1677,6 +1696,7 @@ _cogl_pipeline_prune_to_n_layers (CoglPipeline *pipeline, int n)
                                     FALSE);
 
   pipeline->differences |= COGL_PIPELINE_STATE_LAYERS;
+  _cogl_pipeline_authorities_changed (pipeline);
   pipeline->n_layers = n;
 
   /* It's possible that this pipeline owns some of the layers being
@@ -1691,6 +1711,7 @@ _cogl_pipeline_prune_to_n_layers (CoglPipeline *pipeline, int n)
     }
 
   pipeline->differences |= COGL_PIPELINE_STATE_LAYERS;
+  _cogl_pipeline_authorities_changed (pipeline);
 }
 
 typedef struct
@@ -2179,6 +2200,81 @@ _cogl_pipeline_compare_differences (CoglPipeline *pipeline0,
   return pipelines_difference;
 }
 
+static CoglPipelineAuthoritiesCache *
+get_valid_authorities_cache (CoglPipeline *pipeline)
+{
+  CoglPipelineAuthoritiesCache *cache = pipeline->authorities_cache;
+
+  if (cache->age != _cogl_pipeline_authorities_age)
+    {
+      cache->age = _cogl_pipeline_authorities_age;
+      cache->valid = 0;
+    }
+
+  return cache;
+}
+
+void
+_cogl_pipeline_authorities_changed (CoglPipeline *pipeline)
+{
+  /* Only descendants can have cached this pipeline's ancestors, so if
+   * there are none, e.g. for a new copy or a pipeline being freed,
+   * only its own cache has to go and every other pipeline can keep
+   * theirs */
+  if (_cogl_list_empty (&COGL_NODE (pipeline)->children))
+    {
+      if (pipeline->authorities_cache)
+        pipeline->authorities_cache->valid = 0;
+    }
+  else
+    _cogl_pipeline_authorities_age++;
+}
+
+void
+_cogl_pipeline_cache_authority (CoglPipeline *pipeline,
+                                unsigned long difference,
+                                CoglPipeline *authority)
+{
+  CoglPipelineAuthoritiesCache *cache;
+
+  /* Only single sparse state groups have a slot in the cache */
+  if ((difference & (difference - 1)) ||
+      !(difference & COGL_PIPELINE_STATE_ALL_SPARSE))
+    return;
+
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_AUTHORITIES_CACHE)))
+    return;
+
+  if (pipeline->authorities_cache == NULL)
+    {
+      pipeline->authorities_cache =
+        g_slice_new0 (CoglPipelineAuthoritiesCache);
+    }
+
+  cache = get_valid_authorities_cache (pipeline);
+  cache->authorities[_cogl_util_ffsl (difference) - 1] = authority;
+  cache->valid |= difference;
+}
+
+CoglPipeline *
+_cogl_pipeline_get_cached_authority (CoglPipeline *pipeline,
+                                     unsigned long difference)
+{
+  CoglPipelineAuthoritiesCache *cache = get_valid_authorities_cache (pipeline);
+  CoglPipeline *authority = pipeline;
+
+  if ((cache->valid & difference) == difference &&
+      !(difference & (difference - 1)))
+    return cache->authorities[_cogl_util_ffsl (difference) - 1];
+
+  while (!(authority->differences & difference))
+    authority = _cogl_pipeline_get_parent (authority);
+
+  _cogl_pipeline_cache_authority (pipeline, difference, authority);
+
+  return authority;
+}
+
 static void
 _cogl_pipeline_resolve_authorities (CoglPipeline *pipeline,
                                     unsigned long differences,
@@ -2186,6 +2282,30 @@ _cogl_pipeline_resolve_authorities (CoglPipeline *pipeline,
 {
   unsigned long remaining = differences;
   CoglPipeline *authority = pipeline;
+  CoglPipelineAuthoritiesCache *cache = NULL;
+
+  /* Take whatever we can from the authorities cache and only walk
+   * the ancestry for the rest, remembering what we find */
+  if (pipeline->authorities_cache)
+    {
+      unsigned long cached;
+      int i;
+
+      cache = get_valid_authorities_cache (pipeline);
+      cached = cache->valid & remaining;
+
+      COGL_FLAGS_FOREACH_START (&cached, 1, i)
+        {
+          authorities[i] = cache->authorities[i];
+        }
+      COGL_FLAGS_FOREACH_END;
+
+      remaining &= ~cached;
+      if (remaining == 0)
+        return;
+
+      cache->valid |= remaining & COGL_PIPELINE_STATE_ALL_SPARSE;
+    }
 
   do
     {
@@ -2200,7 +2320,11 @@ _cogl_pipeline_resolve_authorities (CoglPipeline *pipeline,
           unsigned long state = (1L<<i);
 
           if (state & found)
-            authorities[i] = authority;
+            {
+              authorities[i] = authority;
+              if (cache)
+                cache->authorities[i] = authority;
+            }
           else if (state > found)
             break;
         }
@@ -2465,7 +2589,10 @@ _cogl_pipeline_update_authority (CoglPipeline *pipeline,
         _cogl_pipeline_get_authority (parent, state);
 
       if (comparitor (authority, old_authority))
-        pipeline->differences &= ~state;
+        {
+          pipeline->differences &= ~state;
+          _cogl_pipeline_authorities_changed (pipeline);
+        }
     }
   else if (pipeline != authority)
     {
@@ -2474,6 +2601,7 @@ _cogl_pipeline_update_authority (CoglPipeline *pipeline,
        * that some of our ancestry will now become redundant, so we
        * aim to reparent ourselves if that's true... */
       pipeline->differences |= state;
+      _cogl_pipeline_authorities_changed (pipeline);
       _cogl_pipeline_prune_redundant_ancestry (pipeline);
     }
 }
@@ -80,6 +80,8 @@ typedef enum
   /* This is currently only implemented for GLX, but isn't actually
    * that winsys dependent */
   COGL_PRIVATE_FEATURE_THREADED_SWAP_WAIT,
+  /* Linked GLSL programs can be retrieved and reloaded as binaries */
+  COGL_PRIVATE_FEATURE_PROGRAM_BINARY,
 
   COGL_N_PRIVATE_FEATURES
 } CoglPrivateFeature;
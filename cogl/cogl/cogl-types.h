@@ -869,13 +869,19 @@ typedef enum {
 /**
  * CoglReadPixelsFlags:
  * @COGL_READ_PIXELS_COLOR_BUFFER: Read from the color buffer
+ * @COGL_READ_PIXELS_NO_FLIP: Don't flip the rows to compensate for GL's
+ *   upside-down coordinate system, but leave them in the order GL
+ *   returns them. That is bottom to top for onscreen framebuffers and
+ *   top to bottom for offscreen ones. This avoids having to map a
+ *   pixel buffer backed bitmap to flip it.
  *
  * Flags for cogl_framebuffer_read_pixels_into_bitmap()
  *
  * Since: 1.0
  */
 typedef enum { /*< prefix=COGL_READ_PIXELS >*/
-  COGL_READ_PIXELS_COLOR_BUFFER = 1L << 0
+  COGL_READ_PIXELS_COLOR_BUFFER = 1L << 0,
+  COGL_READ_PIXELS_NO_FLIP      = 1L << 30
 } CoglReadPixelsFlags;
 
 /**
@@ -78,6 +78,15 @@
 #ifndef GL_MAP_INVALIDATE_BUFFER_BIT
 #define GL_MAP_INVALIDATE_BUFFER_BIT 0x0008
 #endif
+#ifndef GL_MAP_UNSYNCHRONIZED_BIT
+#define GL_MAP_UNSYNCHRONIZED_BIT 0x0020
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
 
 void
 _cogl_buffer_gl_create (CoglBuffer *buffer)
@@ -151,6 +160,35 @@ recreate_store (CoglBuffer *buffer,
   /* Clear any GL errors */
   _cogl_gl_util_clear_gl_errors (ctx);
 
+  /* Stream buffers are only written to so if the storage can be
+   * persistently mapped then it only needs to be mapped once and
+   * every map after that is free. The storage is immutable so this
+   * can only happen the first time. */
+  if ((buffer->flags & COGL_BUFFER_FLAG_STREAM) &&
+      ctx->glBufferStorage &&
+      !buffer->store_created)
+    {
+      GLbitfield gl_flags = (GL_MAP_WRITE_BIT |
+                             GL_MAP_PERSISTENT_BIT |
+                             GL_MAP_COHERENT_BIT);
+
+      ctx->glBufferStorage (gl_target, buffer->size, NULL, gl_flags);
+
+      if (_cogl_gl_util_catch_out_of_memory (ctx, error))
+        return FALSE;
+
+      buffer->persistent_data = ctx->glMapBufferRange (gl_target,
+                                                       0,
+                                                       buffer->size,
+                                                       gl_flags);
+
+      if (_cogl_gl_util_catch_out_of_memory (ctx, error))
+        return FALSE;
+
+      buffer->store_created = TRUE;
+      return TRUE;
+    }
+
   ctx->glBufferData (gl_target,
                      buffer->size,
                      NULL,
@@ -227,6 +265,12 @@ _cogl_buffer_gl_map_range (CoglBuffer *buffer,
       return NULL;
     }
 
+  if (buffer->persistent_data)
+    {
+      buffer->flags |= COGL_BUFFER_FLAG_MAPPED;
+      return buffer->persistent_data + offset;
+    }
+
   target = buffer->last_target;
   _cogl_buffer_bind_no_create (buffer, target);
 
@@ -250,6 +294,15 @@ _cogl_buffer_gl_map_range (CoglBuffer *buffer,
       if ((access & COGL_BUFFER_ACCESS_WRITE))
         gl_access |= GL_MAP_WRITE_BIT;
 
+      if ((buffer->flags & COGL_BUFFER_FLAG_STREAM) && buffer->store_created)
+        {
+          /* The user of a stream buffer fences the ranges it has
+           * written so the driver doesn't need to synchronize the map
+           * and the storage must never be orphaned */
+          gl_access |= GL_MAP_UNSYNCHRONIZED_BIT;
+          hints &= ~COGL_BUFFER_MAP_HINT_DISCARD;
+        }
+
       if ((hints & COGL_BUFFER_MAP_HINT_DISCARD))
         {
           /* glMapBufferRange generates an error if you pass the
@@ -276,6 +329,13 @@ _cogl_buffer_gl_map_range (CoglBuffer *buffer,
               _cogl_buffer_gl_unbind (buffer);
               return NULL;
             }
+
+          if (buffer->persistent_data)
+            {
+              _cogl_buffer_gl_unbind (buffer);
+              buffer->flags |= COGL_BUFFER_FLAG_MAPPED;
+              return buffer->persistent_data + offset;
+            }
         }
 
       /* Clear any GL errors */
@@ -339,6 +399,14 @@ _cogl_buffer_gl_unmap (CoglBuffer *buffer)
 {
   CoglContext *ctx = buffer->context;
 
+  /* Persistently mapped storage stays mapped for the lifetime of the
+   * buffer */
+  if (buffer->persistent_data)
+    {
+      buffer->flags &= ~COGL_BUFFER_FLAG_MAPPED;
+      return;
+    }
+
   _cogl_buffer_bind_no_create (buffer, buffer->last_target);
 
   GE( ctx, glUnmapBuffer (convert_bind_target_to_gl_target
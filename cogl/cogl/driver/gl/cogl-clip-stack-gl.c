@@ -224,7 +224,7 @@ add_stencil_clip_rectangle (CoglFramebuffer *framebuffer,
 
   if (first)
     {
-      GE( ctx, glEnable (GL_STENCIL_TEST) );
+      _cogl_gl_util_set_capability (ctx, GL_STENCIL_TEST, TRUE);
 
       /* Initially disallow everything */
       GE( ctx, glClearStencil (0) );
@@ -297,10 +297,14 @@ add_stencil_clip_silhouette (CoglFramebuffer *framebuffer,
   _cogl_pipeline_flush_gl_state (ctx, ctx->stencil_pipeline,
                                  framebuffer, FALSE, FALSE);
 
-  GE( ctx, glEnable (GL_STENCIL_TEST) );
+  _cogl_gl_util_set_capability (ctx, GL_STENCIL_TEST, TRUE);
 
   GE( ctx, glColorMask (FALSE, FALSE, FALSE, FALSE) );
   GE( ctx, glDepthMask (FALSE) );
+  /* Keep the state caches honest so the pipeline flushing code
+     doesn't skip restoring the masks */
+  ctx->current_gl_color_mask = 0;
+  ctx->depth_writing_enabled_cache = FALSE;
 
   if (merge)
     {
@@ -362,6 +366,8 @@ add_stencil_clip_silhouette (CoglFramebuffer *framebuffer,
   GE (ctx, glStencilMask (~(GLuint) 0));
   GE (ctx, glDepthMask (TRUE));
   GE (ctx, glColorMask (TRUE, TRUE, TRUE, TRUE));
+  ctx->current_gl_color_mask = COGL_COLOR_MASK_ALL;
+  ctx->depth_writing_enabled_cache = TRUE;
 
   GE (ctx, glStencilFunc (GL_EQUAL, 0x1, 0x1));
   GE (ctx, glStencilOp (GL_KEEP, GL_KEEP, GL_KEEP));
@@ -460,7 +466,7 @@ _cogl_clip_stack_gl_flush (CoglClipStack *stack,
 
   if (has_clip_planes)
     disable_clip_planes (ctx);
-  GE( ctx, glDisable (GL_STENCIL_TEST) );
+  _cogl_gl_util_set_capability (ctx, GL_STENCIL_TEST, FALSE);
 
   /* If the stack is empty then there's nothing else to do
    *
@@ -471,7 +477,7 @@ _cogl_clip_stack_gl_flush (CoglClipStack *stack,
       COGL_NOTE (CLIPPING, "Flushed empty clip stack");
 
       ctx->current_clip_stack_uses_stencil = FALSE;
-      GE (ctx, glDisable (GL_SCISSOR_TEST));
+      _cogl_gl_util_set_capability (ctx, GL_SCISSOR_TEST, FALSE);
       return;
     }
 
@@ -536,10 +542,11 @@ _cogl_clip_stack_gl_flush (CoglClipStack *stack,
              scissor_x0, scissor_y0,
              scissor_x1, scissor_y1);
 
-  GE (ctx, glEnable (GL_SCISSOR_TEST));
-  GE (ctx, glScissor (scissor_x0, scissor_y_start,
-                      scissor_x1 - scissor_x0,
-                      scissor_y1 - scissor_y0));
+  _cogl_gl_util_set_capability (ctx, GL_SCISSOR_TEST, TRUE);
+  _cogl_gl_util_set_scissor (ctx,
+                             scissor_x0, scissor_y_start,
+                             scissor_x1 - scissor_x0,
+                             scissor_y1 - scissor_y0);
 
   /* Add all of the entries. This will end up adding them in the
      reverse order that they were specified but as all of the clips
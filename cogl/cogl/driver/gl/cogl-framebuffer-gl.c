@@ -150,11 +150,11 @@ _cogl_framebuffer_gl_flush_viewport_state (CoglFramebuffer *framebuffer)
              framebuffer->viewport_width,
              framebuffer->viewport_height);
 
-  GE (framebuffer->context,
-      glViewport (framebuffer->viewport_x,
-                  gl_viewport_y,
-                  framebuffer->viewport_width,
-                  framebuffer->viewport_height));
+  _cogl_gl_util_set_viewport (framebuffer->context,
+                              framebuffer->viewport_x,
+                              gl_viewport_y,
+                              framebuffer->viewport_width,
+                              framebuffer->viewport_height);
 }
 
 static void
@@ -175,7 +175,10 @@ _cogl_framebuffer_gl_flush_dither_state (CoglFramebuffer *framebuffer)
       else
         GE (ctx, glDisable (GL_DITHER));
       ctx->current_gl_dither_enabled = framebuffer->dither_enabled;
+      _COGL_GL_STATE_ISSUED (ctx);
     }
+  else
+    _COGL_GL_STATE_ELIDED (ctx);
 }
 
 static void
@@ -1132,6 +1135,12 @@ _cogl_framebuffer_gl_finish (CoglFramebuffer *framebuffer)
   GE (framebuffer->context, glFinish ());
 }
 
+void
+_cogl_framebuffer_gl_flush (CoglFramebuffer *framebuffer)
+{
+  GE (framebuffer->context, glFlush ());
+}
+
 void
 _cogl_framebuffer_gl_discard_buffers (CoglFramebuffer *framebuffer,
                                       unsigned long buffers)
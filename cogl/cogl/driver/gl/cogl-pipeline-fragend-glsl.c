@@ -1003,7 +1003,6 @@ _cogl_pipeline_fragend_glsl_end (CoglPipeline *pipeline,
     {
       const char *source_strings[2];
       GLint lengths[2];
-      GLint compile_status;
       GLuint shader;
       CoglPipelineSnippetData snippet_data;
 
@@ -1074,19 +1073,8 @@ _cogl_pipeline_fragend_glsl_end (CoglPipeline *pipeline,
                                                      2, /* count */
                                                      source_strings, lengths);
 
-      GE( ctx, glCompileShader (shader) );
-      GE( ctx, glGetShaderiv (shader, GL_COMPILE_STATUS, &compile_status) );
-
-      if (!compile_status)
-        {
-          GLint len = 0;
-          char *shader_log;
-
-          GE( ctx, glGetShaderiv (shader, GL_INFO_LOG_LENGTH, &len) );
-          shader_log = g_alloca (len);
-          GE( ctx, glGetShaderInfoLog (shader, len, &len, shader_log) );
-          g_warning ("Shader compilation failed:\n%s", shader_log);
-        }
+      /* Compiled by the progend, unless the program is loaded from a
+       * binary */
 
       shader_state->header = NULL;
       shader_state->source = NULL;
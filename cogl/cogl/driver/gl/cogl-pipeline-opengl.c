@@ -141,7 +141,10 @@ _cogl_set_active_texture_unit (int unit_index)
     {
       GE (ctx, glActiveTexture (GL_TEXTURE0 + unit_index));
       ctx->active_texture_unit = unit_index;
+      _COGL_GL_STATE_ISSUED (ctx);
     }
+  else
+    _COGL_GL_STATE_ELIDED (ctx);
 }
 
 /* Note: _cogl_bind_gl_texture_transient conceptually has slightly
@@ -189,9 +192,13 @@ _cogl_bind_gl_texture_transient (GLenum gl_target,
   if (unit->gl_texture == gl_texture &&
       !unit->dirty_gl_texture &&
       !unit->is_foreign)
-    return;
+    {
+      _COGL_GL_STATE_ELIDED (ctx);
+      return;
+    }
 
   GE (ctx, glBindTexture (gl_target, gl_texture));
+  _COGL_GL_STATE_ISSUED (ctx);
 
   unit->dirty_gl_texture = TRUE;
   unit->is_foreign = is_foreign;
@@ -251,8 +258,11 @@ set_glsl_program (GLuint gl_program)
 {
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
 
-  if (ctx->current_gl_program != gl_program)
+  if (ctx->current_gl_program == gl_program)
+    _COGL_GL_STATE_ELIDED (ctx);
+  else
     {
+      _COGL_GL_STATE_ISSUED (ctx);
       _cogl_gl_util_clear_gl_errors (ctx);
       ctx->glUseProgram (gl_program);
       if (_cogl_gl_util_get_error (ctx) == GL_NO_ERROR)
@@ -406,6 +416,36 @@ blend_factor_uses_constant (GLenum blend_factor)
 
 #endif
 
+static void
+flush_blend_func (CoglContext *ctx,
+                  GLenum src_rgb,
+                  GLenum dst_rgb,
+                  GLenum src_alpha,
+                  GLenum dst_alpha)
+{
+  GLenum *cache = ctx->gl_blend_func_cache;
+
+  if (cache[0] == src_rgb && cache[1] == dst_rgb &&
+      cache[2] == src_alpha && cache[3] == dst_alpha)
+    {
+      _COGL_GL_STATE_ELIDED (ctx);
+      return;
+    }
+
+#if defined(HAVE_COGL_GLES2) || defined(HAVE_COGL_GL)
+  if (src_rgb != src_alpha || dst_rgb != dst_alpha)
+    GE (ctx, glBlendFuncSeparate (src_rgb, dst_rgb, src_alpha, dst_alpha));
+  else
+#endif
+    GE (ctx, glBlendFunc (src_rgb, dst_rgb));
+
+  cache[0] = src_rgb;
+  cache[1] = dst_rgb;
+  cache[2] = src_alpha;
+  cache[3] = dst_alpha;
+  _COGL_GL_STATE_ISSUED (ctx);
+}
+
 static void
 flush_depth_state (CoglContext *ctx,
                    CoglDepthState *depth_state)
@@ -422,13 +462,17 @@ flush_depth_state (CoglContext *ctx,
       else
         GE (ctx, glDisable (GL_DEPTH_TEST));
       ctx->depth_test_enabled_cache = depth_state->test_enabled;
+      _COGL_GL_STATE_ISSUED (ctx);
     }
+  else
+    _COGL_GL_STATE_ELIDED (ctx);
 
   if (ctx->depth_test_function_cache != depth_state->test_function &&
       depth_state->test_enabled == TRUE)
     {
       GE (ctx, glDepthFunc (depth_state->test_function));
       ctx->depth_test_function_cache = depth_state->test_function;
+      _COGL_GL_STATE_ISSUED (ctx);
     }
 
   if (ctx->depth_writing_enabled_cache != depth_writing_enabled)
@@ -436,7 +480,10 @@ flush_depth_state (CoglContext *ctx,
       GE (ctx, glDepthMask (depth_writing_enabled ?
                             GL_TRUE : GL_FALSE));
       ctx->depth_writing_enabled_cache = depth_writing_enabled;
+      _COGL_GL_STATE_ISSUED (ctx);
     }
+  else
+    _COGL_GL_STATE_ELIDED (ctx);
 
   if (ctx->driver != COGL_DRIVER_GLES1 &&
       (ctx->depth_range_near_cache != depth_state->range_near ||
@@ -451,6 +498,7 @@ flush_depth_state (CoglContext *ctx,
 
       ctx->depth_range_near_cache = depth_state->range_near;
       ctx->depth_range_far_cache = depth_state->range_far;
+      _COGL_GL_STATE_ISSUED (ctx);
     }
 }
 
@@ -522,8 +570,11 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
       /* GLES 1 only has glBlendFunc */
       if (ctx->driver == COGL_DRIVER_GLES1)
         {
-          GE (ctx, glBlendFunc (blend_state->blend_src_factor_rgb,
-                                blend_state->blend_dst_factor_rgb));
+          flush_blend_func (ctx,
+                            blend_state->blend_src_factor_rgb,
+                            blend_state->blend_dst_factor_rgb,
+                            blend_state->blend_src_factor_rgb,
+                            blend_state->blend_dst_factor_rgb);
         }
 #if defined(HAVE_COGL_GLES2) || defined(HAVE_COGL_GL)
       else
@@ -534,40 +585,65 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
               blend_factor_uses_constant (blend_state->blend_dst_factor_rgb) ||
               blend_factor_uses_constant (blend_state->blend_dst_factor_alpha))
             {
-              float red =
+              float color[4];
+
+              color[0] =
                 cogl_color_get_red_float (&blend_state->blend_constant);
-              float green =
+              color[1] =
                 cogl_color_get_green_float (&blend_state->blend_constant);
-              float blue =
+              color[2] =
                 cogl_color_get_blue_float (&blend_state->blend_constant);
-              float alpha =
+              color[3] =
                 cogl_color_get_alpha_float (&blend_state->blend_constant);
 
-
-              GE (ctx, glBlendColor (red, green, blue, alpha));
+              if (memcmp (ctx->gl_blend_color_cache, color,
+                          sizeof (color)) != 0)
+                {
+                  GE (ctx, glBlendColor (color[0], color[1],
+                                         color[2], color[3]));
+                  memcpy (ctx->gl_blend_color_cache, color, sizeof (color));
+                  _COGL_GL_STATE_ISSUED (ctx);
+                }
+              else
+                _COGL_GL_STATE_ELIDED (ctx);
             }
 
-          if (ctx->glBlendEquationSeparate &&
-              blend_state->blend_equation_rgb !=
+          if (ctx->gl_blend_equation_cache[0] ==
+              blend_state->blend_equation_rgb &&
+              ctx->gl_blend_equation_cache[1] ==
               blend_state->blend_equation_alpha)
-            GE (ctx,
-                glBlendEquationSeparate (blend_state->blend_equation_rgb,
-                                         blend_state->blend_equation_alpha));
+            _COGL_GL_STATE_ELIDED (ctx);
           else
-            GE (ctx, glBlendEquation (blend_state->blend_equation_rgb));
-
-          if (ctx->glBlendFuncSeparate &&
-              (blend_state->blend_src_factor_rgb !=
-               blend_state->blend_src_factor_alpha ||
-               (blend_state->blend_dst_factor_rgb !=
-                blend_state->blend_dst_factor_alpha)))
-            GE (ctx, glBlendFuncSeparate (blend_state->blend_src_factor_rgb,
-                                          blend_state->blend_dst_factor_rgb,
-                                          blend_state->blend_src_factor_alpha,
-                                          blend_state->blend_dst_factor_alpha));
+            {
+              if (ctx->glBlendEquationSeparate &&
+                  blend_state->blend_equation_rgb !=
+                  blend_state->blend_equation_alpha)
+                GE (ctx,
+                    glBlendEquationSeparate (blend_state->blend_equation_rgb,
+                                             blend_state->blend_equation_alpha));
+              else
+                GE (ctx, glBlendEquation (blend_state->blend_equation_rgb));
+
+              ctx->gl_blend_equation_cache[0] = blend_state->blend_equation_rgb;
+              ctx->gl_blend_equation_cache[1] =
+                ctx->glBlendEquationSeparate ?
+                blend_state->blend_equation_alpha :
+                blend_state->blend_equation_rgb;
+              _COGL_GL_STATE_ISSUED (ctx);
+            }
+
+          if (ctx->glBlendFuncSeparate)
+            flush_blend_func (ctx,
+                              blend_state->blend_src_factor_rgb,
+                              blend_state->blend_dst_factor_rgb,
+                              blend_state->blend_src_factor_alpha,
+                              blend_state->blend_dst_factor_alpha);
           else
-            GE (ctx, glBlendFunc (blend_state->blend_src_factor_rgb,
-                                  blend_state->blend_dst_factor_rgb));
+            flush_blend_func (ctx,
+                              blend_state->blend_src_factor_rgb,
+                              blend_state->blend_dst_factor_rgb,
+                              blend_state->blend_src_factor_rgb,
+                              blend_state->blend_dst_factor_rgb);
         }
 #endif
     }
@@ -636,11 +712,17 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
       if (ctx->current_draw_buffer)
         color_mask &= ctx->current_draw_buffer->color_mask;
 
-      GE (ctx, glColorMask (!!(color_mask & COGL_COLOR_MASK_RED),
-                            !!(color_mask & COGL_COLOR_MASK_GREEN),
-                            !!(color_mask & COGL_COLOR_MASK_BLUE),
-                            !!(color_mask & COGL_COLOR_MASK_ALPHA)));
-      ctx->current_gl_color_mask = color_mask;
+      if (ctx->current_gl_color_mask != color_mask)
+        {
+          GE (ctx, glColorMask (!!(color_mask & COGL_COLOR_MASK_RED),
+                                !!(color_mask & COGL_COLOR_MASK_GREEN),
+                                !!(color_mask & COGL_COLOR_MASK_BLUE),
+                                !!(color_mask & COGL_COLOR_MASK_ALPHA)));
+          ctx->current_gl_color_mask = color_mask;
+          _COGL_GL_STATE_ISSUED (ctx);
+        }
+      else
+        _COGL_GL_STATE_ELIDED (ctx);
     }
 
   if (pipelines_difference & COGL_PIPELINE_STATE_CULL_FACE)
@@ -651,12 +733,14 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
         = &authority->big_state->cull_face_state;
 
       if (cull_face_state->mode == COGL_PIPELINE_CULL_FACE_MODE_NONE)
-        GE( ctx, glDisable (GL_CULL_FACE) );
+        _cogl_gl_util_set_capability (ctx, GL_CULL_FACE, FALSE);
       else
         {
           CoglBool invert_winding;
+          GLenum cull_face_mode = GL_BACK;
+          GLenum front_face = GL_CCW;
 
-          GE( ctx, glEnable (GL_CULL_FACE) );
+          _cogl_gl_util_set_capability (ctx, GL_CULL_FACE, TRUE);
 
           switch (cull_face_state->mode)
             {
@@ -664,18 +748,27 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
               g_assert_not_reached ();
 
             case COGL_PIPELINE_CULL_FACE_MODE_FRONT:
-              GE( ctx, glCullFace (GL_FRONT) );
+              cull_face_mode = GL_FRONT;
               break;
 
             case COGL_PIPELINE_CULL_FACE_MODE_BACK:
-              GE( ctx, glCullFace (GL_BACK) );
+              cull_face_mode = GL_BACK;
               break;
 
             case COGL_PIPELINE_CULL_FACE_MODE_BOTH:
-              GE( ctx, glCullFace (GL_FRONT_AND_BACK) );
+              cull_face_mode = GL_FRONT_AND_BACK;
               break;
             }
 
+          if (ctx->gl_cull_face_mode_cache != cull_face_mode)
+            {
+              GE( ctx, glCullFace (cull_face_mode) );
+              ctx->gl_cull_face_mode_cache = cull_face_mode;
+              _COGL_GL_STATE_ISSUED (ctx);
+            }
+          else
+            _COGL_GL_STATE_ELIDED (ctx);
+
           /* If we are painting to an offscreen framebuffer then we
              need to invert the winding of the front face because
              everything is painted upside down */
@@ -684,13 +777,22 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
           switch (cull_face_state->front_winding)
             {
             case COGL_WINDING_CLOCKWISE:
-              GE( ctx, glFrontFace (invert_winding ? GL_CCW : GL_CW) );
+              front_face = invert_winding ? GL_CCW : GL_CW;
               break;
 
             case COGL_WINDING_COUNTER_CLOCKWISE:
-              GE( ctx, glFrontFace (invert_winding ? GL_CW : GL_CCW) );
+              front_face = invert_winding ? GL_CW : GL_CCW;
               break;
             }
+
+          if (ctx->gl_front_face_cache != front_face)
+            {
+              GE( ctx, glFrontFace (front_face) );
+              ctx->gl_front_face_cache = front_face;
+              _COGL_GL_STATE_ISSUED (ctx);
+            }
+          else
+            _COGL_GL_STATE_ELIDED (ctx);
         }
     }
 
@@ -718,7 +820,10 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
       /* XXX: we shouldn't update any other blend state if blending
        * is disabled! */
       ctx->gl_blend_enable_cache = pipeline->real_blend_enable;
+      _COGL_GL_STATE_ISSUED (ctx);
     }
+  else
+    _COGL_GL_STATE_ELIDED (ctx);
 }
 
 static int
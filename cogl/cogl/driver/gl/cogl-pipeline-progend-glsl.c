@@ -56,6 +56,8 @@
 #include "cogl-attribute-private.h"
 #include "cogl-framebuffer-private.h"
 #include "cogl-pipeline-progend-glsl-private.h"
+#include "cogl-program-binary-cache-private.h"
+#include "cogl-glsl-shader-private.h"
 
 /* These are used to generalise updating some uniforms that are
    required when building for drivers missing some fixed function
@@ -281,7 +283,10 @@ destroy_program_state (void *user_data,
       _cogl_matrix_entry_cache_destroy (&program_state->modelview_cache);
 
       if (program_state->program)
-        GE( ctx, glDeleteProgram (program_state->program) );
+        {
+          _cogl_program_binary_cache_cancel (ctx, program_state->program);
+          GE( ctx, glDeleteProgram (program_state->program) );
+        }
 
       g_free (program_state->unit_state);
 
@@ -729,14 +734,19 @@ _cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
   if (program_state->program && user_program &&
        user_program->age != program_state->user_program_age)
     {
+      _cogl_program_binary_cache_cancel (ctx, program_state->program);
       GE( ctx, glDeleteProgram (program_state->program) );
       program_state->program = 0;
     }
 
   if (program_state->program == 0)
     {
+      GLuint backend_shaders[2];
+      int n_backend_shaders = 0;
       GLuint backend_shader;
+      char *binary_path;
       GSList *l;
+      int i;
 
       GE_RET( program_state->program, ctx, glCreateProgram () );
 
@@ -760,9 +770,12 @@ _cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
 
       /* Attach any shaders from the GLSL backends */
       if ((backend_shader = _cogl_pipeline_fragend_glsl_get_shader (pipeline)))
-        GE( ctx, glAttachShader (program_state->program, backend_shader) );
+        backend_shaders[n_backend_shaders++] = backend_shader;
       if ((backend_shader = _cogl_pipeline_vertend_glsl_get_shader (pipeline)))
-        GE( ctx, glAttachShader (program_state->program, backend_shader) );
+        backend_shaders[n_backend_shaders++] = backend_shader;
+
+      for (i = 0; i < n_backend_shaders; i++)
+        GE( ctx, glAttachShader (program_state->program, backend_shaders[i]) );
 
       /* XXX: OpenGL as a special case requires the vertex position to
        * be bound to generic attribute 0 so for simplicity we
@@ -771,7 +784,30 @@ _cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
       GE( ctx, glBindAttribLocation (program_state->program,
                                      0, "cogl_position_in"));
 
-      link_program (program_state->program);
+      /* Skip compiling and linking entirely if the same program has
+       * been linked before */
+      binary_path = _cogl_program_binary_cache_get_path (ctx,
+                                                         program_state->program);
+
+      if (binary_path == NULL ||
+          !_cogl_program_binary_cache_load (ctx, binary_path,
+                                            program_state->program))
+        {
+          for (i = 0; i < n_backend_shaders; i++)
+            _cogl_glsl_shader_ensure_compiled (ctx, backend_shaders[i]);
+
+          if (binary_path)
+            _cogl_program_binary_cache_prepare_link (ctx,
+                                                     program_state->program);
+
+          link_program (program_state->program);
+
+          if (binary_path)
+            _cogl_program_binary_cache_store (ctx, binary_path,
+                                              program_state->program);
+        }
+
+      g_free (binary_path);
 
       program_changed = TRUE;
     }
@@ -0,0 +1,72 @@
+/*
+ * Cogl
+ *
+ * A Low Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __COGL_PROGRAM_BINARY_CACHE_PRIVATE_H
+#define __COGL_PROGRAM_BINARY_CACHE_PRIVATE_H
+
+#include "cogl-context-private.h"
+
+/* Returns the file a binary of @program would be stored in, derived
+ * from the sources of the shaders currently attached to it and the GL
+ * driver in use, or NULL if binaries can't be cached. */
+char *
+_cogl_program_binary_cache_get_path (CoglContext *ctx,
+                                     GLuint program);
+
+/* Tries to load @program from the binary at @path instead of linking
+ * it. Returns FALSE if there is no usable binary, in which case
+ * @program still has to be linked. */
+CoglBool
+_cogl_program_binary_cache_load (CoglContext *ctx,
+                                 const char *path,
+                                 GLuint program);
+
+/* Asks the driver to keep the binary of @program retrievable. This
+ * has to be called before linking it. */
+void
+_cogl_program_binary_cache_prepare_link (CoglContext *ctx,
+                                         GLuint program);
+
+/* Stores the binary of the linked @program at @path. This is deferred
+ * to an idle so that it doesn't wait for the link in the middle of a
+ * frame. */
+void
+_cogl_program_binary_cache_store (CoglContext *ctx,
+                                  const char *path,
+                                  GLuint program);
+
+/* Forgets about any binary of @program that is still to be stored.
+ * This has to be called before deleting the program. */
+void
+_cogl_program_binary_cache_cancel (CoglContext *ctx,
+                                   GLuint program);
+
+void
+_cogl_program_binary_cache_free (CoglContext *ctx);
+
+#endif /* __COGL_PROGRAM_BINARY_CACHE_PRIVATE_H */
@@ -0,0 +1,412 @@
+/*
+ * Cogl
+ *
+ * A Low Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Linking the generated GLSL programs is the bulk of the time Cogl
+ * spends before the first frames can be drawn. Where the driver lets us
+ * retrieve linked programs, they are kept in the user's cache directory
+ * and reloaded instead of compiling and linking the same sources again.
+ *
+ * Binaries are only valid for the driver that created them, so they are
+ * kept in a directory named after the driver identification strings.
+ * The directories of other drivers, eg. from before an update, are
+ * removed. Drivers are also allowed to reject a binary at any time, eg.
+ * after an update that didn't change those strings, in which case the
+ * program is linked from source again and the binary replaced.
+ *
+ * Retrieving a binary waits for the driver to finish linking, so it is
+ * done from an idle after the frame that needed the program.
+ */
+
+#include "cogl-config.h"
+
+#include <errno.h>
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include "cogl-private.h"
+#include "cogl-context-private.h"
+#include "cogl-poll-private.h"
+#include "cogl-debug.h"
+#include "cogl-util-gl-private.h"
+#include "cogl-program-binary-cache-private.h"
+
+/* Each file starts with this, followed by the binary format as a
+ * native endian 32-bit integer and the binary itself */
+static const char binary_magic[8] = "CoglPB1";
+
+#define BINARY_HEADER_SIZE (sizeof (binary_magic) + sizeof (uint32_t))
+
+typedef struct
+{
+  char *path;
+  GLuint program;
+} PendingBinary;
+
+static void
+pending_binary_free (PendingBinary *pending)
+{
+  g_free (pending->path);
+  g_slice_free (PendingBinary, pending);
+}
+
+static const char *
+get_cache_dir (CoglContext *ctx)
+{
+  if (ctx->program_binary_dir == NULL)
+    {
+      static const GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+      GChecksum *checksum = g_checksum_new (G_CHECKSUM_SHA256);
+      char glsl_version[16];
+      int i;
+
+      for (i = 0; i < G_N_ELEMENTS (names); i++)
+        {
+          const char *str = (const char *) ctx->glGetString (names[i]);
+
+          /* Keep the terminator so the strings can't run into each other */
+          if (str)
+            g_checksum_update (checksum, (const guchar *) str, strlen (str) + 1);
+        }
+
+      g_snprintf (glsl_version, sizeof (glsl_version), "%i",
+                  ctx->glsl_version_to_use);
+      g_checksum_update (checksum, (const guchar *) glsl_version, -1);
+
+      ctx->program_binary_dir = g_build_filename (g_get_user_cache_dir (),
+                                                  "cogl",
+                                                  "program-binaries",
+                                                  g_checksum_get_string (checksum),
+                                                  NULL);
+
+      g_checksum_free (checksum);
+    }
+
+  return ctx->program_binary_dir;
+}
+
+char *
+_cogl_program_binary_cache_get_path (CoglContext *ctx,
+                                     GLuint program)
+{
+  GChecksum *checksum;
+  GLint n_shaders = 0;
+  GLuint *shaders;
+  char *basename, *path;
+  int i;
+
+  if (!_cogl_has_private_feature (ctx, COGL_PRIVATE_FEATURE_PROGRAM_BINARY) ||
+      G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_PROGRAM_CACHES)))
+    return NULL;
+
+  GE( ctx, glGetProgramiv (program, GL_ATTACHED_SHADERS, &n_shaders) );
+  if (n_shaders <= 0)
+    return NULL;
+
+  shaders = g_alloca (sizeof (GLuint) * n_shaders);
+  GE( ctx, glGetAttachedShaders (program, n_shaders, &n_shaders, shaders) );
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+
+  for (i = 0; i < n_shaders; i++)
+    {
+      GLint type = 0, length = 0;
+      GLsizei source_length = 0;
+      char *source;
+
+      GE( ctx, glGetShaderiv (shaders[i], GL_SHADER_TYPE, &type) );
+      GE( ctx, glGetShaderiv (shaders[i], GL_SHADER_SOURCE_LENGTH, &length) );
+
+      source = g_malloc (MAX (length, 1));
+      GE( ctx, glGetShaderSource (shaders[i], MAX (length, 1),
+                                  &source_length, source) );
+
+      g_checksum_update (checksum, (const guchar *) &type, sizeof (type));
+      g_checksum_update (checksum, (const guchar *) &source_length,
+                         sizeof (source_length));
+      g_checksum_update (checksum, (const guchar *) source, source_length);
+
+      g_free (source);
+    }
+
+  basename = g_strconcat (g_checksum_get_string (checksum), ".bin", NULL);
+  path = g_build_filename (get_cache_dir (ctx), basename, NULL);
+
+  g_free (basename);
+  g_checksum_free (checksum);
+
+  return path;
+}
+
+CoglBool
+_cogl_program_binary_cache_load (CoglContext *ctx,
+                                 const char *path,
+                                 GLuint program)
+{
+  char *contents;
+  gsize length;
+  GLint link_status = GL_FALSE;
+
+  if (!g_file_get_contents (path, &contents, &length, NULL))
+    return FALSE;
+
+  if (length > BINARY_HEADER_SIZE &&
+      memcmp (contents, binary_magic, sizeof (binary_magic)) == 0)
+    {
+      uint32_t format;
+
+      memcpy (&format, contents + sizeof (binary_magic), sizeof (format));
+
+      /* A rejected binary is expected to raise a GL error, so don't
+       * let GE() warn about it */
+      ctx->glProgramBinary (program, format,
+                            contents + BINARY_HEADER_SIZE,
+                            length - BINARY_HEADER_SIZE);
+      _cogl_gl_util_clear_gl_errors (ctx);
+
+      GE( ctx, glGetProgramiv (program, GL_LINK_STATUS, &link_status) );
+    }
+
+  g_free (contents);
+
+  if (!link_status)
+    {
+      COGL_NOTE (OPENGL, "Discarding program binary %s", path);
+      g_unlink (path);
+      return FALSE;
+    }
+
+  COGL_NOTE (OPENGL, "Loaded program binary %s", path);
+
+  return TRUE;
+}
+
+static void
+store_binary (CoglContext *ctx,
+              const char *path,
+              GLuint program)
+{
+  GLint link_status = GL_FALSE, length = 0;
+  GLsizei binary_length = 0;
+  GLenum format = 0;
+  uint32_t format32;
+  char *contents, *dir;
+  GError *error = NULL;
+
+  GE( ctx, glGetProgramiv (program, GL_LINK_STATUS, &link_status) );
+  if (!link_status)
+    return;
+
+  GE( ctx, glGetProgramiv (program, GL_PROGRAM_BINARY_LENGTH, &length) );
+  if (length <= 0)
+    return;
+
+  contents = g_malloc (BINARY_HEADER_SIZE + length);
+
+  GE( ctx, glGetProgramBinary (program, length, &binary_length, &format,
+                               contents + BINARY_HEADER_SIZE) );
+  if (binary_length <= 0)
+    goto out;
+
+  format32 = format;
+  memcpy (contents, binary_magic, sizeof (binary_magic));
+  memcpy (contents + sizeof (binary_magic), &format32, sizeof (format32));
+
+  dir = g_path_get_dirname (path);
+
+  /* Failing to store the binary only costs linking it again next time */
+  if (g_mkdir_with_parents (dir, 0700) != 0)
+    COGL_NOTE (OPENGL, "Failed to create %s: %s", dir, g_strerror (errno));
+  else if (!g_file_set_contents (path, contents,
+                                 BINARY_HEADER_SIZE + binary_length, &error))
+    {
+      COGL_NOTE (OPENGL, "Failed to store program binary: %s",
+                 error->message);
+      g_error_free (error);
+    }
+  else
+    COGL_NOTE (OPENGL, "Stored program binary %s", path);
+
+  g_free (dir);
+
+out:
+  g_free (contents);
+}
+
+/* Removes the binaries of every driver but the current one */
+static void
+prune_cache_dirs (CoglContext *ctx)
+{
+  const char *cache_dir = get_cache_dir (ctx);
+  char *parent_dir, *current_name;
+  const char *name;
+  GDir *dir;
+
+  parent_dir = g_path_get_dirname (cache_dir);
+  current_name = g_path_get_basename (cache_dir);
+
+  dir = g_dir_open (parent_dir, 0, NULL);
+  if (dir == NULL)
+    goto out;
+
+  while ((name = g_dir_read_name (dir)))
+    {
+      char *driver_dir;
+      const char *binary_name;
+      GDir *binaries;
+
+      if (strcmp (name, current_name) == 0)
+        continue;
+
+      driver_dir = g_build_filename (parent_dir, name, NULL);
+
+      binaries = g_dir_open (driver_dir, 0, NULL);
+      if (binaries)
+        {
+          while ((binary_name = g_dir_read_name (binaries)))
+            {
+              char *binary_path = g_build_filename (driver_dir,
+                                                    binary_name,
+                                                    NULL);
+
+              g_unlink (binary_path);
+              g_free (binary_path);
+            }
+
+          g_dir_close (binaries);
+
+          if (g_rmdir (driver_dir) == 0)
+            COGL_NOTE (OPENGL, "Removed stale program binaries in %s",
+                       driver_dir);
+        }
+
+      g_free (driver_dir);
+    }
+
+  g_dir_close (dir);
+
+out:
+  g_free (current_name);
+  g_free (parent_dir);
+}
+
+static void
+store_idle_cb (void *user_data)
+{
+  CoglContext *ctx = user_data;
+  GList *pending, *l;
+
+  _cogl_closure_disconnect (ctx->program_binary_store_idle);
+  ctx->program_binary_store_idle = NULL;
+
+  if (!ctx->program_binary_dirs_pruned)
+    {
+      prune_cache_dirs (ctx);
+      ctx->program_binary_dirs_pruned = TRUE;
+    }
+
+  /* Stored in the order the programs were linked */
+  pending = g_list_reverse (ctx->pending_program_binaries);
+  ctx->pending_program_binaries = NULL;
+
+  for (l = pending; l; l = l->next)
+    {
+      PendingBinary *binary = l->data;
+
+      store_binary (ctx, binary->path, binary->program);
+    }
+
+  g_list_free_full (pending, (GDestroyNotify) pending_binary_free);
+}
+
+void
+_cogl_program_binary_cache_prepare_link (CoglContext *ctx,
+                                         GLuint program)
+{
+  /* Without this the driver may not keep the binary around, or only
+   * after recompiling the program when it is asked for */
+  if (ctx->glProgramParameteri)
+    GE( ctx, glProgramParameteri (program,
+                                  GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                                  GL_TRUE) );
+}
+
+void
+_cogl_program_binary_cache_store (CoglContext *ctx,
+                                  const char *path,
+                                  GLuint program)
+{
+  PendingBinary *binary;
+
+  binary = g_slice_new (PendingBinary);
+  binary->path = g_strdup (path);
+  binary->program = program;
+
+  ctx->pending_program_binaries =
+    g_list_prepend (ctx->pending_program_binaries, binary);
+
+  if (ctx->program_binary_store_idle == NULL)
+    ctx->program_binary_store_idle =
+      _cogl_poll_renderer_add_idle (ctx->display->renderer,
+                                    store_idle_cb,
+                                    ctx,
+                                    NULL);
+}
+
+void
+_cogl_program_binary_cache_cancel (CoglContext *ctx,
+                                   GLuint program)
+{
+  GList *l, *next;
+
+  for (l = ctx->pending_program_binaries; l; l = next)
+    {
+      PendingBinary *binary = l->data;
+
+      next = l->next;
+
+      if (binary->program == program)
+        {
+          pending_binary_free (binary);
+          ctx->pending_program_binaries =
+            g_list_delete_link (ctx->pending_program_binaries, l);
+        }
+    }
+}
+
+void
+_cogl_program_binary_cache_free (CoglContext *ctx)
+{
+  if (ctx->program_binary_store_idle)
+    _cogl_closure_disconnect (ctx->program_binary_store_idle);
+
+  g_list_free_full (ctx->pending_program_binaries,
+                    (GDestroyNotify) pending_binary_free);
+
+  g_free (ctx->program_binary_dir);
+}
@@ -0,0 +1,68 @@
+/*
+ * Cogl
+ *
+ * A Low Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __COGL_STREAM_BUFFER_PRIVATE_H
+#define __COGL_STREAM_BUFFER_PRIVATE_H
+
+#include "cogl-context.h"
+#include "cogl-attribute-buffer.h"
+
+typedef struct _CoglStreamBuffer CoglStreamBuffer;
+
+/* Returns whether the driver can synchronise suballocations of a
+ * stream buffer with fences. If not then a stream buffer can't be
+ * created and the caller should use separate buffers instead. */
+CoglBool
+_cogl_stream_buffer_is_supported (CoglContext *ctx);
+
+CoglStreamBuffer *
+_cogl_stream_buffer_new (CoglContext *ctx);
+
+void
+_cogl_stream_buffer_free (CoglStreamBuffer *stream);
+
+/* Reserves @size bytes of the stream and maps them for writing.
+ * @buffer_out is set to the attribute buffer the data ends up in
+ * (without taking a reference) and @offset_out to where in the buffer
+ * it starts. Returns NULL if the range couldn't be mapped. */
+void *
+_cogl_stream_buffer_map (CoglStreamBuffer *stream,
+                         size_t size,
+                         CoglAttributeBuffer **buffer_out,
+                         size_t *offset_out);
+
+void
+_cogl_stream_buffer_unmap (CoglStreamBuffer *stream);
+
+/* Must be called after submitting the drawing commands that read the
+ * data written since the last call so that the data won't be
+ * overwritten before the GPU is done with it */
+void
+_cogl_stream_buffer_fence (CoglStreamBuffer *stream);
+
+#endif /* __COGL_STREAM_BUFFER_PRIVATE_H */
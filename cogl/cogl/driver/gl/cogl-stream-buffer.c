@@ -0,0 +1,309 @@
+/*
+ * Cogl
+ *
+ * A Low Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * A stream buffer is a single large attribute buffer that per-frame
+ * vertex data is appended to, wrapping around to the start when it
+ * reaches the end. Instead of orphaning the buffer or letting the
+ * driver synchronise every map, a fence is inserted after the drawing
+ * commands that use each chunk of data and the chunk is only
+ * overwritten once its fence has signalled. The buffer only needs to
+ * grow if the data written between two fences doesn't fit in it.
+ *
+ * Where GL_ARB_buffer_storage is available the buffer is mapped once
+ * persistently and coherently so writing to it doesn't involve any GL
+ * calls at all. Otherwise each chunk is mapped with
+ * GL_MAP_UNSYNCHRONIZED_BIT.
+ */
+
+#include "cogl-config.h"
+
+#include <string.h>
+
+#include "cogl-private.h"
+#include "cogl-context-private.h"
+#include "cogl-buffer-private.h"
+#include "cogl-attribute-buffer.h"
+#include "cogl-error-private.h"
+#include "cogl-util-gl-private.h"
+#include "cogl-stream-buffer-private.h"
+
+/* The initial size of the buffer. It's doubled whenever the data
+ * written between two fences doesn't fit */
+#define STREAM_BUFFER_INITIAL_SIZE (1024 * 1024)
+
+/* Offsets of the mapped ranges are aligned to this so that vertex
+ * data always starts on a cache line */
+#define STREAM_BUFFER_ALIGNMENT 64
+
+/* A range of the buffer that may still be in use by the GPU. If end
+ * is less than start then the range wraps around the end of the
+ * buffer. */
+typedef struct
+{
+  size_t start;
+  size_t end;
+#ifdef GL_ARB_sync
+  GLsync fence;
+#endif
+} CoglStreamRange;
+
+struct _CoglStreamBuffer
+{
+  CoglContext *context;
+
+  CoglAttributeBuffer *buffer;
+  size_t size;
+
+  /* The next byte that will be handed out */
+  size_t head;
+
+  /* The range written since the last fence */
+  CoglStreamRange pending;
+  CoglBool has_pending;
+
+  /* Fenced ranges, oldest first */
+  GQueue fenced;
+
+  CoglBool mapped;
+};
+
+static CoglBool
+range_overlaps (const CoglStreamRange *range,
+                size_t start,
+                size_t end)
+{
+  if (range->start < range->end)
+    return start < range->end && range->start < end;
+  else
+    return start < range->end || range->start < end;
+}
+
+static void
+range_free (CoglContext *ctx,
+            CoglStreamRange *range,
+            CoglBool wait)
+{
+#ifdef GL_ARB_sync
+  if (range->fence)
+    {
+      if (wait)
+        {
+          GLenum status;
+
+          do
+            status = ctx->glClientWaitSync (range->fence,
+                                            GL_SYNC_FLUSH_COMMANDS_BIT,
+                                            G_GINT64_CONSTANT (1000000000));
+          while (status == GL_TIMEOUT_EXPIRED);
+        }
+
+      ctx->glDeleteSync (range->fence);
+    }
+  else if (wait)
+    ctx->glFinish ();
+#endif
+
+  g_slice_free (CoglStreamRange, range);
+}
+
+static void
+free_fenced_ranges (CoglStreamBuffer *stream,
+                    CoglBool wait)
+{
+  CoglStreamRange *range;
+
+  while ((range = g_queue_pop_head (&stream->fenced)))
+    range_free (stream->context, range, wait);
+}
+
+static void
+create_buffer (CoglStreamBuffer *stream,
+               size_t size)
+{
+  if (stream->buffer)
+    cogl_object_unref (stream->buffer);
+
+  /* The old buffer stays alive in the driver until the commands
+   * using it have completed so there is no need to wait for its
+   * fences */
+  free_fenced_ranges (stream, FALSE);
+
+  stream->buffer = cogl_attribute_buffer_new_with_size (stream->context,
+                                                        size);
+  cogl_buffer_set_update_hint (COGL_BUFFER (stream->buffer),
+                               COGL_BUFFER_UPDATE_HINT_STREAM);
+  /* This has to be set before the buffer storage is created */
+  COGL_BUFFER (stream->buffer)->flags |= COGL_BUFFER_FLAG_STREAM;
+
+  stream->size = size;
+  stream->head = 0;
+  stream->has_pending = FALSE;
+
+  COGL_NOTE (DRAW, "Created a %" G_GSIZE_FORMAT " byte stream buffer", size);
+}
+
+CoglBool
+_cogl_stream_buffer_is_supported (CoglContext *ctx)
+{
+#ifdef GL_ARB_sync
+  return (_cogl_has_private_feature (ctx, COGL_PRIVATE_FEATURE_VBOS) &&
+          ctx->glFenceSync &&
+          (ctx->glBufferStorage || ctx->glMapBufferRange));
+#else
+  return FALSE;
+#endif
+}
+
+CoglStreamBuffer *
+_cogl_stream_buffer_new (CoglContext *ctx)
+{
+  CoglStreamBuffer *stream = g_slice_new0 (CoglStreamBuffer);
+
+  stream->context = ctx;
+  g_queue_init (&stream->fenced);
+
+  create_buffer (stream, STREAM_BUFFER_INITIAL_SIZE);
+
+  return stream;
+}
+
+void
+_cogl_stream_buffer_free (CoglStreamBuffer *stream)
+{
+  _COGL_RETURN_IF_FAIL (!stream->mapped);
+
+  free_fenced_ranges (stream, FALSE);
+  cogl_object_unref (stream->buffer);
+
+  g_slice_free (CoglStreamBuffer, stream);
+}
+
+void *
+_cogl_stream_buffer_map (CoglStreamBuffer *stream,
+                         size_t size,
+                         CoglAttributeBuffer **buffer_out,
+                         size_t *offset_out)
+{
+  CoglStreamRange *range;
+  CoglError *ignore_error = NULL;
+  size_t start;
+  void *data;
+
+  _COGL_RETURN_VAL_IF_FAIL (!stream->mapped, NULL);
+
+  start = ((stream->head + STREAM_BUFFER_ALIGNMENT - 1) &
+           ~(size_t) (STREAM_BUFFER_ALIGNMENT - 1));
+  if (start + size > stream->size)
+    start = 0;
+
+  /* Data that hasn't been fenced yet belongs to drawing commands that
+   * haven't been submitted so it can't be waited for. If the new data
+   * would overwrite it then the buffer is too small for a frame */
+  if (start + size > stream->size ||
+      (stream->has_pending &&
+       range_overlaps (&stream->pending, start, start + size)))
+    {
+      size_t new_size = stream->size * 2;
+
+      while (new_size < size * 2)
+        new_size *= 2;
+
+      create_buffer (stream, new_size);
+      start = 0;
+    }
+
+  /* Wait for the GPU to finish with the oldest data where it is
+   * about to be overwritten. The ranges are written in order so only
+   * the ones at the head of the queue can overlap */
+  while ((range = g_queue_peek_head (&stream->fenced)) &&
+         range_overlaps (range, start, start + size))
+    {
+      g_queue_pop_head (&stream->fenced);
+      range_free (stream->context, range, TRUE);
+    }
+
+  data = cogl_buffer_map_range (COGL_BUFFER (stream->buffer),
+                                start, size,
+                                COGL_BUFFER_ACCESS_WRITE,
+                                COGL_BUFFER_MAP_HINT_DISCARD_RANGE,
+                                &ignore_error);
+  if (data == NULL)
+    {
+      cogl_error_free (ignore_error);
+      return NULL;
+    }
+
+  if (stream->has_pending)
+    stream->pending.end = start + size;
+  else
+    {
+      stream->pending.start = start;
+      stream->pending.end = start + size;
+      stream->has_pending = TRUE;
+    }
+
+  stream->head = start + size;
+  stream->mapped = TRUE;
+
+  *buffer_out = stream->buffer;
+  *offset_out = start;
+
+  return data;
+}
+
+void
+_cogl_stream_buffer_unmap (CoglStreamBuffer *stream)
+{
+  _COGL_RETURN_IF_FAIL (stream->mapped);
+
+  cogl_buffer_unmap (COGL_BUFFER (stream->buffer));
+  stream->mapped = FALSE;
+}
+
+void
+_cogl_stream_buffer_fence (CoglStreamBuffer *stream)
+{
+  CoglStreamRange *range;
+
+  if (!stream->has_pending)
+    return;
+
+  range = g_slice_new (CoglStreamRange);
+  *range = stream->pending;
+
+#ifdef GL_ARB_sync
+  /* If creating the fence fails then range_free() falls back to
+   * glFinish() before reusing the range */
+  range->fence =
+    stream->context->glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+
+  g_queue_push_tail (&stream->fenced, range);
+  stream->has_pending = FALSE;
+}
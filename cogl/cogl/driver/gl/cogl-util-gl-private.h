@@ -42,6 +42,17 @@
 #define GL_CONTEXT_LOST GL_CONTEXT_LOST_KHR
 #endif
 
+/* From GL_ARB_get_program_binary / GL_OES_get_program_binary */
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+
 #ifdef COGL_GL_DEBUG
 
 const char *
@@ -76,6 +87,11 @@ _cogl_gl_error_to_string (GLenum error_code);
 
 #endif /* COGL_GL_DEBUG */
 
+/* Every place that skips setting GL state to the value it already
+ * has records whether it made the call, for COGL_DEBUG=gl-state */
+#define _COGL_GL_STATE_ISSUED(ctx) ((ctx)->n_gl_state_changes_issued++)
+#define _COGL_GL_STATE_ELIDED(ctx) ((ctx)->n_gl_state_changes_elided++)
+
 GLenum
 _cogl_gl_util_get_error (CoglContext *ctx);
 
@@ -85,6 +101,30 @@ _cogl_gl_util_clear_gl_errors (CoglContext *ctx);
 CoglBool
 _cogl_gl_util_catch_out_of_memory (CoglContext *ctx, CoglError **error);
 
+/* Enables or disables GL_SCISSOR_TEST, GL_STENCIL_TEST or
+ * GL_CULL_FACE unless it is already in that state */
+void
+_cogl_gl_util_set_capability (CoglContext *ctx,
+                              GLenum capability,
+                              CoglBool enabled);
+
+void
+_cogl_gl_util_set_viewport (CoglContext *ctx,
+                            GLint x,
+                            GLint y,
+                            GLsizei width,
+                            GLsizei height);
+
+void
+_cogl_gl_util_set_scissor (CoglContext *ctx,
+                           GLint x,
+                           GLint y,
+                           GLsizei width,
+                           GLsizei height);
+
+void
+_cogl_gl_util_report_state_changes (CoglContext *ctx);
+
 void
 _cogl_gl_util_get_texture_target_string (CoglTextureType texture_type,
                                          const char **target_string_out,
@@ -37,6 +37,7 @@
 #include "cogl-types.h"
 #include "cogl-context-private.h"
 #include "cogl-error-private.h"
+#include "cogl-debug.h"
 #include "cogl-util-gl-private.h"
 
 #ifdef COGL_GL_DEBUG
@@ -129,6 +130,114 @@ _cogl_gl_util_catch_out_of_memory (CoglContext *ctx, CoglError **error)
   return FALSE;
 }
 
+static CoglBool *
+get_capability_cache (CoglContext *ctx,
+                      GLenum capability)
+{
+  switch (capability)
+    {
+    case GL_SCISSOR_TEST:
+      return &ctx->gl_scissor_test_enabled_cache;
+    case GL_STENCIL_TEST:
+      return &ctx->gl_stencil_test_enabled_cache;
+    case GL_CULL_FACE:
+      return &ctx->gl_cull_face_enabled_cache;
+    }
+
+  g_assert_not_reached ();
+  return NULL;
+}
+
+void
+_cogl_gl_util_set_capability (CoglContext *ctx,
+                              GLenum capability,
+                              CoglBool enabled)
+{
+  CoglBool *cache = get_capability_cache (ctx, capability);
+
+  enabled = !!enabled;
+
+  if (*cache == enabled)
+    {
+      _COGL_GL_STATE_ELIDED (ctx);
+      return;
+    }
+
+  if (enabled)
+    GE (ctx, glEnable (capability));
+  else
+    GE (ctx, glDisable (capability));
+
+  *cache = enabled;
+  _COGL_GL_STATE_ISSUED (ctx);
+}
+
+void
+_cogl_gl_util_set_viewport (CoglContext *ctx,
+                            GLint x,
+                            GLint y,
+                            GLsizei width,
+                            GLsizei height)
+{
+  GLint *cache = ctx->gl_viewport_cache;
+
+  if (cache[0] == x && cache[1] == y &&
+      cache[2] == width && cache[3] == height)
+    {
+      _COGL_GL_STATE_ELIDED (ctx);
+      return;
+    }
+
+  GE (ctx, glViewport (x, y, width, height));
+
+  cache[0] = x;
+  cache[1] = y;
+  cache[2] = width;
+  cache[3] = height;
+  _COGL_GL_STATE_ISSUED (ctx);
+}
+
+void
+_cogl_gl_util_set_scissor (CoglContext *ctx,
+                           GLint x,
+                           GLint y,
+                           GLsizei width,
+                           GLsizei height)
+{
+  GLint *cache = ctx->gl_scissor_cache;
+
+  if (cache[0] == x && cache[1] == y &&
+      cache[2] == width && cache[3] == height)
+    {
+      _COGL_GL_STATE_ELIDED (ctx);
+      return;
+    }
+
+  GE (ctx, glScissor (x, y, width, height));
+
+  cache[0] = x;
+  cache[1] = y;
+  cache[2] = width;
+  cache[3] = height;
+  _COGL_GL_STATE_ISSUED (ctx);
+}
+
+void
+_cogl_gl_util_report_state_changes (CoglContext *ctx)
+{
+  unsigned int total = (ctx->n_gl_state_changes_issued +
+                        ctx->n_gl_state_changes_elided);
+
+  COGL_NOTE (GL_STATE,
+             "%u GL state changes issued, %u elided (%.1f%% elided)",
+             ctx->n_gl_state_changes_issued,
+             ctx->n_gl_state_changes_elided,
+             total ? 100.0 * ctx->n_gl_state_changes_elided / total : 0.0);
+
+  ctx->n_gl_state_changes_issued = 0;
+  ctx->n_gl_state_changes_elided = 0;
+}
+
 void
 _cogl_gl_util_get_texture_target_string (CoglTextureType texture_type,
                                          const char **target_string_out,
@@ -661,6 +661,18 @@ _cogl_driver_update_features (CoglContext *ctx,
   if (ctx->glFenceSync)
     COGL_FLAGS_SET (ctx->features, COGL_FEATURE_ID_FENCE, TRUE);
 
+  if (ctx->glProgramBinary)
+    {
+      GLint n_formats = 0;
+
+      /* Drivers may expose the entry points without supporting any
+       * binary format, in which case no program can be retrieved */
+      GE( ctx, glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &n_formats) );
+      if (n_formats > 0)
+        COGL_FLAGS_SET (private_features,
+                        COGL_PRIVATE_FEATURE_PROGRAM_BINARY, TRUE);
+    }
+
   if (COGL_CHECK_GL_VERSION (gl_major, gl_minor, 3, 0) ||
       _cogl_check_extension ("GL_ARB_texture_rg", gl_extensions))
     COGL_FLAGS_SET (ctx->features,
@@ -701,6 +713,7 @@ _cogl_driver_gl =
     _cogl_framebuffer_gl_clear,
     _cogl_framebuffer_gl_query_bits,
     _cogl_framebuffer_gl_finish,
+    _cogl_framebuffer_gl_flush,
     _cogl_framebuffer_gl_discard_buffers,
     _cogl_framebuffer_gl_draw_attributes,
     _cogl_framebuffer_gl_draw_indexed_attributes,
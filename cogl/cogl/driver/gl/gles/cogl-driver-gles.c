@@ -457,6 +457,18 @@ _cogl_driver_update_features (CoglContext *context,
                     COGL_FEATURE_ID_TEXTURE_RG,
                     TRUE);
 
+  if (context->glProgramBinary)
+    {
+      GLint n_formats = 0;
+
+      /* Drivers may expose the entry points without supporting any
+       * binary format, in which case no program can be retrieved */
+      GE( context, glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &n_formats) );
+      if (n_formats > 0)
+        COGL_FLAGS_SET (private_features,
+                        COGL_PRIVATE_FEATURE_PROGRAM_BINARY, TRUE);
+    }
+
   /* Cache features */
   for (i = 0; i < G_N_ELEMENTS (private_features); i++)
     context->private_features[i] |= private_features[i];
@@ -480,6 +492,7 @@ _cogl_driver_gles =
     _cogl_framebuffer_gl_clear,
     _cogl_framebuffer_gl_query_bits,
     _cogl_framebuffer_gl_finish,
+    _cogl_framebuffer_gl_flush,
     _cogl_framebuffer_gl_discard_buffers,
     _cogl_framebuffer_gl_draw_attributes,
     _cogl_framebuffer_gl_draw_indexed_attributes,
@@ -319,6 +319,17 @@ COGL_EXT_FUNCTION (void, glDeleteSync,
 COGL_EXT_END ()
 #endif
 
+COGL_EXT_BEGIN (buffer_storage, 4, 4,
+                0, /* not in either GLES */
+                "ARB:\0",
+                "buffer_storage\0")
+COGL_EXT_FUNCTION (void, glBufferStorage,
+                   (GLenum target,
+                    GLsizeiptr size,
+                    const GLvoid *data,
+                    GLbitfield flags))
+COGL_EXT_END ()
+
 COGL_EXT_BEGIN (draw_buffers, 2, 0,
                 COGL_EXT_IN_GLES3,
                 "ARB\0EXT\0",
@@ -327,6 +338,34 @@ COGL_EXT_FUNCTION (void, glDrawBuffers,
                    (GLsizei n, const GLenum *bufs))
 COGL_EXT_END ()
 
+COGL_EXT_BEGIN (get_program_binary, 4, 1,
+                COGL_EXT_IN_GLES3,
+                "ARB:\0OES\0",
+                "get_program_binary\0")
+COGL_EXT_FUNCTION (void, glGetProgramBinary,
+                   (GLuint program,
+                    GLsizei bufSize,
+                    GLsizei *length,
+                    GLenum *binaryFormat,
+                    GLvoid *binary))
+COGL_EXT_FUNCTION (void, glProgramBinary,
+                   (GLuint program,
+                    GLenum binaryFormat,
+                    const GLvoid *binary,
+                    GLsizei length))
+COGL_EXT_END ()
+
+/* GL_OES_get_program_binary doesn't have this one */
+COGL_EXT_BEGIN (program_parameteri, 4, 1,
+                COGL_EXT_IN_GLES3,
+                "ARB:\0",
+                "get_program_binary\0")
+COGL_EXT_FUNCTION (void, glProgramParameteri,
+                   (GLuint program,
+                    GLenum pname,
+                    GLint value))
+COGL_EXT_END ()
+
 COGL_EXT_BEGIN (robustness, 255, 255,
                 0,
                 "ARB\0",
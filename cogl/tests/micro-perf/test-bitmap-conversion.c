@@ -0,0 +1,139 @@
+#include <glib.h>
+#include <cogl/cogl.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Times reading back a framebuffer into each of the 8888 formats, which
+ * converts the pixels on the CPU whenever the premultiplied state or
+ * (with GLES) the component order differs from what GL returns. The
+ * "native" row of each framebuffer needs no conversion; the difference
+ * to the other rows is the cost of converting.
+ *
+ * Run with COGL_DEBUG=disable-simd-conversion to time the generic code
+ * instead of the SIMD kernels.
+ */
+
+#define FRAMEBUFFER_WIDTH 1920
+#define FRAMEBUFFER_HEIGHT 1080
+
+#define N_ITERATIONS 20
+
+static const struct {
+  CoglPixelFormat format;
+  const char *name;
+} formats[] = {
+  { COGL_PIXEL_FORMAT_RGBA_8888_PRE, "RGBA_8888_PRE" },
+  { COGL_PIXEL_FORMAT_RGBA_8888, "RGBA_8888" },
+  { COGL_PIXEL_FORMAT_BGRA_8888_PRE, "BGRA_8888_PRE" },
+  { COGL_PIXEL_FORMAT_BGRA_8888, "BGRA_8888" },
+  { COGL_PIXEL_FORMAT_ARGB_8888_PRE, "ARGB_8888_PRE" },
+  { COGL_PIXEL_FORMAT_ARGB_8888, "ARGB_8888" },
+  { COGL_PIXEL_FORMAT_ABGR_8888_PRE, "ABGR_8888_PRE" },
+  { COGL_PIXEL_FORMAT_ABGR_8888, "ABGR_8888" },
+};
+
+/* Fills the framebuffer with a gradient covering all alpha values, so
+ * that neither the opaque nor the transparent special cases dominate */
+static void
+paint_gradient (CoglContext *ctx,
+                CoglFramebuffer *fb)
+{
+  CoglVertexP2C4 vertices[] = {
+    { 0, 0, 0xff, 0x00, 0x00, 0x00 },
+    { 0, FRAMEBUFFER_HEIGHT, 0x00, 0xff, 0x00, 0x80 },
+    { FRAMEBUFFER_WIDTH, 0, 0x00, 0x00, 0xff, 0x80 },
+    { FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT, 0xff, 0xff, 0xff, 0xff },
+  };
+  CoglPrimitive *primitive;
+  CoglPipeline *pipeline;
+
+  cogl_framebuffer_orthographic (fb,
+                                 0, 0,
+                                 FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT,
+                                 -1, 100);
+
+  pipeline = cogl_pipeline_new (ctx);
+  cogl_pipeline_set_blend (pipeline, "RGBA = ADD (SRC_COLOR, 0)", NULL);
+
+  primitive = cogl_primitive_new_p2c4 (ctx,
+                                       COGL_VERTICES_MODE_TRIANGLE_STRIP,
+                                       G_N_ELEMENTS (vertices),
+                                       vertices);
+  cogl_primitive_draw (primitive, fb, pipeline);
+
+  cogl_object_unref (primitive);
+  cogl_object_unref (pipeline);
+}
+
+static void
+test_read_pixels (CoglContext *ctx,
+                  CoglBool premultiplied)
+{
+  CoglTexture *texture;
+  CoglFramebuffer *fb;
+  uint8_t *pixels;
+  int i, j;
+
+  texture = COGL_TEXTURE (cogl_texture_2d_new_with_size (ctx,
+                                                         FRAMEBUFFER_WIDTH,
+                                                         FRAMEBUFFER_HEIGHT));
+  cogl_texture_set_premultiplied (texture, premultiplied);
+  fb = COGL_FRAMEBUFFER (cogl_offscreen_new_with_texture (texture));
+
+  paint_gradient (ctx, fb);
+
+  pixels = g_malloc (FRAMEBUFFER_WIDTH * FRAMEBUFFER_HEIGHT * 4);
+
+  /* Make sure the painting is done before timing anything */
+  cogl_framebuffer_read_pixels (fb, 0, 0, 1, 1,
+                                COGL_PIXEL_FORMAT_RGBA_8888_PRE, pixels);
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++)
+    {
+      CoglBool native;
+      GTimer *timer;
+      double elapsed;
+
+      native = (formats[i].format == (premultiplied ?
+                                      COGL_PIXEL_FORMAT_RGBA_8888_PRE :
+                                      COGL_PIXEL_FORMAT_RGBA_8888));
+
+      timer = g_timer_new ();
+      for (j = 0; j < N_ITERATIONS; j++)
+        cogl_framebuffer_read_pixels (fb, 0, 0,
+                                      FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT,
+                                      formats[i].format,
+                                      pixels);
+      elapsed = g_timer_elapsed (timer, NULL) / N_ITERATIONS;
+      g_timer_destroy (timer);
+
+      printf ("%-18s %-14s %-6s %10.3f %10.1f\n",
+              premultiplied ? "premultiplied" : "not premultiplied",
+              formats[i].name,
+              native ? "native" : "",
+              elapsed * 1000.0,
+              FRAMEBUFFER_WIDTH * FRAMEBUFFER_HEIGHT / elapsed / 1e6);
+    }
+
+  g_free (pixels);
+  cogl_object_unref (fb);
+  cogl_object_unref (texture);
+}
+
+int
+main (int argc, char **argv)
+{
+  CoglContext *ctx;
+
+  ctx = cogl_context_new (NULL, NULL);
+
+  printf ("%-18s %-14s %-6s %10s %10s\n",
+          "framebuffer", "read as", "", "ms/read", "Mpixels/s");
+
+  test_read_pixels (ctx, TRUE);
+  test_read_pixels (ctx, FALSE);
+
+  cogl_object_unref (ctx);
+
+  return EXIT_SUCCESS;
+}
@@ -97,6 +97,37 @@ test_rectangles (Data *data)
         }
     }
 
+  /* Short runs of rectangles sharing a modelview and a rectangle clip,
+   * like the glyphs of a clipped label. These batches are below the
+   * hardware clip threshold so they exercise software clipping.
+   */
+  for (y = 0; y < FRAMEBUFFER_HEIGHT; y += RECT_HEIGHT * 2)
+    {
+      cogl_framebuffer_push_matrix (data->fb);
+      cogl_framebuffer_translate (data->fb, 0, y, 0);
+
+      for (x = 0; x < FRAMEBUFFER_WIDTH; x += RECT_WIDTH * 4)
+        {
+          int i;
+
+          cogl_framebuffer_push_rectangle_clip (data->fb,
+                                                x + 1, 1,
+                                                x + RECT_WIDTH * 4 - 1,
+                                                RECT_HEIGHT * 2 - 1);
+
+          for (i = 0; i < 4; i++)
+            cogl_framebuffer_draw_rectangle (data->fb,
+                                             data->pipeline,
+                                             x + i * RECT_WIDTH, 0,
+                                             x + (i + 1) * RECT_WIDTH,
+                                             RECT_HEIGHT * 2);
+
+          cogl_framebuffer_pop_clip (data->fb);
+        }
+
+      cogl_framebuffer_pop_matrix (data->fb);
+    }
+
   cogl_framebuffer_pop_clip (data->fb);
 }
 
@@ -0,0 +1,104 @@
+#include <glib.h>
+#include <cogl/cogl.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Times looking up state on a pipeline at the end of a chain of
+ * copies. None of the copies change anything so every lookup has to
+ * find the state on the root pipeline, which is the worst case for
+ * walking the ancestry.
+ *
+ * The second run also copies and frees an unrelated pipeline between
+ * lookups, as painting typically does, which shouldn't invalidate the
+ * cache of the chain. The time for the copies is included, so
+ * compare it with the same run without the cache.
+ *
+ * Run with COGL_DEBUG=disable-authorities-cache to time walking the
+ * ancestry for every lookup instead of using the cache.
+ */
+
+#define N_LOOKUPS 1000000
+
+static const int depths[] = { 1, 4, 16, 64, 256 };
+
+static CoglPipeline *
+create_chain (CoglContext *ctx,
+              int depth)
+{
+  CoglPipeline *pipeline = cogl_pipeline_new (ctx);
+  int i;
+
+  cogl_pipeline_set_color4f (pipeline, 1, 0, 0, 1);
+  cogl_pipeline_set_point_size (pipeline, 2.0f);
+
+  for (i = 0; i < depth; i++)
+    {
+      CoglPipeline *copy = cogl_pipeline_copy (pipeline);
+
+      /* The copy keeps a reference on its parent */
+      cogl_object_unref (pipeline);
+      pipeline = copy;
+    }
+
+  return pipeline;
+}
+
+static void
+test_lookups (CoglContext *ctx,
+              int depth,
+              CoglBool copy_between_lookups)
+{
+  CoglPipeline *pipeline = create_chain (ctx, depth);
+  CoglPipeline *other = cogl_pipeline_new (ctx);
+  CoglColor color;
+  float sum = 0.0f;
+  GTimer *timer;
+  double elapsed;
+  int i;
+
+  timer = g_timer_new ();
+  for (i = 0; i < N_LOOKUPS; i++)
+    {
+      cogl_pipeline_get_color (pipeline, &color);
+      sum += cogl_color_get_red_float (&color);
+      sum += cogl_pipeline_get_point_size (pipeline);
+
+      if (copy_between_lookups)
+        cogl_object_unref (cogl_pipeline_copy (other));
+    }
+  elapsed = g_timer_elapsed (timer, NULL);
+  g_timer_destroy (timer);
+
+  /* Use the sum so the lookups can't be optimized away */
+  printf ("%6i %12.2f%s\n",
+          depth,
+          elapsed * 1e9 / (N_LOOKUPS * 2),
+          sum > 0.0f ? "" : " (?)");
+
+  cogl_object_unref (other);
+  cogl_object_unref (pipeline);
+}
+
+int
+main (int argc, char **argv)
+{
+  CoglContext *ctx;
+  int i;
+
+  ctx = cogl_context_new (NULL, NULL);
+
+  printf ("%6s %12s\n", "depth", "ns/lookup");
+
+  for (i = 0; i < G_N_ELEMENTS (depths); i++)
+    test_lookups (ctx, depths[i], FALSE);
+
+  printf ("\ncopying and freeing a pipeline between lookups:\n");
+  printf ("%6s %12s\n", "depth", "ns/lookup");
+
+  for (i = 0; i < G_N_ELEMENTS (depths); i++)
+    test_lookups (ctx, depths[i], TRUE);
+
+  cogl_object_unref (ctx);
+
+  return EXIT_SUCCESS;
+}
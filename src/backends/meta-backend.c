@@ -46,6 +46,7 @@
 #include "backends/native/meta-backend-native.h"
 #endif
 
+#include "backends/meta-frame-timings.h"
 #include "backends/meta-idle-monitor-private.h"
 #include "backends/meta-logical-monitor.h"
 #include "backends/meta-monitor-manager-dummy.h"
@@ -91,6 +92,7 @@ struct _MetaBackendPrivate
   MetaRenderer *renderer;
   MetaEgl *egl;
   MetaSettings *settings;
+  MetaFrameTimings *frame_timings;
 #ifdef HAVE_REMOTE_DESKTOP
   MetaDbusSessionWatcher *dbus_session_watcher;
   MetaScreenCast *screen_cast;
@@ -134,6 +136,7 @@ meta_backend_finalize (GObject *object)
   g_clear_object (&priv->monitor_manager);
   g_clear_object (&priv->orientation_manager);
   g_clear_object (&priv->input_settings);
+  g_clear_object (&priv->frame_timings);
 #ifdef HAVE_REMOTE_DESKTOP
   g_clear_object (&priv->remote_desktop);
   g_clear_object (&priv->screen_cast);
@@ -467,6 +470,8 @@ meta_backend_real_post_init (MetaBackend *backend)
 
   priv->input_settings = meta_backend_create_input_settings (backend);
 
+  priv->frame_timings = meta_frame_timings_new ();
+
 #ifdef HAVE_REMOTE_DESKTOP
   priv->dbus_session_watcher = g_object_new (META_TYPE_DBUS_SESSION_WATCHER, NULL);
   if (is_screen_cast_enabled (backend))
@@ -0,0 +1,427 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2018 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "backends/meta-frame-timings.h"
+
+#include <errno.h>
+#include <gio/gio.h>
+#include <gio/gunixfdlist.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "clutter/clutter-mutter.h"
+
+#define META_FRAME_TIMINGS_DBUS_SERVICE "org.gnome.Mutter.FrameTimings"
+#define META_FRAME_TIMINGS_DBUS_PATH "/org/gnome/Mutter/FrameTimings"
+#define META_FRAME_TIMINGS_API_VERSION 1
+
+#define MAX_FRAMES_PER_CALL 1024
+
+/* How often a capture is written out */
+#define CAPTURE_INTERVAL_S 1
+
+/* A frame this many frames older than the newest one will not be presented
+ * anymore; younger ones are held back from the capture until they either
+ * are, or get that old. */
+#define MAX_PENDING_PRESENTATIONS 16
+
+static const char *phase_names[] = {
+  [CLUTTER_FRAME_PHASE_EVENTS] = "events",
+  [CLUTTER_FRAME_PHASE_TIMELINES] = "timelines",
+  [CLUTTER_FRAME_PHASE_RELAYOUT] = "relayout",
+  [CLUTTER_FRAME_PHASE_CULL] = "cull",
+  [CLUTTER_FRAME_PHASE_PAINT] = "paint",
+  [CLUTTER_FRAME_PHASE_SWAP] = "swap",
+  [CLUTTER_N_FRAME_PHASES] = NULL,
+};
+
+struct _MetaFrameTimings
+{
+  MetaDBusFrameTimingsSkeleton parent;
+
+  int dbus_name_id;
+
+  FILE *capture_file;
+  uint64_t captured_sequence;
+  guint capture_timeout_id;
+};
+
+static void
+meta_frame_timings_init_iface (MetaDBusFrameTimingsIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (MetaFrameTimings, meta_frame_timings,
+                         META_DBUS_TYPE_FRAME_TIMINGS_SKELETON,
+                         G_IMPLEMENT_INTERFACE (META_DBUS_TYPE_FRAME_TIMINGS,
+                                                meta_frame_timings_init_iface))
+
+static void
+write_capture_header (FILE *file)
+{
+  int i;
+
+  fputs ("sequence,frame_counter,start_time", file);
+  for (i = 0; i < CLUTTER_N_FRAME_PHASES; i++)
+    fprintf (file, ",%s", phase_names[i]);
+  fputs (",presentation_time\n", file);
+}
+
+static void
+write_capture_record (FILE                     *file,
+                      const ClutterFrameRecord *record)
+{
+  int i;
+
+  fprintf (file, "%" G_GUINT64_FORMAT ",%" G_GINT64_FORMAT ",%" G_GINT64_FORMAT,
+           record->sequence, record->frame_counter, record->start_time);
+  for (i = 0; i < CLUTTER_N_FRAME_PHASES; i++)
+    fprintf (file, ",%" G_GINT64_FORMAT, record->phase_time[i]);
+  fprintf (file, ",%" G_GINT64_FORMAT "\n", record->presentation_time);
+}
+
+static void
+write_captured_frames (MetaFrameTimings *frame_timings,
+                       gboolean          flush_pending)
+{
+  ClutterFrameRecord *records;
+
+  records = g_new (ClutterFrameRecord, MAX_FRAMES_PER_CALL);
+
+  while (TRUE)
+    {
+      unsigned int n_records, n_complete, i;
+
+      n_records =
+        clutter_frame_timings_get_records (frame_timings->captured_sequence,
+                                           records, MAX_FRAMES_PER_CALL);
+      if (n_records == 0)
+        break;
+
+      n_complete = n_records;
+      if (!flush_pending && n_records < MAX_FRAMES_PER_CALL)
+        {
+          uint64_t newest_sequence = records[n_records - 1].sequence;
+
+          while (n_complete > 0 &&
+                 records[n_complete - 1].presentation_time == 0 &&
+                 (records[n_complete - 1].sequence + MAX_PENDING_PRESENTATIONS >
+                  newest_sequence))
+            n_complete--;
+        }
+
+      for (i = 0; i < n_complete; i++)
+        write_capture_record (frame_timings->capture_file, &records[i]);
+
+      if (n_complete > 0)
+        frame_timings->captured_sequence = records[n_complete - 1].sequence;
+
+      if (n_records < MAX_FRAMES_PER_CALL || n_complete < n_records)
+        break;
+    }
+
+  fflush (frame_timings->capture_file);
+
+  g_free (records);
+}
+
+static gboolean
+capture_timeout (gpointer user_data)
+{
+  MetaFrameTimings *frame_timings = user_data;
+
+  write_captured_frames (frame_timings, FALSE);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+start_capture_to_file (MetaFrameTimings *frame_timings,
+                       FILE             *file)
+{
+  meta_frame_timings_stop_capture (frame_timings);
+
+  frame_timings->capture_file = file;
+  frame_timings->captured_sequence = 0;
+  write_capture_header (file);
+
+  frame_timings->capture_timeout_id =
+    g_timeout_add_seconds (CAPTURE_INTERVAL_S, capture_timeout, frame_timings);
+  g_source_set_name_by_id (frame_timings->capture_timeout_id,
+                           "[mutter] frame timings capture");
+}
+
+gboolean
+meta_frame_timings_start_capture (MetaFrameTimings  *frame_timings,
+                                  const char        *path,
+                                  GError           **error)
+{
+  FILE *file;
+
+  file = g_fopen (path, "w");
+  if (!file)
+    {
+      int errsv = errno;
+
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                   "Failed to open '%s': %s", path, g_strerror (errsv));
+      return FALSE;
+    }
+
+  start_capture_to_file (frame_timings, file);
+
+  return TRUE;
+}
+
+void
+meta_frame_timings_stop_capture (MetaFrameTimings *frame_timings)
+{
+  if (!frame_timings->capture_file)
+    return;
+
+  write_captured_frames (frame_timings, TRUE);
+
+  fclose (frame_timings->capture_file);
+  frame_timings->capture_file = NULL;
+
+  if (frame_timings->capture_timeout_id)
+    {
+      g_source_remove (frame_timings->capture_timeout_id);
+      frame_timings->capture_timeout_id = 0;
+    }
+}
+
+static gboolean
+handle_get_frames (MetaDBusFrameTimings  *skeleton,
+                   GDBusMethodInvocation *invocation,
+                   guint64                since)
+{
+  ClutterFrameRecord *records;
+  GVariantBuilder frames_builder;
+  unsigned int n_records, i;
+
+  records = g_new (ClutterFrameRecord, MAX_FRAMES_PER_CALL);
+  n_records = clutter_frame_timings_get_records (since, records,
+                                                 MAX_FRAMES_PER_CALL);
+
+  g_variant_builder_init (&frames_builder, G_VARIANT_TYPE ("a(txxxxxxxxx)"));
+  for (i = 0; i < n_records; i++)
+    {
+      ClutterFrameRecord *record = &records[i];
+
+      g_variant_builder_add (&frames_builder, "(txxxxxxxxx)",
+                             record->sequence,
+                             record->frame_counter,
+                             record->start_time,
+                             record->phase_time[CLUTTER_FRAME_PHASE_EVENTS],
+                             record->phase_time[CLUTTER_FRAME_PHASE_TIMELINES],
+                             record->phase_time[CLUTTER_FRAME_PHASE_RELAYOUT],
+                             record->phase_time[CLUTTER_FRAME_PHASE_CULL],
+                             record->phase_time[CLUTTER_FRAME_PHASE_PAINT],
+                             record->phase_time[CLUTTER_FRAME_PHASE_SWAP],
+                             record->presentation_time);
+    }
+
+  g_free (records);
+
+  meta_dbus_frame_timings_complete_get_frames (skeleton, invocation,
+                                               g_variant_builder_end (&frames_builder));
+
+  return TRUE;
+}
+
+/*
+ * The capture is written to a file descriptor the caller opened, rather
+ * than to a path, so that a caller can't make the compositor write to
+ * files the caller itself has no access to.
+ */
+static gboolean
+handle_start_capture (MetaDBusFrameTimings  *skeleton,
+                      GDBusMethodInvocation *invocation,
+                      GUnixFDList           *fd_list,
+                      GVariant              *fd_variant)
+{
+  MetaFrameTimings *frame_timings = META_FRAME_TIMINGS (skeleton);
+  GError *error = NULL;
+  FILE *file;
+  int fd;
+
+  if (!fd_list)
+    {
+      g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                             G_DBUS_ERROR_INVALID_ARGS,
+                                             "No file descriptor passed");
+      return TRUE;
+    }
+
+  fd = g_unix_fd_list_get (fd_list, g_variant_get_handle (fd_variant),
+                           &error);
+  if (fd == -1)
+    {
+      g_dbus_method_invocation_return_gerror (invocation, error);
+      g_error_free (error);
+      return TRUE;
+    }
+
+  file = fdopen (fd, "w");
+  if (!file)
+    {
+      int errsv = errno;
+
+      close (fd);
+      g_dbus_method_invocation_return_error (invocation, G_IO_ERROR,
+                                             g_io_error_from_errno (errsv),
+                                             "Failed to open capture file: %s",
+                                             g_strerror (errsv));
+      return TRUE;
+    }
+
+  start_capture_to_file (frame_timings, file);
+
+  meta_dbus_frame_timings_complete_start_capture (skeleton, invocation, NULL);
+
+  return TRUE;
+}
+
+static gboolean
+handle_stop_capture (MetaDBusFrameTimings  *skeleton,
+                     GDBusMethodInvocation *invocation)
+{
+  MetaFrameTimings *frame_timings = META_FRAME_TIMINGS (skeleton);
+
+  meta_frame_timings_stop_capture (frame_timings);
+
+  meta_dbus_frame_timings_complete_stop_capture (skeleton, invocation);
+
+  return TRUE;
+}
+
+static void
+meta_frame_timings_init_iface (MetaDBusFrameTimingsIface *iface)
+{
+  iface->handle_get_frames = handle_get_frames;
+  iface->handle_start_capture = handle_start_capture;
+  iface->handle_stop_capture = handle_stop_capture;
+}
+
+static void
+on_bus_acquired (GDBusConnection *connection,
+                 const char      *name,
+                 gpointer         user_data)
+{
+  MetaFrameTimings *frame_timings = user_data;
+  GDBusInterfaceSkeleton *interface_skeleton =
+    G_DBUS_INTERFACE_SKELETON (frame_timings);
+  GError *error = NULL;
+
+  if (!g_dbus_interface_skeleton_export (interface_skeleton,
+                                         connection,
+                                         META_FRAME_TIMINGS_DBUS_PATH,
+                                         &error))
+    {
+      g_warning ("Failed to export frame timings object: %s", error->message);
+      g_error_free (error);
+    }
+}
+
+static void
+on_name_acquired (GDBusConnection *connection,
+                  const char      *name,
+                  gpointer         user_data)
+{
+  g_info ("Acquired name %s\n", name);
+}
+
+static void
+on_name_lost (GDBusConnection *connection,
+              const char      *name,
+              gpointer         user_data)
+{
+  g_warning ("Lost or failed to acquire name %s\n", name);
+}
+
+static void
+meta_frame_timings_constructed (GObject *object)
+{
+  MetaFrameTimings *frame_timings = META_FRAME_TIMINGS (object);
+  const char *capture_path;
+
+  capture_path = g_getenv ("MUTTER_DEBUG_FRAME_TIMINGS_CAPTURE");
+  if (capture_path)
+    {
+      GError *error = NULL;
+
+      if (!meta_frame_timings_start_capture (frame_timings, capture_path,
+                                             &error))
+        {
+          g_warning ("Failed to start frame timings capture: %s",
+                     error->message);
+          g_error_free (error);
+        }
+    }
+
+  frame_timings->dbus_name_id =
+    g_bus_own_name (G_BUS_TYPE_SESSION,
+                    META_FRAME_TIMINGS_DBUS_SERVICE,
+                    G_BUS_NAME_OWNER_FLAGS_NONE,
+                    on_bus_acquired,
+                    on_name_acquired,
+                    on_name_lost,
+                    frame_timings,
+                    NULL);
+}
+
+static void
+meta_frame_timings_finalize (GObject *object)
+{
+  MetaFrameTimings *frame_timings = META_FRAME_TIMINGS (object);
+
+  if (frame_timings->dbus_name_id)
+    g_bus_unown_name (frame_timings->dbus_name_id);
+
+  meta_frame_timings_stop_capture (frame_timings);
+
+  G_OBJECT_CLASS (meta_frame_timings_parent_class)->finalize (object);
+}
+
+MetaFrameTimings *
+meta_frame_timings_new (void)
+{
+  return g_object_new (META_TYPE_FRAME_TIMINGS, NULL);
+}
+
+static void
+meta_frame_timings_init (MetaFrameTimings *frame_timings)
+{
+  MetaDBusFrameTimings *skeleton = META_DBUS_FRAME_TIMINGS (frame_timings);
+
+  meta_dbus_frame_timings_set_phases (skeleton, phase_names);
+  meta_dbus_frame_timings_set_version (skeleton,
+                                       META_FRAME_TIMINGS_API_VERSION);
+}
+
+static void
+meta_frame_timings_class_init (MetaFrameTimingsClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->constructed = meta_frame_timings_constructed;
+  object_class->finalize = meta_frame_timings_finalize;
+}
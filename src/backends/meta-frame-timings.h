@@ -0,0 +1,40 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2018 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef META_FRAME_TIMINGS_H
+#define META_FRAME_TIMINGS_H
+
+#include <glib-object.h>
+
+#include "meta-dbus-frame-timings.h"
+
+#define META_TYPE_FRAME_TIMINGS (meta_frame_timings_get_type ())
+G_DECLARE_FINAL_TYPE (MetaFrameTimings, meta_frame_timings,
+                      META, FRAME_TIMINGS,
+                      MetaDBusFrameTimingsSkeleton)
+
+gboolean meta_frame_timings_start_capture (MetaFrameTimings  *frame_timings,
+                                           const char        *path,
+                                           GError           **error);
+
+void meta_frame_timings_stop_capture (MetaFrameTimings *frame_timings);
+
+MetaFrameTimings * meta_frame_timings_new (void);
+
+#endif /* META_FRAME_TIMINGS_H */
@@ -28,6 +28,7 @@
 #include "backends/meta-screen-cast-monitor-stream.h"
 #include "backends/meta-logical-monitor.h"
 #include "backends/meta-monitor.h"
+#include "backends/meta-renderer.h"
 #include "clutter/clutter.h"
 #include "clutter/clutter-mutter.h"
 
@@ -93,13 +94,107 @@ meta_screen_cast_monitor_stream_src_get_specs (MetaScreenCastStreamSrc *src,
   *frame_rate = meta_monitor_mode_get_refresh_rate (mode);
 }
 
+static ClutterStageView *
+get_view (MetaScreenCastMonitorStreamSrc *monitor_src)
+{
+  MetaBackend *backend = meta_get_backend ();
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  MetaMonitor *monitor;
+  MetaLogicalMonitor *logical_monitor;
+  GList *l;
+
+  monitor = get_monitor (monitor_src);
+  logical_monitor = meta_monitor_get_logical_monitor (monitor);
+
+  for (l = meta_renderer_get_views (renderer); l; l = l->next)
+    {
+      ClutterStageView *view = l->data;
+      MetaRectangle view_layout;
+
+      clutter_stage_view_get_layout (view, (cairo_rectangle_int_t *) &view_layout);
+      if (meta_rectangle_contains_rect (&view_layout, &logical_monitor->rect))
+        return view;
+    }
+
+  return NULL;
+}
+
+static cairo_region_t *
+stage_damage_to_stream_damage (MetaLogicalMonitor   *logical_monitor,
+                               const cairo_region_t *stage_damage)
+{
+  cairo_region_t *monitor_damage;
+  cairo_region_t *stream_damage;
+  float scale = logical_monitor->scale;
+  int n_rects, i;
+
+  monitor_damage = cairo_region_copy (stage_damage);
+  cairo_region_intersect_rectangle (monitor_damage,
+                                    &(cairo_rectangle_int_t) {
+                                      .x = logical_monitor->rect.x,
+                                      .y = logical_monitor->rect.y,
+                                      .width = logical_monitor->rect.width,
+                                      .height = logical_monitor->rect.height,
+                                    });
+  cairo_region_translate (monitor_damage,
+                          -logical_monitor->rect.x,
+                          -logical_monitor->rect.y);
+
+  stream_damage = cairo_region_create ();
+  n_rects = cairo_region_num_rectangles (monitor_damage);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+      int x1, y1, x2, y2;
+
+      cairo_region_get_rectangle (monitor_damage, i, &rect);
+      x1 = (int) floorf (rect.x * scale);
+      y1 = (int) floorf (rect.y * scale);
+      x2 = (int) ceilf ((rect.x + rect.width) * scale);
+      y2 = (int) ceilf ((rect.y + rect.height) * scale);
+
+      cairo_region_union_rectangle (stream_damage,
+                                    &(cairo_rectangle_int_t) {
+                                      .x = x1,
+                                      .y = y1,
+                                      .width = x2 - x1,
+                                      .height = y2 - y1,
+                                    });
+    }
+  cairo_region_destroy (monitor_damage);
+
+  /* Rounding out may have stepped past the edge of the stream. */
+  cairo_region_intersect_rectangle (stream_damage,
+                                    &(cairo_rectangle_int_t) {
+                                      .width = (int) roundf (logical_monitor->rect.width * scale),
+                                      .height = (int) roundf (logical_monitor->rect.height * scale),
+                                    });
+
+  return stream_damage;
+}
+
 static void
-stage_painted (ClutterActor                   *actor,
+stage_painted (ClutterStage                   *stage,
+               ClutterStageView               *view,
+               const cairo_region_t           *damage,
                MetaScreenCastMonitorStreamSrc *monitor_src)
 {
   MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (monitor_src);
+  MetaMonitor *monitor;
+  MetaLogicalMonitor *logical_monitor;
+  cairo_region_t *stream_damage;
+
+  if (view != get_view (monitor_src))
+    return;
 
-  meta_screen_cast_stream_src_maybe_record_frame (src);
+  monitor = get_monitor (monitor_src);
+  logical_monitor = meta_monitor_get_logical_monitor (monitor);
+
+  /* Nothing on this monitor changed; a static screen costs nothing. */
+  stream_damage = stage_damage_to_stream_damage (logical_monitor, damage);
+  if (!cairo_region_is_empty (stream_damage))
+    meta_screen_cast_stream_src_maybe_record_frame (src, stream_damage);
+  cairo_region_destroy (stream_damage);
 }
 
 static void
@@ -110,8 +205,10 @@ meta_screen_cast_monitor_stream_src_enable (MetaScreenCastStreamSrc *src)
   ClutterStage *stage;
 
   stage = get_stage (monitor_src);
+  /* Use "after-paint-view" rather than "paint", as the view may be painted
+   * in multiple clipped passes. */
   monitor_src->stage_painted_handler_id =
-    g_signal_connect_after (stage, "paint",
+    g_signal_connect_after (stage, "after-paint-view",
                             G_CALLBACK (stage_painted),
                             monitor_src);
   clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
@@ -145,6 +242,86 @@ meta_screen_cast_monitor_stream_src_record_frame (MetaScreenCastStreamSrc *src,
   clutter_stage_capture_into (stage, FALSE, &logical_monitor->rect, data);
 }
 
+static CoglFramebuffer *
+meta_screen_cast_monitor_stream_src_read_frame_into_bitmap (MetaScreenCastStreamSrc *src,
+                                                            CoglBitmap              *bitmap)
+{
+  MetaScreenCastMonitorStreamSrc *monitor_src =
+    META_SCREEN_CAST_MONITOR_STREAM_SRC (src);
+  MetaMonitor *monitor;
+  MetaLogicalMonitor *logical_monitor;
+  ClutterStageView *view;
+  CoglFramebuffer *framebuffer;
+  cairo_rectangle_int_t view_layout;
+  float view_scale;
+
+  view = get_view (monitor_src);
+  if (!view)
+    return NULL;
+
+  monitor = get_monitor (monitor_src);
+  logical_monitor = meta_monitor_get_logical_monitor (monitor);
+  framebuffer = clutter_stage_view_get_framebuffer (view);
+  clutter_stage_view_get_layout (view, &view_layout);
+  view_scale = clutter_stage_view_get_scale (view);
+
+  /* Leave the rows in the order GL reads them; flipping them here would
+   * map the pixel buffer and wait for the GPU. */
+  if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                 (logical_monitor->rect.x -
+                                                  view_layout.x) * view_scale,
+                                                 (logical_monitor->rect.y -
+                                                  view_layout.y) * view_scale,
+                                                 COGL_READ_PIXELS_COLOR_BUFFER |
+                                                 COGL_READ_PIXELS_NO_FLIP,
+                                                 bitmap))
+    return NULL;
+
+  return framebuffer;
+}
+
+static void
+meta_screen_cast_monitor_stream_src_record_follow_up (MetaScreenCastStreamSrc *src,
+                                                      const cairo_region_t    *damage)
+{
+  MetaScreenCastMonitorStreamSrc *monitor_src =
+    META_SCREEN_CAST_MONITOR_STREAM_SRC (src);
+  ClutterActor *stage;
+  MetaMonitor *monitor;
+  MetaLogicalMonitor *logical_monitor;
+  float scale;
+  int n_rects, i;
+
+  /* Frames are captured from the view as it is painted, and its content
+   * can't be relied on in between, so paint the damage that was held back
+   * again. */
+  stage = CLUTTER_ACTOR (get_stage (monitor_src));
+  monitor = get_monitor (monitor_src);
+  logical_monitor = meta_monitor_get_logical_monitor (monitor);
+  scale = logical_monitor->scale;
+
+  n_rects = cairo_region_num_rectangles (damage);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+      int x1, y1, x2, y2;
+
+      cairo_region_get_rectangle (damage, i, &rect);
+      x1 = (int) floorf (rect.x / scale);
+      y1 = (int) floorf (rect.y / scale);
+      x2 = (int) ceilf ((rect.x + rect.width) / scale);
+      y2 = (int) ceilf ((rect.y + rect.height) / scale);
+
+      clutter_actor_queue_redraw_with_clip (stage,
+                                            &(cairo_rectangle_int_t) {
+                                              .x = logical_monitor->rect.x + x1,
+                                              .y = logical_monitor->rect.y + y1,
+                                              .width = x2 - x1,
+                                              .height = y2 - y1,
+                                            });
+    }
+}
+
 MetaScreenCastMonitorStreamSrc *
 meta_screen_cast_monitor_stream_src_new (MetaScreenCastMonitorStream  *monitor_stream,
                                          GError                      **error)
@@ -169,4 +346,8 @@ meta_screen_cast_monitor_stream_src_class_init (MetaScreenCastMonitorStreamSrcCl
   src_class->enable = meta_screen_cast_monitor_stream_src_enable;
   src_class->disable = meta_screen_cast_monitor_stream_src_disable;
   src_class->record_frame = meta_screen_cast_monitor_stream_src_record_frame;
+  src_class->read_frame_into_bitmap =
+    meta_screen_cast_monitor_stream_src_read_frame_into_bitmap;
+  src_class->record_follow_up =
+    meta_screen_cast_monitor_stream_src_record_follow_up;
 }
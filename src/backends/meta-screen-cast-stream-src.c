@@ -32,8 +32,10 @@
 #include <stdint.h>
 #include <sys/mman.h>
 
+#include "backends/meta-backend-private.h"
 #include "backends/meta-screen-cast-stream.h"
 #include "clutter/clutter-mutter.h"
+#include "cogl/cogl.h"
 #include "core/meta-fraction.h"
 #include "meta/boxes.h"
 
@@ -72,6 +74,35 @@ typedef struct _MetaPipeWireSource
   struct pw_loop *pipewire_loop;
 } MetaPipeWireSource;
 
+#define READBACK_RING_SIZE 3
+
+#define MAX_DAMAGE_RECTS 16
+
+/*
+ * Layout of the "VideoDamage" buffer metadata: up to MAX_DAMAGE_RECTS
+ * rectangles of what changed since the previous frame, terminated by a
+ * rectangle with zero size if there are fewer.
+ */
+typedef struct _MetaScreenCastDamageRect
+{
+  int32_t x;
+  int32_t y;
+  uint32_t width;
+  uint32_t height;
+} MetaScreenCastDamageRect;
+
+typedef struct _MetaScreenCastReadback
+{
+  MetaScreenCastStreamSrc *src;
+
+  CoglBitmap *bitmap;
+  CoglFramebuffer *framebuffer;
+  CoglFenceClosure *fence;
+  gboolean y_inverted;
+  int64_t timestamp_us;
+  cairo_region_t *damage;
+} MetaScreenCastReadback;
+
 typedef struct _MetaScreenCastStreamSrcPrivate
 {
   MetaScreenCastStream *stream;
@@ -88,9 +119,18 @@ typedef struct _MetaScreenCastStreamSrcPrivate
   struct spa_hook pipewire_stream_listener;
 
   MetaSpaType spa_type;
+  uint32_t meta_video_damage;
   struct spa_video_info_raw video_format;
 
   uint64_t last_frame_timestamp_us;
+  uint32_t sequence;
+  guint follow_up_frame_source_id;
+
+  cairo_region_t *pending_damage;
+  GHashTable *buffer_damage;
+
+  MetaScreenCastReadback readbacks[READBACK_RING_SIZE];
+  int next_readback;
 } MetaScreenCastStreamSrcPrivate;
 
 static void
@@ -127,65 +167,543 @@ meta_screen_cast_stream_src_record_frame (MetaScreenCastStreamSrc *src,
   klass->record_frame (src, data);
 }
 
-void
-meta_screen_cast_stream_src_maybe_record_frame (MetaScreenCastStreamSrc *src)
+static uint8_t *
+map_buffer_data (MetaScreenCastStreamSrc  *src,
+                 struct spa_buffer        *buffer,
+                 uint8_t                 **map)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  *map = NULL;
+
+  if (buffer->datas[0].type == priv->pipewire_type->data.MemFd)
+    {
+      *map = mmap (NULL, buffer->datas[0].maxsize + buffer->datas[0].mapoffset,
+                   PROT_READ | PROT_WRITE, MAP_SHARED,
+                   buffer->datas[0].fd, 0);
+      if (*map == MAP_FAILED)
+        {
+          g_warning ("Failed to mmap pipewire stream buffer: %s\n",
+                     strerror (errno));
+          *map = NULL;
+          return NULL;
+        }
+
+      return SPA_MEMBER (*map, buffer->datas[0].mapoffset, uint8_t);
+    }
+  else if (buffer->datas[0].type == priv->pipewire_type->data.MemPtr)
+    {
+      return buffer->datas[0].data;
+    }
+  else
+    {
+      return NULL;
+    }
+}
+
+static void
+unmap_buffer_data (struct spa_buffer *buffer,
+                   uint8_t           *map)
+{
+  if (map)
+    munmap (map, buffer->datas[0].maxsize + buffer->datas[0].mapoffset);
+}
+
+static cairo_region_t *
+create_full_damage (MetaScreenCastStreamSrc *src)
 {
   MetaScreenCastStreamSrcPrivate *priv =
     meta_screen_cast_stream_src_get_instance_private (src);
+  cairo_rectangle_int_t rect = {
+    .x = 0,
+    .y = 0,
+    .width = priv->video_format.size.width,
+    .height = priv->video_format.size.height
+  };
+
+  return cairo_region_create_rectangle (&rect);
+}
+
+static cairo_region_t *
+take_pending_damage (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  cairo_region_t *damage;
+
+  damage = priv->pending_damage;
+  priv->pending_damage = cairo_region_create ();
+
+  return damage;
+}
+
+/*
+ * Buffers are recycled by the consumer, so each one only needs to be
+ * updated where the frames sent since it was last filled differ from it.
+ */
+static void
+apply_frame_damage (MetaScreenCastStreamSrc *src,
+                    cairo_region_t          *frame_damage)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  GHashTableIter iter;
+  cairo_region_t *buffer_damage;
+
+  g_hash_table_iter_init (&iter, priv->buffer_damage);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &buffer_damage))
+    cairo_region_union (buffer_damage, frame_damage);
+}
+
+static cairo_region_t *
+take_buffer_damage (MetaScreenCastStreamSrc *src,
+                    uint32_t                 buffer_id)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  cairo_region_t *buffer_damage;
+
+  buffer_damage = g_hash_table_lookup (priv->buffer_damage,
+                                       GUINT_TO_POINTER (buffer_id));
+  if (buffer_damage)
+    cairo_region_reference (buffer_damage);
+  else
+    buffer_damage = create_full_damage (src);
+
+  g_hash_table_insert (priv->buffer_damage,
+                       GUINT_TO_POINTER (buffer_id),
+                       cairo_region_create ());
+
+  return buffer_damage;
+}
+
+static void
+set_damage_metadata (MetaScreenCastStreamSrc *src,
+                     struct spa_buffer       *buffer,
+                     cairo_region_t          *frame_damage)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  MetaScreenCastDamageRect *damage_rects;
+  int n_rects;
+  int i;
+
+  damage_rects = spa_buffer_find_meta (buffer, priv->meta_video_damage);
+  if (!damage_rects)
+    return;
+
+  n_rects = cairo_region_num_rectangles (frame_damage);
+  if (n_rects > MAX_DAMAGE_RECTS)
+    {
+      cairo_rectangle_int_t extents;
+
+      cairo_region_get_extents (frame_damage, &extents);
+      damage_rects[0] = (MetaScreenCastDamageRect) {
+        .x = extents.x,
+        .y = extents.y,
+        .width = extents.width,
+        .height = extents.height
+      };
+      n_rects = 1;
+    }
+  else
+    {
+      for (i = 0; i < n_rects; i++)
+        {
+          cairo_rectangle_int_t rect;
+
+          cairo_region_get_rectangle (frame_damage, i, &rect);
+          damage_rects[i] = (MetaScreenCastDamageRect) {
+            .x = rect.x,
+            .y = rect.y,
+            .width = rect.width,
+            .height = rect.height
+          };
+        }
+    }
+
+  if (n_rects < MAX_DAMAGE_RECTS)
+    damage_rects[n_rects] = (MetaScreenCastDamageRect) { 0 };
+}
+
+static void
+send_buffer (MetaScreenCastStreamSrc *src,
+             uint32_t                 buffer_id,
+             struct spa_buffer       *buffer,
+             cairo_region_t          *frame_damage,
+             int64_t                  timestamp_us)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  struct spa_meta_header *header;
+
+  header = spa_buffer_find_meta (buffer, priv->pipewire_type->meta.Header);
+  if (header)
+    {
+      header->flags = 0;
+      header->seq = priv->sequence++;
+      header->pts = timestamp_us * 1000;
+      header->dts_offset = 0;
+    }
+
+  set_damage_metadata (src, buffer, frame_damage);
+
+  buffer->datas[0].chunk->size = buffer->datas[0].maxsize;
+
+  pw_stream_send_buffer (priv->pipewire_stream, buffer_id);
+}
+
+static void
+clear_readback (MetaScreenCastReadback *readback)
+{
+  if (readback->fence)
+    {
+      cogl_framebuffer_cancel_fence_callback (readback->framebuffer,
+                                              readback->fence);
+      readback->fence = NULL;
+    }
+
+  g_clear_pointer (&readback->framebuffer, cogl_object_unref);
+  g_clear_pointer (&readback->bitmap, cogl_object_unref);
+  g_clear_pointer (&readback->damage, cairo_region_destroy);
+}
+
+static void
+clear_readbacks (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  int i;
+
+  for (i = 0; i < READBACK_RING_SIZE; i++)
+    clear_readback (&priv->readbacks[i]);
+}
+
+static void
+copy_readback_rect (MetaScreenCastReadback      *readback,
+                    const uint8_t               *pixels,
+                    uint8_t                     *data,
+                    const cairo_rectangle_int_t *rect)
+{
+  int stride = cogl_bitmap_get_rowstride (readback->bitmap);
+  int height = cogl_bitmap_get_height (readback->bitmap);
+  const int bpp = 4;
+  int y;
+
+  for (y = rect->y; y < rect->y + rect->height; y++)
+    {
+      int src_y = readback->y_inverted ? height - y - 1 : y;
+
+      memcpy (data + y * stride + rect->x * bpp,
+              pixels + src_y * stride + rect->x * bpp,
+              rect->width * bpp);
+    }
+}
+
+static void
+finish_readback (MetaScreenCastReadback *readback)
+{
+  MetaScreenCastStreamSrc *src = readback->src;
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  CoglBuffer *pixel_buffer;
   uint32_t buffer_id;
   struct spa_buffer *buffer;
-  uint8_t *map = NULL;
+  cairo_region_t *frame_damage;
+  cairo_region_t *buffer_damage;
+  uint8_t *map;
   uint8_t *data;
-  uint64_t now_us;
+  uint8_t *pixels;
+  int n_rects, i;
 
-  now_us = g_get_monotonic_time ();
-  if (priv->last_frame_timestamp_us != 0 &&
-      (now_us - priv->last_frame_timestamp_us <
-       ((1000000 * priv->video_format.max_framerate.denom) /
-        priv->video_format.max_framerate.num)))
-    return;
+  frame_damage = g_steal_pointer (&readback->damage);
+  apply_frame_damage (src, frame_damage);
 
   if (!priv->pipewire_stream)
-    return;
+    goto out;
 
   buffer_id = pw_stream_get_empty_buffer (priv->pipewire_stream);
   if (buffer_id == SPA_ID_INVALID)
-    return;
+    goto out;
 
   buffer = pw_stream_peek_buffer (priv->pipewire_stream, buffer_id);
+  data = map_buffer_data (src, buffer, &map);
+  if (!data)
+    goto out;
 
-  if (buffer->datas[0].type == priv->pipewire_type->data.MemFd)
+  pixel_buffer = COGL_BUFFER (cogl_bitmap_get_buffer (readback->bitmap));
+  pixels = cogl_buffer_map (pixel_buffer, COGL_BUFFER_ACCESS_READ, 0);
+  if (!pixels)
     {
-      map = mmap (NULL, buffer->datas[0].maxsize + buffer->datas[0].mapoffset,
-                  PROT_READ | PROT_WRITE, MAP_SHARED,
-                  buffer->datas[0].fd, 0);
-      if (map == MAP_FAILED)
-        {
-          g_warning ("Failed to mmap pipewire stream buffer: %s\n",
-                     strerror (errno));
-          return;
-        }
+      unmap_buffer_data (buffer, map);
+      goto out;
+    }
 
-      data = SPA_MEMBER (map, buffer->datas[0].mapoffset, uint8_t);
+  buffer_damage = take_buffer_damage (src, buffer_id);
+  n_rects = cairo_region_num_rectangles (buffer_damage);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (buffer_damage, i, &rect);
+      copy_readback_rect (readback, pixels, data, &rect);
     }
-  else if (buffer->datas[0].type == priv->pipewire_type->data.MemPtr)
+  cairo_region_destroy (buffer_damage);
+
+  cogl_buffer_unmap (pixel_buffer);
+  unmap_buffer_data (buffer, map);
+
+  send_buffer (src, buffer_id, buffer, frame_damage, readback->timestamp_us);
+
+out:
+  cairo_region_destroy (frame_damage);
+}
+
+static void
+on_readback_fence (CoglFence *fence,
+                   void      *user_data)
+{
+  MetaScreenCastReadback *readback = user_data;
+
+  readback->fence = NULL;
+  finish_readback (readback);
+}
+
+static gboolean
+ensure_readback_bitmap (MetaScreenCastStreamSrc *src,
+                        MetaScreenCastReadback  *readback)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  MetaBackend *backend = meta_get_backend ();
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+  CoglContext *cogl_context = clutter_backend_get_cogl_context (clutter_backend);
+  CoglPixelBuffer *pixel_buffer;
+  int width, height, stride;
+
+  if (readback->bitmap)
+    return TRUE;
+
+  width = priv->video_format.size.width;
+  height = priv->video_format.size.height;
+  stride = width * 4;
+
+  pixel_buffer = cogl_pixel_buffer_new (cogl_context, stride * height, NULL);
+  if (!pixel_buffer)
+    return FALSE;
+
+  readback->src = src;
+  readback->bitmap = cogl_bitmap_new_from_buffer (COGL_BUFFER (pixel_buffer),
+                                                  CLUTTER_CAIRO_FORMAT_ARGB32,
+                                                  width, height,
+                                                  stride,
+                                                  0);
+  cogl_object_unref (pixel_buffer);
+
+  return TRUE;
+}
+
+static gboolean
+queue_readback (MetaScreenCastStreamSrc *src,
+                int64_t                  now_us)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  MetaScreenCastStreamSrcClass *klass =
+    META_SCREEN_CAST_STREAM_SRC_GET_CLASS (src);
+  MetaScreenCastReadback *readback;
+  CoglFramebuffer *framebuffer;
+
+  readback = &priv->readbacks[priv->next_readback];
+
+  /* The consumer side is lagging behind; drop the frame rather than
+   * waiting for the GPU. */
+  if (readback->fence)
+    return FALSE;
+
+  if (!ensure_readback_bitmap (src, readback))
+    return FALSE;
+
+  framebuffer = klass->read_frame_into_bitmap (src, readback->bitmap);
+  if (!framebuffer)
+    return FALSE;
+
+  priv->next_readback = (priv->next_readback + 1) % READBACK_RING_SIZE;
+
+  readback->timestamp_us = now_us;
+  readback->y_inverted = !cogl_is_offscreen (framebuffer);
+  readback->damage = take_pending_damage (src);
+  g_clear_pointer (&readback->framebuffer, cogl_object_unref);
+  readback->framebuffer = cogl_object_ref (framebuffer);
+  readback->fence = cogl_framebuffer_add_fence_callback (framebuffer,
+                                                         on_readback_fence,
+                                                         readback);
+
+  /* Without fence support, fall back to waiting for the pixels right away. */
+  if (!readback->fence)
+    finish_readback (readback);
+
+  return TRUE;
+}
+
+static void
+cancel_follow_up_frame (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  if (priv->follow_up_frame_source_id)
     {
-      data = buffer->datas[0].data;
+      g_source_remove (priv->follow_up_frame_source_id);
+      priv->follow_up_frame_source_id = 0;
+    }
+}
+
+static gboolean
+follow_up_frame_cb (gpointer user_data)
+{
+  MetaScreenCastStreamSrc *src = user_data;
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  MetaScreenCastStreamSrcClass *klass =
+    META_SCREEN_CAST_STREAM_SRC_GET_CLASS (src);
+
+  priv->follow_up_frame_source_id = 0;
+
+  if (klass->record_follow_up)
+    {
+      klass->record_follow_up (src, priv->pending_damage);
     }
   else
     {
+      cairo_region_t *no_damage = cairo_region_create ();
+
+      meta_screen_cast_stream_src_maybe_record_frame (src, no_damage);
+      cairo_region_destroy (no_damage);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Damage arriving faster than the negotiated frame rate, or while every
+ * readback is still in flight, is only queued; make sure it is sent once
+ * the interval has passed, even if nothing else changes by then. */
+static void
+maybe_schedule_follow_up_frame (MetaScreenCastStreamSrc *src,
+                                uint64_t                 timeout_us)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  if (priv->follow_up_frame_source_id)
+    return;
+
+  priv->follow_up_frame_source_id =
+    g_timeout_add ((timeout_us + 999) / 1000, follow_up_frame_cb, src);
+}
+
+/**
+ * meta_screen_cast_stream_src_maybe_record_frame:
+ * @src: a #MetaScreenCastStreamSrc
+ * @damage: (nullable): the area that changed since the last call, in stream
+ *          coordinates, or %NULL if everything may have changed
+ *
+ * Records a frame, unless doing so would exceed the negotiated frame rate,
+ * in which case @damage is carried over to the next recorded frame.
+ */
+void
+meta_screen_cast_stream_src_maybe_record_frame (MetaScreenCastStreamSrc *src,
+                                                const cairo_region_t    *damage)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  MetaScreenCastStreamSrcClass *klass =
+    META_SCREEN_CAST_STREAM_SRC_GET_CLASS (src);
+  uint32_t buffer_id;
+  struct spa_buffer *buffer;
+  cairo_region_t *frame_damage;
+  uint8_t *map;
+  uint8_t *data;
+  uint64_t now_us;
+  uint64_t frame_interval_us;
+
+  if (damage)
+    {
+      cairo_region_union (priv->pending_damage, damage);
+    }
+  else
+    {
+      cairo_region_t *full_damage = create_full_damage (src);
+
+      cairo_region_union (priv->pending_damage, full_damage);
+      cairo_region_destroy (full_damage);
+    }
+
+  if (cairo_region_is_empty (priv->pending_damage))
+    return;
+
+  now_us = g_get_monotonic_time ();
+  frame_interval_us = ((1000000 * priv->video_format.max_framerate.denom) /
+                       priv->video_format.max_framerate.num);
+  if (priv->last_frame_timestamp_us != 0)
+    {
+      if (now_us - priv->last_frame_timestamp_us < frame_interval_us)
+        {
+          uint64_t time_left_us;
+
+          time_left_us = (priv->last_frame_timestamp_us + frame_interval_us -
+                          now_us);
+          maybe_schedule_follow_up_frame (src, time_left_us);
+          return;
+        }
+    }
+
+  if (!priv->pipewire_stream)
+    return;
+
+  /* Shared memory buffers are filled asynchronously: the readback is
+   * issued now and copied into a buffer once the GPU has finished it. */
+  if (klass->read_frame_into_bitmap)
+    {
+      if (queue_readback (src, now_us))
+        {
+          priv->last_frame_timestamp_us = now_us;
+          cancel_follow_up_frame (src);
+        }
+      else if (priv->readbacks[priv->next_readback].fence)
+        {
+          /* The ring is full; try again a frame later rather than
+           * waiting for unrelated damage. */
+          maybe_schedule_follow_up_frame (src, frame_interval_us);
+        }
       return;
     }
 
+  buffer_id = pw_stream_get_empty_buffer (priv->pipewire_stream);
+  if (buffer_id == SPA_ID_INVALID)
+    return;
+
+  buffer = pw_stream_peek_buffer (priv->pipewire_stream, buffer_id);
+
+  data = map_buffer_data (src, buffer, &map);
+  if (!data)
+    return;
+
+  frame_damage = take_pending_damage (src);
+  apply_frame_damage (src, frame_damage);
+
+  /* The whole frame is written, regardless of the damage. */
   meta_screen_cast_stream_src_record_frame (src, data);
-  priv->last_frame_timestamp_us = now_us;
+  cairo_region_destroy (take_buffer_damage (src, buffer_id));
 
-  if (map)
-    munmap (map, buffer->datas[0].maxsize + buffer->datas[0].mapoffset);
+  unmap_buffer_data (buffer, map);
 
-  buffer->datas[0].chunk->size = buffer->datas[0].maxsize;
+  priv->last_frame_timestamp_us = now_us;
+  cancel_follow_up_frame (src);
 
-  pw_stream_send_buffer (priv->pipewire_stream, buffer_id);
+  send_buffer (src, buffer_id, buffer, frame_damage, now_us);
+  cairo_region_destroy (frame_damage);
 }
 
 static gboolean
@@ -216,6 +734,8 @@ meta_screen_cast_stream_src_disable (MetaScreenCastStreamSrc *src)
 
   META_SCREEN_CAST_STREAM_SRC_GET_CLASS (src)->disable (src);
 
+  cancel_follow_up_frame (src);
+
   priv->is_enabled = FALSE;
 }
 
@@ -271,7 +791,7 @@ on_stream_format_changed (void           *data,
   uint8_t params_buffer[1024];
   int32_t width, height, stride, size;
   struct spa_pod_builder pod_builder;
-  struct spa_pod *params[1];
+  struct spa_pod *params[3];
   const int bpp = 4;
 
   if (!format)
@@ -284,6 +804,11 @@ on_stream_format_changed (void           *data,
                               &priv->video_format,
                               &priv->spa_type.format_video);
 
+  clear_readbacks (src);
+  g_hash_table_remove_all (priv->buffer_damage);
+  cairo_region_destroy (priv->pending_damage);
+  priv->pending_damage = create_full_damage (src);
+
   width = priv->video_format.size.width;
   height = priv->video_format.size.height;
   stride = SPA_ROUND_UP_N (width * bpp, 4);
@@ -299,14 +824,53 @@ on_stream_format_changed (void           *data,
     ":", pipewire_type->param_buffers.buffers, "iru", 16, PROP_RANGE (2, 16),
     ":", pipewire_type->param_buffers.align, "i", 16);
 
+  params[1] = spa_pod_builder_object (
+    &pod_builder,
+    pipewire_type->param.idMeta, pipewire_type->param_meta.Meta,
+    ":", pipewire_type->param_meta.type, "I", pipewire_type->meta.Header,
+    ":", pipewire_type->param_meta.size, "i", sizeof (struct spa_meta_header));
+
+  params[2] = spa_pod_builder_object (
+    &pod_builder,
+    pipewire_type->param.idMeta, pipewire_type->param_meta.Meta,
+    ":", pipewire_type->param_meta.type, "I", priv->meta_video_damage,
+    ":", pipewire_type->param_meta.size, "i",
+    sizeof (MetaScreenCastDamageRect) * MAX_DAMAGE_RECTS);
+
   pw_stream_finish_format (priv->pipewire_stream, 0,
                            params, G_N_ELEMENTS (params));
 }
 
+static void
+on_stream_add_buffer (void     *data,
+                      uint32_t  id)
+{
+  MetaScreenCastStreamSrc *src = data;
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  g_hash_table_insert (priv->buffer_damage,
+                       GUINT_TO_POINTER (id),
+                       create_full_damage (src));
+}
+
+static void
+on_stream_remove_buffer (void     *data,
+                         uint32_t  id)
+{
+  MetaScreenCastStreamSrc *src = data;
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  g_hash_table_remove (priv->buffer_damage, GUINT_TO_POINTER (id));
+}
+
 static const struct pw_stream_events stream_events = {
   PW_VERSION_STREAM_EVENTS,
   .state_changed = on_stream_state_changed,
   .format_changed = on_stream_format_changed,
+  .add_buffer = on_stream_add_buffer,
+  .remove_buffer = on_stream_remove_buffer,
 };
 
 static struct pw_stream *
@@ -407,6 +971,44 @@ on_state_changed (void                 *data,
     }
 }
 
+/**
+ * meta_screen_cast_stream_src_renegotiate:
+ * @src: a #MetaScreenCastStreamSrc
+ *
+ * Offers a new format after the specs of @src, e.g. its size, changed.
+ * libpipewire-0.1 can't change the formats of a connected stream, so the
+ * stream is replaced, and "ready" is emitted again with the new node.
+ */
+void
+meta_screen_cast_stream_src_renegotiate (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  GError *error = NULL;
+
+  /* Not connected yet; the stream will be created with the new specs. */
+  if (!priv->pipewire_stream)
+    return;
+
+  if (meta_screen_cast_stream_src_is_enabled (src))
+    meta_screen_cast_stream_src_disable (src);
+
+  clear_readbacks (src);
+  g_hash_table_remove_all (priv->buffer_damage);
+  priv->last_frame_timestamp_us = 0;
+
+  spa_hook_remove (&priv->pipewire_stream_listener);
+  g_clear_pointer (&priv->pipewire_stream, (GDestroyNotify) pw_stream_destroy);
+
+  priv->pipewire_stream = create_pipewire_stream (src, &error);
+  if (!priv->pipewire_stream)
+    {
+      g_warning ("Could not recreate pipewire stream: %s", error->message);
+      g_error_free (error);
+      meta_screen_cast_stream_src_notify_closed (src);
+    }
+}
+
 static gboolean
 pipewire_loop_source_prepare (GSource *base,
                               int     *timeout)
@@ -515,6 +1117,9 @@ meta_screen_cast_stream_src_initable_init (GInitable     *initable,
 
   priv->pipewire_type = pw_core_get_type (priv->pipewire_core);
   init_spa_type (&priv->spa_type, priv->pipewire_type->map);
+  priv->meta_video_damage =
+    spa_type_map_get_id (priv->pipewire_type->map,
+                         SPA_TYPE_META_BASE "VideoDamage");
 
   if (pw_remote_connect (priv->pipewire_remote) != 0)
     {
@@ -551,7 +1156,12 @@ meta_screen_cast_stream_src_finalize (GObject *object)
   if (meta_screen_cast_stream_src_is_enabled (src))
     meta_screen_cast_stream_src_disable (src);
 
+  cancel_follow_up_frame (src);
+  clear_readbacks (src);
+
   g_clear_pointer (&priv->pipewire_stream, (GDestroyNotify) pw_stream_destroy);
+  g_clear_pointer (&priv->buffer_damage, g_hash_table_destroy);
+  g_clear_pointer (&priv->pending_damage, cairo_region_destroy);
   g_clear_pointer (&priv->pipewire_remote, (GDestroyNotify) pw_remote_destroy);
   g_clear_pointer (&priv->pipewire_core, (GDestroyNotify) pw_core_destroy);
   g_source_destroy (&priv->pipewire_source->base);
@@ -602,6 +1212,14 @@ meta_screen_cast_stream_src_get_property (GObject    *object,
 static void
 meta_screen_cast_stream_src_init (MetaScreenCastStreamSrc *src)
 {
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  priv->buffer_damage =
+    g_hash_table_new_full (NULL, NULL,
+                           NULL,
+                           (GDestroyNotify) cairo_region_destroy);
+  priv->pending_damage = cairo_region_create ();
 }
 
 static void
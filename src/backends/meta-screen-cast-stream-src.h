@@ -47,9 +47,16 @@ struct _MetaScreenCastStreamSrcClass
   void (* disable) (MetaScreenCastStreamSrc *src);
   void (* record_frame) (MetaScreenCastStreamSrc *src,
                          uint8_t                 *data);
+  CoglFramebuffer * (* read_frame_into_bitmap) (MetaScreenCastStreamSrc *src,
+                                                CoglBitmap              *bitmap);
+  void (* record_follow_up) (MetaScreenCastStreamSrc *src,
+                             const cairo_region_t    *damage);
 };
 
-void meta_screen_cast_stream_src_maybe_record_frame (MetaScreenCastStreamSrc *src);
+void meta_screen_cast_stream_src_maybe_record_frame (MetaScreenCastStreamSrc *src,
+                                                     const cairo_region_t    *damage);
+
+void meta_screen_cast_stream_src_renegotiate (MetaScreenCastStreamSrc *src);
 
 MetaScreenCastStream * meta_screen_cast_stream_src_get_stream (MetaScreenCastStreamSrc *src);
 
@@ -55,6 +55,8 @@ void meta_screen_cast_stream_close (MetaScreenCastStream *stream);
 
 char * meta_screen_cast_stream_get_object_path (MetaScreenCastStream *stream);
 
+void meta_screen_cast_stream_update_parameters (MetaScreenCastStream *stream);
+
 void meta_screen_cast_stream_transform_position (MetaScreenCastStream *stream,
                                                  double                stream_x,
                                                  double                stream_y,
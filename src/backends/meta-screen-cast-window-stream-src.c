@@ -0,0 +1,338 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2018 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include "config.h"
+
+#include "backends/meta-screen-cast-window-stream-src.h"
+
+#include "backends/meta-backend-private.h"
+#include "backends/meta-logical-monitor.h"
+#include "backends/meta-monitor.h"
+#include "backends/meta-screen-cast-window-stream.h"
+#include "compositor/meta-shaped-texture-private.h"
+#include "compositor/meta-surface-actor.h"
+#include "core/window-private.h"
+
+struct _MetaScreenCastWindowStreamSrc
+{
+  MetaScreenCastStreamSrc parent;
+
+  MetaSurfaceActor *surface_actor;
+  gulong damaged_handler_id;
+  gulong size_changed_handler_id;
+  gulong destroy_handler_id;
+
+  CoglFramebuffer *offscreen;
+};
+
+G_DEFINE_TYPE (MetaScreenCastWindowStreamSrc,
+               meta_screen_cast_window_stream_src,
+               META_TYPE_SCREEN_CAST_STREAM_SRC)
+
+static MetaScreenCastWindowStream *
+get_window_stream (MetaScreenCastWindowStreamSrc *window_src)
+{
+  MetaScreenCastStreamSrc *src;
+  MetaScreenCastStream *stream;
+
+  src = META_SCREEN_CAST_STREAM_SRC (window_src);
+  stream = meta_screen_cast_stream_src_get_stream (src);
+
+  return META_SCREEN_CAST_WINDOW_STREAM (stream);
+}
+
+static float
+get_refresh_rate (MetaScreenCastWindowStream *window_stream)
+{
+  MetaWindow *window;
+  MetaLogicalMonitor *logical_monitor;
+  float refresh_rate = 0.0f;
+  GList *l;
+
+  window = meta_screen_cast_window_stream_get_window (window_stream);
+  logical_monitor = meta_window_get_main_logical_monitor (window);
+  if (!logical_monitor)
+    return 60.0f;
+
+  /* The window is updated as often as the fastest of the monitors
+   * showing it. */
+  for (l = meta_logical_monitor_get_monitors (logical_monitor); l; l = l->next)
+    {
+      MetaMonitor *monitor = l->data;
+      MetaMonitorMode *mode = meta_monitor_get_current_mode (monitor);
+
+      if (mode)
+        refresh_rate = MAX (refresh_rate,
+                            meta_monitor_mode_get_refresh_rate (mode));
+    }
+
+  return refresh_rate > 0.0f ? refresh_rate : 60.0f;
+}
+
+static void
+meta_screen_cast_window_stream_src_get_specs (MetaScreenCastStreamSrc *src,
+                                              int                     *width,
+                                              int                     *height,
+                                              float                   *frame_rate)
+{
+  MetaScreenCastWindowStreamSrc *window_src =
+    META_SCREEN_CAST_WINDOW_STREAM_SRC (src);
+  MetaScreenCastWindowStream *window_stream;
+
+  window_stream = get_window_stream (window_src);
+
+  *width = meta_screen_cast_window_stream_get_width (window_stream);
+  *height = meta_screen_cast_window_stream_get_height (window_stream);
+  *frame_rate = get_refresh_rate (window_stream);
+}
+
+static void
+surface_damaged (MetaSurfaceActor              *surface_actor,
+                 int                            x,
+                 int                            y,
+                 int                            width,
+                 int                            height,
+                 MetaScreenCastWindowStreamSrc *window_src)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (window_src);
+  MetaScreenCastWindowStream *window_stream;
+  cairo_region_t *stream_damage;
+
+  window_stream = get_window_stream (window_src);
+
+  stream_damage = cairo_region_create_rectangle (&(cairo_rectangle_int_t) {
+                                                   .x = x,
+                                                   .y = y,
+                                                   .width = width,
+                                                   .height = height,
+                                                 });
+  cairo_region_intersect_rectangle (stream_damage,
+                                    &(cairo_rectangle_int_t) {
+                                      .width = meta_screen_cast_window_stream_get_width (window_stream),
+                                      .height = meta_screen_cast_window_stream_get_height (window_stream),
+                                    });
+  if (!cairo_region_is_empty (stream_damage))
+    meta_screen_cast_stream_src_maybe_record_frame (src, stream_damage);
+  cairo_region_destroy (stream_damage);
+}
+
+static void
+surface_size_changed (MetaSurfaceActor              *surface_actor,
+                      MetaScreenCastWindowStreamSrc *window_src)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (window_src);
+  MetaScreenCastWindowStream *window_stream;
+
+  window_stream = get_window_stream (window_src);
+  if (meta_screen_cast_window_stream_update_size (window_stream))
+    {
+      /* Recording resumes once the new format has been negotiated. */
+      g_clear_pointer (&window_src->offscreen, cogl_object_unref);
+      meta_screen_cast_stream_src_renegotiate (src);
+      return;
+    }
+
+  meta_screen_cast_stream_src_maybe_record_frame (src, NULL);
+}
+
+static void
+disconnect_surface_actor (MetaScreenCastWindowStreamSrc *window_src)
+{
+  if (!window_src->surface_actor)
+    return;
+
+  g_signal_handler_disconnect (window_src->surface_actor,
+                               window_src->damaged_handler_id);
+  window_src->damaged_handler_id = 0;
+  g_signal_handler_disconnect (window_src->surface_actor,
+                               window_src->size_changed_handler_id);
+  window_src->size_changed_handler_id = 0;
+  g_signal_handler_disconnect (window_src->surface_actor,
+                               window_src->destroy_handler_id);
+  window_src->destroy_handler_id = 0;
+  window_src->surface_actor = NULL;
+}
+
+static void
+surface_destroyed (MetaSurfaceActor              *surface_actor,
+                   MetaScreenCastWindowStreamSrc *window_src)
+{
+  /* The stream is closed when the window is unmanaged; until then,
+   * frames are left empty. */
+  disconnect_surface_actor (window_src);
+}
+
+static void
+meta_screen_cast_window_stream_src_enable (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastWindowStreamSrc *window_src =
+    META_SCREEN_CAST_WINDOW_STREAM_SRC (src);
+  MetaScreenCastWindowStream *window_stream;
+  MetaSurfaceActor *surface_actor;
+
+  window_stream = get_window_stream (window_src);
+  surface_actor = meta_screen_cast_window_stream_get_surface_actor (window_stream);
+  if (!surface_actor)
+    return;
+
+  /* Follow surface damage rather than stage painting, so that frames keep
+   * coming when the window is obscured or on another workspace, and stop
+   * when only the rest of the screen changes. */
+  window_src->surface_actor = surface_actor;
+  window_src->damaged_handler_id =
+    g_signal_connect (surface_actor, "damaged",
+                      G_CALLBACK (surface_damaged),
+                      window_src);
+  window_src->size_changed_handler_id =
+    g_signal_connect (surface_actor, "size-changed",
+                      G_CALLBACK (surface_size_changed),
+                      window_src);
+  window_src->destroy_handler_id =
+    g_signal_connect (surface_actor, "destroy",
+                      G_CALLBACK (surface_destroyed),
+                      window_src);
+
+  meta_screen_cast_stream_src_maybe_record_frame (src, NULL);
+}
+
+static void
+meta_screen_cast_window_stream_src_disable (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastWindowStreamSrc *window_src =
+    META_SCREEN_CAST_WINDOW_STREAM_SRC (src);
+
+  disconnect_surface_actor (window_src);
+}
+
+static void
+paint_window (MetaScreenCastWindowStreamSrc *window_src,
+              CoglFramebuffer               *framebuffer)
+{
+  MetaShapedTexture *stex;
+
+  cogl_framebuffer_clear4f (framebuffer, COGL_BUFFER_BIT_COLOR,
+                            0.0f, 0.0f, 0.0f, 0.0f);
+
+  if (!window_src->surface_actor)
+    return;
+
+  stex = meta_surface_actor_get_texture (window_src->surface_actor);
+  meta_shaped_texture_paint_to_framebuffer (stex, framebuffer);
+}
+
+static CoglFramebuffer *
+ensure_offscreen (MetaScreenCastWindowStreamSrc *window_src)
+{
+  MetaBackend *backend = meta_get_backend ();
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+  CoglContext *cogl_context = clutter_backend_get_cogl_context (clutter_backend);
+  MetaScreenCastWindowStream *window_stream;
+  CoglTexture2D *texture;
+  CoglOffscreen *offscreen;
+  GError *error = NULL;
+
+  if (window_src->offscreen)
+    return window_src->offscreen;
+
+  window_stream = get_window_stream (window_src);
+  texture = cogl_texture_2d_new_with_size (cogl_context,
+                                           meta_screen_cast_window_stream_get_width (window_stream),
+                                           meta_screen_cast_window_stream_get_height (window_stream));
+  offscreen = cogl_offscreen_new_with_texture (COGL_TEXTURE (texture));
+  cogl_object_unref (texture);
+
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), &error))
+    {
+      g_warning ("Failed to allocate window screen cast framebuffer: %s",
+                 error->message);
+      g_error_free (error);
+      cogl_object_unref (offscreen);
+      return NULL;
+    }
+
+  window_src->offscreen = COGL_FRAMEBUFFER (offscreen);
+
+  return window_src->offscreen;
+}
+
+static CoglFramebuffer *
+meta_screen_cast_window_stream_src_read_frame_into_bitmap (MetaScreenCastStreamSrc *src,
+                                                           CoglBitmap              *bitmap)
+{
+  MetaScreenCastWindowStreamSrc *window_src =
+    META_SCREEN_CAST_WINDOW_STREAM_SRC (src);
+  CoglFramebuffer *framebuffer;
+
+  framebuffer = ensure_offscreen (window_src);
+  if (!framebuffer)
+    return NULL;
+
+  paint_window (window_src, framebuffer);
+  if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                 0, 0,
+                                                 COGL_READ_PIXELS_COLOR_BUFFER,
+                                                 bitmap))
+    return NULL;
+
+  return framebuffer;
+}
+
+MetaScreenCastWindowStreamSrc *
+meta_screen_cast_window_stream_src_new (MetaScreenCastWindowStream  *window_stream,
+                                        GError                     **error)
+{
+  return g_initable_new (META_TYPE_SCREEN_CAST_WINDOW_STREAM_SRC, NULL, error,
+                         "stream", window_stream,
+                         NULL);
+}
+
+static void
+meta_screen_cast_window_stream_src_finalize (GObject *object)
+{
+  MetaScreenCastWindowStreamSrc *window_src =
+    META_SCREEN_CAST_WINDOW_STREAM_SRC (object);
+
+  g_clear_pointer (&window_src->offscreen, cogl_object_unref);
+
+  G_OBJECT_CLASS (meta_screen_cast_window_stream_src_parent_class)->finalize (object);
+}
+
+static void
+meta_screen_cast_window_stream_src_init (MetaScreenCastWindowStreamSrc *window_src)
+{
+}
+
+static void
+meta_screen_cast_window_stream_src_class_init (MetaScreenCastWindowStreamSrcClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  MetaScreenCastStreamSrcClass *src_class =
+    META_SCREEN_CAST_STREAM_SRC_CLASS (klass);
+
+  object_class->finalize = meta_screen_cast_window_stream_src_finalize;
+
+  src_class->get_specs = meta_screen_cast_window_stream_src_get_specs;
+  src_class->enable = meta_screen_cast_window_stream_src_enable;
+  src_class->disable = meta_screen_cast_window_stream_src_disable;
+  src_class->read_frame_into_bitmap =
+    meta_screen_cast_window_stream_src_read_frame_into_bitmap;
+}
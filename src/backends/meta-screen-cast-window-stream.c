@@ -0,0 +1,311 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2018 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include "config.h"
+
+#include "backends/meta-screen-cast-window-stream.h"
+
+#include "backends/meta-screen-cast-window-stream-src.h"
+#include "compositor/meta-window-actor-private.h"
+
+enum
+{
+  PROP_0,
+
+  PROP_WINDOW,
+};
+
+struct _MetaScreenCastWindowStream
+{
+  MetaScreenCastStream parent;
+
+  MetaWindow *window;
+
+  int width;
+  int height;
+};
+
+G_DEFINE_TYPE (MetaScreenCastWindowStream,
+               meta_screen_cast_window_stream,
+               META_TYPE_SCREEN_CAST_STREAM)
+
+static void
+on_window_unmanaged (MetaWindow                 *window,
+                     MetaScreenCastWindowStream *window_stream)
+{
+  meta_screen_cast_stream_close (META_SCREEN_CAST_STREAM (window_stream));
+}
+
+MetaWindow *
+meta_screen_cast_window_stream_get_window (MetaScreenCastWindowStream *window_stream)
+{
+  return window_stream->window;
+}
+
+MetaSurfaceActor *
+meta_screen_cast_window_stream_get_surface_actor (MetaScreenCastWindowStream *window_stream)
+{
+  MetaWindowActor *window_actor;
+
+  window_actor =
+    META_WINDOW_ACTOR (meta_window_get_compositor_private (window_stream->window));
+  if (!window_actor)
+    return NULL;
+
+  return meta_window_actor_get_surface (window_actor);
+}
+
+int
+meta_screen_cast_window_stream_get_width (MetaScreenCastWindowStream *window_stream)
+{
+  return window_stream->width;
+}
+
+int
+meta_screen_cast_window_stream_get_height (MetaScreenCastWindowStream *window_stream)
+{
+  return window_stream->height;
+}
+
+static CoglTexture *
+get_window_texture (MetaWindow *window)
+{
+  MetaWindowActor *window_actor;
+  MetaSurfaceActor *surface_actor;
+  MetaShapedTexture *stex;
+
+  window_actor = META_WINDOW_ACTOR (meta_window_get_compositor_private (window));
+  if (!window_actor)
+    return NULL;
+
+  surface_actor = meta_window_actor_get_surface (window_actor);
+  if (!surface_actor)
+    return NULL;
+
+  stex = meta_surface_actor_get_texture (surface_actor);
+
+  return meta_shaped_texture_get_texture (stex);
+}
+
+MetaScreenCastWindowStream *
+meta_screen_cast_window_stream_new (GDBusConnection  *connection,
+                                    MetaWindow       *window,
+                                    GError          **error)
+{
+  MetaScreenCastWindowStream *window_stream;
+  CoglTexture *texture;
+
+  texture = get_window_texture (window);
+  if (!texture)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Window has no content");
+      return NULL;
+    }
+
+  window_stream = g_object_new (META_TYPE_SCREEN_CAST_WINDOW_STREAM,
+                                "connection", connection,
+                                "window", window,
+                                NULL);
+
+  /* The stream has the size of the window buffer; see
+   * meta_screen_cast_window_stream_update_size(). */
+  window_stream->width = cogl_texture_get_width (texture);
+  window_stream->height = cogl_texture_get_height (texture);
+
+  if (!g_initable_init (G_INITABLE (window_stream), NULL, error))
+    {
+      g_object_unref (window_stream);
+      return NULL;
+    }
+
+  g_signal_connect_object (window, "unmanaged",
+                           G_CALLBACK (on_window_unmanaged),
+                           window_stream, 0);
+
+  return window_stream;
+}
+
+gboolean
+meta_screen_cast_window_stream_update_size (MetaScreenCastWindowStream *window_stream)
+{
+  CoglTexture *texture;
+  int width, height;
+
+  texture = get_window_texture (window_stream->window);
+  if (!texture)
+    return FALSE;
+
+  width = cogl_texture_get_width (texture);
+  height = cogl_texture_get_height (texture);
+  if (width == window_stream->width && height == window_stream->height)
+    return FALSE;
+
+  window_stream->width = width;
+  window_stream->height = height;
+
+  meta_screen_cast_stream_update_parameters (META_SCREEN_CAST_STREAM (window_stream));
+
+  return TRUE;
+}
+
+static MetaScreenCastStreamSrc *
+meta_screen_cast_window_stream_create_src (MetaScreenCastStream  *stream,
+                                           GError               **error)
+{
+  MetaScreenCastWindowStream *window_stream =
+    META_SCREEN_CAST_WINDOW_STREAM (stream);
+  MetaScreenCastWindowStreamSrc *window_stream_src;
+
+  window_stream_src = meta_screen_cast_window_stream_src_new (window_stream,
+                                                              error);
+  if (!window_stream_src)
+    return NULL;
+
+  return META_SCREEN_CAST_STREAM_SRC (window_stream_src);
+}
+
+static void
+meta_screen_cast_window_stream_set_parameters (MetaScreenCastStream *stream,
+                                               GVariantBuilder      *parameters_builder)
+{
+  MetaScreenCastWindowStream *window_stream =
+    META_SCREEN_CAST_WINDOW_STREAM (stream);
+
+  g_variant_builder_add (parameters_builder, "{sv}",
+                         "size",
+                         g_variant_new ("(ii)",
+                                        window_stream->width,
+                                        window_stream->height));
+}
+
+static void
+meta_screen_cast_window_stream_transform_position (MetaScreenCastStream *stream,
+                                                   double                stream_x,
+                                                   double                stream_y,
+                                                   double               *x,
+                                                   double               *y)
+{
+  MetaScreenCastWindowStream *window_stream =
+    META_SCREEN_CAST_WINDOW_STREAM (stream);
+  MetaSurfaceActor *surface_actor;
+  ClutterVertex stream_point;
+  ClutterVertex stage_point;
+
+  surface_actor = meta_screen_cast_window_stream_get_surface_actor (window_stream);
+  if (!surface_actor)
+    {
+      *x = stream_x;
+      *y = stream_y;
+      return;
+    }
+
+  /* Stream pixels are texture pixels; let the actor hierarchy account for
+   * the window position and any buffer scale. */
+  stream_point = (ClutterVertex) { .x = stream_x, .y = stream_y };
+  clutter_actor_apply_transform_to_point (
+    CLUTTER_ACTOR (meta_surface_actor_get_texture (surface_actor)),
+    &stream_point, &stage_point);
+
+  *x = stage_point.x;
+  *y = stage_point.y;
+}
+
+static void
+meta_screen_cast_window_stream_set_property (GObject      *object,
+                                             guint         prop_id,
+                                             const GValue *value,
+                                             GParamSpec   *pspec)
+{
+  MetaScreenCastWindowStream *window_stream =
+    META_SCREEN_CAST_WINDOW_STREAM (object);
+
+  switch (prop_id)
+    {
+    case PROP_WINDOW:
+      g_set_object (&window_stream->window, g_value_get_object (value));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+meta_screen_cast_window_stream_get_property (GObject    *object,
+                                             guint       prop_id,
+                                             GValue     *value,
+                                             GParamSpec *pspec)
+{
+  MetaScreenCastWindowStream *window_stream =
+    META_SCREEN_CAST_WINDOW_STREAM (object);
+
+  switch (prop_id)
+    {
+    case PROP_WINDOW:
+      g_value_set_object (value, window_stream->window);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+meta_screen_cast_window_stream_finalize (GObject *object)
+{
+  MetaScreenCastWindowStream *window_stream =
+    META_SCREEN_CAST_WINDOW_STREAM (object);
+
+  g_clear_object (&window_stream->window);
+
+  G_OBJECT_CLASS (meta_screen_cast_window_stream_parent_class)->finalize (object);
+}
+
+static void
+meta_screen_cast_window_stream_init (MetaScreenCastWindowStream *window_stream)
+{
+}
+
+static void
+meta_screen_cast_window_stream_class_init (MetaScreenCastWindowStreamClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  MetaScreenCastStreamClass *stream_class =
+    META_SCREEN_CAST_STREAM_CLASS (klass);
+
+  object_class->set_property = meta_screen_cast_window_stream_set_property;
+  object_class->get_property = meta_screen_cast_window_stream_get_property;
+  object_class->finalize = meta_screen_cast_window_stream_finalize;
+
+  stream_class->create_src = meta_screen_cast_window_stream_create_src;
+  stream_class->set_parameters = meta_screen_cast_window_stream_set_parameters;
+  stream_class->transform_position = meta_screen_cast_window_stream_transform_position;
+
+  g_object_class_install_property (object_class,
+                                   PROP_WINDOW,
+                                   g_param_spec_object ("window",
+                                                        "window",
+                                                        "MetaWindow",
+                                                        META_TYPE_WINDOW,
+                                                        G_PARAM_READWRITE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_STRINGS));
+}
@@ -44,6 +44,12 @@ struct _MetaStageNative
   int64_t presented_frame_counter_complete;
 };
 
+typedef struct _MetaStageNativeViewFrameData
+{
+  MetaStageNative *stage_native;
+  ClutterStageView *stage_view;
+} MetaStageNativeViewFrameData;
+
 static void
 clutter_stage_window_iface_init (ClutterStageWindowIface *iface);
 
@@ -59,7 +65,8 @@ frame_cb (CoglOnscreen  *onscreen,
           void          *user_data)
 
 {
-  MetaStageNative *stage_native = user_data;
+  MetaStageNativeViewFrameData *frame_data = user_data;
+  MetaStageNative *stage_native = frame_data->stage_native;
   ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_native);
   int64_t global_frame_counter;
   int64_t presented_frame_counter;
@@ -67,6 +74,18 @@ frame_cb (CoglOnscreen  *onscreen,
 
   global_frame_counter = cogl_frame_info_get_global_frame_counter (frame_info);
 
+  clutter_frame_info = (ClutterFrameInfo) {
+    .frame_counter = global_frame_counter,
+    .refresh_rate = cogl_frame_info_get_refresh_rate (frame_info),
+    .presentation_time = cogl_frame_info_get_presentation_time (frame_info)
+  };
+
+  /* Every view is scheduled from the events of its own CRTC... */
+  _clutter_stage_cogl_view_presented (stage_cogl, frame_data->stage_view,
+                                      frame_event, &clutter_frame_info);
+
+  /* ...but the stage is only told once about each frame */
+
   switch (frame_event)
     {
     case COGL_FRAME_EVENT_SYNC:
@@ -84,12 +103,6 @@ frame_cb (CoglOnscreen  *onscreen,
   if (global_frame_counter <= presented_frame_counter)
     return;
 
-  clutter_frame_info = (ClutterFrameInfo) {
-    .frame_counter = global_frame_counter,
-    .refresh_rate = cogl_frame_info_get_refresh_rate (frame_info),
-    .presentation_time = cogl_frame_info_get_presentation_time (frame_info)
-  };
-
   _clutter_stage_cogl_presented (stage_cogl, frame_event, &clutter_frame_info);
 }
 
@@ -100,18 +113,25 @@ ensure_frame_callback (MetaStageNative  *stage_native,
   CoglFramebuffer *framebuffer;
   CoglOnscreen *onscreen;
   CoglClosure *closure;
+  MetaStageNativeViewFrameData *frame_data;
 
   closure = g_object_get_qdata (G_OBJECT (stage_view),
                                 quark_view_frame_closure);
   if (closure)
     return;
 
+  /* The frame data is freed along with the closure when the onscreen
+   * of the view is destroyed */
+  frame_data = g_new0 (MetaStageNativeViewFrameData, 1);
+  frame_data->stage_native = stage_native;
+  frame_data->stage_view = stage_view;
+
   framebuffer = clutter_stage_view_get_onscreen (stage_view);
   onscreen = COGL_ONSCREEN (framebuffer);
   closure = cogl_onscreen_add_frame_callback (onscreen,
                                               frame_cb,
-                                              stage_native,
-                                              NULL);
+                                              frame_data,
+                                              g_free);
   g_object_set_qdata (G_OBJECT (stage_view),
                       quark_view_frame_closure,
                       closure);
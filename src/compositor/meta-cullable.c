@@ -46,6 +46,37 @@ G_DEFINE_INTERFACE (MetaCullable, meta_cullable, CLUTTER_TYPE_ACTOR);
  * so that actors underneath know not to draw there as well.
  */
 
+static gboolean
+child_needs_culling (ClutterActor *child)
+{
+  if (!CLUTTER_ACTOR_IS_VISIBLE (child))
+    return FALSE;
+
+  /* If an actor has effects applied, then that can change the area
+   * it paints and the opacity, so we no longer can figure out what
+   * portion of the actor is obscured and what portion of the screen
+   * it obscures, so we skip the actor.
+   *
+   * This has a secondary beneficial effect: if a ClutterOffscreenEffect
+   * is applied to an actor, then our clipped redraws interfere with the
+   * caching of the FBO - even if we only need to draw a small portion
+   * of the window right now, ClutterOffscreenEffect may use other portions
+   * of the FBO later. So, skipping actors with effects applied also
+   * prevents these bugs.
+   *
+   * Theoretically, we should check clutter_actor_get_offscreen_redirect()
+   * as well for the same reason, but omitted for simplicity in the
+   * hopes that no-one will do that.
+   */
+  if (clutter_actor_has_effects (child))
+    return FALSE;
+
+  if (!meta_actor_is_untransformed (child, NULL, NULL))
+    return FALSE;
+
+  return TRUE;
+}
+
 /**
  * meta_cullable_cull_out_children:
  * @cullable: The #MetaCullable
@@ -70,49 +101,23 @@ meta_cullable_cull_out_children (MetaCullable   *cullable,
   while (clutter_actor_iter_prev (&iter, &child))
     {
       float x, y;
-      gboolean needs_culling;
 
       if (!META_IS_CULLABLE (child))
         continue;
 
-      needs_culling = (unobscured_region != NULL && clip_region != NULL);
-
-      if (needs_culling && !CLUTTER_ACTOR_IS_VISIBLE (child))
-        needs_culling = FALSE;
-
-      /* If an actor has effects applied, then that can change the area
-       * it paints and the opacity, so we no longer can figure out what
-       * portion of the actor is obscured and what portion of the screen
-       * it obscures, so we skip the actor.
-       *
-       * This has a secondary beneficial effect: if a ClutterOffscreenEffect
-       * is applied to an actor, then our clipped redraws interfere with the
-       * caching of the FBO - even if we only need to draw a small portion
-       * of the window right now, ClutterOffscreenEffect may use other portions
-       * of the FBO later. So, skipping actors with effects applied also
-       * prevents these bugs.
-       *
-       * Theoretically, we should check clutter_actor_get_offscreen_redirect()
-       * as well for the same reason, but omitted for simplicity in the
-       * hopes that no-one will do that.
-       */
-      if (needs_culling && clutter_actor_has_effects (child))
-        needs_culling = FALSE;
-
-      if (needs_culling && !meta_actor_is_untransformed (child, NULL, NULL))
-        needs_culling = FALSE;
-
-      if (needs_culling)
+      if (clip_region != NULL && child_needs_culling (child))
         {
           clutter_actor_get_position (child, &x, &y);
 
           /* Temporarily move to the coordinate system of the actor */
-          cairo_region_translate (unobscured_region, - x, - y);
+          if (unobscured_region)
+            cairo_region_translate (unobscured_region, - x, - y);
           cairo_region_translate (clip_region, - x, - y);
 
           meta_cullable_cull_out (META_CULLABLE (child), unobscured_region, clip_region);
 
-          cairo_region_translate (unobscured_region, x, y);
+          if (unobscured_region)
+            cairo_region_translate (unobscured_region, x, y);
           cairo_region_translate (clip_region, x, y);
         }
       else
@@ -176,6 +181,15 @@ meta_cullable_default_init (MetaCullableInterface *iface)
  *
  * Actors that have children can also use the meta_cullable_cull_out_children()
  * helper method to do a simple cull across all their children.
+ *
+ * Computing @unobscured_region means subtracting the opaque parts of
+ * every actor above, which gets expensive with many stacked windows, and
+ * usually nothing changed since the last frame. When the inputs reported
+ * by meta_cullable_append_culling_inputs() are unchanged, #MetaWindowGroup
+ * passes %NULL for @unobscured_region and a non-%NULL @clip_region.
+ * Actors should then keep the unobscured region they recorded in the
+ * last cull and only subtract from @clip_region. If both are %NULL, the
+ * actor is not being culled at all.
  */
 void
 meta_cullable_cull_out (MetaCullable   *cullable,
@@ -199,3 +213,54 @@ meta_cullable_reset_culling (MetaCullable *cullable)
 {
   META_CULLABLE_GET_IFACE (cullable)->reset_culling (cullable);
 }
+
+/**
+ * meta_cullable_append_culling_inputs:
+ * @cullable: The #MetaCullable
+ * @inputs: the array to append to
+ *
+ * Appends everything that decides what meta_cullable_cull_out() subtracts
+ * from the unobscured region below @cullable: the stacking and position
+ * of its cullable descendants, which of them can be culled at all, and
+ * whatever implementations add in their append_culling_inputs() vfunc,
+ * like their opaque region. If two walks append the same bytes, the
+ * unobscured regions recorded in the last full cull still hold.
+ */
+void
+meta_cullable_append_culling_inputs (MetaCullable *cullable,
+                                     GByteArray   *inputs)
+{
+  MetaCullableInterface *iface = META_CULLABLE_GET_IFACE (cullable);
+  ClutterActor *actor = CLUTTER_ACTOR (cullable);
+  ClutterActor *child;
+  ClutterActorIter iter;
+
+  if (iface->append_culling_inputs)
+    iface->append_culling_inputs (cullable, inputs);
+
+  clutter_actor_iter_init (&iter, actor);
+  while (clutter_actor_iter_prev (&iter, &child))
+    {
+      gboolean needs_culling;
+      float x, y;
+
+      if (!META_IS_CULLABLE (child))
+        continue;
+
+      needs_culling = child_needs_culling (child);
+
+      g_byte_array_append (inputs, (const guint8 *) &child, sizeof (child));
+      g_byte_array_append (inputs, (const guint8 *) &needs_culling,
+                           sizeof (needs_culling));
+
+      /* Children that are not culled get no regions at all */
+      if (!needs_culling)
+        continue;
+
+      clutter_actor_get_position (child, &x, &y);
+      g_byte_array_append (inputs, (const guint8 *) &x, sizeof (x));
+      g_byte_array_append (inputs, (const guint8 *) &y, sizeof (y));
+
+      meta_cullable_append_culling_inputs (META_CULLABLE (child), inputs);
+    }
+}
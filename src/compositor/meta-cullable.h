@@ -45,6 +45,9 @@ struct _MetaCullableInterface
                           cairo_region_t *unobscured_region,
                           cairo_region_t *clip_region);
   void (* reset_culling) (MetaCullable  *cullable);
+
+  void (* append_culling_inputs) (MetaCullable *cullable,
+                                  GByteArray   *inputs);
 };
 
 GType meta_cullable_get_type (void);
@@ -53,6 +56,8 @@ void meta_cullable_cull_out (MetaCullable   *cullable,
                              cairo_region_t *unobscured_region,
                              cairo_region_t *clip_region);
 void meta_cullable_reset_culling (MetaCullable *cullable);
+void meta_cullable_append_culling_inputs (MetaCullable *cullable,
+                                          GByteArray   *inputs);
 
 /* Utility methods for implementations */
 void meta_cullable_cull_out_children (MetaCullable   *cullable,
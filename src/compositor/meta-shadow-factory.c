@@ -30,6 +30,7 @@
 #include <meta/util.h>
 
 #include "cogl-utils.h"
+#include "meta-shadow-factory-private.h"
 #include "region-utils.h"
 
 /* This file implements blurring the shape of a window to produce a
@@ -479,8 +480,8 @@ meta_shadow_factory_get_default (void)
  *
  * http://www.w3.org/TR/SVG/filters.html#feGaussianBlurElement
  *
- * The 2D blur is then done by blurring the rows, flipping the
- * image and blurring the columns. (This is possible because the
+ * The 2D blur is then done by blurring the columns and then the
+ * rows. (This is possible because the
  * Gaussian kernel is separable - it's the product of a horizontal
  * blur and a vertical blur.)
  */
@@ -511,6 +512,34 @@ get_shadow_spread (int radius)
     return 3 * (d / 2) - 1;
 }
 
+/* The box blur divides a window sum by the filter width for every pixel
+ * of every pass; an integer division is by far the slowest part of that,
+ * so divide by multiplying with a fixed point reciprocal instead. For sums
+ * below 2^16 this gives the same results as the division.
+ */
+static guint32
+get_reciprocal (int d)
+{
+  return (guint32) ((G_GUINT64_CONSTANT (1) << 32) / d + 1);
+}
+
+static inline guchar
+divide_sum (guint32 sum,
+            guint32 reciprocal)
+{
+  return ((guint64) sum * reciprocal) >> 32;
+}
+
+static int
+get_span_offset (int d,
+                 int shift)
+{
+  if (d % 2 == 1)
+    return d / 2;
+  else
+    return (d - shift) / 2;
+}
+
 /* This applies a single box blur pass to a horizontal range of pixels;
  * since the box blur has the same weight for all pixels, we can
  * implement an efficient sliding window algorithm where we add
@@ -530,23 +559,15 @@ blur_xspan (guchar *row,
             int     d,
             int     shift)
 {
-  int offset;
+  int offset = get_span_offset (d, shift);
+  guint32 reciprocal = get_reciprocal (d);
   int sum = 0;
   int i;
 
-  if (d % 2 == 1)
-    offset = d / 2;
-  else
-    offset = (d - shift) / 2;
-
   /* All the conditionals in here look slow, but the branches will
    * be well predicted and there are enough different possibilities
    * that trying to write this as a series of unconditional loops
-   * is hard and not an obvious win. The main slow down here seems
-   * to be the integer division per pixel; one possible optimization
-   * would be to accumulate into two 16-bit integer buffers and
-   * only divide down after all three passes. (SSE parallel implementation
-   * of the divide step is possible.)
+   * is hard and not an obvious win.
    */
   for (i = x0 - d + offset; i < x1 + offset; i++)
     {
@@ -558,7 +579,7 @@ blur_xspan (guchar *row,
           if (i >= d)
             sum -= row[i - d];
 
-          tmp_buffer[i - offset] = (sum + d / 2) / d;
+          tmp_buffer[i - offset] = divide_sum (sum + d / 2, reciprocal);
         }
     }
 
@@ -617,108 +638,433 @@ blur_rows (cairo_region_t   *convolve_region,
   g_free (tmp_buffer);
 }
 
+/* The vertical passes apply the same sliding window as blur_xspan() down
+ * the columns x0 to x1 of the buffer, but walk the rows in order so that
+ * neighbouring columns are blurred together. This replaces transposing
+ * the buffer before and after blurring, and lets the columns be blurred
+ * in parallel with SIMD instructions. The result for rows y0 to y1 is
+ * written to tmp_buffer, which has a row stride of tmp_stride.
+ */
 static void
-fade_bytes (guchar *bytes,
-            int     width,
-            int     distance,
-            int     total)
+blur_yspan_generic (const guchar *buffer,
+                    int           buffer_width,
+                    int           buffer_height,
+                    int           x0,
+                    int           x1,
+                    int           y0,
+                    int           y1,
+                    int           d,
+                    int           shift,
+                    guint32      *sums,
+                    guchar       *tmp_buffer,
+                    int           tmp_stride)
 {
-  guint32 multiplier = (distance * 0x10000 + 0x8000) / total;
-  int i;
+  int offset = get_span_offset (d, shift);
+  guint32 reciprocal = get_reciprocal (d);
+  int width = x1 - x0;
+  int i, x;
 
-  for (i = 0; i < width; i++)
-    bytes[i] = (bytes[i] * multiplier) >> 16;
+  memset (sums, 0, width * sizeof (*sums));
+
+  for (i = y0 - d + offset; i < y1 + offset; i++)
+    {
+      if (i >= 0 && i < buffer_height)
+        {
+          const guchar *row = buffer + i * buffer_width + x0;
+
+          for (x = 0; x < width; x++)
+            sums[x] += row[x];
+        }
+
+      if (i >= y0 + offset)
+        {
+          guchar *out = tmp_buffer + (i - offset - y0) * tmp_stride;
+
+          if (i >= d)
+            {
+              const guchar *row = buffer + (i - d) * buffer_width + x0;
+
+              for (x = 0; x < width; x++)
+                sums[x] -= row[x];
+            }
+
+          for (x = 0; x < width; x++)
+            out[x] = divide_sum (sums[x] + d / 2, reciprocal);
+        }
+    }
 }
 
-/* Swaps width and height. Either swaps in-place and returns the original
- * buffer or allocates a new buffer, frees the original buffer and returns
- * the new buffer.
+/* The SIMD versions keep the sums for 16 or 32 columns in 16 bit lanes,
+ * which holds as long as d * 255 + d / 2 fits. The division uses the
+ * truncated 16 bit reciprocal, which is at most one too small, and then
+ * corrects the quotient by comparing the remainder with d.
  */
-static guchar *
-flip_buffer (guchar *buffer,
-             int     width,
-             int     height)
+#define MAX_SIMD_FILTER_SIZE 256
+
+#if defined(__SSE2__) && defined(__GNUC__) \
+  && (defined(__x86_64) || defined(__i386))
+#define META_SHADOW_USE_SSE2
+#include <emmintrin.h>
+
+#if (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)) || defined(__clang__)
+#define META_SHADOW_USE_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+#ifdef META_SHADOW_USE_SSE2
+static inline __m128i
+divide_sums_sse2 (__m128i sums,
+                  __m128i half,
+                  __m128i reciprocal,
+                  __m128i divisor,
+                  __m128i max_remainder)
 {
-  /* Working in blocks increases cache efficiency, compared to reading
-   * or writing an entire column at once */
-#define BLOCK_SIZE 16
+  __m128i quotient;
+  __m128i remainder;
+
+  sums = _mm_add_epi16 (sums, half);
+  quotient = _mm_mulhi_epu16 (sums, reciprocal);
+  remainder = _mm_sub_epi16 (sums, _mm_mullo_epi16 (quotient, divisor));
 
-  if (width == height)
+  return _mm_sub_epi16 (quotient, _mm_cmpgt_epi16 (remainder, max_remainder));
+}
+
+static int
+blur_yspan_sse2 (const guchar *buffer,
+                 int           buffer_width,
+                 int           buffer_height,
+                 int           x0,
+                 int           x1,
+                 int           y0,
+                 int           y1,
+                 int           d,
+                 int           shift,
+                 guchar       *tmp_buffer,
+                 int           tmp_stride)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i half = _mm_set1_epi16 (d / 2);
+  const __m128i reciprocal = _mm_set1_epi16 ((guint16) (0x10000 / d));
+  const __m128i divisor = _mm_set1_epi16 (d);
+  const __m128i max_remainder = _mm_set1_epi16 (d - 1);
+  int offset = get_span_offset (d, shift);
+  int i, x;
+
+  for (x = x0; x + 16 <= x1; x += 16)
     {
-      int i0, j0;
-
-      for (j0 = 0; j0 < height; j0 += BLOCK_SIZE)
-        for (i0 = 0; i0 <= j0; i0 += BLOCK_SIZE)
-          {
-            int max_j = MIN(j0 + BLOCK_SIZE, height);
-            int max_i = MIN(i0 + BLOCK_SIZE, width);
-            int i, j;
-
-            if (i0 == j0)
-              {
-                for (j = j0; j < max_j; j++)
-                  for (i = i0; i < j; i++)
-                    {
-                      guchar tmp = buffer[j * width + i];
-                      buffer[j * width + i] = buffer[i * width + j];
-                      buffer[i * width + j] = tmp;
-                    }
-              }
-            else
-              {
-                for (j = j0; j < max_j; j++)
-                  for (i = i0; i < max_i; i++)
-                    {
-                      guchar tmp = buffer[j * width + i];
-                      buffer[j * width + i] = buffer[i * width + j];
-                      buffer[i * width + j] = tmp;
-                    }
-              }
-          }
-
-      return buffer;
+      __m128i sums_lo = zero;
+      __m128i sums_hi = zero;
+
+      for (i = y0 - d + offset; i < y1 + offset; i++)
+        {
+          if (i >= 0 && i < buffer_height)
+            {
+              __m128i pixels =
+                _mm_loadu_si128 ((const __m128i *) (buffer + i * buffer_width + x));
+
+              sums_lo = _mm_add_epi16 (sums_lo, _mm_unpacklo_epi8 (pixels, zero));
+              sums_hi = _mm_add_epi16 (sums_hi, _mm_unpackhi_epi8 (pixels, zero));
+            }
+
+          if (i >= y0 + offset)
+            {
+              guchar *out = tmp_buffer + (i - offset - y0) * tmp_stride + (x - x0);
+              __m128i quotient_lo;
+              __m128i quotient_hi;
+
+              if (i >= d)
+                {
+                  __m128i pixels =
+                    _mm_loadu_si128 ((const __m128i *) (buffer + (i - d) * buffer_width + x));
+
+                  sums_lo = _mm_sub_epi16 (sums_lo, _mm_unpacklo_epi8 (pixels, zero));
+                  sums_hi = _mm_sub_epi16 (sums_hi, _mm_unpackhi_epi8 (pixels, zero));
+                }
+
+              quotient_lo = divide_sums_sse2 (sums_lo, half, reciprocal,
+                                              divisor, max_remainder);
+              quotient_hi = divide_sums_sse2 (sums_hi, half, reciprocal,
+                                              divisor, max_remainder);
+              _mm_storeu_si128 ((__m128i *) out,
+                                _mm_packus_epi16 (quotient_lo, quotient_hi));
+            }
+        }
     }
-  else
+
+  return x;
+}
+#endif /* META_SHADOW_USE_SSE2 */
+
+#ifdef META_SHADOW_USE_AVX2
+__attribute__ ((target ("avx2")))
+static inline __m256i
+divide_sums_avx2 (__m256i sums,
+                  __m256i half,
+                  __m256i reciprocal,
+                  __m256i divisor,
+                  __m256i max_remainder)
+{
+  __m256i quotient;
+  __m256i remainder;
+
+  sums = _mm256_add_epi16 (sums, half);
+  quotient = _mm256_mulhi_epu16 (sums, reciprocal);
+  remainder = _mm256_sub_epi16 (sums, _mm256_mullo_epi16 (quotient, divisor));
+
+  return _mm256_sub_epi16 (quotient,
+                           _mm256_cmpgt_epi16 (remainder, max_remainder));
+}
+
+/* The unpacking and packing below both work within 128 bit lanes, so the
+ * columns come back out in the order they were loaded. */
+__attribute__ ((target ("avx2")))
+static int
+blur_yspan_avx2 (const guchar *buffer,
+                 int           buffer_width,
+                 int           buffer_height,
+                 int           x0,
+                 int           x1,
+                 int           y0,
+                 int           y1,
+                 int           d,
+                 int           shift,
+                 guchar       *tmp_buffer,
+                 int           tmp_stride)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+  const __m256i half = _mm256_set1_epi16 (d / 2);
+  const __m256i reciprocal = _mm256_set1_epi16 ((guint16) (0x10000 / d));
+  const __m256i divisor = _mm256_set1_epi16 (d);
+  const __m256i max_remainder = _mm256_set1_epi16 (d - 1);
+  int offset = get_span_offset (d, shift);
+  int i, x;
+
+  for (x = x0; x + 32 <= x1; x += 32)
     {
-      guchar *new_buffer = g_malloc (height * width);
-      int i0, j0;
+      __m256i sums_lo = zero;
+      __m256i sums_hi = zero;
 
-      for (i0 = 0; i0 < width; i0 += BLOCK_SIZE)
-        for (j0 = 0; j0 < height; j0 += BLOCK_SIZE)
-          {
-            int max_j = MIN(j0 + BLOCK_SIZE, height);
-            int max_i = MIN(i0 + BLOCK_SIZE, width);
-            int i, j;
+      for (i = y0 - d + offset; i < y1 + offset; i++)
+        {
+          if (i >= 0 && i < buffer_height)
+            {
+              __m256i pixels =
+                _mm256_loadu_si256 ((const __m256i *) (buffer + i * buffer_width + x));
+
+              sums_lo = _mm256_add_epi16 (sums_lo, _mm256_unpacklo_epi8 (pixels, zero));
+              sums_hi = _mm256_add_epi16 (sums_hi, _mm256_unpackhi_epi8 (pixels, zero));
+            }
 
-            for (i = i0; i < max_i; i++)
-              for (j = j0; j < max_j; j++)
-                new_buffer[i * height + j] = buffer[j * width + i];
-          }
+          if (i >= y0 + offset)
+            {
+              guchar *out = tmp_buffer + (i - offset - y0) * tmp_stride + (x - x0);
+              __m256i quotient_lo;
+              __m256i quotient_hi;
 
-      g_free (buffer);
+              if (i >= d)
+                {
+                  __m256i pixels =
+                    _mm256_loadu_si256 ((const __m256i *) (buffer + (i - d) * buffer_width + x));
 
-      return new_buffer;
+                  sums_lo = _mm256_sub_epi16 (sums_lo, _mm256_unpacklo_epi8 (pixels, zero));
+                  sums_hi = _mm256_sub_epi16 (sums_hi, _mm256_unpackhi_epi8 (pixels, zero));
+                }
+
+              quotient_lo = divide_sums_avx2 (sums_lo, half, reciprocal,
+                                              divisor, max_remainder);
+              quotient_hi = divide_sums_avx2 (sums_hi, half, reciprocal,
+                                              divisor, max_remainder);
+              _mm256_storeu_si256 ((__m256i *) out,
+                                   _mm256_packus_epi16 (quotient_lo, quotient_hi));
+            }
+        }
     }
-#undef BLOCK_SIZE
+
+  return x;
+}
+#endif /* META_SHADOW_USE_AVX2 */
+
+typedef enum
+{
+  BLUR_KERNELS_GENERIC,
+  BLUR_KERNELS_SSE2,
+  BLUR_KERNELS_AVX2,
+} BlurKernels;
+
+static BlurKernels
+get_blur_kernels (void)
+{
+  static BlurKernels kernels;
+  static gsize initialized = 0;
+
+  if (g_once_init_enter (&initialized))
+    {
+      kernels = BLUR_KERNELS_GENERIC;
+
+      if (!g_getenv ("MUTTER_DEBUG_DISABLE_SIMD_SHADOWS"))
+        {
+#ifdef META_SHADOW_USE_SSE2
+          kernels = BLUR_KERNELS_SSE2;
+#endif
+#ifdef META_SHADOW_USE_AVX2
+          __builtin_cpu_init ();
+          if (__builtin_cpu_supports ("avx2"))
+            kernels = BLUR_KERNELS_AVX2;
+#endif
+        }
+
+      g_once_init_leave (&initialized, 1);
+    }
+
+  return kernels;
 }
 
 static void
-make_shadow (MetaShadow     *shadow,
-             cairo_region_t *region)
+blur_yspan (guchar      *buffer,
+            int          buffer_width,
+            int          buffer_height,
+            int          x0,
+            int          x1,
+            int          y0,
+            int          y1,
+            int          d,
+            int          shift,
+            BlurKernels  kernels,
+            guint32     *sums,
+            guchar      *tmp_buffer)
 {
-  ClutterBackend *backend = clutter_get_default_backend ();
-  CoglContext *ctx = clutter_backend_get_cogl_context (backend);
-  CoglError *error = NULL;
-  int d = get_box_filter_size (shadow->key.radius);
-  int spread = get_shadow_spread (shadow->key.radius);
+  int tmp_stride = x1 - x0;
+  int x = x0;
+  int i;
+
+  if (d <= MAX_SIMD_FILTER_SIZE)
+    {
+      switch (kernels)
+        {
+        case BLUR_KERNELS_AVX2:
+#ifdef META_SHADOW_USE_AVX2
+          x = blur_yspan_avx2 (buffer, buffer_width, buffer_height,
+                               x, x1, y0, y1, d, shift,
+                               tmp_buffer + (x - x0), tmp_stride);
+#endif
+          /* fall through */
+        case BLUR_KERNELS_SSE2:
+#ifdef META_SHADOW_USE_SSE2
+          x = blur_yspan_sse2 (buffer, buffer_width, buffer_height,
+                               x, x1, y0, y1, d, shift,
+                               tmp_buffer + (x - x0), tmp_stride);
+#endif
+          break;
+        case BLUR_KERNELS_GENERIC:
+          break;
+        }
+    }
+
+  if (x < x1)
+    blur_yspan_generic (buffer, buffer_width, buffer_height,
+                        x, x1, y0, y1, d, shift, sums,
+                        tmp_buffer + (x - x0), tmp_stride);
+
+  for (i = y0; i < y1; i++)
+    memcpy (buffer + i * buffer_width + x0,
+            tmp_buffer + (i - y0) * tmp_stride,
+            tmp_stride);
+}
+
+/* The rectangles of convolve_region have x and y swapped, as for a
+ * flipped buffer; see meta_make_border_region().
+ */
+static void
+blur_columns (cairo_region_t *convolve_region,
+              int             x_offset,
+              int             y_offset,
+              guchar         *buffer,
+              int             buffer_width,
+              int             buffer_height,
+              int             d,
+              BlurKernels     kernels)
+{
+  int i;
+  int n_rectangles;
+  guint32 *sums;
+  guchar *tmp_buffer;
+
+  sums = g_new (guint32, buffer_width);
+  tmp_buffer = g_malloc (buffer_width * buffer_height);
+
+  n_rectangles = cairo_region_num_rectangles (convolve_region);
+  for (i = 0; i < n_rectangles; i++)
+    {
+      cairo_rectangle_int_t rect;
+      int x0, x1, y0, y1;
+
+      cairo_region_get_rectangle (convolve_region, i, &rect);
+
+      x0 = x_offset + rect.y;
+      x1 = x0 + rect.height;
+      y0 = y_offset + rect.x;
+      y1 = y0 + rect.width;
+
+      /* See blur_rows() */
+      if (d % 2 == 1)
+        {
+          blur_yspan (buffer, buffer_width, buffer_height,
+                      x0, x1, y0, y1, d, 0, kernels,
+                      sums, tmp_buffer);
+          blur_yspan (buffer, buffer_width, buffer_height,
+                      x0, x1, y0, y1, d, 0, kernels,
+                      sums, tmp_buffer);
+          blur_yspan (buffer, buffer_width, buffer_height,
+                      x0, x1, y0, y1, d, 0, kernels,
+                      sums, tmp_buffer);
+        }
+      else
+        {
+          blur_yspan (buffer, buffer_width, buffer_height,
+                      x0, x1, y0, y1, d, 1, kernels,
+                      sums, tmp_buffer);
+          blur_yspan (buffer, buffer_width, buffer_height,
+                      x0, x1, y0, y1, d, -1, kernels,
+                      sums, tmp_buffer);
+          blur_yspan (buffer, buffer_width, buffer_height,
+                      x0, x1, y0, y1, d + 1, 0, kernels,
+                      sums, tmp_buffer);
+        }
+    }
+
+  g_free (tmp_buffer);
+  g_free (sums);
+}
+
+static void
+fade_bytes (guchar *bytes,
+            int     width,
+            int     distance,
+            int     total)
+{
+  guint32 multiplier = (distance * 0x10000 + 0x8000) / total;
+  int i;
+
+  for (i = 0; i < width; i++)
+    bytes[i] = (bytes[i] * multiplier) >> 16;
+}
+
+static guchar *
+blur_region (cairo_region_t *region,
+             int             radius,
+             BlurKernels     kernels,
+             int            *buffer_width,
+             int            *buffer_height)
+{
+  int d = get_box_filter_size (radius);
+  int spread = get_shadow_spread (radius);
   cairo_rectangle_int_t extents;
   cairo_region_t *row_convolve_region;
   cairo_region_t *column_convolve_region;
   guchar *buffer;
-  int buffer_width;
-  int buffer_height;
-  int x_offset;
-  int y_offset;
+  int width;
+  int height;
   int n_rectangles, j, k;
 
   cairo_region_get_extents (region, &extents);
@@ -732,22 +1078,13 @@ make_shadow (MetaShadow     *shadow,
    * and only crop when creating the CoglTexture.
    */
 
-  buffer_width = extents.width + 2 * spread;
-  buffer_height = extents.height + 2 * spread;
+  width = extents.width + 2 * spread;
+  height = extents.height + 2 * spread;
 
-  /* Round up so we have aligned rows/columns */
-  buffer_width = (buffer_width + 3) & ~3;
-  buffer_height = (buffer_height + 3) & ~3;
-
-  /* Square buffer allows in-place swaps, which are roughly 70% faster, but we
-   * don't want to over-allocate too much memory.
-   */
-  if (buffer_height < buffer_width && buffer_height > (3 * buffer_width) / 4)
-    buffer_height = buffer_width;
-  if (buffer_width < buffer_height && buffer_width > (3 * buffer_height) / 4)
-    buffer_width = buffer_height;
+  /* Round up so we have aligned rows */
+  width = (width + 3) & ~3;
 
-  buffer = g_malloc0 (buffer_width * buffer_height);
+  buffer = g_malloc0 (width * height);
 
   /* Blurring with multiple box-blur passes is fast, but (especially for
    * large shadow sizes) we can improve efficiency by restricting the blur
@@ -756,10 +1093,6 @@ make_shadow (MetaShadow     *shadow,
   row_convolve_region = meta_make_border_region (region, spread, spread, FALSE);
   column_convolve_region = meta_make_border_region (region, 0, spread, TRUE);
 
-  /* Offsets between coordinates of the regions and coordinates in the buffer */
-  x_offset = spread;
-  y_offset = spread;
-
   /* Step 1: unblurred image */
   n_rectangles = cairo_region_num_rectangles (region);
   for (k = 0; k < n_rectangles; k++)
@@ -767,27 +1100,102 @@ make_shadow (MetaShadow     *shadow,
       cairo_rectangle_int_t rect;
 
       cairo_region_get_rectangle (region, k, &rect);
-      for (j = y_offset + rect.y; j < y_offset + rect.y + rect.height; j++)
-        memset (buffer + buffer_width * j + x_offset + rect.x, 255, rect.width);
+      for (j = spread + rect.y; j < spread + rect.y + rect.height; j++)
+        memset (buffer + width * j + spread + rect.x, 255, rect.width);
     }
 
-  /* Step 2: swap rows and columns */
-  buffer = flip_buffer (buffer, buffer_width, buffer_height);
+  /* Step 2: blur columns */
+  if (d > 0)
+    blur_columns (column_convolve_region, spread, spread,
+                  buffer, width, height,
+                  d, kernels);
+
+  /* Step 3: blur rows */
+  if (d > 0)
+    blur_rows (row_convolve_region, spread, spread,
+               buffer, width, height,
+               d);
+
+  cairo_region_destroy (row_convolve_region);
+  cairo_region_destroy (column_convolve_region);
 
-  /* Step 3: blur rows (really columns) */
-  blur_rows (column_convolve_region, y_offset, x_offset,
-             buffer, buffer_height, buffer_width,
-             d);
+  *buffer_width = width;
+  *buffer_height = height;
 
-  /* Step 4: swap rows and columns */
-  buffer = flip_buffer (buffer, buffer_height, buffer_width);
+  return buffer;
+}
 
-  /* Step 5: blur rows */
-  blur_rows (row_convolve_region, x_offset, y_offset,
-             buffer, buffer_width, buffer_height,
-             d);
+/**
+ * meta_shadow_blur_region: (skip)
+ * @region: the shape to blur
+ * @radius: the blur radius
+ * @buffer_width: (out): return location for the width of the buffer
+ * @buffer_height: (out): return location for the height of the buffer
+ *
+ * Renders @region into an 8 bit alpha buffer, with the origin of the region
+ * at (spread, spread), and blurs it with the approximated Gaussian blur used
+ * for shadows.
+ *
+ * Return value: (transfer full): the buffer, free with g_free()
+ */
+guchar *
+meta_shadow_blur_region (cairo_region_t *region,
+                         int             radius,
+                         int            *buffer_width,
+                         int            *buffer_height)
+{
+  return blur_region (region, radius, get_blur_kernels (),
+                      buffer_width, buffer_height);
+}
 
-  /* Step 6: fade out the top, if applicable */
+/**
+ * meta_shadow_blur_region_generic: (skip)
+ * @region: the shape to blur
+ * @radius: the blur radius
+ * @buffer_width: (out): return location for the width of the buffer
+ * @buffer_height: (out): return location for the height of the buffer
+ *
+ * Like meta_shadow_blur_region(), but never uses the SIMD kernels; their
+ * output must be the same.
+ *
+ * Return value: (transfer full): the buffer, free with g_free()
+ */
+guchar *
+meta_shadow_blur_region_generic (cairo_region_t *region,
+                                 int             radius,
+                                 int            *buffer_width,
+                                 int            *buffer_height)
+{
+  return blur_region (region, radius, BLUR_KERNELS_GENERIC,
+                      buffer_width, buffer_height);
+}
+
+static void
+make_shadow (MetaShadow     *shadow,
+             cairo_region_t *region)
+{
+  ClutterBackend *backend = clutter_get_default_backend ();
+  CoglContext *ctx = clutter_backend_get_cogl_context (backend);
+  CoglError *error = NULL;
+  int spread = get_shadow_spread (shadow->key.radius);
+  cairo_rectangle_int_t extents;
+  guchar *buffer;
+  int buffer_width;
+  int buffer_height;
+  int x_offset;
+  int y_offset;
+  int j;
+
+  cairo_region_get_extents (region, &extents);
+
+  buffer = meta_shadow_blur_region (region, shadow->key.radius,
+                                    &buffer_width, &buffer_height);
+
+  /* Offsets between coordinates of the regions and coordinates in the buffer */
+  x_offset = spread;
+  y_offset = spread;
+
+  /* Fade out the top, if applicable */
   if (shadow->key.top_fade >= 0)
     {
       for (j = y_offset; j < y_offset + MIN (shadow->key.top_fade, extents.height + shadow->outer_border_bottom); j++)
@@ -814,8 +1222,6 @@ make_shadow (MetaShadow     *shadow,
       cogl_error_free (error);
     }
 
-  cairo_region_destroy (row_convolve_region);
-  cairo_region_destroy (column_convolve_region);
   g_free (buffer);
 
   shadow->pipeline = meta_create_texture_pipeline (shadow->texture);
@@ -41,5 +41,7 @@ void meta_shaped_texture_set_fallback_size (MetaShapedTexture *stex,
                                             guint              fallback_height);
 gboolean meta_shaped_texture_is_obscured (MetaShapedTexture *self);
 cairo_region_t * meta_shaped_texture_get_opaque_region (MetaShapedTexture *stex);
+void meta_shaped_texture_paint_to_framebuffer (MetaShapedTexture *stex,
+                                               CoglFramebuffer   *framebuffer);
 
 #endif
@@ -82,6 +82,7 @@ struct _MetaShapedTexturePrivate
   CoglPipeline *base_pipeline;
   CoglPipeline *masked_pipeline;
   CoglPipeline *unblended_pipeline;
+  CoglPipeline *unblended_masked_pipeline;
 
   gboolean is_y_inverted;
 
@@ -183,6 +184,7 @@ meta_shaped_texture_reset_pipelines (MetaShapedTexture *stex)
   g_clear_pointer (&priv->base_pipeline, cogl_object_unref);
   g_clear_pointer (&priv->masked_pipeline, cogl_object_unref);
   g_clear_pointer (&priv->unblended_pipeline, cogl_object_unref);
+  g_clear_pointer (&priv->unblended_masked_pipeline, cogl_object_unref);
 }
 
 static void
@@ -296,6 +298,26 @@ get_unblended_pipeline (MetaShapedTexture *stex,
   return pipeline;
 }
 
+static CoglPipeline *
+get_unblended_masked_pipeline (MetaShapedTexture *stex,
+                               CoglContext       *ctx)
+{
+  MetaShapedTexturePrivate *priv = stex->priv;
+  CoglPipeline *pipeline;
+
+  if (priv->unblended_masked_pipeline)
+    return priv->unblended_masked_pipeline;
+
+  pipeline = cogl_pipeline_copy (get_masked_pipeline (stex, ctx));
+  cogl_pipeline_set_blend (pipeline,
+                           "RGBA = ADD (SRC_COLOR, 0)",
+                           NULL);
+
+  priv->unblended_masked_pipeline = pipeline;
+
+  return pipeline;
+}
+
 static void
 paint_clipped_rectangle (CoglFramebuffer       *fb,
                          CoglPipeline          *pipeline,
@@ -986,6 +1008,79 @@ meta_shaped_texture_get_image (MetaShapedTexture     *stex,
   return surface;
 }
 
+/**
+ * meta_shaped_texture_paint_to_framebuffer: (skip)
+ * @stex: A #MetaShapedTexture
+ * @framebuffer: The #CoglFramebuffer to draw into
+ *
+ * Draws the texture, with the shape mask applied, unscaled to the top
+ * left corner of @framebuffer. Unlike painting the actor, this replaces
+ * the destination pixels including their alpha, and doesn't depend on
+ * the actor being mapped or unobscured. Buffers that aren't y-inverted
+ * are flipped, as when painting the actor.
+ */
+void
+meta_shaped_texture_paint_to_framebuffer (MetaShapedTexture *stex,
+                                          CoglFramebuffer   *framebuffer)
+{
+  MetaShapedTexturePrivate *priv = stex->priv;
+  CoglContext *ctx;
+  CoglPipeline *pipeline;
+  CoglColor color;
+  cairo_rectangle_int_t rect;
+  ClutterActorBox alloc;
+
+  if (priv->texture == NULL)
+    return;
+
+  if (priv->tex_width == 0 || priv->tex_height == 0)
+    return;
+
+  ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+
+  if (priv->mask_texture == NULL)
+    {
+      pipeline = get_unblended_pipeline (stex, ctx);
+    }
+  else
+    {
+      pipeline = get_unblended_masked_pipeline (stex, ctx);
+      cogl_pipeline_set_layer_texture (pipeline, 1, priv->mask_texture);
+      cogl_pipeline_set_layer_filters (pipeline, 1,
+                                       COGL_PIPELINE_FILTER_NEAREST,
+                                       COGL_PIPELINE_FILTER_NEAREST);
+    }
+
+  cogl_pipeline_set_layer_texture (pipeline, 0, priv->texture);
+  cogl_pipeline_set_layer_filters (pipeline, 0,
+                                   COGL_PIPELINE_FILTER_NEAREST,
+                                   COGL_PIPELINE_FILTER_NEAREST);
+
+  cogl_color_init_from_4ub (&color, 255, 255, 255, 255);
+  cogl_pipeline_set_color (pipeline, &color);
+
+  cogl_framebuffer_push_matrix (framebuffer);
+  cogl_framebuffer_identity_matrix (framebuffer);
+  cogl_framebuffer_orthographic (framebuffer,
+                                 0, 0,
+                                 cogl_framebuffer_get_width (framebuffer),
+                                 cogl_framebuffer_get_height (framebuffer),
+                                 -1, 1);
+  /* Use the same texture coordinates for both layers as the actor paint,
+   * so that the base pipeline's layer matrix flips the texture but not
+   * the mask. */
+  rect = (cairo_rectangle_int_t) {
+    .width = priv->tex_width,
+    .height = priv->tex_height,
+  };
+  alloc = (ClutterActorBox) {
+    .x2 = priv->tex_width,
+    .y2 = priv->tex_height,
+  };
+  paint_clipped_rectangle (framebuffer, pipeline, &rect, &alloc);
+  cogl_framebuffer_pop_matrix (framebuffer);
+}
+
 void
 meta_shaped_texture_set_fallback_size (MetaShapedTexture *self,
                                        guint              fallback_width,
@@ -1005,7 +1100,10 @@ meta_shaped_texture_cull_out (MetaCullable   *cullable,
   MetaShapedTexture *self = META_SHAPED_TEXTURE (cullable);
   MetaShapedTexturePrivate *priv = self->priv;
 
-  set_unobscured_region (self, unobscured_region);
+  /* A NULL unobscured region with a clip region means the one we
+   * recorded in the last full cull is still valid */
+  if (unobscured_region || !clip_region)
+    set_unobscured_region (self, unobscured_region);
   set_clip_region (self, clip_region);
 
   if (clutter_actor_get_paint_opacity (CLUTTER_ACTOR (self)) == 0xff)
@@ -1027,11 +1125,55 @@ meta_shaped_texture_reset_culling (MetaCullable *cullable)
   set_clip_region (self, NULL);
 }
 
+static void
+meta_shaped_texture_append_culling_inputs (MetaCullable *cullable,
+                                           GByteArray   *inputs)
+{
+  MetaShapedTexture *self = META_SHAPED_TEXTURE (cullable);
+  MetaShapedTexturePrivate *priv = self->priv;
+  gboolean opaque;
+  int width, height;
+  int n_rects, i;
+
+  if (priv->texture)
+    {
+      width = priv->tex_width;
+      height = priv->tex_height;
+    }
+  else
+    {
+      width = priv->fallback_width;
+      height = priv->fallback_height;
+    }
+
+  g_byte_array_append (inputs, (const guint8 *) &width, sizeof (width));
+  g_byte_array_append (inputs, (const guint8 *) &height, sizeof (height));
+
+  opaque = (priv->opaque_region != NULL &&
+            clutter_actor_get_paint_opacity (CLUTTER_ACTOR (self)) == 0xff);
+  g_byte_array_append (inputs, (const guint8 *) &opaque, sizeof (opaque));
+
+  if (!opaque)
+    return;
+
+  n_rects = cairo_region_num_rectangles (priv->opaque_region);
+  g_byte_array_append (inputs, (const guint8 *) &n_rects, sizeof (n_rects));
+
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (priv->opaque_region, i, &rect);
+      g_byte_array_append (inputs, (const guint8 *) &rect, sizeof (rect));
+    }
+}
+
 static void
 cullable_iface_init (MetaCullableInterface *iface)
 {
   iface->cull_out = meta_shaped_texture_cull_out;
   iface->reset_culling = meta_shaped_texture_reset_culling;
+  iface->append_culling_inputs = meta_shaped_texture_append_culling_inputs;
 }
 
 ClutterActor *
@@ -37,6 +37,7 @@ G_DEFINE_ABSTRACT_TYPE_WITH_CODE (MetaSurfaceActor, meta_surface_actor, CLUTTER_
 enum {
   REPAINT_SCHEDULED,
   SIZE_CHANGED,
+  DAMAGED,
 
   LAST_SIGNAL,
 };
@@ -61,38 +62,23 @@ meta_surface_actor_pick (ClutterActor       *actor,
   else
     {
       int n_rects;
-      float *rectangles;
       int i;
-      CoglPipeline *pipeline;
-      CoglContext *ctx;
-      CoglFramebuffer *fb;
-      CoglColor cogl_color;
 
       n_rects = cairo_region_num_rectangles (priv->input_region);
-      rectangles = g_alloca (sizeof (float) * 4 * n_rects);
 
       for (i = 0; i < n_rects; i++)
         {
           cairo_rectangle_int_t rect;
-          int pos = i * 4;
+          ClutterActorBox box;
 
           cairo_region_get_rectangle (priv->input_region, i, &rect);
 
-          rectangles[pos + 0] = rect.x;
-          rectangles[pos + 1] = rect.y;
-          rectangles[pos + 2] = rect.x + rect.width;
-          rectangles[pos + 3] = rect.y + rect.height;
+          box.x1 = rect.x;
+          box.y1 = rect.y;
+          box.x2 = rect.x + rect.width;
+          box.y2 = rect.y + rect.height;
+          clutter_actor_pick_box (actor, &box);
         }
-
-      ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
-      fb = cogl_get_draw_framebuffer ();
-
-      cogl_color_init_from_4ub (&cogl_color, color->red, color->green, color->blue, color->alpha);
-
-      pipeline = cogl_pipeline_new (ctx);
-      cogl_pipeline_set_color (pipeline, &cogl_color);
-      cogl_framebuffer_draw_rectangles (fb, pipeline, rectangles, n_rects);
-      cogl_object_unref (pipeline);
     }
 
   clutter_actor_iter_init (&iter, actor);
@@ -120,6 +106,7 @@ meta_surface_actor_class_init (MetaSurfaceActorClass *klass)
 
   object_class->dispose = meta_surface_actor_dispose;
   actor_class->pick = meta_surface_actor_pick;
+  clutter_actor_class_set_geometric_pick (actor_class);
 
   signals[REPAINT_SCHEDULED] = g_signal_new ("repaint-scheduled",
                                              G_TYPE_FROM_CLASS (object_class),
@@ -135,6 +122,19 @@ meta_surface_actor_class_init (MetaSurfaceActorClass *klass)
                                         NULL, NULL, NULL,
                                         G_TYPE_NONE, 0);
 
+  /* Emitted for all damage applied to the surface contents, whether or not
+   * the surface is visible, in texture coordinates. */
+  signals[DAMAGED] = g_signal_new ("damaged",
+                                   G_TYPE_FROM_CLASS (object_class),
+                                   G_SIGNAL_RUN_LAST,
+                                   0,
+                                   NULL, NULL, NULL,
+                                   G_TYPE_NONE, 4,
+                                   G_TYPE_INT,
+                                   G_TYPE_INT,
+                                   G_TYPE_INT,
+                                   G_TYPE_INT);
+
   g_type_class_add_private (klass, sizeof (MetaSurfaceActorPrivate));
 }
 
@@ -225,6 +225,10 @@ meta_surface_actor_set_input_region (MetaSurfaceActor *self,
     priv->input_region = cairo_region_reference (region);
   else
     priv->input_region = NULL;
+
+  /* Geometric picking reuses the pickable areas of the last pick until
+   * the scene changes, which it detects through queued redraws. */
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (self));
 }
 
 void
@@ -281,6 +285,8 @@ meta_surface_actor_process_damage (MetaSurfaceActor *self,
 
   META_SURFACE_ACTOR_GET_CLASS (self)->process_damage (self, x, y, width, height);
 
+  g_signal_emit (self, signals[DAMAGED], 0, x, y, width, height);
+
   if (meta_surface_actor_is_visible (self))
     meta_surface_actor_update_area (self, x, y, width, height);
 }
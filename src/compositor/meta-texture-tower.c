@@ -26,12 +26,20 @@
 #include "meta-texture-tower.h"
 #include "meta-texture-rectangle.h"
 
+#include <meta/util.h>
+
 #ifndef M_LOG2E
 #define M_LOG2E 1.4426950408889634074
 #endif
 
 #define MAX_TEXTURE_LEVELS 12
 
+/* The scaled down levels are only needed while a window is painted scaled
+ * down, e.g. in the overview, but would otherwise stay around as long as the
+ * window does. Keep at most this many bytes in them over all towers, and
+ * throw away the levels of the least recently painted towers beyond that. */
+#define LEVELS_MEMORY_BUDGET (128 * 1024 * 1024)
+
 /* If the texture format in memory doesn't match this, then Mesa
  * will do the conversion, so things will still work, but it might
  * be slow depending on how efficient Mesa is. These should be the
@@ -61,8 +69,89 @@ struct _MetaTextureTower
   CoglOffscreen *fbos[MAX_TEXTURE_LEVELS];
   Box invalid[MAX_TEXTURE_LEVELS];
   CoglPipeline *pipeline_template;
+
+  size_t levels_bytes;
+  GList lru_link;
+  guint64 painted_frame;
 };
 
+/* Towers with scaled down levels, most recently painted first */
+static GQueue towers_lru = G_QUEUE_INIT;
+static size_t resident_levels_bytes;
+
+/* Counts the frames the budget was enforced after; towers painted with the
+ * current value are on screen and are never evicted. */
+static guint64 current_frame = 1;
+static guint budget_repaint_func_id;
+
+static void
+texture_tower_free_levels (MetaTextureTower *tower)
+{
+  int i;
+
+  for (i = 1; i < tower->n_levels; i++)
+    {
+      g_clear_pointer (&tower->textures[i], cogl_object_unref);
+      g_clear_pointer (&tower->fbos[i], cogl_object_unref);
+    }
+
+  if (tower->levels_bytes > 0)
+    {
+      g_queue_unlink (&towers_lru, &tower->lru_link);
+      resident_levels_bytes -= tower->levels_bytes;
+      tower->levels_bytes = 0;
+    }
+}
+
+static gboolean
+enforce_levels_memory_budget (gpointer data)
+{
+  int n_evicted = 0;
+
+  /* Towers painted in the frame that just finished are all at the head of
+   * the list; evicting them would only recreate them in the next frame, so
+   * stay over budget rather than thrash while that much is visible. */
+  while (resident_levels_bytes > LEVELS_MEMORY_BUDGET &&
+         towers_lru.tail != NULL)
+    {
+      MetaTextureTower *tower = towers_lru.tail->data;
+
+      if (tower->painted_frame == current_frame)
+        break;
+
+      texture_tower_free_levels (tower);
+      n_evicted++;
+    }
+
+  if (n_evicted > 0)
+    meta_topic (META_DEBUG_COMPOSITOR,
+                "Evicted scaled down textures of %d windows, "
+                "%" G_GSIZE_FORMAT " bytes resident\n",
+                n_evicted, resident_levels_bytes);
+
+  current_frame++;
+
+  return TRUE;
+}
+
+static void
+texture_tower_mark_painted (MetaTextureTower *tower)
+{
+  tower->painted_frame = current_frame;
+
+  if (budget_repaint_func_id == 0)
+    budget_repaint_func_id =
+      clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                             enforce_levels_memory_budget,
+                                             NULL, NULL);
+
+  if (towers_lru.head == &tower->lru_link)
+    return;
+
+  g_queue_unlink (&towers_lru, &tower->lru_link);
+  g_queue_push_head_link (&towers_lru, &tower->lru_link);
+}
+
 /**
  * meta_texture_tower_new:
  *
@@ -77,6 +166,7 @@ meta_texture_tower_new (void)
   MetaTextureTower *tower;
 
   tower = g_slice_new0 (MetaTextureTower);
+  tower->lru_link.data = tower;
 
   return tower;
 }
@@ -114,8 +204,6 @@ void
 meta_texture_tower_set_base_texture (MetaTextureTower *tower,
                                      CoglTexture      *texture)
 {
-  int i;
-
   g_return_if_fail (tower != NULL);
 
   if (texture == tower->textures[0])
@@ -123,21 +211,7 @@ meta_texture_tower_set_base_texture (MetaTextureTower *tower,
 
   if (tower->textures[0] != NULL)
     {
-      for (i = 1; i < tower->n_levels; i++)
-        {
-          if (tower->textures[i] != NULL)
-            {
-              cogl_object_unref (tower->textures[i]);
-              tower->textures[i] = NULL;
-            }
-
-          if (tower->fbos[i] != NULL)
-            {
-              cogl_object_unref (tower->fbos[i]);
-              tower->fbos[i] = NULL;
-            }
-        }
-
+      texture_tower_free_levels (tower);
       cogl_object_unref (tower->textures[0]);
     }
 
@@ -377,6 +451,17 @@ texture_tower_create_texture (MetaTextureTower *tower,
   tower->invalid[level].y1 = 0;
   tower->invalid[level].x2 = width;
   tower->invalid[level].y2 = height;
+
+  if (tower->levels_bytes == 0)
+    g_queue_push_head_link (&towers_lru, &tower->lru_link);
+
+  tower->levels_bytes += (size_t) width * height * 4;
+  resident_levels_bytes += (size_t) width * height * 4;
+
+  meta_topic (META_DEBUG_COMPOSITOR,
+              "Created %dx%d scaled down texture, "
+              "%" G_GSIZE_FORMAT " bytes resident\n",
+              width, height, resident_levels_bytes);
 }
 
 static void
@@ -464,6 +549,9 @@ meta_texture_tower_get_paint_texture (MetaTextureTower *tower)
     return NULL;
   level = MIN (level, tower->n_levels - 1);
 
+  if (level == 0)
+    return tower->textures[0];
+
   if (tower->textures[level] == NULL ||
       (tower->invalid[level].x2 != tower->invalid[level].x1 &&
        tower->invalid[level].y2 != tower->invalid[level].y1))
@@ -488,5 +576,7 @@ meta_texture_tower_get_paint_texture (MetaTextureTower *tower)
        }
    }
 
+  texture_tower_mark_painted (tower);
+
   return tower->textures[level];
 }
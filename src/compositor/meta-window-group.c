@@ -4,9 +4,11 @@
 
 #define _ISOC99_SOURCE /* for roundf */
 #include <math.h>
+#include <string.h>
 
 #include <gdk/gdk.h> /* for gdk_rectangle_intersect() */
 
+#include "clutter/clutter-mutter.h"
 #include "clutter-utils.h"
 #include "compositor-private.h"
 #include "meta-window-actor-private.h"
@@ -24,6 +26,11 @@ struct _MetaWindowGroup
   ClutterActor parent;
 
   MetaScreen *screen;
+
+  /* What the unobscured regions recorded by our descendants were computed
+   * from, and scratch space for comparing against it. */
+  GByteArray *culling_inputs;
+  GByteArray *pending_culling_inputs;
 };
 
 static void cullable_iface_init (MetaCullableInterface *iface);
@@ -52,11 +59,60 @@ cullable_iface_init (MetaCullableInterface *iface)
   iface->reset_culling = meta_window_group_reset_culling;
 }
 
+static gboolean
+culling_inputs_changed (MetaWindowGroup       *window_group,
+                        cairo_rectangle_int_t *visible_rect)
+{
+  GByteArray *inputs = window_group->pending_culling_inputs;
+
+  g_byte_array_set_size (inputs, 0);
+  g_byte_array_append (inputs, (const guint8 *) visible_rect,
+                       sizeof (*visible_rect));
+  meta_cullable_append_culling_inputs (META_CULLABLE (window_group), inputs);
+
+  if (inputs->len == window_group->culling_inputs->len &&
+      memcmp (inputs->data, window_group->culling_inputs->data, inputs->len) == 0)
+    return FALSE;
+
+  window_group->pending_culling_inputs = window_group->culling_inputs;
+  window_group->culling_inputs = inputs;
+
+  return TRUE;
+}
+
+/**
+ * meta_window_group_cull:
+ * @window_group: a #MetaWindowGroup
+ * @visible_rect: the part of the stage that can be seen
+ * @clip_region: the clip region, in @window_group's space
+ *
+ * Culls out the children of @window_group before painting. The unobscured
+ * regions are only recomputed when the stacking, position, visibility or
+ * opaque region of any descendant changed since the last call; otherwise
+ * only @clip_region is walked down the stack, which stays cheap no matter
+ * how many windows are stacked on top of each other.
+ */
+void
+meta_window_group_cull (MetaWindowGroup       *window_group,
+                        cairo_rectangle_int_t *visible_rect,
+                        cairo_region_t        *clip_region)
+{
+  cairo_region_t *unobscured_region = NULL;
+
+  if (culling_inputs_changed (window_group, visible_rect))
+    unobscured_region = cairo_region_create_rectangle (visible_rect);
+
+  meta_cullable_cull_out (META_CULLABLE (window_group),
+                          unobscured_region, clip_region);
+
+  if (unobscured_region)
+    cairo_region_destroy (unobscured_region);
+}
+
 static void
 meta_window_group_paint (ClutterActor *actor)
 {
   cairo_region_t *clip_region;
-  cairo_region_t *unobscured_region;
   cairo_rectangle_int_t visible_rect, clip_rect;
   int paint_x_origin, paint_y_origin;
   int screen_width, screen_height;
@@ -101,8 +157,6 @@ meta_window_group_paint (ClutterActor *actor)
   visible_rect.width = clutter_actor_get_width (CLUTTER_ACTOR (stage));
   visible_rect.height = clutter_actor_get_height (CLUTTER_ACTOR (stage));
 
-  unobscured_region = cairo_region_create_rectangle (&visible_rect);
-
   /* Get the clipped redraw bounds from Clutter so that we can avoid
    * painting shadows on windows that don't need to be painted in this
    * frame. In the case of a multihead setup with mismatched monitor
@@ -116,9 +170,10 @@ meta_window_group_paint (ClutterActor *actor)
 
   cairo_region_translate (clip_region, -paint_x_origin, -paint_y_origin);
 
-  meta_cullable_cull_out (META_CULLABLE (window_group), unobscured_region, clip_region);
+  clutter_frame_timings_begin_phase (CLUTTER_FRAME_PHASE_CULL);
+  meta_window_group_cull (window_group, &visible_rect, clip_region);
+  clutter_frame_timings_end_phase (CLUTTER_FRAME_PHASE_CULL);
 
-  cairo_region_destroy (unobscured_region);
   cairo_region_destroy (clip_region);
 
   CLUTTER_ACTOR_CLASS (meta_window_group_parent_class)->paint (actor);
@@ -182,11 +237,25 @@ meta_window_group_get_preferred_height (ClutterActor *actor,
   *nat_height = 0;
 }
 
+static void
+meta_window_group_finalize (GObject *object)
+{
+  MetaWindowGroup *window_group = META_WINDOW_GROUP (object);
+
+  g_byte_array_unref (window_group->culling_inputs);
+  g_byte_array_unref (window_group->pending_culling_inputs);
+
+  G_OBJECT_CLASS (meta_window_group_parent_class)->finalize (object);
+}
+
 static void
 meta_window_group_class_init (MetaWindowGroupClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
   ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
 
+  object_class->finalize = meta_window_group_finalize;
+
   actor_class->paint = meta_window_group_paint;
   actor_class->get_paint_volume = meta_window_group_get_paint_volume;
   actor_class->get_preferred_width = meta_window_group_get_preferred_width;
@@ -196,6 +265,8 @@ meta_window_group_class_init (MetaWindowGroupClass *klass)
 static void
 meta_window_group_init (MetaWindowGroup *window_group)
 {
+  window_group->culling_inputs = g_byte_array_new ();
+  window_group->pending_culling_inputs = g_byte_array_new ();
 }
 
 ClutterActor *
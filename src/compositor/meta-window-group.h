@@ -31,6 +31,10 @@ GType meta_window_group_get_type (void);
 
 ClutterActor *meta_window_group_new (MetaScreen *screen);
 
+void meta_window_group_cull (MetaWindowGroup       *window_group,
+                             cairo_rectangle_int_t *visible_rect,
+                             cairo_region_t        *clip_region);
+
 gboolean meta_window_group_actor_is_untransformed (ClutterActor *actor,
                                                    int          *x_origin,
                                                    int          *y_origin);
@@ -0,0 +1,52 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "tests/benchmark-utils.h"
+
+#include <glib.h>
+
+/* The shape of a window with rounded top corners, as the default theme
+ * and most CSD windows have */
+cairo_region_t *
+create_rounded_window_region (int width,
+                              int height)
+{
+  static const int corner[] = { 5, 3, 2, 1, 1 };
+  cairo_region_t *region;
+  int i;
+
+  region = cairo_region_create_rectangle (&(cairo_rectangle_int_t) {
+                                            .y = G_N_ELEMENTS (corner),
+                                            .width = width,
+                                            .height = height - G_N_ELEMENTS (corner),
+                                          });
+
+  for (i = 0; i < (int) G_N_ELEMENTS (corner); i++)
+    cairo_region_union_rectangle (region,
+                                  &(cairo_rectangle_int_t) {
+                                    .x = corner[i],
+                                    .y = i,
+                                    .width = width - 2 * corner[i],
+                                    .height = 1,
+                                  });
+
+  return region;
+}
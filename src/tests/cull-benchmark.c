@@ -0,0 +1,173 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/* Times culling out a deep stack of windows before painting */
+
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Needs a display Clutter can open, but never paints anything. The
+ * "static" rows are the common case of nothing but window contents
+ * changing; the "moving" rows move the topmost window every frame, which
+ * forces the unobscured regions to be recomputed and is what every frame
+ * cost before culling results were kept across frames. Both must report
+ * the same number of obscured windows.
+ */
+
+#include "config.h"
+
+#include <clutter/clutter.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "compositor/meta-cullable.h"
+#include "compositor/meta-shaped-texture-private.h"
+#include "compositor/meta-window-group.h"
+#include "tests/benchmark-utils.h"
+
+#define N_WINDOWS 500
+#define N_FRAMES 200
+
+#define STAGE_WIDTH 1920
+#define STAGE_HEIGHT 1080
+
+static const struct {
+  int width;
+  int height;
+} window_sizes[] = {
+  { 640, 480 },
+  { 800, 600 },
+  { 320, 240 },
+  { 1024, 768 },
+  { 480, 640 },
+};
+
+static ClutterActor *
+create_window (int i)
+{
+  int width = window_sizes[i % G_N_ELEMENTS (window_sizes)].width;
+  int height = window_sizes[i % G_N_ELEMENTS (window_sizes)].height;
+  ClutterActor *actor;
+  cairo_region_t *opaque_region;
+
+  actor = meta_shaped_texture_new ();
+  meta_shaped_texture_set_fallback_size (META_SHAPED_TEXTURE (actor),
+                                         width, height);
+  clutter_actor_set_size (actor, width, height);
+  clutter_actor_set_position (actor,
+                              (i * 37) % (STAGE_WIDTH - width),
+                              (i * 23) % (STAGE_HEIGHT - height));
+
+  opaque_region = create_rounded_window_region (width, height);
+  meta_shaped_texture_set_opaque_region (META_SHAPED_TEXTURE (actor),
+                                         opaque_region);
+  cairo_region_destroy (opaque_region);
+
+  return actor;
+}
+
+static int
+count_obscured (ClutterActor *window_group)
+{
+  ClutterActorIter iter;
+  ClutterActor *child;
+  int n_obscured = 0;
+
+  clutter_actor_iter_init (&iter, window_group);
+  while (clutter_actor_iter_next (&iter, &child))
+    {
+      if (meta_shaped_texture_is_obscured (META_SHAPED_TEXTURE (child)))
+        n_obscured++;
+    }
+
+  return n_obscured;
+}
+
+static void
+run_benchmark (ClutterActor                *window_group,
+               const char                  *name,
+               const cairo_rectangle_int_t *clip_rect,
+               gboolean                     move_top_window)
+{
+  cairo_rectangle_int_t visible_rect = {
+    .width = STAGE_WIDTH,
+    .height = STAGE_HEIGHT,
+  };
+  ClutterActor *top_window = clutter_actor_get_last_child (window_group);
+  float top_x = clutter_actor_get_x (top_window);
+  gint64 start_us, elapsed_us;
+  char clip[32];
+  int i;
+
+  start_us = g_get_monotonic_time ();
+  for (i = 0; i < N_FRAMES; i++)
+    {
+      cairo_region_t *clip_region;
+
+      if (move_top_window)
+        clutter_actor_set_x (top_window, top_x + 1 + (i % 2));
+
+      clip_region = cairo_region_create_rectangle (clip_rect);
+      meta_window_group_cull (META_WINDOW_GROUP (window_group),
+                              &visible_rect, clip_region);
+      cairo_region_destroy (clip_region);
+
+      meta_cullable_reset_culling (META_CULLABLE (window_group));
+    }
+  elapsed_us = g_get_monotonic_time () - start_us;
+
+  clutter_actor_set_x (top_window, top_x);
+
+  g_snprintf (clip, sizeof (clip), "%dx%d", clip_rect->width, clip_rect->height);
+  printf ("%-8s %8d %-10s %12.3f %9d\n",
+          name, N_WINDOWS, clip,
+          elapsed_us / 1000.0 / N_FRAMES,
+          count_obscured (window_group));
+}
+
+int
+main (int argc, char **argv)
+{
+  const cairo_rectangle_int_t damage_rect = { 900, 500, 16, 16 };
+  const cairo_rectangle_int_t full_rect = { 0, 0, STAGE_WIDTH, STAGE_HEIGHT };
+  ClutterActor *stage, *window_group;
+  int i;
+
+  if (clutter_init (&argc, &argv) != CLUTTER_INIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  stage = clutter_stage_new ();
+  clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
+
+  window_group = meta_window_group_new (NULL);
+  clutter_actor_add_child (stage, window_group);
+
+  for (i = 0; i < N_WINDOWS; i++)
+    clutter_actor_add_child (window_group, create_window (i));
+
+  printf ("%-8s %8s %-10s %12s %9s\n",
+          "frames", "windows", "clip", "ms/frame", "obscured");
+
+  run_benchmark (window_group, "static", &damage_rect, FALSE);
+  run_benchmark (window_group, "static", &full_rect, FALSE);
+  run_benchmark (window_group, "moving", &damage_rect, TRUE);
+  run_benchmark (window_group, "moving", &full_rect, TRUE);
+
+  clutter_actor_destroy (stage);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/* Times the CPU side of creating window shadows */
+
+/*
+ * Copyright (C) 2018 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Every shadow is also blurred with the generic kernels, and the program
+ * fails if the output of the SIMD kernels differs. Run with
+ * MUTTER_DEBUG_DISABLE_SIMD_SHADOWS=1 set to time the generic kernels
+ * instead; the checksums must not change.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "compositor/meta-shadow-factory-private.h"
+#include "tests/benchmark-utils.h"
+
+#define N_ITERATIONS 20
+
+static const struct {
+  int width;
+  int height;
+} window_sizes[] = {
+  { 320, 240 },
+  { 800, 600 },
+  { 1280, 1024 },
+  { 1920, 1080 },
+};
+
+static const int radii[] = { 4, 12, 24, 40 };
+
+static guint32
+checksum (const guchar *buffer,
+          int           size)
+{
+  guint32 a = 1, b = 0;
+  int i;
+
+  for (i = 0; i < size; i++)
+    {
+      a = (a + buffer[i]) % 65521;
+      b = (b + a) % 65521;
+    }
+
+  return (b << 16) | a;
+}
+
+int
+main (int argc, char **argv)
+{
+  unsigned int i, j;
+  int status = EXIT_SUCCESS;
+
+  printf ("%-12s %6s %12s %10s\n", "size", "radius", "ms/shadow", "checksum");
+
+  for (i = 0; i < G_N_ELEMENTS (window_sizes); i++)
+    {
+      cairo_region_t *region =
+        create_rounded_window_region (window_sizes[i].width,
+                                      window_sizes[i].height);
+
+      for (j = 0; j < G_N_ELEMENTS (radii); j++)
+        {
+          guchar *buffer = NULL;
+          guchar *expected_buffer;
+          int buffer_width, buffer_height;
+          int expected_width, expected_height;
+          gint64 start_us, elapsed_us;
+          char size[32];
+          int k;
+
+          start_us = g_get_monotonic_time ();
+          for (k = 0; k < N_ITERATIONS; k++)
+            {
+              g_free (buffer);
+              buffer = meta_shadow_blur_region (region, radii[j],
+                                                &buffer_width,
+                                                &buffer_height);
+            }
+          elapsed_us = g_get_monotonic_time () - start_us;
+
+          g_snprintf (size, sizeof (size), "%dx%d",
+                      window_sizes[i].width, window_sizes[i].height);
+          printf ("%-12s %6d %12.3f %10.8x\n",
+                  size, radii[j],
+                  elapsed_us / 1000.0 / N_ITERATIONS,
+                  checksum (buffer, buffer_width * buffer_height));
+
+          expected_buffer = meta_shadow_blur_region_generic (region, radii[j],
+                                                             &expected_width,
+                                                             &expected_height);
+          if (expected_width != buffer_width ||
+              expected_height != buffer_height ||
+              memcmp (expected_buffer, buffer,
+                      buffer_width * buffer_height) != 0)
+            {
+              fprintf (stderr, "%s radius %d: differs from the generic blur\n",
+                       size, radii[j]);
+              status = EXIT_FAILURE;
+            }
+
+          g_free (expected_buffer);
+          g_free (buffer);
+        }
+
+      cairo_region_destroy (region);
+    }
+
+  return status;
+}
@@ -388,48 +388,208 @@ meta_wayland_buffer_is_y_inverted (MetaWaylandBuffer *buffer)
   return buffer->is_y_inverted;
 }
 
+/* Every upload is a separate trip through cogl and the GL driver; below this
+ * many bytes, also uploading some undamaged pixels is cheaper than issuing
+ * another upload. */
+#define SHM_UPLOAD_CALL_COST_BYTES (16 * 1024)
+
+/* Trying every pair of rectangles is cubic in their number; beyond this
+ * many, only neighbours in the region's banded order are merged. */
+#define SHM_UPLOAD_MAX_PAIRWISE_RECTS 32
+
+static size_t
+rect_bytes (const cairo_rectangle_int_t *rect,
+            int                          bpp)
+{
+  return (size_t) rect->width * rect->height * bpp;
+}
+
+static void
+union_rect (const cairo_rectangle_int_t *a,
+            const cairo_rectangle_int_t *b,
+            cairo_rectangle_int_t       *out)
+{
+  int x1 = MIN (a->x, b->x);
+  int y1 = MIN (a->y, b->y);
+  int x2 = MAX (a->x + a->width, b->x + b->width);
+  int y2 = MAX (a->y + a->height, b->y + b->height);
+
+  out->x = x1;
+  out->y = y1;
+  out->width = x2 - x1;
+  out->height = y2 - y1;
+}
+
+static gboolean
+try_merge_rects (const cairo_rectangle_int_t *a,
+                 const cairo_rectangle_int_t *b,
+                 int                          bpp,
+                 cairo_rectangle_int_t       *out)
+{
+  cairo_rectangle_int_t merged_rect;
+  size_t separate_bytes;
+
+  union_rect (a, b, &merged_rect);
+  separate_bytes = (rect_bytes (a, bpp) + rect_bytes (b, bpp) +
+                    SHM_UPLOAD_CALL_COST_BYTES);
+  if (rect_bytes (&merged_rect, bpp) > separate_bytes)
+    return FALSE;
+
+  *out = merged_rect;
+  return TRUE;
+}
+
+/*
+ * Merges each rectangle into the one before it when that pays off. Region
+ * rectangles are sorted by band and then by x, so this catches runs along
+ * a row and rows stacked below each other in linear time.
+ */
+static int
+merge_neighbour_rects (cairo_rectangle_int_t *rects,
+                       int                    n_rects,
+                       int                    bpp)
+{
+  int n_merged = 1;
+  int i;
+
+  for (i = 1; i < n_rects; i++)
+    {
+      if (!try_merge_rects (&rects[n_merged - 1], &rects[i], bpp,
+                            &rects[n_merged - 1]))
+        rects[n_merged++] = rects[i];
+    }
+
+  return n_merged;
+}
+
+/*
+ * Turns the damage region into a list of rectangles to upload, merging
+ * rectangles whenever the wasted bytes of the merged rectangle cost less
+ * than the extra upload would. Returns the number of rectangles written to
+ * @rects, which must have room for all the rectangles in @region.
+ */
+static int
+plan_shm_damage_upload (cairo_region_t        *region,
+                        int                    bpp,
+                        cairo_rectangle_int_t *rects)
+{
+  cairo_rectangle_int_t extents;
+  size_t damaged_bytes = 0;
+  int n_rects, i, j;
+  gboolean merged;
+
+  n_rects = cairo_region_num_rectangles (region);
+  if (n_rects <= 1)
+    {
+      if (n_rects == 1)
+        cairo_region_get_rectangle (region, 0, &rects[0]);
+      return n_rects;
+    }
+
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_region_get_rectangle (region, i, &rects[i]);
+      damaged_bytes += rect_bytes (&rects[i], bpp);
+    }
+
+  /* The common case of many small rectangles close together is a single
+   * upload of the extents; don't bother pairing them up. */
+  cairo_region_get_extents (region, &extents);
+  if (rect_bytes (&extents, bpp) - damaged_bytes <
+      (size_t) (n_rects - 1) * SHM_UPLOAD_CALL_COST_BYTES)
+    {
+      rects[0] = extents;
+      return 1;
+    }
+
+  if (n_rects > SHM_UPLOAD_MAX_PAIRWISE_RECTS)
+    {
+      n_rects = merge_neighbour_rects (rects, n_rects, bpp);
+      if (n_rects > SHM_UPLOAD_MAX_PAIRWISE_RECTS)
+        return n_rects;
+    }
+
+  do
+    {
+      merged = FALSE;
+
+      for (i = 0; i < n_rects; i++)
+        {
+          for (j = i + 1; j < n_rects; j++)
+            {
+              if (!try_merge_rects (&rects[i], &rects[j], bpp, &rects[i]))
+                continue;
+
+              rects[j] = rects[--n_rects];
+              merged = TRUE;
+              j = i;
+            }
+        }
+    }
+  while (merged);
+
+  return n_rects;
+}
+
 static gboolean
 process_shm_buffer_damage (MetaWaylandBuffer *buffer,
                            cairo_region_t    *region,
                            GError           **error)
 {
   struct wl_shm_buffer *shm_buffer;
-  int i, n_rectangles;
+  const uint8_t *data;
+  int32_t stride;
+  CoglPixelFormat format;
+  int bpp;
+  cairo_rectangle_int_t *rects;
+  int i, n_rects;
+  size_t uploaded_bytes = 0;
   gboolean set_texture_failed = FALSE;
 
-  n_rectangles = cairo_region_num_rectangles (region);
-
   shm_buffer = wl_shm_buffer_get (buffer->resource);
+  shm_buffer_get_cogl_pixel_format (shm_buffer, &format, NULL);
+  bpp = _cogl_pixel_format_get_bytes_per_pixel (format);
+
+  rects = g_new (cairo_rectangle_int_t, cairo_region_num_rectangles (region));
+  n_rects = plan_shm_damage_upload (region, bpp, rects);
+
   wl_shm_buffer_begin_access (shm_buffer);
 
-  for (i = 0; i < n_rectangles; i++)
-    {
-      const uint8_t *data = wl_shm_buffer_get_data (shm_buffer);
-      int32_t stride = wl_shm_buffer_get_stride (shm_buffer);
-      CoglPixelFormat format;
-      int bpp;
-      cairo_rectangle_int_t rect;
+  data = wl_shm_buffer_get_data (shm_buffer);
+  stride = wl_shm_buffer_get_stride (shm_buffer);
 
-      shm_buffer_get_cogl_pixel_format (shm_buffer, &format, NULL);
-      bpp = _cogl_pixel_format_get_bytes_per_pixel (format);
-      cairo_region_get_rectangle (region, i, &rect);
+  /* Upload straight from the client buffer; cogl passes the stride on as
+   * the unpack row length, so the rectangles need no repacking. */
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t *rect = &rects[i];
 
       if (!_cogl_texture_set_region (buffer->texture,
-                                     rect.width, rect.height,
+                                     rect->width, rect->height,
                                      format,
                                      stride,
-                                     data + rect.x * bpp + rect.y * stride,
-                                     rect.x, rect.y,
+                                     data + rect->x * bpp + rect->y * stride,
+                                     rect->x, rect->y,
                                      0,
                                      error))
         {
           set_texture_failed = TRUE;
           break;
         }
+
+      uploaded_bytes += rect_bytes (rect, bpp);
     }
 
   wl_shm_buffer_end_access (shm_buffer);
 
+  meta_topic (META_DEBUG_COMPOSITOR,
+              "Uploaded %d damage rectangles of buffer %p in %d calls, "
+              "%" G_GSIZE_FORMAT " bytes\n",
+              cairo_region_num_rectangles (region), buffer,
+              i, uploaded_bytes);
+
+  g_free (rects);
+
   return !set_texture_failed;
 }
 